@@ -10,6 +10,16 @@ namespace internal {
 // no parallel algorithm (such as parallel_reduce) should split work into
 // smaller than GRAIN_SIZE chunks.
 constexpr int64_t GRAIN_SIZE = 32768;
+
+// With NUMA enabled (--caffe2_cpu_numa_enabled) on a host with more than
+// one node, the native intra- and inter-op thread pools are sharded into one
+// pool per node, with workers bound to that node. Returns the number of
+// shards, 1 otherwise.
+CAFFE2_API int num_numa_pool_shards();
+
+// Returns the shard serving the calling thread, i.e. its current NUMA node,
+// or 0 if the pools are not sharded.
+CAFFE2_API int current_numa_pool_shard();
 } // namespace internal
 
 inline int64_t divup(int64_t x, int64_t y) {
@@ -26,7 +36,9 @@ CAFFE2_API void set_num_threads(int);
 CAFFE2_API int get_num_threads();
 
 // Returns the current thread number (starting from 0)
-// in the current parallel region, or 0 in the sequential region
+// in the current parallel region, or 0 in the sequential region.
+// It is below get_num_threads(), and a thread may run several chunks of
+// the same parallel_for under one number.
 CAFFE2_API int get_thread_num();
 
 // Checks whether the code runs in parallel region
@@ -3,7 +3,9 @@
 #include <ATen/Config.h>
 #include <ATen/PTThreadPool.h>
 #include <ATen/Version.h>
+#include <c10/util/numa.h>
 
+#include <algorithm>
 #include <sstream>
 #include <thread>
 
@@ -71,9 +73,16 @@ std::string get_parallel_info() {
   ss << "\tMKL_NUM_THREADS : "
      << get_env_var("MKL_NUM_THREADS", "[not set]") << std::endl;
 
+  if (internal::num_numa_pool_shards() > 1) {
+    ss << "Thread pools sharded over "
+       << internal::num_numa_pool_shards() << " NUMA nodes" << std::endl;
+  }
+
   ss << "ATen parallel backend: ";
   #if AT_PARALLEL_OPENMP
   ss << "OpenMP";
+  #elif AT_PARALLEL_NATIVE_WS
+  ss << "native work-stealing thread pool";
   #elif AT_PARALLEL_NATIVE
   ss << "native thread pool";
   #elif AT_PARALLEL_NATIVE_TBB
@@ -91,6 +100,29 @@ std::string get_parallel_info() {
   return ss.str();
 }
 
+namespace internal {
+
+int num_numa_pool_shards() {
+  static const int num_shards = []() {
+    if (!c10::IsNUMAEnabled()) {
+      return 1;
+    }
+    return std::max(c10::GetNumNUMANodes(), 1);
+  }();
+  return num_shards;
+}
+
+int current_numa_pool_shard() {
+  int num_shards = num_numa_pool_shards();
+  if (num_shards == 1) {
+    return 0;
+  }
+  int node = c10::GetCurrentNUMANode();
+  return node >= 0 && node < num_shards ? node : 0;
+}
+
+} // namespace internal
+
 int intraop_default_num_threads() {
 #ifdef C10_MOBILE
   // Intraop thread pool size should be determined by mobile cpuinfo.
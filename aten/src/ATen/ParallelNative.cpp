@@ -4,12 +4,17 @@
 
 #ifndef C10_MOBILE
 #include <c10/core/thread_pool.h>
+#if AT_PARALLEL_NATIVE_WS
+#include <c10/core/WorkStealingThreadPool.h>
+#endif
 #else
 #include <caffe2/utils/threadpool/ThreadPool.h>
 #include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 #endif // C10_MOBILE
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -55,28 +60,107 @@ const int CONSUMED = -2;
 //  - CONSUMED - pool is initialized
 std::atomic<int> num_intraop_threads{NOT_SET};
 
-int _num_pool_threads(int nthreads) {
-  if (nthreads == NOT_SET) {
-    nthreads = intraop_default_num_threads();
-  } else {
-    TORCH_INTERNAL_ASSERT(nthreads > 0);
+// The number of threads the pools were created with, in total over the NUMA
+// shards. Set once num_intraop_threads is CONSUMED.
+int num_intraop_pool_threads = 0;
+
+// With one pool per NUMA node, the index of the first worker of each node's
+// pool in the thread numbers of a parallel region, minus one; thread number 0
+// is the thread that starts the region. See Note [NUMA shards in parallel
+// regions]
+std::vector<int> intraop_shard_offsets;
+
+#if AT_PARALLEL_NATIVE_WS
+using IntraOpPool = c10::WorkStealingThreadPool;
+#else
+using IntraOpPool = TaskThreadPoolBase;
+#endif
+
+std::shared_ptr<IntraOpPool> _create_intraop_pool(
+    int pool_size, int numa_node_id) {
+#if AT_PARALLEL_NATIVE_WS
+  return std::make_shared<c10::WorkStealingThreadPool>(
+      pool_size,
+      numa_node_id,
+      []() {
+        c10::setThreadName("PTIntraOpPool");
+        init_num_threads();
+      });
+#else
+  if (numa_node_id < 0) {
+    return ThreadPoolRegistry()->Create(
+        "C10",
+        /* device_id */ 0,
+        pool_size,
+        /* create_new */ true); // create a separate thread pool for intra-op
+  }
+  return std::make_shared<c10::ThreadPool>(
+      pool_size,
+      numa_node_id,
+      [numa_node_id]() {
+        c10::setThreadName("PTIntraOpPool");
+        c10::NUMABind(numa_node_id);
+        init_num_threads();
+      });
+#endif // AT_PARALLEL_NATIVE_WS
+}
+
+// A single pool, or one pool per NUMA node (see
+// internal::num_numa_pool_shards), each with its share of the threads.
+std::vector<std::shared_ptr<IntraOpPool>>& _get_intraop_pools() {
+  static std::vector<std::shared_ptr<IntraOpPool>> pools = []() {
+    int nthreads = num_intraop_threads.exchange(CONSUMED);
+    if (nthreads == NOT_SET) {
+      nthreads = intraop_default_num_threads();
+    } else {
+      TORCH_INTERNAL_ASSERT(nthreads > 0);
+    }
+    num_intraop_pool_threads = nthreads;
+    std::vector<std::shared_ptr<IntraOpPool>> pools;
+    int num_shards = internal::num_numa_pool_shards();
+    if (num_shards == 1) {
+      // minus one because of the master thread
+      pools.push_back(_create_intraop_pool(nthreads - 1, -1));
+    } else {
+      // The workers are spread evenly over the nodes, and the thread that
+      // starts a parallel region makes up the last of the nthreads.
+      int num_workers = nthreads - 1;
+      int offset = 0;
+      for (int node = 0; node < num_shards; ++node) {
+        int pool_size = num_workers / num_shards +
+            (node < num_workers % num_shards ? 1 : 0);
+        intraop_shard_offsets.push_back(offset);
+        offset += pool_size;
+        pools.push_back(_create_intraop_pool(pool_size, node));
+      }
+    }
+    return pools;
+  }();
+  return pools;
+}
+
+// Returns the pool of the calling thread's NUMA node, so that parallel work
+// stays on the node that owns the caller's (freshly allocated) memory.
+IntraOpPool& _get_intraop_pool() {
+  auto& pools = _get_intraop_pools();
+  if (pools.size() == 1) {
+    return *pools[0];
   }
-  // minus one because of the master thread
-  return nthreads - 1;
+  return *pools[internal::current_numa_pool_shard()];
 }
 
-TaskThreadPoolBase& _get_intraop_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
-  return *pool;
+bool _in_intraop_pool() {
+  for (auto& pool : _get_intraop_pools()) {
+    if (pool->inThreadPool()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 #endif // C10_MOBILE
 
+#if !AT_PARALLEL_NATIVE_WS || defined(C10_MOBILE)
 // Run lambda function `fn` over `task_id` in [0, `range`) with threadpool.
 // `fn` will be called with params: (thread_pool_task_id, task_id).
 void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
@@ -98,6 +182,96 @@ void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
   }
 #endif // C10_MOBILE
 }
+#endif // !AT_PARALLEL_NATIVE_WS || C10_MOBILE
+
+#ifndef C10_MOBILE
+// Note [NUMA shards in parallel regions]
+// With one intra-op pool per NUMA node, a parallel region is started on the
+// pool of the calling thread's node, and the workers of the other nodes join
+// it: the caller posts one helper task per remote worker, and every thread
+// taking part claims task ids in order from a shared counter until none are
+// left. The threads of the caller's node start right away, so they take the
+// first tasks, and the remote workers take what is left when they get to
+// their helper task.
+//
+// The trade-off is locality: the tasks a remote worker claims usually touch
+// memory on the caller's node, which is still faster than leaving the
+// remote cores idle for a loop split into get_num_threads() tasks. A remote
+// worker that is busy with other work joins late or not at all, in which
+// case the region finishes on the threads that did join. Helper tasks that
+// start after the region has ended find the counter exhausted and return.
+//
+// Thread numbers stay below get_num_threads(): the caller is 0 and the k-th
+// worker (or helper task) of node s is 1 + intraop_shard_offsets[s] + k.
+struct ShardedRegion {
+  ShardedRegion(size_t num_tasks, const std::function<void(size_t, size_t)>& fn)
+      : num_tasks(num_tasks), remaining(num_tasks), fn(fn) {}
+
+  // Runs tasks until none are left to claim. fn is only called for a claimed
+  // task, and the region does not end before its claimed tasks are done.
+  void participate(size_t thread_num) {
+    for (size_t task_id = next_task++; task_id < num_tasks;
+         task_id = next_task++) {
+      fn(task_id, thread_num);
+      if (--remaining == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.notify_all();
+      }
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return remaining.load() == 0; });
+  }
+
+  const size_t num_tasks;
+  std::atomic<size_t> next_task{0};
+  std::atomic<size_t> remaining;
+  const std::function<void(size_t, size_t)>& fn;
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+// Runs fn(task_id, thread_num) for task_id in [0, num_tasks) on the pools of
+// all NUMA nodes; see Note [NUMA shards in parallel regions]
+void _run_on_all_shards(
+    size_t num_tasks,
+    const std::function<void(size_t, size_t)>& fn) {
+  auto& pools = _get_intraop_pools();
+  int local_shard = internal::current_numa_pool_shard();
+  // Shared with the helper tasks, which may start after this call returned.
+  auto region = std::make_shared<ShardedRegion>(num_tasks, fn);
+  auto post_helpers = [&](int shard) {
+    for (size_t k = 0; k < pools[shard]->size(); ++k) {
+      size_t thread_num = 1 + intraop_shard_offsets[shard] + k;
+      pools[shard]->run([region, thread_num]() {
+        region->participate(thread_num);
+      });
+    }
+  };
+#if !AT_PARALLEL_NATIVE_WS
+  post_helpers(local_shard);
+#endif
+  for (int shard = 0; shard < (int)pools.size(); ++shard) {
+    if (shard != local_shard) {
+      post_helpers(shard);
+    }
+  }
+#if AT_PARALLEL_NATIVE_WS
+  auto& local_pool = *pools[local_shard];
+  size_t local_offset = intraop_shard_offsets[local_shard];
+  local_pool.parallelRun(
+      local_pool.size() + 1,
+      [&region, local_offset](size_t /* task_id */, size_t thread_id) {
+        region->participate(thread_id == 0 ? 0 : local_offset + thread_id);
+      });
+#else
+  region->participate(0);
+#endif
+  region->wait();
+}
+#endif // C10_MOBILE
 
 // RAII guard helps to support in_parallel_region() and get_thread_num() API.
 struct ParallelRegionGuard {
@@ -127,17 +301,14 @@ void _parallel_run(
 
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
   std::exception_ptr eptr;
-  std::vector<std::shared_ptr<c10::ivalue::Future>> futures(num_tasks);
-  for (size_t task_id = 0; task_id < num_tasks; ++task_id) {
-    futures[task_id] = std::make_shared<c10::ivalue::Future>(c10::NoneType::get());
-  }
-  auto task = [f, &eptr, &err_flag, &futures, begin, end, chunk_size]
-      (int /* unused */, size_t task_id) {
+  // Runs a chunk with get_thread_num() reporting thread_num.
+  auto run_task = [&f, &eptr, &err_flag, begin, end, chunk_size](
+      size_t task_id, size_t thread_num) {
     int64_t local_start = begin + task_id * chunk_size;
     if (local_start < end) {
       int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
       try {
-        ParallelRegionGuard guard(task_id);
+        ParallelRegionGuard guard(thread_num);
         f(local_start, local_end, task_id);
       } catch (...) {
         if (!err_flag.test_and_set()) {
@@ -145,6 +316,30 @@ void _parallel_run(
         }
       }
     }
+  };
+#ifndef C10_MOBILE
+  if (_get_intraop_pools().size() > 1) {
+    _run_on_all_shards(num_tasks, run_task);
+    if (eptr) {
+      std::rethrow_exception(eptr);
+    }
+    return;
+  }
+#endif // C10_MOBILE
+#if AT_PARALLEL_NATIVE_WS && !defined(C10_MOBILE)
+  // The work-stealing pool runs the chunks on its workers and the calling
+  // thread without allocating a task or a future per chunk. There can be
+  // more tasks than threads, so get_thread_num() reports the executing
+  // thread rather than the task, which keeps it below get_num_threads(). A
+  // thread may run several tasks of the region under the same number.
+  _get_intraop_pool().parallelRun(num_tasks, run_task);
+#else
+  std::vector<std::shared_ptr<c10::ivalue::Future>> futures(num_tasks);
+  for (size_t task_id = 0; task_id < num_tasks; ++task_id) {
+    futures[task_id] = std::make_shared<c10::ivalue::Future>(c10::NoneType::get());
+  }
+  auto task = [&run_task, &futures](int /* unused */, size_t task_id) {
+    run_task(task_id, task_id);
     futures[task_id]->markCompleted();
   };
   _run_with_pool(task, num_tasks);
@@ -153,6 +348,7 @@ void _parallel_run(
   for (size_t task_id = 0; task_id < num_tasks; ++task_id) {
     futures[task_id]->wait();
   }
+#endif // AT_PARALLEL_NATIVE_WS
   if (eptr) {
     std::rethrow_exception(eptr);
   }
@@ -183,8 +379,8 @@ void set_num_threads(int nthreads) {
     // check that requested size is the same as the current one
     int stored_nthreads = num_intraop_threads.load();
     if (stored_nthreads <= 0) {
-      // plus one because of master thread
-      stored_nthreads = _get_intraop_pool().size() + 1;
+      _get_intraop_pools();
+      stored_nthreads = num_intraop_pool_threads;
     }
     if (stored_nthreads != nthreads) {
       TORCH_WARN(
@@ -209,7 +405,9 @@ int get_num_threads() {
     return intraop_default_num_threads();
   } else {
     TORCH_INTERNAL_ASSERT(nthreads == CONSUMED);
-    return _get_intraop_pool().size() + 1;
+    // The configured count rather than the size of one NUMA shard's pool.
+    _get_intraop_pools();
+    return num_intraop_pool_threads;
   }
 #else
   caffe2::ThreadPool* pool = caffe2::mobile_threadpool();
@@ -227,7 +425,7 @@ bool in_parallel_region() {
   return in_parallel_region_ || (
     num_intraop_threads.load() == CONSUMED &&
     // Needed as intraop_launch() doesn't set in_parallel_region().
-    _get_intraop_pool().inThreadPool()
+    _in_intraop_pool()
   );
 #else
   return in_parallel_region_;
@@ -15,7 +15,15 @@ inline std::tuple<size_t, size_t> calc_num_tasks_and_chunk_size(
     return std::make_tuple(1, std::max((int64_t)0, end - begin));
   }
   // Choose number of tasks based on grain size and number of threads.
+#if AT_PARALLEL_NATIVE_WS
+  // Over-decompose so that idle workers have something to steal when the
+  // cost of the chunks is uneven.
+  constexpr int64_t kTasksPerThread = 4;
+  size_t chunk_size =
+      divup((end - begin), get_num_threads() * kTasksPerThread);
+#else
   size_t chunk_size = divup((end - begin), get_num_threads());
+#endif
   // Make sure each task is at least grain_size size.
   chunk_size = std::max((size_t)grain_size, chunk_size);
   size_t num_tasks = divup((end - begin), chunk_size);
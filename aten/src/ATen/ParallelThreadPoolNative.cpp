@@ -3,6 +3,7 @@
 #include <ATen/PTThreadPool.h>
 #include <ATen/ThreadLocalDebugInfo.h>
 
+#include <algorithm>
 #include <atomic>
 
 namespace at {
@@ -18,16 +19,51 @@ const int CONSUMED = -2;
 // NOT_SET -> CONSUMED
 std::atomic<int> num_interop_threads{NOT_SET};
 
-// thread pool global instance is hidden,
+// The number of threads the pools were created with, in total over the NUMA
+// shards. Set once num_interop_threads is CONSUMED.
+int num_interop_pool_threads = 0;
+
+// thread pool global instances are hidden,
 // users should use at::launch and get/set_num_interop_threads interface
-TaskThreadPoolBase& get_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
+std::vector<std::shared_ptr<TaskThreadPoolBase>>& get_pools() {
+  static std::vector<std::shared_ptr<TaskThreadPoolBase>> pools = []() {
+    int nthreads = num_interop_threads.exchange(CONSUMED);
+    std::vector<std::shared_ptr<TaskThreadPoolBase>> pools;
+    int num_shards = internal::num_numa_pool_shards();
+    if (num_shards == 1) {
+      pools.push_back(ThreadPoolRegistry()->Create(
           "C10",
           /* device_id */ 0,
-          /* pool_size */ num_interop_threads.exchange(CONSUMED),
-          /* create_new */ true);
-  return *pool;
+          /* pool_size */ nthreads,
+          /* create_new */ true));
+      num_interop_pool_threads = pools[0]->size();
+    } else {
+      // One pool per NUMA node, see internal::num_numa_pool_shards. The
+      // threads are spread evenly, and every node gets at least one so that
+      // at::launch never waits on an empty pool.
+      if (nthreads == NOT_SET) {
+        nthreads = TaskThreadPoolBase::defaultNumThreads();
+      }
+      for (int node = 0; node < num_shards; ++node) {
+        int pool_size = std::max(
+            nthreads / num_shards + (node < nthreads % num_shards ? 1 : 0),
+            1);
+        pools.push_back(std::make_shared<PTThreadPool>(pool_size, node));
+        num_interop_pool_threads += pool_size;
+      }
+    }
+    return pools;
+  }();
+  return pools;
+}
+
+// Returns the pool of the calling thread's NUMA node
+TaskThreadPoolBase& get_pool() {
+  auto& pools = get_pools();
+  if (pools.size() == 1) {
+    return *pools[0];
+  }
+  return *pools[internal::current_numa_pool_shard()];
 }
 
 // Factory function for ThreadPoolRegistry
@@ -63,7 +99,9 @@ int get_num_interop_threads() {
     // return default value
     return TaskThreadPoolBase::defaultNumThreads();
   } else {
-    return get_pool().size();
+    // The configured count rather than the size of one NUMA shard's pool.
+    get_pools();
+    return num_interop_pool_threads;
   }
 }
 
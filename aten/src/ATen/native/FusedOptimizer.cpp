@@ -0,0 +1,35 @@
+#include <ATen/native/FusedOptimizer.h>
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(fused_sgd_stub);
+DEFINE_DISPATCH(fused_adam_stub);
+DEFINE_DISPATCH(fused_adagrad_stub);
+DEFINE_DISPATCH(fused_rmsprop_stub);
+
+bool can_use_fused_optimizer(
+    const Tensor& param,
+    const Tensor& grad,
+    TensorList state) {
+  if (!param.device().is_cpu() || param.layout() != kStrided ||
+      grad.layout() != kStrided || !isFloatingType(param.scalar_type()) ||
+      param.scalar_type() == kHalf || param.scalar_type() == kBFloat16) {
+    return false;
+  }
+  auto compatible = [&](const Tensor& t) {
+    return t.defined() && t.device().is_cpu() && t.layout() == kStrided &&
+        t.scalar_type() == param.scalar_type() && t.numel() == param.numel() &&
+        t.is_contiguous();
+  };
+  if (!param.is_contiguous() || !compatible(grad)) {
+    return false;
+  }
+  for (const auto& t : state) {
+    if (!compatible(t)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}} // at::native
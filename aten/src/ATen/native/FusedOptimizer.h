@@ -0,0 +1,98 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+// Multi-tensor optimizer steps.
+//
+// Each kernel updates a whole list of parameters in one call: the elements of
+// all the tensors are split into chunks that are processed in parallel, and
+// every element of the parameter, its gradient and its state is read and
+// written once, instead of once per ATen op of the per-parameter update.
+//
+// All the tensors of a call are contiguous CPU tensors of the same floating
+// point dtype, and the state tensors of a parameter have its number of
+// elements (see can_use_fused_optimizer). Optional state lists are either
+// empty or have one tensor per parameter.
+
+namespace at { namespace native {
+
+struct FusedSGDOptions {
+  double lr;
+  double momentum;
+  double dampening;
+  double weight_decay;
+  bool nesterov;
+};
+
+struct FusedAdamOptions {
+  double beta1;
+  double beta2;
+  double eps;
+  double weight_decay;
+  bool amsgrad;
+};
+
+struct FusedAdagradOptions {
+  double eps;
+  double weight_decay;
+};
+
+struct FusedRMSpropOptions {
+  double lr;
+  double alpha;
+  double eps;
+  double weight_decay;
+  double momentum;
+  bool centered;
+};
+
+// momentum_buffers are updated in place; they are expected to have been
+// initialized already.
+using fused_sgd_fn = void(*)(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    const FusedSGDOptions& options);
+
+// step_sizes[i] is lr / bias_correction1 and bias_correction2_sqrts[i] is
+// sqrt(bias_correction2) for the step of params[i].
+using fused_adam_fn = void(*)(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    ArrayRef<double> step_sizes,
+    ArrayRef<double> bias_correction2_sqrts,
+    const FusedAdamOptions& options);
+
+// clrs[i] is the decayed learning rate for the step of params[i].
+using fused_adagrad_fn = void(*)(
+    TensorList params,
+    TensorList grads,
+    TensorList sums,
+    ArrayRef<double> clrs,
+    const FusedAdagradOptions& options);
+
+using fused_rmsprop_fn = void(*)(
+    TensorList params,
+    TensorList grads,
+    TensorList square_avgs,
+    TensorList momentum_buffers,
+    TensorList grad_avgs,
+    const FusedRMSpropOptions& options);
+
+DECLARE_DISPATCH(fused_sgd_fn, fused_sgd_stub);
+DECLARE_DISPATCH(fused_adam_fn, fused_adam_stub);
+DECLARE_DISPATCH(fused_adagrad_fn, fused_adagrad_stub);
+DECLARE_DISPATCH(fused_rmsprop_fn, fused_rmsprop_stub);
+
+// Whether param can be updated by the kernels above with a dense gradient grad
+// and the given state tensors.
+CAFFE2_API bool can_use_fused_optimizer(
+    const Tensor& param,
+    const Tensor& grad,
+    TensorList state);
+
+}} // at::native
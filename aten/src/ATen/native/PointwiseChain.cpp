@@ -0,0 +1,100 @@
+#include <ATen/native/PointwiseChain.h>
+
+#include <ATen/native/TensorIterator.h>
+
+#include <atomic>
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(pointwise_chain_stub);
+
+constexpr int32_t PointwiseChain::kMaxValues;
+
+PointwiseChain::PointwiseChain() {
+  static std::atomic<uint64_t> next_id{1};
+  id_ = next_id++;
+}
+
+PointwiseChain::Value PointwiseChain::input(const Tensor& tensor) {
+  TORCH_CHECK(tensor.defined(), "PointwiseChain: input is undefined");
+  TORCH_CHECK(
+      tensor.device().is_cpu(),
+      "PointwiseChain only supports CPU tensors, got ",
+      tensor.device());
+  TORCH_CHECK(
+      tensor.scalar_type() == kFloat || tensor.scalar_type() == kDouble,
+      "PointwiseChain only supports float and double tensors, got ",
+      tensor.scalar_type());
+  TORCH_CHECK(
+      inputs_.empty() || tensor.scalar_type() == inputs_[0].scalar_type(),
+      "PointwiseChain: all inputs must have the same dtype, got ",
+      inputs_[0].scalar_type(),
+      " and ",
+      tensor.scalar_type());
+  inputs_.push_back(tensor);
+  return push(
+      PointwiseOp::Input, {static_cast<int32_t>(inputs_.size() - 1)});
+}
+
+PointwiseChain::Value PointwiseChain::constant(double value) {
+  return push(PointwiseOp::Constant, {-1}, {-1}, value);
+}
+
+PointwiseChain::Value PointwiseChain::push(
+    PointwiseOp op,
+    Value a,
+    Value b,
+    double constant) {
+  TORCH_CHECK(
+      static_cast<int32_t>(instructions_.size()) < kMaxValues,
+      "PointwiseChain supports at most ",
+      kMaxValues,
+      " values");
+  if (op != PointwiseOp::Input && op != PointwiseOp::Constant) {
+    const auto size = static_cast<int32_t>(instructions_.size());
+    const bool binary = op == PointwiseOp::Add || op == PointwiseOp::Sub ||
+        op == PointwiseOp::Mul || op == PointwiseOp::Div ||
+        op == PointwiseOp::Maximum || op == PointwiseOp::Minimum;
+    TORCH_CHECK(
+        a.chain == id_ && a.index >= 0 && a.index < size &&
+            (!binary || (b.chain == id_ && b.index >= 0 && b.index < size)),
+        "PointwiseChain: value does not belong to this chain");
+  }
+  instructions_.push_back({op, a.index, b.index, constant});
+  return {static_cast<int32_t>(instructions_.size() - 1), id_};
+}
+
+Tensor PointwiseChain::run(Value result) const {
+  Tensor out;
+  return run_out(out, result);
+}
+
+Tensor& PointwiseChain::run_out(Tensor& out, Value result) const {
+  TORCH_CHECK(!inputs_.empty(), "PointwiseChain: the chain has no input");
+  TORCH_CHECK(
+      result.chain == id_ && result.index >= 0 &&
+          result.index < static_cast<int32_t>(instructions_.size()),
+      "PointwiseChain: value does not belong to this chain");
+  if (out.defined()) {
+    TORCH_CHECK(
+        out.scalar_type() == inputs_[0].scalar_type(),
+        "PointwiseChain: expected out of dtype ",
+        inputs_[0].scalar_type(),
+        ", got ",
+        out.scalar_type());
+  }
+  auto iter = TensorIterator();
+  iter.set_check_mem_overlap(true);
+  iter.add_output(out);
+  for (const auto& input : inputs_) {
+    iter.add_input(input);
+  }
+  iter.build();
+  if (iter.numel() > 0) {
+    pointwise_chain_stub(iter.device_type(), iter, instructions_, result.index);
+  }
+  out = iter.output();
+  return out;
+}
+
+}} // at::native
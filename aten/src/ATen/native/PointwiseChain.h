@@ -0,0 +1,123 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+#include <vector>
+
+namespace at {
+struct TensorIterator;
+}
+
+namespace at { namespace native {
+
+// PointwiseChain
+// ==============
+//
+// Records a short chain of pointwise ops over tensors and runs all of it in a
+// single pass over memory. Each pointwise ATen op builds its own
+// TensorIterator and reads and writes its operands in full, so
+// relu(a * b + c) is three passes with two temporaries. A chain reads a, b
+// and c once and writes the result once. The kernel interprets the chain one
+// Vec256 of elements at a time, keeping the intermediates in a small array on
+// the stack, so they never go back to memory in full.
+//
+//   PointwiseChain chain;
+//   auto a = chain.input(x), b = chain.input(y), c = chain.input(z);
+//   Tensor out = chain.run(chain.relu(chain.add(chain.mul(a, b), c)));
+//
+// The inputs broadcast against each other like in binary ops, and must be
+// CPU tensors of the same floating point dtype (float or double), which is
+// the dtype of the result. Every op of the chain is evaluated, whether the
+// result depends on it or not.
+enum class PointwiseOp : uint8_t {
+  Input,
+  Constant,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Maximum,
+  Minimum,
+  Neg,
+  Abs,
+  Relu,
+  Exp,
+  Log,
+  Sqrt,
+  Sigmoid,
+  Tanh,
+};
+
+struct PointwiseInstruction {
+  PointwiseOp op;
+  // The operands of the op, as indices of earlier instructions. For Input,
+  // `a` is the index of the input.
+  int32_t a;
+  int32_t b;
+  // The value of a Constant.
+  double constant;
+};
+
+class CAFFE2_API PointwiseChain {
+ public:
+  // Chains are short: every value has a slot in the kernel's stack array.
+  static constexpr int32_t kMaxValues = 32;
+
+  // A value computed by the chain, identified by the index of its
+  // instruction and by the chain that made it.
+  struct Value {
+    int32_t index;
+    uint64_t chain = 0;
+  };
+
+  PointwiseChain();
+
+  Value input(const Tensor& tensor);
+  Value constant(double value);
+
+  Value add(Value a, Value b) { return push(PointwiseOp::Add, a, b); }
+  Value sub(Value a, Value b) { return push(PointwiseOp::Sub, a, b); }
+  Value mul(Value a, Value b) { return push(PointwiseOp::Mul, a, b); }
+  Value div(Value a, Value b) { return push(PointwiseOp::Div, a, b); }
+  Value maximum(Value a, Value b) { return push(PointwiseOp::Maximum, a, b); }
+  Value minimum(Value a, Value b) { return push(PointwiseOp::Minimum, a, b); }
+
+  Value neg(Value a) { return push(PointwiseOp::Neg, a); }
+  Value abs(Value a) { return push(PointwiseOp::Abs, a); }
+  Value relu(Value a) { return push(PointwiseOp::Relu, a); }
+  Value exp(Value a) { return push(PointwiseOp::Exp, a); }
+  Value log(Value a) { return push(PointwiseOp::Log, a); }
+  Value sqrt(Value a) { return push(PointwiseOp::Sqrt, a); }
+  Value sigmoid(Value a) { return push(PointwiseOp::Sigmoid, a); }
+  Value tanh(Value a) { return push(PointwiseOp::Tanh, a); }
+
+  // Evaluates the chain into a new tensor, or into out, which is resized to
+  // the broadcast shape of the inputs.
+  Tensor run(Value result) const;
+  Tensor& run_out(Tensor& out, Value result) const;
+
+  const std::vector<PointwiseInstruction>& instructions() const {
+    return instructions_;
+  }
+
+ private:
+  Value push(PointwiseOp op, Value a, Value b = {-1}, double constant = 0);
+
+  // Unique to each chain (copies share it), so that values of another chain
+  // are rejected even when their index is in range.
+  uint64_t id_;
+  std::vector<Tensor> inputs_;
+  std::vector<PointwiseInstruction> instructions_;
+};
+
+// Evaluates program over the operands of iter, the output first and then the
+// inputs of the chain, and writes the value of instruction `result`.
+using pointwise_chain_fn = void(*)(
+    TensorIterator& iter,
+    ArrayRef<PointwiseInstruction> program,
+    int32_t result);
+
+DECLARE_DISPATCH(pointwise_chain_fn, pointwise_chain_stub);
+
+}} // at::native
@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/core/grad_mode.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
@@ -69,6 +70,11 @@ struct CellParams {
   Tensor linear_hh(Tensor h) const {
     return at::linear(h, w_hh, b_hh);
   }
+  bool requires_grad() const {
+    return w_ih.requires_grad() || w_hh.requires_grad() ||
+        (b_ih.defined() && b_ih.requires_grad()) ||
+        (b_hh.defined() && b_hh.requires_grad());
+  }
 };
 
 // Run this Python script and pipe to clang-format to generate the constructor
@@ -141,6 +147,11 @@ struct QuantizedCellParams {
     return at::fbgemm_linear_int8_weight_fp32_activation(
         h, w_hh, packed_hh, col_offsets_hh, scale_hh, zero_point_hh, b_hh);
   }
+  // Only the float biases can require a gradient.
+  bool requires_grad() const {
+    return (b_ih.defined() && b_ih.requires_grad()) ||
+        (b_hh.defined() && b_hh.requires_grad());
+  }
 };
 
 // QuantizedCellParams vs. QuantizedCellParamsDynamic
@@ -194,6 +205,10 @@ struct QuantizedCellParamsDynamic {
     const Tensor output_hh = output_hh_list[0].toTensor();
     return output_hh;
   }
+  bool requires_grad() const {
+    return (b_ih.defined() && b_ih.requires_grad()) ||
+        (b_hh.defined() && b_hh.requires_grad());
+  }
 };
 
 struct QuantizedCellParamsFP16 {
@@ -219,6 +234,10 @@ struct QuantizedCellParamsFP16 {
   Tensor linear_hh(const Tensor& h) const {
     return at::fbgemm_linear_fp16_weight(h, packed_hh, b_hh);
   }
+  bool requires_grad() const {
+    return (b_ih.defined() && b_ih.requires_grad()) ||
+        (b_hh.defined() && b_hh.requires_grad());
+  }
 };
 
 // Gathers every two elements of a vector in a vector of pairs
@@ -355,6 +374,26 @@ static std::vector<QuantizedCellParamsFP16> gather_quantized_params_fp16(
 Tensor hidden_as_output(const Tensor& t) { return t; }
 Tensor hidden_as_output(const tpair_of<Tensor>& t) { return std::get<0>(t); }
 
+// The hidden state with its output part replaced by output.
+Tensor hidden_with_output(const Tensor& t, const Tensor& output) { return output; }
+tpair_of<Tensor> hidden_with_output(const tpair_of<Tensor>& t, const Tensor& output) {
+  return std::make_tuple(output, std::get<1>(t));
+}
+
+bool hidden_requires_grad(const Tensor& t) { return t.requires_grad(); }
+bool hidden_requires_grad(const tpair_of<Tensor>& t) {
+  return std::get<0>(t).requires_grad() || std::get<1>(t).requires_grad();
+}
+
+// A hidden state that Cell::step_into can update in place: the output part is
+// never written (steps write theirs into the layer output), so it's only
+// made contiguous, but the rest is copied.
+Tensor hidden_for_update(const Tensor& t) { return t.contiguous(); }
+tpair_of<Tensor> hidden_for_update(const tpair_of<Tensor>& t) {
+  return std::make_tuple(std::get<0>(t).contiguous(),
+                         std::get<1>(t).clone(at::MemoryFormat::Contiguous));
+}
+
 template<size_t index>
 std::vector<Tensor> project(at::ArrayRef<tpair_of<Tensor>> tuples) {
   std::vector<Tensor> result;
@@ -390,6 +429,37 @@ tpair_of<Tensor> hidden_slice(const tpair_of<Tensor>& t, int64_t start, int64_t
 // It's a struct only because functional programming in C++ is a pain, and it's easier
 // to pass around "vtable pointers" than actual function pointers.
 
+// Computes the hidden-hidden projection of h into out, reusing its storage
+// when the parameters allow it.
+void linear_hh_out(Tensor& out, const Tensor& h, const CellParams& params) {
+  at::mm_out(out, h, params.w_hh.t());
+  if (params.b_hh.defined()) {
+    out.add_(params.b_hh);
+  }
+}
+template <typename cell_params>
+void linear_hh_out(Tensor& out, const Tensor& h, const cell_params& params) {
+  out = params.linear_hh(h);
+}
+
+// Whether the fused cell kernels of RNN.h can update a cell from these
+// tensors: 2-D float or double CPU tensors with contiguous rows, none of
+// which needs a gradient, as the kernels aren't differentiable.
+bool use_fused_cell(at::ArrayRef<Tensor> tensors) {
+  const auto scalar_type = tensors[0].scalar_type();
+  if (scalar_type != at::kFloat && scalar_type != at::kDouble) {
+    return false;
+  }
+  for (const auto& t : tensors) {
+    if (!t.device().is_cpu() || t.scalar_type() != scalar_type ||
+        t.dim() != 2 || t.stride(1) != 1 ||
+        (at::GradMode::is_enabled() && t.requires_grad())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template<typename hidden_type_tmpl, typename cell_params_tmpl>
 struct Cell {
   using hidden_type = hidden_type_tmpl;
@@ -403,6 +473,22 @@ struct Cell {
       const hidden_type& hidden,
       const cell_params& params,
       bool pre_compute_input = false) const = 0;
+
+  // The step of the CPU layers when no gradient is needed. input is the
+  // precomputed input projection; the output of the step is written into
+  // output, a slice of the layer output, and the rest of the state may be
+  // updated in place (layers pass hidden states from hidden_for_update).
+  // workspace is a buffer the cell may keep between the steps of a sequence.
+  virtual hidden_type step_into(
+      const Tensor& input,
+      const hidden_type& hidden,
+      const cell_params& params,
+      const Tensor& output,
+      Tensor& workspace) const {
+    const auto new_hidden = (*this)(input, hidden, params, /*pre_compute_input=*/true);
+    output.copy_(hidden_as_output(new_hidden));
+    return hidden_with_output(new_hidden, output);
+  }
 };
 
 template<typename nonlinearity, typename cell_params>
@@ -418,7 +504,6 @@ struct SimpleCell : Cell<Tensor, cell_params> {
   }
 };
 
-// TODO: can use inplace ops?
 template <typename cell_params>
 struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
   using hidden_type = std::tuple<Tensor, Tensor>;
@@ -441,8 +526,16 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
       return std::make_tuple(std::move(std::get<0>(result)), std::move(std::get<1>(result)));
     }
 
-    const auto gates = params.linear_hh(hx).add_(
-        pre_compute_input ? input : params.linear_ih(input));
+    const auto igates = pre_compute_input ? input : params.linear_ih(input);
+    const auto hgates = params.linear_hh(hx);
+    if (use_fused_cell({igates, hgates, cx})) {
+      auto hy = at::empty_like(cx, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+      auto cy = at::empty_like(cx, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+      lstm_cell_fused_stub(kCPU, hy, cy, igates, hgates, cx);
+      return std::make_tuple(std::move(hy), std::move(cy));
+    }
+
+    const auto gates = hgates.add_(igates);
     auto chunked_gates = gates.chunk(4, 1);
     auto ingate = chunked_gates[0].sigmoid_();
     auto forgetgate = chunked_gates[1].sigmoid_();
@@ -453,6 +546,23 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
     return std::make_tuple(std::move(hy), std::move(cy));
   }
 
+  // Updates c in place.
+  hidden_type step_into(
+      const Tensor& input,
+      const hidden_type& hidden,
+      const cell_params& params,
+      const Tensor& output,
+      Tensor& workspace) const override {
+    const auto& hx = std::get<0>(hidden);
+    const auto& cx = std::get<1>(hidden);
+    if (!use_fused_cell({input, hx, cx, output})) {
+      return Cell<hidden_type, cell_params>::step_into(
+          input, hidden, params, output, workspace);
+    }
+    linear_hh_out(workspace, hx, params);
+    lstm_cell_fused_stub(kCPU, output, cx, input, workspace, cx);
+    return std::make_tuple(output, cx);
+  }
 };
 
 template <typename cell_params>
@@ -473,10 +583,16 @@ struct GRUCell : Cell<Tensor, cell_params> {
       // Slice off the workspace argument (it's needed only for AD).
       return std::move(std::get<0>(result));
     }
-    const auto chunked_igates = pre_compute_input
-        ? input.chunk(3, 1)
-        : params.linear_ih(input).chunk(3, 1);
-    auto chunked_hgates = params.linear_hh(hidden).chunk(3, 1);
+    const auto igates = pre_compute_input ? input : params.linear_ih(input);
+    const auto hgates = params.linear_hh(hidden);
+    if (use_fused_cell({igates, hgates, hidden})) {
+      auto hy = at::empty_like(hidden, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+      gru_cell_fused_stub(kCPU, hy, igates, hgates, hidden);
+      return hy;
+    }
+
+    const auto chunked_igates = igates.chunk(3, 1);
+    auto chunked_hgates = hgates.chunk(3, 1);
     const auto reset_gate =
         chunked_hgates[0].add_(chunked_igates[0]).sigmoid_();
     const auto input_gate =
@@ -485,6 +601,21 @@ struct GRUCell : Cell<Tensor, cell_params> {
         chunked_igates[2].add(chunked_hgates[2].mul_(reset_gate)).tanh_();
     return (hidden - new_gate).mul_(input_gate).add_(new_gate);
   }
+
+  hidden_type step_into(
+      const Tensor& input,
+      const hidden_type& hidden,
+      const cell_params& params,
+      const Tensor& output,
+      Tensor& workspace) const override {
+    if (!use_fused_cell({input, hidden, output})) {
+      return Cell<hidden_type, cell_params>::step_into(
+          input, hidden, params, output, workspace);
+    }
+    linear_hh_out(workspace, hidden, params);
+    gru_cell_fused_stub(kCPU, output, input, workspace, hidden);
+    return output;
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -504,6 +635,15 @@ struct LayerOutput {
   hidden_type final_hidden;
 };
 
+// On CPU, layers that don't need a gradient run their cells with
+// Cell::step_into, into an output tensor allocated once per sequence.
+template<typename hidden_type, typename cell_params>
+bool use_step_into(const Tensor& input, const hidden_type& hidden, const cell_params& params) {
+  return input.device().is_cpu() &&
+      !(at::GradMode::is_enabled() &&
+        (input.requires_grad() || hidden_requires_grad(hidden) || params.requires_grad()));
+}
+
 template<typename io_type, typename hidden_type, typename param_type>
 struct Layer {
   using output_type = LayerOutput<io_type, hidden_type>;
@@ -539,10 +679,33 @@ struct FullLayer : Layer<Tensor, hidden_type, cell_params> {
     return {step_outputs, hidden};
   }
 
+  // Runs the steps with Cell::step_into, writing the output of each into
+  // step_outputs. Returns the final hidden state.
+  hidden_type run_into(
+      const std::vector<Tensor>& step_inputs,
+      const hidden_type& input_hidden,
+      const cell_params& params,
+      const std::vector<Tensor>& step_outputs) const {
+    auto hidden = hidden_for_update(input_hidden);
+    auto workspace = at::empty({0}, hidden_as_output(hidden).options());
+    for (size_t i = 0; i < step_inputs.size(); i++) {
+      hidden = cell_.step_into(step_inputs[i], hidden, params, step_outputs[i], workspace);
+    }
+    return hidden;
+  }
+
   output_type operator()(
       const Tensor& inputs,
       const hidden_type& input_hidden,
       const cell_params& params) const override {
+    if (use_step_into(inputs, input_hidden, params)) {
+      const auto inputs_w = params.linear_ih(inputs);
+      const auto hx = hidden_as_output(input_hidden);
+      auto outputs = at::empty({inputs.size(0), hx.size(0), hx.size(1)}, hx.options());
+      auto final_hidden =
+          run_into(inputs_w.unbind(0), input_hidden, params, outputs.unbind(0));
+      return {outputs, final_hidden};
+    }
     if (inputs.device().is_cpu()) {
       const auto inputs_w = params.linear_ih(inputs);
       auto unstacked_output =
@@ -572,6 +735,25 @@ struct FullBidirectionalLayer
       const Tensor& input,
       const hidden_type& input_hidden,
       const param_type& params) const override {
+    if (use_step_into(input, input_hidden.first, params.first) &&
+        use_step_into(input, input_hidden.second, params.second)) {
+      // Both directions write into their half of the output.
+      const auto hx = hidden_as_output(input_hidden.first);
+      const int64_t hidden_size = hx.size(1);
+      auto output = at::empty({input.size(0), hx.size(0), 2 * hidden_size}, hx.options());
+      auto fw_hidden = layer_.run_into(
+          params.first.linear_ih(input).unbind(0),
+          input_hidden.first,
+          params.first,
+          output.narrow(2, 0, hidden_size).unbind(0));
+      auto rev_hidden = layer_.run_into(
+          reverse(params.second.linear_ih(input).unbind(0)),
+          input_hidden.second,
+          params.second,
+          reverse(output.narrow(2, hidden_size, hidden_size).unbind(0)));
+      return {output, std::make_pair(fw_hidden, rev_hidden)};
+    }
+
     std::vector<Tensor> step_inputs;
     if (input.device().is_cpu()) {
       auto input_w = params.first.linear_ih(input);
@@ -639,17 +821,26 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
       pre_compute_input = true;
     }
 
+    // With step_into, the steps write into output and the hidden state slices
+    // saved below are views that later steps don't write to.
+    const bool into = use_step_into(input.data, input_hidden, params);
+    Tensor output, workspace;
+    if (into) {
+      const auto hx = hidden_as_output(input_hidden);
+      output = at::empty({input.data.size(0), hx.size(1)}, hx.options());
+      workspace = at::empty({0}, hx.options());
+    }
+
     // Batch sizes is a sequence of decreasing lengths, which are offsets
     // into a 1D list of inputs. At every step we slice out batch_size elements,
     // and possibly account for the decrease in the batch size since the last step,
     // which requires us to slice the hidden state (since some sequences
     // are completed now). The sliced parts are also saved, because we will need
     // to return a tensor of final hidden state.
-    auto hidden = input_hidden;
+    auto hidden = into ? hidden_for_update(input_hidden) : input_hidden;
     for (int64_t i = 0; i < num_steps; ++i) {
       const int64_t batch_size = batch_sizes[i];
       auto step_input = input_ptr->narrow(0, input_offset, batch_size);
-      input_offset += batch_size;
       const int64_t dec = last_batch_size - batch_size;
       if (dec > 0) {
         hiddens.emplace_back(
@@ -658,13 +849,20 @@ struct PackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
       }
 
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params, pre_compute_input);
-      step_outputs.push_back(hidden_as_output(hidden));
+      if (into) {
+        hidden = cell_.step_into(
+            step_input, hidden, params,
+            output.narrow(0, input_offset, batch_size), workspace);
+      } else {
+        hidden = cell_(step_input, hidden, params, pre_compute_input);
+        step_outputs.push_back(hidden_as_output(hidden));
+      }
+      input_offset += batch_size;
     }
     hiddens.emplace_back(hidden);
     std::reverse(hiddens.begin(), hiddens.end());
 
-    return {PackedSequence{at::cat(step_outputs, 0), input.batch_sizes},
+    return {PackedSequence{into ? output : at::cat(step_outputs, 0), input.batch_sizes},
             hidden_concat(hiddens)};
   }
 
@@ -698,11 +896,22 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
       pre_compute_input = true;
     }
 
+    const bool into = use_step_into(input.data, input_hidden, params);
+    Tensor output, workspace;
+    if (into) {
+      const auto hx = hidden_as_output(input_hidden);
+      output = at::empty({input.data.size(0), hx.size(1)}, hx.options());
+      workspace = at::empty({0}, hx.options());
+    }
+
     // Here the situation is similar to that above, except we start out with
     // the smallest batch size (and a small set of hidden states we actually use),
     // and progressively expand the hidden states, as we move backwards over the
     // 1D list of inputs.
-    auto hidden = hidden_slice(input_hidden, 0, batch_sizes[num_steps - 1]);
+    auto hidden = hidden_slice(
+        into ? hidden_for_update(input_hidden) : input_hidden,
+        0,
+        batch_sizes[num_steps - 1]);
     for (int64_t i = num_steps - 1; i >= 0; --i) {
       const int64_t batch_size = batch_sizes[i];
       const int64_t inc = batch_size - last_batch_size;
@@ -714,8 +923,17 @@ struct ReversedPackedLayer : Layer<PackedSequence, hidden_type, cell_params> {
           input_ptr->narrow(0, input_offset - batch_size, batch_size);
       input_offset -= batch_size;
       last_batch_size = batch_size;
-      hidden = cell_(step_input, hidden, params, pre_compute_input);
-      step_outputs.emplace_back(hidden_as_output(hidden));
+      if (into) {
+        hidden = cell_.step_into(
+            step_input, hidden, params,
+            output.narrow(0, input_offset, batch_size), workspace);
+      } else {
+        hidden = cell_(step_input, hidden, params, pre_compute_input);
+        step_outputs.emplace_back(hidden_as_output(hidden));
+      }
+    }
+    if (into) {
+      return {PackedSequence{output, input.batch_sizes}, hidden};
     }
     std::reverse(step_outputs.begin(), step_outputs.end());
     return {PackedSequence{at::cat(step_outputs, 0), input.batch_sizes},
@@ -996,6 +1214,9 @@ ONE_HIDDEN_RNN(rnn_tanh, tanf_cell_type)
 using relu_cell_type = SimpleCell<relu_f, CellParams>;
 ONE_HIDDEN_RNN(rnn_relu, relu_cell_type);
 
+DEFINE_DISPATCH(lstm_cell_fused_stub);
+DEFINE_DISPATCH(gru_cell_fused_stub);
+
 DEFINE_DISPATCH(lstm_cudnn_stub);
 DEFINE_DISPATCH(lstm_packed_cudnn_stub);
 DEFINE_DISPATCH(lstm_miopen_stub);
@@ -27,6 +27,19 @@ DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_miopen_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_miopen_stub);
 
+// Fused CPU cell updates used by the inference path of RNN.cpp. They compute
+// the gates from the input and hidden projections (igates, hgates) and write
+// the new state into their first arguments, which may be views of larger
+// buffers and may alias the previous state. All tensors are 2-D with
+// contiguous rows.
+// lstm_cell_fused(hy, cy, igates, hgates, cx)
+using lstm_cell_fused_fn = void(*)(const Tensor&, const Tensor&, const Tensor&, const Tensor&, const Tensor&);
+// gru_cell_fused(hy, igates, hgates, hx)
+using gru_cell_fused_fn = void(*)(const Tensor&, const Tensor&, const Tensor&, const Tensor&);
+
+DECLARE_DISPATCH(lstm_cell_fused_fn, lstm_cell_fused_stub);
+DECLARE_DISPATCH(gru_cell_fused_fn, gru_cell_fused_stub);
+
 inline void check_device(const Tensor& input, const TensorList& params, const TensorList& hiddens) {
   auto input_device = input.device();
 
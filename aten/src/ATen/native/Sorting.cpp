@@ -93,32 +93,16 @@ void quick_select_template(
 
 } // namespace
 
-static std::tuple<Tensor&, Tensor&> kthvalue_out_impl_cpu(
+// Slices at least this long are selected from by topk when k is close to
+// either end.
+constexpr int64_t kParallelKthValueMinSize = 1 << 16;
+
+static void kthvalue_select_cpu(
     Tensor& values,
     Tensor& indices,
     const Tensor& self,
     int64_t k,
-    int64_t dim_,
-    bool keepdim) {
-  int64_t dim = maybe_wrap_dim(dim_, self.dim(), /*wrap_scalar=*/true);
-  // FIXME: This seems bogus, I only do this because it was the old behaviour.
-  //        The reductions are fine, as long as the axis being reduced along
-  //        isn't of 0 elements (and the output has elements).
-  TORCH_CHECK(
-      self.numel() > 0,
-      "cannot perform reduction function kthvalue",
-      " on tensor with no elements because the operation does not have an identity");
-  TORCH_CHECK(
-      k > 0 && k <= (self.dim() > 0 ? self.size(dim) : 1),
-      "selected index k out of range");
-
-  _reduction_with_indices_allocate_or_resize_output(
-      values, indices, self, dim_, keepdim);
-  if (self.dim() == 0 && self.numel() == 1) {
-    values.copy_(self);
-    indices.zero_();
-    return std::forward_as_tuple(values, indices);
-  }
+    int64_t dim) {
   auto tmp_values = self.clone(at::MemoryFormat::Contiguous);
   auto tmp_indices = at::empty(self.sizes(), self.options().dtype(kLong));
   AT_DISPATCH_ALL_TYPES(self.scalar_type(), "kthvalue_cpu", [&] {
@@ -149,6 +133,51 @@ static std::tuple<Tensor&, Tensor&> kthvalue_out_impl_cpu(
           *mode_index = tmp_indices[k - 1];
         });
   });
+}
+
+static std::tuple<Tensor&, Tensor&> kthvalue_out_impl_cpu(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t k,
+    int64_t dim_,
+    bool keepdim) {
+  int64_t dim = maybe_wrap_dim(dim_, self.dim(), /*wrap_scalar=*/true);
+  // FIXME: This seems bogus, I only do this because it was the old behaviour.
+  //        The reductions are fine, as long as the axis being reduced along
+  //        isn't of 0 elements (and the output has elements).
+  TORCH_CHECK(
+      self.numel() > 0,
+      "cannot perform reduction function kthvalue",
+      " on tensor with no elements because the operation does not have an identity");
+  TORCH_CHECK(
+      k > 0 && k <= (self.dim() > 0 ? self.size(dim) : 1),
+      "selected index k out of range");
+
+  _reduction_with_indices_allocate_or_resize_output(
+      values, indices, self, dim_, keepdim);
+  if (self.dim() == 0 && self.numel() == 1) {
+    values.copy_(self);
+    indices.zero_();
+    return std::forward_as_tuple(values, indices);
+  }
+  // When there are only a few long slices and k is close to either end, the
+  // k-th value is the last of a small top k, which topk finds with all
+  // threads and without copying the slices.
+  const int64_t n = self.size(dim);
+  const int64_t k_from_top = n - k + 1;
+  if (n >= kParallelKthValueMinSize && std::min(k, k_from_top) * 64 <= n &&
+      self.numel() / n < at::get_num_threads()) {
+    const bool largest = k_from_top < k;
+    const int64_t top_k = largest ? k_from_top : k;
+    Tensor top_values, top_indices;
+    std::tie(top_values, top_indices) =
+        at::topk(self, top_k, dim, largest, /*sorted=*/true);
+    values.copy_(top_values.narrow(dim, top_k - 1, 1));
+    indices.copy_(top_indices.narrow(dim, top_k - 1, 1));
+  } else {
+    kthvalue_select_cpu(values, indices, self, k, dim);
+  }
   if (!keepdim) {
     values.squeeze_(dim);
     indices.squeeze_(dim);
@@ -220,6 +249,38 @@ std::tuple<Tensor, Tensor> topk(
   return std::make_tuple(values, indices);
 }
 
+std::tuple<Tensor&, Tensor&> sort_out_cpu(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim_,
+    bool descending) {
+  int64_t dim = maybe_wrap_dim(dim_, self.dim(), /*wrap_scalar=*/true);
+  _allocate_or_resize_output_with_indices(
+      values, indices, self, dim, self.dim() > 0 ? self.size(dim) : 1);
+  if (self.dim() == 0 && self.numel() == 1) {
+    values.copy_(self);
+    indices.zero_();
+    return std::forward_as_tuple(values, indices);
+  }
+  if (self.numel() == 0) {
+    return std::forward_as_tuple(values, indices);
+  }
+
+  sort_stub(kCPU, values, indices, self, dim, descending);
+
+  return std::forward_as_tuple(values, indices);
+}
+
+std::tuple<Tensor, Tensor> sort_cpu(
+    const Tensor& self,
+    int64_t dim,
+    bool descending) {
+  Tensor values = at::empty({0}, self.options());
+  Tensor indices = at::empty({0}, self.options().dtype(kLong));
+  return sort_out_cpu(values, indices, self, dim, descending);
+}
+
 std::tuple<Tensor&, Tensor&> median_out(
     Tensor& values,
     Tensor& indices,
@@ -304,6 +365,7 @@ Tensor median_cpu(const Tensor& self) {
 }
 
 DEFINE_DISPATCH(topk_stub);
+DEFINE_DISPATCH(sort_stub);
 
 } // namespace native
 } // namespace at
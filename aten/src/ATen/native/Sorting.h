@@ -7,6 +7,9 @@ namespace at { namespace native {
 
 using topk_fn = void(*)(Tensor&, Tensor&, const Tensor&, int64_t, int64_t, bool, bool);
 
+using sort_fn = void(*)(Tensor& values, Tensor& indices, const Tensor& self, int64_t dim, bool descending);
+
 DECLARE_DISPATCH(topk_fn, topk_stub);
+DECLARE_DISPATCH(sort_fn, sort_stub);
 
 }} // at::native
@@ -1,6 +1,10 @@
 #include <ATen/native/TensorIterator.h>
 
 #include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/native/TypeProperties.h>
@@ -1040,16 +1044,9 @@ FastSetupType TensorIterator::compute_fast_setup_type() {
   return FastSetupType::NONE;
 }
 
-void TensorIterator::build() {
+void TensorIterator::compute_iteration_plan() {
   // check input tensors memory format to use it during output allocation
   analyze_memory_format();
-  // set is_output and is_read_write flags on appropriate tensors
-  mark_outputs();
-  // Check that the outputs have no internal overlap
-  // and do not share memory with inputs.
-  check_mem_overlaps();
-  // Check that input dimensions are aligned correctly & compute outnames.
-  compute_names();
   // compute the broadcasted shape
   compute_shape();
   // compute the result dtype and device
@@ -1065,6 +1062,283 @@ void TensorIterator::build() {
     // coalesce adjacent dimensions when possible
     coalesce_dimensions();
   }
+}
+
+namespace {
+
+std::atomic<bool> plan_cache_enabled{false};
+
+struct PlanCacheCounters;
+
+// The lookup counters of all threads, so that the stats can add them up.
+struct PlanCacheCounterRegistry {
+  std::mutex mutex;
+  std::unordered_set<const PlanCacheCounters*> threads;
+  // The counts of threads that have exited.
+  int64_t exited_hits = 0;
+  int64_t exited_misses = 0;
+  // The totals at the last reset.
+  int64_t reset_hits = 0;
+  int64_t reset_misses = 0;
+};
+
+PlanCacheCounterRegistry& plan_cache_counter_registry() {
+  // Leaked, so that threads exiting after static destruction can unregister.
+  static auto* registry = new PlanCacheCounterRegistry();
+  return *registry;
+}
+
+// A thread's lookup counters. Only the thread itself writes them, so counting
+// a lookup is a plain store to memory that no other thread writes.
+struct PlanCacheCounters {
+  PlanCacheCounters() {
+    auto& registry = plan_cache_counter_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    registry.threads.insert(this);
+  }
+
+  ~PlanCacheCounters() {
+    auto& registry = plan_cache_counter_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    registry.exited_hits += hits.load(std::memory_order_relaxed);
+    registry.exited_misses += misses.load(std::memory_order_relaxed);
+    registry.threads.erase(this);
+  }
+
+  static void increment(std::atomic<int64_t>& counter) {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::atomic<int64_t> hits{0};
+  std::atomic<int64_t> misses{0};
+};
+
+PlanCacheCounters& plan_cache_counters() {
+  static thread_local PlanCacheCounters counters;
+  return counters;
+}
+
+// The hits and misses of all threads since they started. The caller holds
+// the registry's mutex.
+TensorIteratorCacheStats total_plan_cache_lookups(
+    const PlanCacheCounterRegistry& registry) {
+  TensorIteratorCacheStats total = {
+      registry.exited_hits, registry.exited_misses};
+  for (const auto* counters : registry.threads) {
+    total.hits += counters->hits.load(std::memory_order_relaxed);
+    total.misses += counters->misses.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+// Bounds the memory of a thread's cache; a full cache is cleared.
+constexpr size_t kMaxCachedPlans = 1024;
+
+using PlanKey = SmallVector<int64_t, 48>;
+
+struct PlanKeyHash {
+  size_t operator()(const PlanKey& key) const {
+    size_t hash = key.size();
+    for (auto v : key) {
+      hash ^= std::hash<int64_t>()(v) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+  }
+};
+
+struct PlannedOperand {
+  StrideVector stride_bytes;
+  Device device = kCPU;
+  ScalarType target_dtype = ScalarType::Undefined;
+  ScalarType current_dtype = ScalarType::Undefined;
+  // Whether the input is converted to target_dtype and device, and whether
+  // the given tensor is kept as original_tensor.
+  bool convert = false;
+  bool keep_original = false;
+  // The sizes and strides of an output allocated by build(). Empty if the
+  // output was given.
+  DimVector sizes;
+  DimVector strides;
+};
+
+// Everything build() computes from the signature of the operands.
+struct IterationPlan {
+  DimVector shape;
+  DimVector perm;
+  SmallVector<PlannedOperand, 4> operands;
+  ScalarType common_dtype;
+  bool has_coalesced_dimensions;
+  bool all_ops_same_shape;
+  bool requires_channels_last_output;
+  bool requires_channels_last_3d_output;
+};
+
+using PlanCache = std::unordered_map<PlanKey, IterationPlan, PlanKeyHash>;
+
+PlanCache& plan_cache() {
+  static thread_local PlanCache cache;
+  return cache;
+}
+
+} // namespace
+
+void set_tensor_iterator_cache_enabled(bool enabled) {
+  plan_cache_enabled = enabled;
+}
+
+bool tensor_iterator_cache_enabled() {
+  return plan_cache_enabled;
+}
+
+TensorIteratorCacheStats tensor_iterator_cache_stats() {
+  auto& registry = plan_cache_counter_registry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  auto total = total_plan_cache_lookups(registry);
+  return {total.hits - registry.reset_hits,
+          total.misses - registry.reset_misses};
+}
+
+void reset_tensor_iterator_cache() {
+  plan_cache().clear();
+  auto& registry = plan_cache_counter_registry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  auto total = total_plan_cache_lookups(registry);
+  registry.reset_hits = total.hits;
+  registry.reset_misses = total.misses;
+}
+
+void TensorIterator::build_with_cache() {
+  // The key holds everything compute_iteration_plan() reads: the
+  // configuration of the iterator and the metadata of every operand.
+  PlanKey key = {
+      num_outputs_,
+      static_cast<int64_t>(common_dtype_strategy_),
+      resize_outputs_,
+      is_reduction_,
+      allow_cpu_scalars_,
+      promote_gpu_output_dtypes_};
+  for (const auto& op : operands_) {
+    key.push_back(op.tensor.defined());
+    key.push_back(static_cast<int64_t>(op.target_dtype));
+    key.push_back(static_cast<int64_t>(op.device.type()));
+    key.push_back(op.device.index());
+    if (!op.tensor.defined()) {
+      continue;
+    }
+    if (op.tensor.has_names()) {
+      compute_iteration_plan();
+      return;
+    }
+    key.push_back(static_cast<int64_t>(op.current_dtype));
+    key.push_back(op.tensor.unsafeGetTensorImpl()->is_wrapped_number());
+    key.push_back(op.is_read_write);
+    key.push_back(op.tensor.dim());
+    key.append(op.tensor.sizes().begin(), op.tensor.sizes().end());
+    key.append(op.tensor.strides().begin(), op.tensor.strides().end());
+  }
+
+  auto& cache = plan_cache();
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    PlanCacheCounters::increment(plan_cache_counters().hits);
+    const auto& plan = it->second;
+    shape_ = plan.shape;
+    perm_ = plan.perm;
+    common_dtype_ = plan.common_dtype;
+    has_coalesced_dimensions_ = plan.has_coalesced_dimensions;
+    all_ops_same_shape_ = plan.all_ops_same_shape;
+    requires_channels_last_output_ = plan.requires_channels_last_output;
+    requires_channels_last_3d_output_ = plan.requires_channels_last_3d_output;
+    for (int i = 0; i < ntensors(); i++) {
+      auto& op = operands_[i];
+      const auto& planned = plan.operands[i];
+      op.stride_bytes = planned.stride_bytes;
+      op.device = planned.device;
+      op.target_dtype = planned.target_dtype;
+      op.current_dtype = planned.current_dtype;
+      if (planned.convert) {
+        if (planned.keep_original) {
+          op.original_tensor = op.tensor;
+        }
+        op.tensor = op.tensor.to(op.options());
+      } else if (!op.tensor.defined()) {
+        op.tensor = at::empty_strided(planned.sizes, planned.strides, op.options());
+      }
+    }
+    return;
+  }
+  PlanCacheCounters::increment(plan_cache_counters().misses);
+
+  // Inputs may be converted to another dtype or device, but plans that
+  // replace or resize a given output (casts, or out= arguments of the wrong
+  // shape) are not cached.
+  SmallVector<TensorImpl*, 4> given;
+  SmallVector<std::pair<DimVector, DimVector>, 2> given_outputs;
+  for (int i = 0; i < ntensors(); i++) {
+    const auto& tensor = operands_[i].tensor;
+    given.push_back(tensor.defined() ? tensor.unsafeGetTensorImpl() : nullptr);
+    if (i < num_outputs_ && tensor.defined()) {
+      given_outputs.emplace_back(DimVector(tensor.sizes()), DimVector(tensor.strides()));
+    }
+  }
+  compute_iteration_plan();
+
+  IterationPlan plan;
+  auto given_output = given_outputs.begin();
+  for (int i = 0; i < ntensors(); i++) {
+    const auto& op = operands_[i];
+    PlannedOperand planned;
+    if (given[i] == nullptr) {
+      planned.sizes = DimVector(op.tensor.sizes());
+      planned.strides = DimVector(op.tensor.strides());
+    } else if (i >= num_outputs_) {
+      planned.convert = op.tensor.unsafeGetTensorImpl() != given[i];
+      planned.keep_original = op.original_tensor.defined();
+    } else if (op.tensor.unsafeGetTensorImpl() != given[i] ||
+               op.original_tensor.defined()) {
+      return;
+    } else {
+      if (!op.tensor.sizes().equals(given_output->first) ||
+          !op.tensor.strides().equals(given_output->second)) {
+        return;
+      }
+      ++given_output;
+    }
+    planned.stride_bytes = op.stride_bytes;
+    planned.device = op.device;
+    planned.target_dtype = op.target_dtype;
+    planned.current_dtype = op.current_dtype;
+    plan.operands.push_back(std::move(planned));
+  }
+  plan.shape = shape_;
+  plan.perm = perm_;
+  plan.common_dtype = common_dtype_;
+  plan.has_coalesced_dimensions = has_coalesced_dimensions_;
+  plan.all_ops_same_shape = all_ops_same_shape_;
+  plan.requires_channels_last_output = requires_channels_last_output_;
+  plan.requires_channels_last_3d_output = requires_channels_last_3d_output_;
+
+  if (cache.size() >= kMaxCachedPlans) {
+    cache.clear();
+  }
+  cache.emplace(std::move(key), std::move(plan));
+}
+
+void TensorIterator::build() {
+  // set is_output and is_read_write flags on appropriate tensors
+  mark_outputs();
+  // Check that the outputs have no internal overlap
+  // and do not share memory with inputs.
+  check_mem_overlaps();
+  // Check that input dimensions are aligned correctly & compute outnames.
+  compute_names();
+  // compute the shape, dtypes and strides, and allocate the outputs
+  if (tensor_iterator_cache_enabled()) {
+    build_with_cache();
+  } else {
+    compute_iteration_plan();
+  }
   // perform name inference
   propagate_names_to_outputs();
 
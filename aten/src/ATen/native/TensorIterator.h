@@ -359,6 +359,8 @@ struct CAFFE2_API TensorIterator {
   void build();
 
 protected:
+  void compute_iteration_plan();
+  void build_with_cache();
   void mark_outputs();
   void check_mem_overlaps();
   void compute_shape();
@@ -397,6 +399,30 @@ protected:
   bool requires_channels_last_output_ = false;
   bool requires_channels_last_3d_output_ = false;
 };
+/// TensorIterator plan cache
+/// ~~~~~~~~~~~~~~~~~~~~~~~~~
+/// When enabled, build() remembers the iteration plan it computes (the
+/// broadcast shape, the dimension order, the strides and dtypes of the
+/// operands) per thread, keyed on the sizes, strides, dtypes and devices of
+/// the operands and on the configuration of the iterator, and reuses it when
+/// the same signature is built again. This is meant for latency bound
+/// workloads on small tensors, where computing the plan costs as much as the
+/// kernel. Overlap checks and name inference still run on every build(), and
+/// builds that cast or resize an output are never cached.
+///
+/// The cache is disabled by default.
+struct TensorIteratorCacheStats {
+  int64_t hits;
+  int64_t misses;
+};
+
+CAFFE2_API void set_tensor_iterator_cache_enabled(bool enabled);
+CAFFE2_API bool tensor_iterator_cache_enabled();
+/// Hits and misses of all threads since the last reset.
+CAFFE2_API TensorIteratorCacheStats tensor_iterator_cache_stats();
+/// Clears the plans cached by the calling thread and zeroes the counters.
+CAFFE2_API void reset_tensor_iterator_cache();
+
 /// A container-like struct that acts as if it contains splits of a
 /// TensorIterator that can use 32-bit indexing. Taken together the splits cover
 /// the original TensorIterator.
@@ -12,6 +12,7 @@ using loop2d_t = TensorIterator::loop2d_t;
 static bool use_two_pass_reduction(TensorIterator& iter);
 static void two_pass_reduction(TensorIterator& iter, loop2d_t loop);
 static void parallel_dim_reduction(TensorIterator& iter, loop2d_t loop);
+static int find_split_dim(TensorIterator& iter);
 
 void TensorIterator::parallel_reduce(loop2d_t loop) {
   TORCH_CHECK(ntensors() == 2, "parallel_reduce only supports one input and one output");
@@ -26,8 +27,19 @@ void TensorIterator::parallel_reduce(loop2d_t loop) {
   }
 }
 
+/// Reductions to a single element, and reductions whose output is too small
+/// to give every thread a slice of it (e.g. summing an [N, C, H, W] tensor
+/// over dims (0, 2, 3) with C < num_threads) also split the reduced dims:
+/// every thread reduces a range of the input into its own copy of the output.
+/// The copies are only worth it while they are small compared to the input.
 static bool use_two_pass_reduction(TensorIterator& iter) {
-  return iter.output(0).numel() == 1;
+  int64_t output_numel = iter.output(0).numel();
+  if (output_numel == 1) {
+    return true;
+  }
+  int num_threads = at::get_num_threads();
+  return iter.shape()[find_split_dim(iter)] < num_threads &&
+      output_numel * num_threads <= iter.numel() / 16;
 }
 
 static void two_pass_reduction(TensorIterator& iter, loop2d_t loop) {
@@ -42,10 +54,14 @@ static void two_pass_reduction(TensorIterator& iter, loop2d_t loop) {
   std::fill(written.get(), written.get() + max_threads, false);
 
   at::parallel_for(0, iter.numel(), internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    // A thread can run several chunks, so its slice is only initialized
+    // the first time and accumulates over the chunks after that.
     int thread_num = at::get_thread_num();
-    written[thread_num] = true;
     auto slice = buffer[thread_num];
-    slice.copy_(dst);
+    if (!written[thread_num]) {
+      written[thread_num] = true;
+      slice.copy_(dst);
+    }
 
     auto sub_iter = TensorIterator::reduce_op(slice, iter.input(0));
     sub_iter.serial_for_each(loop, {begin, end});
@@ -60,7 +76,13 @@ static void two_pass_reduction(TensorIterator& iter, loop2d_t loop) {
 
   auto unsqueezed = dst.unsqueeze(0);
   auto final_reduce = TensorIterator::reduce_op(unsqueezed, buffer);
-  final_reduce.for_each(loop);
+  // for_each would split the combine by linear range, which can give two
+  // threads the same output element; split it by output element instead.
+  if (final_reduce.numel() < internal::GRAIN_SIZE || dst.numel() == 1) {
+    final_reduce.serial_for_each(loop, {0, final_reduce.numel()});
+  } else {
+    parallel_dim_reduction(final_reduce, loop);
+  }
 }
 
 /// Chooses a dimension over which to parallelize. Prefers the outer-most
@@ -2,7 +2,10 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 
+#include <cstring>
+#include <numeric>
 #include <set>
 #include <tuple>
 #include <unordered_map>
@@ -13,62 +16,315 @@ namespace native{
 
 namespace {
 
+// Inputs smaller than this are processed by one thread.
+constexpr int64_t kParallelUniqueMinSize = 1 << 16;
+
+// Splits [0, numel) into chunks of roughly equal size.
+inline int64_t chunk_begin(int64_t chunk, int64_t num_chunks, int64_t numel) {
+  return chunk * numel / num_chunks;
+}
+
+// Sort based unique: the input is sorted together with its positions, and a
+// segmented scan over the sorted values finds the groups of equal values.
+// Each thread scans a chunk twice, once to count the groups that start in it
+// and once to write them, so output, inverse and counts are all produced by
+// the second pass. The output is always sorted.
 template <typename scalar_t>
-std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
-    const Tensor& self,
-    const bool sorted,
+std::tuple<Tensor, Tensor, Tensor> unique_cpu_sort_template(
+    const Tensor& input,
     const bool return_inverse,
     const bool return_counts) {
-  const Tensor& input = self.contiguous();
-  const scalar_t* input_data = input.data_ptr<scalar_t>();
-  int64_t numel = input.numel();
-  Tensor output;
-  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
-  Tensor counts = at::empty({0}, self.options().dtype(kLong));
+  const int64_t numel = input.numel();
+  Tensor sorted, perm;
+  std::tie(sorted, perm) = input.view(-1).sort();
+  const scalar_t* sorted_data = sorted.data_ptr<scalar_t>();
+  const int64_t* perm_data = perm.data_ptr<int64_t>();
+
+  const int64_t num_chunks =
+      numel < kParallelUniqueMinSize ? 1 : at::get_num_threads();
+  auto is_start = [&](int64_t i) {
+    return i == 0 || sorted_data[i] != sorted_data[i - 1];
+  };
+  std::vector<int64_t> chunk_groups(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      int64_t groups = 0;
+      for (int64_t i = chunk_begin(chunk, num_chunks, numel);
+           i < chunk_begin(chunk + 1, num_chunks, numel);
+           i++) {
+        groups += is_start(i);
+      }
+      chunk_groups[chunk + 1] = groups;
+    }
+  });
+  std::partial_sum(
+      chunk_groups.begin(), chunk_groups.end(), chunk_groups.begin());
+  const int64_t num_groups = chunk_groups.back();
 
-  std::unordered_set<scalar_t> set(input_data, input_data + numel);
-  output = at::empty({static_cast<int64_t>(set.size())}, input.options());
-  scalar_t *output_data = output.data_ptr<scalar_t>();
+  Tensor output = at::empty({num_groups}, input.options());
+  Tensor inverse_indices = at::empty({0}, input.options().dtype(kLong));
+  Tensor counts = at::empty({0}, input.options().dtype(kLong));
+  if (return_inverse || return_counts) {
+    inverse_indices.resize_(input.sizes());
+  }
+  std::vector<int64_t> group_starts(num_groups + 1);
+  group_starts[num_groups] = numel;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* inverse_data = inverse_indices.numel() > 0
+      ? inverse_indices.data_ptr<int64_t>()
+      : nullptr;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      // The group that is open when the chunk begins.
+      int64_t group = chunk_groups[chunk] - 1;
+      for (int64_t i = chunk_begin(chunk, num_chunks, numel);
+           i < chunk_begin(chunk + 1, num_chunks, numel);
+           i++) {
+        if (is_start(i)) {
+          group++;
+          output_data[group] = sorted_data[i];
+          group_starts[group] = i;
+        }
+        if (inverse_data) {
+          inverse_data[perm_data[i]] = group;
+        }
+      }
+    }
+  });
+
+  if (return_counts) {
+    counts.resize_({num_groups});
+    int64_t* counts_data = counts.data_ptr<int64_t>();
+    at::parallel_for(0, num_groups, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      for (int64_t group = begin; group < end; group++) {
+        counts_data[group] = group_starts[group + 1] - group_starts[group];
+      }
+    });
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
 
-  if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
+template <typename scalar_t>
+inline uint64_t unique_hash(scalar_t value) {
+  // -0.0 and 0.0 compare equal, so they must hash the same.
+  if (value == scalar_t(0)) {
+    value = scalar_t(0);
+  }
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(scalar_t));
+  // Finalizer of MurmurHash3, which mixes every input bit into the low bits
+  // the table uses as well as the high bits used for partitioning.
+  bits ^= bits >> 33;
+  bits *= 0xff51afd7ed558ccdULL;
+  bits ^= bits >> 33;
+  bits *= 0xc4ceb9fe1a85ec53ULL;
+  bits ^= bits >> 33;
+  return bits;
+}
+
+// Hash based unique: the positions of the input are partitioned by the hash
+// of their value, so that equal values end up in the same partition, and
+// every partition is deduplicated by one thread with an open addressing
+// table. Groups are numbered in order of first occurrence within their
+// partition, and the partitions are concatenated. If a sorted output is
+// asked for, only the unique values are sorted afterwards.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_cpu_hash_template(
+    const Tensor& input,
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t numel = input.numel();
+  const int64_t num_partitions =
+      numel < kParallelUniqueMinSize ? 1 : at::get_num_threads();
+  auto partition_of = [&](scalar_t value) {
+    return static_cast<int64_t>((unique_hash(value) >> 32) % num_partitions);
+  };
+
+  // Positions of the input grouped by partition, each group in input order.
+  // A thread counts, then scatters, the positions of its chunk of the input.
+  std::vector<int64_t> partition_begin(num_partitions + 1, 0);
+  std::vector<int64_t> positions;
+  if (num_partitions > 1) {
+    const int64_t num_chunks = num_partitions;
+    std::vector<int64_t> offsets(num_chunks * num_partitions, 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; chunk++) {
+        int64_t* histogram = offsets.data() + chunk * num_partitions;
+        for (int64_t i = chunk_begin(chunk, num_chunks, numel);
+             i < chunk_begin(chunk + 1, num_chunks, numel);
+             i++) {
+          histogram[partition_of(input_data[i])]++;
+        }
+      }
+    });
+    int64_t offset = 0;
+    for (int64_t partition = 0; partition < num_partitions; partition++) {
+      partition_begin[partition] = offset;
+      for (int64_t chunk = 0; chunk < num_chunks; chunk++) {
+        const int64_t count = offsets[chunk * num_partitions + partition];
+        offsets[chunk * num_partitions + partition] = offset;
+        offset += count;
+      }
+    }
+    partition_begin[num_partitions] = offset;
+    positions.resize(numel);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; chunk++) {
+        int64_t* next = offsets.data() + chunk * num_partitions;
+        for (int64_t i = chunk_begin(chunk, num_chunks, numel);
+             i < chunk_begin(chunk + 1, num_chunks, numel);
+             i++) {
+          positions[next[partition_of(input_data[i])]++] = i;
+        }
+      }
+    });
   } else {
-    std::copy(set.begin(), set.end(), output_data);
+    partition_begin[1] = numel;
   }
 
+  Tensor inverse_indices = at::empty({0}, input.options().dtype(kLong));
   if (return_inverse || return_counts) {
     inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data_ptr<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int64_t i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
-    }
-    for(int64_t i = 0; i < numel; ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
-    }
-    if (return_counts) {
-      std::unordered_map<scalar_t, int64_t> counts_map;
-      counts_map.reserve(output.numel());
-      for (int64_t i = 0; i < output.numel(); ++i) {
-        counts_map[output_data[i]] = 0;
+  }
+  int64_t* inverse_data = inverse_indices.numel() > 0
+      ? inverse_indices.data_ptr<int64_t>()
+      : nullptr;
+
+  std::vector<std::vector<scalar_t>> partition_keys(num_partitions);
+  std::vector<std::vector<int64_t>> partition_counts(num_partitions);
+  at::parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t partition = begin; partition < end; partition++) {
+      auto& keys = partition_keys[partition];
+      auto& counts = partition_counts[partition];
+      // Slots hold the id of a group, -1 when empty. The table is kept at
+      // most half full.
+      std::vector<int64_t> slots(16, -1);
+      uint64_t mask = slots.size() - 1;
+      for (int64_t j = partition_begin[partition];
+           j < partition_begin[partition + 1];
+           j++) {
+        const int64_t i = num_partitions > 1 ? positions[j] : j;
+        const scalar_t value = input_data[i];
+        uint64_t slot = unique_hash(value) & mask;
+        int64_t id;
+        while (true) {
+          id = slots[slot];
+          if (id < 0) {
+            id = keys.size();
+            slots[slot] = id;
+            keys.push_back(value);
+            counts.push_back(0);
+            break;
+          }
+          if (keys[id] == value) {
+            break;
+          }
+          slot = (slot + 1) & mask;
+        }
+        counts[id]++;
+        if (inverse_data) {
+          inverse_data[i] = id;
+        }
+        if (2 * keys.size() > slots.size()) {
+          slots.assign(2 * slots.size(), -1);
+          mask = slots.size() - 1;
+          for (int64_t k = 0; k < static_cast<int64_t>(keys.size()); k++) {
+            uint64_t s = unique_hash(keys[k]) & mask;
+            while (slots[s] >= 0) {
+              s = (s + 1) & mask;
+            }
+            slots[s] = k;
+          }
+        }
       }
-      for(int64_t i = 0; i < numel; i++) {
-        counts_map[input_data[i]] += 1;
+    }
+  });
+
+  std::vector<int64_t> partition_offset(num_partitions + 1, 0);
+  for (int64_t partition = 0; partition < num_partitions; partition++) {
+    partition_offset[partition + 1] =
+        partition_offset[partition] + partition_keys[partition].size();
+  }
+  const int64_t num_groups = partition_offset[num_partitions];
+  Tensor output = at::empty({num_groups}, input.options());
+  Tensor counts = at::empty({num_groups}, input.options().dtype(kLong));
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* counts_data = counts.data_ptr<int64_t>();
+  at::parallel_for(0, num_partitions, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t partition = begin; partition < end; partition++) {
+      const int64_t offset = partition_offset[partition];
+      std::copy(
+          partition_keys[partition].begin(),
+          partition_keys[partition].end(),
+          output_data + offset);
+      std::copy(
+          partition_counts[partition].begin(),
+          partition_counts[partition].end(),
+          counts_data + offset);
+      if (inverse_data && offset > 0) {
+        for (int64_t j = partition_begin[partition];
+             j < partition_begin[partition + 1];
+             j++) {
+          inverse_data[positions[j]] += offset;
+        }
       }
-      counts.resize_(output.sizes());
-      counts.fill_(0);
-      int64_t *counts_data = counts.data_ptr<int64_t>();
-      for(int64_t i = 0; i < output.numel(); i++) {
-        counts_data[i] = counts_map[output_data[i]];
+    }
+  });
+
+  if (sorted && num_groups > 1) {
+    // Sorting is not implemented for bool; false < true either way.
+    Tensor order = std::get<1>(
+        (output.scalar_type() == kBool ? output.to(kByte) : output).sort());
+    output = output.index_select(0, order);
+    counts = counts.index_select(0, order);
+    if (inverse_data) {
+      std::vector<int64_t> rank(num_groups);
+      const int64_t* order_data = order.data_ptr<int64_t>();
+      for (int64_t k = 0; k < num_groups; k++) {
+        rank[order_data[k]] = k;
       }
+      at::parallel_for(0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          inverse_data[i] = rank[inverse_data[i]];
+        }
+      });
     }
   }
+  if (!return_counts) {
+    counts = at::empty({0}, input.options().dtype(kLong));
+  }
   return std::make_tuple(output, inverse_indices, counts);
 }
 
+// Floating point keys, which are mostly distinct, are sorted. Integral keys,
+// such as ids, usually repeat a lot, and the hash table stays small compared
+// to the input.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
+    const Tensor& self,
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
+  const Tensor& input = self.contiguous();
+  if (input.numel() == 0) {
+    Tensor output = at::empty({0}, input.options());
+    Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+    Tensor counts = at::empty({0}, self.options().dtype(kLong));
+    if (return_inverse || return_counts) {
+      inverse_indices.resize_(input.sizes());
+    }
+    return std::make_tuple(output, inverse_indices, counts);
+  }
+  if (at::isFloatingType(input.scalar_type())) {
+    return unique_cpu_sort_template<scalar_t>(
+        input, return_inverse, return_counts);
+  }
+  return unique_cpu_hash_template<scalar_t>(
+      input, sorted, return_inverse, return_counts);
+}
+
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
     const Tensor& self,
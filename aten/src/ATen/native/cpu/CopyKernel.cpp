@@ -4,14 +4,202 @@
 #include <ATen/native/Copy.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <ATen/Parallel.h>
 #include <c10/util/TypeCast.h>
 
+#include <algorithm>
+
 namespace at {
 namespace native {
 namespace {
 
+// Transposing copies
+// ~~~~~~~~~~~~~~~~~~
+// When the output and the input are contiguous in different dims, e.g.
+// x.t().contiguous() or an NCHW <-> NHWC conversion, the element-wise loop
+// reads or writes with a large stride and misses the cache on nearly every
+// element. Such copies are done as a batch of 2-d transposes instead, in
+// tiles of kTransposeTile x kTransposeTile elements that fit in L1 for both
+// the reads and the writes. Inside a tile, 8x8 blocks of 4-byte elements are
+// transposed in AVX registers.
+constexpr int64_t kTransposeTile = 64;
+
+// Element types by size; a transposing copy only moves bytes.
+struct Bytes16 {
+  uint64_t data[2];
+};
+
+// Copies the rows x cols block dst(i, j) = src(i, j), where src is
+// contiguous in j and dst in i.
+template <typename T>
+static inline void transpose_block(
+    const char* src, int64_t src_stride, char* dst, int64_t dst_stride,
+    int64_t rows, int64_t cols) {
+  for (int64_t j = 0; j < cols; j++) {
+    T* dst_col = reinterpret_cast<T*>(dst + j * dst_stride);
+    for (int64_t i = 0; i < rows; i++) {
+      dst_col[i] = *reinterpret_cast<const T*>(src + i * src_stride + j * sizeof(T));
+    }
+  }
+}
+
+#if defined(__AVX__) && !defined(_MSC_VER)
+static inline void transpose_8x8(
+    const char* src, int64_t src_stride, char* dst, int64_t dst_stride) {
+  __m256 r0 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 0 * src_stride));
+  __m256 r1 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 1 * src_stride));
+  __m256 r2 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 2 * src_stride));
+  __m256 r3 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 3 * src_stride));
+  __m256 r4 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 4 * src_stride));
+  __m256 r5 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 5 * src_stride));
+  __m256 r6 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 6 * src_stride));
+  __m256 r7 = _mm256_loadu_ps(reinterpret_cast<const float*>(src + 7 * src_stride));
+
+  __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+  __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 0 * dst_stride), _mm256_permute2f128_ps(s0, s4, 0x20));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 1 * dst_stride), _mm256_permute2f128_ps(s1, s5, 0x20));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 2 * dst_stride), _mm256_permute2f128_ps(s2, s6, 0x20));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 3 * dst_stride), _mm256_permute2f128_ps(s3, s7, 0x20));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 4 * dst_stride), _mm256_permute2f128_ps(s0, s4, 0x31));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 5 * dst_stride), _mm256_permute2f128_ps(s1, s5, 0x31));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 6 * dst_stride), _mm256_permute2f128_ps(s2, s6, 0x31));
+  _mm256_storeu_ps(reinterpret_cast<float*>(dst + 7 * dst_stride), _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+template <>
+inline void transpose_block<uint32_t>(
+    const char* src, int64_t src_stride, char* dst, int64_t dst_stride,
+    int64_t rows, int64_t cols) {
+  constexpr int64_t kSize = sizeof(uint32_t);
+  int64_t i = 0;
+  for (; i + 8 <= rows; i += 8) {
+    int64_t j = 0;
+    for (; j + 8 <= cols; j += 8) {
+      transpose_8x8(
+          src + i * src_stride + j * kSize, src_stride,
+          dst + j * dst_stride + i * kSize, dst_stride);
+    }
+    for (; j < cols; j++) {
+      auto dst_col = reinterpret_cast<uint32_t*>(dst + j * dst_stride);
+      for (int64_t k = i; k < i + 8; k++) {
+        dst_col[k] = *reinterpret_cast<const uint32_t*>(src + k * src_stride + j * kSize);
+      }
+    }
+  }
+  for (int64_t j = 0; j < cols; j++) {
+    auto dst_col = reinterpret_cast<uint32_t*>(dst + j * dst_stride);
+    for (int64_t k = i; k < rows; k++) {
+      dst_col[k] = *reinterpret_cast<const uint32_t*>(src + k * src_stride + j * kSize);
+    }
+  }
+}
+#endif
+
+// Returns the dim > 0 of iter in which the input is contiguous, if the
+// output is contiguous in dim 0 and the input is not, or -1.
+static int transpose_dim(const TensorIterator& iter) {
+  const int64_t element_size = iter.element_size(0);
+  if (iter.ndim() < 2 || iter.numel() < kTransposeTile * kTransposeTile / 4 ||
+      iter.strides(0)[0] != element_size || iter.strides(1)[0] == element_size) {
+    return -1;
+  }
+  for (int dim = 1; dim < iter.ndim(); dim++) {
+    if (iter.strides(1)[dim] == element_size && iter.shape()[dim] > 1) {
+      return dim;
+    }
+  }
+  return -1;
+}
+
+template <typename T>
+static void transpose_copy(TensorIterator& iter, int dim) {
+  const int ndim = iter.ndim();
+  const auto shape = iter.shape();
+  const auto out_strides = iter.strides(0);
+  const auto in_strides = iter.strides(1);
+  char* out = static_cast<char*>(iter.data_ptr(0));
+  const char* in = static_cast<const char*>(iter.data_ptr(1));
+
+  // The output is contiguous in rows, the input in cols, and every other
+  // dim is a batch of transposes.
+  const int64_t rows = shape[0];
+  const int64_t cols = shape[dim];
+  DimVector batch_dims;
+  int64_t batch = 1;
+  for (int d = 1; d < ndim; d++) {
+    if (d != dim) {
+      batch_dims.push_back(d);
+      batch *= shape[d];
+    }
+  }
+  const int64_t row_tiles = (rows + kTransposeTile - 1) / kTransposeTile;
+  const int64_t col_tiles = (cols + kTransposeTile - 1) / kTransposeTile;
+  const int64_t tiles = batch * row_tiles * col_tiles;
+
+  at::parallel_for(0, tiles, internal::GRAIN_SIZE / (kTransposeTile * kTransposeTile),
+      [&](int64_t begin, int64_t end) {
+    for (int64_t tile = begin; tile < end; tile++) {
+      const int64_t col_tile = tile % col_tiles;
+      const int64_t row_tile = (tile / col_tiles) % row_tiles;
+      int64_t index = tile / (col_tiles * row_tiles);
+      int64_t out_offset = 0;
+      int64_t in_offset = 0;
+      for (auto d : batch_dims) {
+        const int64_t i = index % shape[d];
+        index /= shape[d];
+        out_offset += i * out_strides[d];
+        in_offset += i * in_strides[d];
+      }
+      const int64_t row = row_tile * kTransposeTile;
+      const int64_t col = col_tile * kTransposeTile;
+      transpose_block<T>(
+          in + in_offset + row * in_strides[0] + col * sizeof(T), in_strides[0],
+          out + out_offset + col * out_strides[dim] + row * sizeof(T), out_strides[dim],
+          std::min(kTransposeTile, rows - row),
+          std::min(kTransposeTile, cols - col));
+    }
+  });
+}
+
+// Returns false if the copy is not a transposing copy of an element size
+// that it handles.
+static bool maybe_transpose_copy(TensorIterator& iter) {
+  const int dim = transpose_dim(iter);
+  if (dim < 0) {
+    return false;
+  }
+  switch (iter.element_size(0)) {
+    case 1: transpose_copy<uint8_t>(iter, dim); return true;
+    case 2: transpose_copy<uint16_t>(iter, dim); return true;
+    case 4: transpose_copy<uint32_t>(iter, dim); return true;
+    case 8: transpose_copy<uint64_t>(iter, dim); return true;
+    case 16: transpose_copy<Bytes16>(iter, dim); return true;
+    default: return false;
+  }
+}
+
 static void copy_kernel(TensorIterator& iter, bool non_blocking) {
   ScalarType dtype = iter.dtype(0);
+  if (dtype == iter.dtype(1) && maybe_transpose_copy(iter)) {
+    return;
+  }
   if (dtype == iter.dtype(1)) {
     if (dtype == ScalarType::Half) {
       cpu_kernel(iter, [=](at::Half a) -> at::Half { return a; });
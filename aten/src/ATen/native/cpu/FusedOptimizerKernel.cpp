@@ -0,0 +1,235 @@
+#include <ATen/native/FusedOptimizer.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Number of elements of a tensor a task of the parallel loop is given at
+// least. Small tensors are one chunk each; large ones are split so that one
+// of them does not serialize the step.
+constexpr int64_t kChunkSize = 1 << 12;
+
+// Calls fn(tensor, begin, end) on chunks of the elements of every tensor of
+// the list, in parallel.
+template <typename F>
+void parallel_for_chunks(TensorList tensors, const F& fn) {
+  std::vector<std::pair<int64_t, int64_t>> chunks;
+  for (size_t t = 0; t < tensors.size(); t++) {
+    for (int64_t begin = 0; begin < tensors[t].numel(); begin += kChunkSize) {
+      chunks.emplace_back(t, begin);
+    }
+  }
+  at::parallel_for(
+      0,
+      chunks.size(),
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / kChunkSize),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; c++) {
+          const auto t = chunks[c].first;
+          const auto chunk_begin = chunks[c].second;
+          fn(t, chunk_begin, std::min(chunk_begin + kChunkSize, tensors[t].numel()));
+        }
+      });
+}
+
+// Calls fn(offset, count) on the vectors of elements of begin..end. The last
+// one may be partial; fn loads and stores count elements at offset.
+template <typename scalar_t, typename F>
+inline void for_each_vec(int64_t begin, int64_t end, const F& fn) {
+  for (int64_t d = begin; d < end; d += Vec256<scalar_t>::size()) {
+    fn(d, std::min<int64_t>(Vec256<scalar_t>::size(), end - d));
+  }
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> load(const scalar_t* ptr, int64_t count) {
+  return count == Vec256<scalar_t>::size() ? Vec256<scalar_t>::loadu(ptr)
+                                          : Vec256<scalar_t>::loadu(ptr, count);
+}
+
+template <typename scalar_t>
+inline void store(const Vec256<scalar_t>& v, scalar_t* ptr, int64_t count) {
+  v.store(ptr, count);
+}
+
+void fused_sgd_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    const FusedSGDOptions& options) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_sgd", [&] {
+    using Vec = Vec256<scalar_t>;
+    const Vec lr(options.lr);
+    const Vec weight_decay(options.weight_decay);
+    const Vec momentum(options.momentum);
+    const Vec one_minus_dampening(1 - options.dampening);
+    parallel_for_chunks(params, [&](int64_t t, int64_t begin, int64_t end) {
+      scalar_t* param = params[t].data_ptr<scalar_t>();
+      const scalar_t* grad = grads[t].data_ptr<scalar_t>();
+      scalar_t* buf = options.momentum != 0
+          ? momentum_buffers[t].data_ptr<scalar_t>()
+          : nullptr;
+      for_each_vec<scalar_t>(begin, end, [&](int64_t d, int64_t n) {
+        Vec p = load(param + d, n);
+        Vec d_p = load(grad + d, n);
+        if (options.weight_decay != 0) {
+          d_p = d_p + p * weight_decay;
+        }
+        if (buf) {
+          const Vec b = load(buf + d, n) * momentum + d_p * one_minus_dampening;
+          store(b, buf + d, n);
+          d_p = options.nesterov ? d_p + b * momentum : b;
+        }
+        store(p - d_p * lr, param + d, n);
+      });
+    });
+  });
+}
+
+void fused_adam_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    ArrayRef<double> step_sizes,
+    ArrayRef<double> bias_correction2_sqrts,
+    const FusedAdamOptions& options) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_adam", [&] {
+    using Vec = Vec256<scalar_t>;
+    const Vec beta1(options.beta1);
+    const Vec one_minus_beta1(1 - options.beta1);
+    const Vec beta2(options.beta2);
+    const Vec one_minus_beta2(1 - options.beta2);
+    const Vec eps(options.eps);
+    const Vec weight_decay(options.weight_decay);
+    parallel_for_chunks(params, [&](int64_t t, int64_t begin, int64_t end) {
+      scalar_t* param = params[t].data_ptr<scalar_t>();
+      const scalar_t* grad = grads[t].data_ptr<scalar_t>();
+      scalar_t* exp_avg = exp_avgs[t].data_ptr<scalar_t>();
+      scalar_t* exp_avg_sq = exp_avg_sqs[t].data_ptr<scalar_t>();
+      scalar_t* max_exp_avg_sq = options.amsgrad
+          ? max_exp_avg_sqs[t].data_ptr<scalar_t>()
+          : nullptr;
+      const Vec step_size(step_sizes[t]);
+      const Vec bias_correction2_sqrt(bias_correction2_sqrts[t]);
+      for_each_vec<scalar_t>(begin, end, [&](int64_t d, int64_t n) {
+        const Vec p = load(param + d, n);
+        Vec g = load(grad + d, n);
+        if (options.weight_decay != 0) {
+          g = g + p * weight_decay;
+        }
+        const Vec m = load(exp_avg + d, n) * beta1 + g * one_minus_beta1;
+        Vec v = load(exp_avg_sq + d, n) * beta2 + g * g * one_minus_beta2;
+        store(m, exp_avg + d, n);
+        store(v, exp_avg_sq + d, n);
+        if (max_exp_avg_sq) {
+          v = maximum(load(max_exp_avg_sq + d, n), v);
+          store(v, max_exp_avg_sq + d, n);
+        }
+        const Vec denom = v.sqrt() / bias_correction2_sqrt + eps;
+        store(p - step_size * m / denom, param + d, n);
+      });
+    });
+  });
+}
+
+void fused_adagrad_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList sums,
+    ArrayRef<double> clrs,
+    const FusedAdagradOptions& options) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_adagrad", [&] {
+    using Vec = Vec256<scalar_t>;
+    const Vec eps(options.eps);
+    const Vec weight_decay(options.weight_decay);
+    parallel_for_chunks(params, [&](int64_t t, int64_t begin, int64_t end) {
+      scalar_t* param = params[t].data_ptr<scalar_t>();
+      const scalar_t* grad = grads[t].data_ptr<scalar_t>();
+      scalar_t* sum = sums[t].data_ptr<scalar_t>();
+      const Vec clr(clrs[t]);
+      for_each_vec<scalar_t>(begin, end, [&](int64_t d, int64_t n) {
+        const Vec p = load(param + d, n);
+        Vec g = load(grad + d, n);
+        if (options.weight_decay != 0) {
+          g = g + p * weight_decay;
+        }
+        const Vec s = load(sum + d, n) + g * g;
+        store(s, sum + d, n);
+        store(p - clr * g / (s.sqrt() + eps), param + d, n);
+      });
+    });
+  });
+}
+
+void fused_rmsprop_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList square_avgs,
+    TensorList momentum_buffers,
+    TensorList grad_avgs,
+    const FusedRMSpropOptions& options) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_rmsprop", [&] {
+    using Vec = Vec256<scalar_t>;
+    const Vec lr(options.lr);
+    const Vec alpha(options.alpha);
+    const Vec one_minus_alpha(1 - options.alpha);
+    const Vec eps(options.eps);
+    const Vec weight_decay(options.weight_decay);
+    const Vec momentum(options.momentum);
+    parallel_for_chunks(params, [&](int64_t t, int64_t begin, int64_t end) {
+      scalar_t* param = params[t].data_ptr<scalar_t>();
+      const scalar_t* grad = grads[t].data_ptr<scalar_t>();
+      scalar_t* square_avg = square_avgs[t].data_ptr<scalar_t>();
+      scalar_t* buf = options.momentum > 0
+          ? momentum_buffers[t].data_ptr<scalar_t>()
+          : nullptr;
+      scalar_t* grad_avg = options.centered
+          ? grad_avgs[t].data_ptr<scalar_t>()
+          : nullptr;
+      for_each_vec<scalar_t>(begin, end, [&](int64_t d, int64_t n) {
+        const Vec p = load(param + d, n);
+        Vec g = load(grad + d, n);
+        if (options.weight_decay != 0) {
+          g = g + p * weight_decay;
+        }
+        const Vec sq = load(square_avg + d, n) * alpha + g * g * one_minus_alpha;
+        store(sq, square_avg + d, n);
+        Vec avg;
+        if (grad_avg) {
+          const Vec ga = load(grad_avg + d, n) * alpha + g * one_minus_alpha;
+          store(ga, grad_avg + d, n);
+          avg = (sq - ga * ga).sqrt() + eps;
+        } else {
+          avg = sq.sqrt() + eps;
+        }
+        if (buf) {
+          const Vec b = load(buf + d, n) * momentum + g / avg;
+          store(b, buf + d, n);
+          store(p - b * lr, param + d, n);
+        } else {
+          store(p - g / avg * lr, param + d, n);
+        }
+      });
+    });
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(fused_sgd_stub, &fused_sgd_kernel);
+REGISTER_DISPATCH(fused_adam_stub, &fused_adam_kernel);
+REGISTER_DISPATCH(fused_adagrad_stub, &fused_adagrad_kernel);
+REGISTER_DISPATCH(fused_rmsprop_stub, &fused_rmsprop_kernel);
+
+}} // at::native
@@ -0,0 +1,134 @@
+#include <ATen/native/PointwiseChain.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// The unary ops, on scalars and on vectors.
+template <typename scalar_t>
+inline scalar_t op_neg(scalar_t x) { return -x; }
+template <typename scalar_t>
+inline Vec256<scalar_t> op_neg(const Vec256<scalar_t>& x) { return x.neg(); }
+template <typename scalar_t>
+inline scalar_t op_abs(scalar_t x) { return std::abs(x); }
+template <typename scalar_t>
+inline Vec256<scalar_t> op_abs(const Vec256<scalar_t>& x) { return x.abs(); }
+template <typename scalar_t>
+inline scalar_t op_exp(scalar_t x) { return std::exp(x); }
+template <typename scalar_t>
+inline Vec256<scalar_t> op_exp(const Vec256<scalar_t>& x) { return x.exp(); }
+template <typename scalar_t>
+inline scalar_t op_log(scalar_t x) { return std::log(x); }
+template <typename scalar_t>
+inline Vec256<scalar_t> op_log(const Vec256<scalar_t>& x) { return x.log(); }
+template <typename scalar_t>
+inline scalar_t op_sqrt(scalar_t x) { return std::sqrt(x); }
+template <typename scalar_t>
+inline Vec256<scalar_t> op_sqrt(const Vec256<scalar_t>& x) { return x.sqrt(); }
+template <typename scalar_t>
+inline scalar_t op_tanh(scalar_t x) { return std::tanh(x); }
+template <typename scalar_t>
+inline Vec256<scalar_t> op_tanh(const Vec256<scalar_t>& x) { return x.tanh(); }
+
+// Evaluates the program into regs. T is scalar_t or Vec256<scalar_t>; load(i)
+// returns the value of input i.
+template <typename T, typename Load>
+inline void evaluate(
+    ArrayRef<PointwiseInstruction> program,
+    const T* constants,
+    T* regs,
+    const Load& load) {
+  for (size_t v = 0; v < program.size(); v++) {
+    const auto& ins = program[v];
+    switch (ins.op) {
+      case PointwiseOp::Input: regs[v] = load(ins.a); break;
+      case PointwiseOp::Constant: regs[v] = constants[v]; break;
+      case PointwiseOp::Add: regs[v] = regs[ins.a] + regs[ins.b]; break;
+      case PointwiseOp::Sub: regs[v] = regs[ins.a] - regs[ins.b]; break;
+      case PointwiseOp::Mul: regs[v] = regs[ins.a] * regs[ins.b]; break;
+      case PointwiseOp::Div: regs[v] = regs[ins.a] / regs[ins.b]; break;
+      case PointwiseOp::Maximum: regs[v] = maximum(regs[ins.a], regs[ins.b]); break;
+      case PointwiseOp::Minimum: regs[v] = minimum(regs[ins.a], regs[ins.b]); break;
+      case PointwiseOp::Neg: regs[v] = op_neg(regs[ins.a]); break;
+      case PointwiseOp::Abs: regs[v] = op_abs(regs[ins.a]); break;
+      case PointwiseOp::Relu: regs[v] = maximum(regs[ins.a], T(0)); break;
+      case PointwiseOp::Exp: regs[v] = op_exp(regs[ins.a]); break;
+      case PointwiseOp::Log: regs[v] = op_log(regs[ins.a]); break;
+      case PointwiseOp::Sqrt: regs[v] = op_sqrt(regs[ins.a]); break;
+      case PointwiseOp::Sigmoid:
+        regs[v] = T(1) / (T(1) + op_exp(op_neg(regs[ins.a])));
+        break;
+      case PointwiseOp::Tanh: regs[v] = op_tanh(regs[ins.a]); break;
+    }
+  }
+}
+
+template <typename scalar_t>
+void pointwise_chain_loop(
+    TensorIterator& iter,
+    ArrayRef<PointwiseInstruction> program,
+    int32_t result) {
+  using Vec = Vec256<scalar_t>;
+  constexpr int64_t kSize = sizeof(scalar_t);
+  scalar_t scalar_constants[PointwiseChain::kMaxValues];
+  Vec vec_constants[PointwiseChain::kMaxValues];
+  for (size_t v = 0; v < program.size(); v++) {
+    scalar_constants[v] = static_cast<scalar_t>(program[v].constant);
+    vec_constants[v] = Vec(scalar_constants[v]);
+  }
+  const int ntensors = iter.ntensors();
+
+  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+    // The inner dimension is vectorized when the output is contiguous and
+    // every input is either contiguous or broadcast along it.
+    bool vectorize = strides[0] == kSize;
+    for (int t = 1; t < ntensors; t++) {
+      vectorize = vectorize && (strides[t] == kSize || strides[t] == 0);
+    }
+    int64_t i = 0;
+    if (vectorize) {
+      Vec regs[PointwiseChain::kMaxValues];
+      for (; i + Vec::size() <= n; i += Vec::size()) {
+        evaluate<Vec>(program, vec_constants, regs, [&](int32_t input) {
+          const char* ptr = data[input + 1];
+          return strides[input + 1] == 0
+              ? Vec(*reinterpret_cast<const scalar_t*>(ptr))
+              : Vec::loadu(ptr + i * kSize);
+        });
+        regs[result].store(data[0] + i * kSize);
+      }
+    }
+    // The remainder, or every element if the strides are not vectorizable.
+    scalar_t regs[PointwiseChain::kMaxValues];
+    for (; i < n; i++) {
+      evaluate<scalar_t>(program, scalar_constants, regs, [&](int32_t input) {
+        return *reinterpret_cast<const scalar_t*>(
+            data[input + 1] + i * strides[input + 1]);
+      });
+      *reinterpret_cast<scalar_t*>(data[0] + i * strides[0]) = regs[result];
+    }
+  });
+}
+
+void pointwise_chain_kernel(
+    TensorIterator& iter,
+    ArrayRef<PointwiseInstruction> program,
+    int32_t result) {
+  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "pointwise_chain", [&] {
+    pointwise_chain_loop<scalar_t>(iter, program, result);
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(pointwise_chain_stub, &pointwise_chain_kernel);
+
+}} // at::native
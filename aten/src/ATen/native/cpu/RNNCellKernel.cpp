@@ -0,0 +1,124 @@
+#include <ATen/native/RNN.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Calls fn(row, begin, end) on the segments of the rows of a [batch, hidden]
+// state covered by the elements begin..end of the state in row-major order.
+// Splitting the elements rather than the rows keeps every thread busy at the
+// small batch sizes RNN inference usually runs with.
+template <typename F>
+void parallel_for_state(int64_t batch, int64_t hidden, int64_t gates, const F& fn) {
+  at::parallel_for(
+      0,
+      batch * hidden,
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / gates),
+      [&](int64_t begin, int64_t end) {
+        while (begin < end) {
+          const int64_t row = begin / hidden;
+          const int64_t col = begin % hidden;
+          const int64_t row_end = std::min(hidden, col + end - begin);
+          fn(row, col, row_end);
+          begin += row_end - col;
+        }
+      });
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> load(const scalar_t* ptr, int64_t count) {
+  return count == Vec256<scalar_t>::size() ? Vec256<scalar_t>::loadu(ptr)
+                                          : Vec256<scalar_t>::loadu(ptr, count);
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> sigmoid(const Vec256<scalar_t>& x) {
+  return (Vec256<scalar_t>(1) + x.neg().exp()).reciprocal();
+}
+
+// All tensors are 2-D with contiguous rows. The gates are ordered as in
+// LSTMCell: input, forget, cell and output.
+void lstm_cell_fused_kernel(
+    const Tensor& hy,
+    const Tensor& cy,
+    const Tensor& igates,
+    const Tensor& hgates,
+    const Tensor& cx) {
+  const int64_t batch = cx.size(0);
+  const int64_t hidden = cx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(cx.scalar_type(), "lstm_cell_fused", [&] {
+    using Vec = Vec256<scalar_t>;
+    scalar_t* hy_data = hy.data_ptr<scalar_t>();
+    scalar_t* cy_data = cy.data_ptr<scalar_t>();
+    const scalar_t* ig_data = igates.data_ptr<scalar_t>();
+    const scalar_t* hg_data = hgates.data_ptr<scalar_t>();
+    const scalar_t* cx_data = cx.data_ptr<scalar_t>();
+    parallel_for_state(batch, hidden, 4, [&](int64_t row, int64_t begin, int64_t end) {
+      const scalar_t* ig = ig_data + row * igates.stride(0);
+      const scalar_t* hg = hg_data + row * hgates.stride(0);
+      const scalar_t* c = cx_data + row * cx.stride(0);
+      scalar_t* h_out = hy_data + row * hy.stride(0);
+      scalar_t* c_out = cy_data + row * cy.stride(0);
+      for (int64_t d = begin; d < end; d += Vec::size()) {
+        const int64_t n = std::min<int64_t>(Vec::size(), end - d);
+        const Vec ingate = sigmoid(load(ig + d, n) + load(hg + d, n));
+        const Vec forgetgate =
+            sigmoid(load(ig + hidden + d, n) + load(hg + hidden + d, n));
+        const Vec cellgate =
+            (load(ig + 2 * hidden + d, n) + load(hg + 2 * hidden + d, n)).tanh();
+        const Vec outgate =
+            sigmoid(load(ig + 3 * hidden + d, n) + load(hg + 3 * hidden + d, n));
+        const Vec c_new = forgetgate * load(c + d, n) + ingate * cellgate;
+        c_new.store(c_out + d, n);
+        (outgate * c_new.tanh()).store(h_out + d, n);
+      }
+    });
+  });
+}
+
+// The gates are ordered as in GRUCell: reset, input and new.
+void gru_cell_fused_kernel(
+    const Tensor& hy,
+    const Tensor& igates,
+    const Tensor& hgates,
+    const Tensor& hx) {
+  const int64_t batch = hx.size(0);
+  const int64_t hidden = hx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(hx.scalar_type(), "gru_cell_fused", [&] {
+    using Vec = Vec256<scalar_t>;
+    scalar_t* hy_data = hy.data_ptr<scalar_t>();
+    const scalar_t* ig_data = igates.data_ptr<scalar_t>();
+    const scalar_t* hg_data = hgates.data_ptr<scalar_t>();
+    const scalar_t* hx_data = hx.data_ptr<scalar_t>();
+    parallel_for_state(batch, hidden, 3, [&](int64_t row, int64_t begin, int64_t end) {
+      const scalar_t* ig = ig_data + row * igates.stride(0);
+      const scalar_t* hg = hg_data + row * hgates.stride(0);
+      const scalar_t* h = hx_data + row * hx.stride(0);
+      scalar_t* h_out = hy_data + row * hy.stride(0);
+      for (int64_t d = begin; d < end; d += Vec::size()) {
+        const int64_t n = std::min<int64_t>(Vec::size(), end - d);
+        const Vec reset_gate = sigmoid(load(ig + d, n) + load(hg + d, n));
+        const Vec input_gate =
+            sigmoid(load(ig + hidden + d, n) + load(hg + hidden + d, n));
+        const Vec new_gate =
+            (load(ig + 2 * hidden + d, n) + reset_gate * load(hg + 2 * hidden + d, n))
+                .tanh();
+        ((load(h + d, n) - new_gate) * input_gate + new_gate).store(h_out + d, n);
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_cell_fused_stub, &lstm_cell_fused_kernel);
+REGISTER_DISPATCH(gru_cell_fused_stub, &gru_cell_fused_kernel);
+
+}} // namespace at::native
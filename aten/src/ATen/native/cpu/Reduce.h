@@ -4,6 +4,8 @@
 #include <ATen/Parallel.h>
 #include <c10/util/TypeList.h>
 
+#include <algorithm>
+#include <array>
 #include <sstream>
 
 namespace at { namespace native { namespace {
@@ -31,30 +33,82 @@ static inline bool is_outer_reduction(const int64_t* strides) {
          strides[3] == sizeof(typename traits::arg2_t);
 }
 
+// Reductions accumulate linearly over blocks of at most kCascadeBlock rows of
+// vectors, and combine the results of the blocks pairwise, so that the
+// rounding error of a floating point sum grows with log(n) instead of n.
+constexpr int64_t kCascadeBlock = 64;
+
+// Combines the values it is given pairwise, like a binary counter:
+// levels[k] holds the combination of 2^k values.
+template <typename acc_t, typename combine_t>
+struct CascadeSum {
+  explicit CascadeSum(const combine_t& combine) : combine(combine) {}
+
+  void add(acc_t value) {
+    int k = 0;
+    for (; occupied & (uint64_t(1) << k); k++) {
+      value = combine(levels[k], value);
+    }
+    occupied = ((occupied >> k) | 1) << k;
+    levels[k] = value;
+  }
+
+  // Returns false if no value was added.
+  bool result(acc_t& out) const {
+    bool any = false;
+    for (int k = 0; k < 64; k++) {
+      if (occupied & (uint64_t(1) << k)) {
+        out = any ? combine(levels[k], out) : levels[k];
+        any = true;
+      }
+    }
+    return any;
+  }
+
+  const combine_t& combine;
+  uint64_t occupied = 0;
+  acc_t levels[64];
+};
+
+template <typename scalar_t, typename func_t>
+static inline scalar_t reduce_all(const Vec256<scalar_t>& acc, func_t op) {
+  scalar_t buffer[Vec256<scalar_t>::size()];
+  acc.store(buffer);
+  for (int j = 1; j < Vec256<scalar_t>::size(); j++) {
+    buffer[0] = op(buffer[0], buffer[j]);
+  }
+  return buffer[0];
+}
+
 template <typename func_t, typename vec_func_t>
 static inline void reduction128(char** data, int64_t n, int64_t stride, func_t op, vec_func_t vop, bool reduce) {
   VEC_LOOP_HEADER(func_t, data)
+  using Acc = std::array<Vec, 4>;
   const char* in1_ptr = data[1];
-  Vec acc[4];
-  for  (int j = 0; j < 4; j++) {
-    acc[j] = Vec::loadu(in1_ptr + j * Vec::size() * sizeof(scalar_t));
-  }
-  for (int64_t i = 1; i < n; i++) {
-    const char* ptr = in1_ptr + stride * i;
-    acc[0] = vop(acc[0], Vec::loadu(ptr + (0 * Vec::size() * sizeof(scalar_t))));
-    acc[1] = vop(acc[1], Vec::loadu(ptr + (1 * Vec::size() * sizeof(scalar_t))));
-    acc[2] = vop(acc[2], Vec::loadu(ptr + (2 * Vec::size() * sizeof(scalar_t))));
-    acc[3] = vop(acc[3], Vec::loadu(ptr + (3 * Vec::size() * sizeof(scalar_t))));
+  auto combine = [&](const Acc& a, const Acc& b) {
+    return Acc{{vop(a[0], b[0]), vop(a[1], b[1]), vop(a[2], b[2]), vop(a[3], b[3])}};
+  };
+  CascadeSum<Acc, decltype(combine)> cascade(combine);
+  for (int64_t begin = 0; begin < n; begin += kCascadeBlock) {
+    const int64_t end = std::min(begin + kCascadeBlock, n);
+    Acc acc;
+    for (int j = 0; j < 4; j++) {
+      acc[j] = Vec::loadu(in1_ptr + stride * begin + j * Vec::size() * sizeof(scalar_t));
+    }
+    for (int64_t i = begin + 1; i < end; i++) {
+      const char* ptr = in1_ptr + stride * i;
+      acc[0] = vop(acc[0], Vec::loadu(ptr + (0 * Vec::size() * sizeof(scalar_t))));
+      acc[1] = vop(acc[1], Vec::loadu(ptr + (1 * Vec::size() * sizeof(scalar_t))));
+      acc[2] = vop(acc[2], Vec::loadu(ptr + (2 * Vec::size() * sizeof(scalar_t))));
+      acc[3] = vop(acc[3], Vec::loadu(ptr + (3 * Vec::size() * sizeof(scalar_t))));
+    }
+    cascade.add(acc);
   }
+  Acc acc;
+  cascade.result(acc);
   if (reduce) {
-    scalar_t buffer[Vec::size()];
-    acc[0] = vop(vop(acc[0], acc[1]), vop(acc[2], acc[3]));
-    acc[0].store(buffer);
-    for (int j = 1; j < Vec::size(); j++) {
-      buffer[0] = op(buffer[0], buffer[j]);
-    }
     auto dst = (scalar_t*)out_ptr;
-    *dst = op(*dst, buffer[0]);
+    *dst = op(*dst, reduce_all(vop(vop(acc[0], acc[1]), vop(acc[2], acc[3])), op));
   } else {
     for (int j = 0; j < 4; j++) {
       auto dst = out_ptr + j * Vec::size() * sizeof(scalar_t);
@@ -82,25 +136,100 @@ static inline void vectorized_inner_reduction(char** data, int64_t n, func_t op,
   if (count > 0) {
     reduction128(data, count, vector_stride, op, vop, /*reduce=*/true);
   }
+  // reduce the remaining whole vectors, fewer than 4
+  int64_t begin = count * 4 * Vec::size();
+  if (begin + Vec::size() <= n) {
+    const char* in_ptr = data[1] + begin * sizeof(scalar_t);
+    Vec acc = Vec::loadu(in_ptr);
+    begin += Vec::size();
+    for (; begin + Vec::size() <= n; begin += Vec::size()) {
+      acc = vop(acc, Vec::loadu(data[1] + begin * sizeof(scalar_t)));
+    }
+    auto dst = (scalar_t*)out_ptr;
+    *dst = op(*dst, reduce_all(acc, op));
+  }
   char* ptrs[3] = { data[0], data[0], data[1] };
   int64_t strides[] = { 0, 0, sizeof(scalar_t) };
-  basic_loop(ptrs, strides, count * 4 * Vec::size(), n, op);
+  basic_loop(ptrs, strides, begin, n, op);
+}
+
+// computes the reduction out = op(out, in) of size1 rows of size0 contiguous
+// elements that all reduce into the same output element, e.g. the H * W
+// elements of the N images of a channel. The rows are short, so instead of
+// reducing every row to a scalar, the vectors of all the rows are
+// accumulated together and reduced once.
+template <typename func_t, typename vec_func_t>
+static inline void vectorized_inner_reduction_2d(char** data, int64_t row_stride, int64_t size0, int64_t size1, func_t op, vec_func_t vop) {
+  VEC_LOOP_HEADER(func_t, data)
+  const int64_t vec_end = size0 - size0 % Vec::size();
+  CascadeSum<Vec, vec_func_t> cascade(vop);
+  CascadeSum<scalar_t, func_t> tail_cascade(op);
+  for (int64_t begin = 0; begin < size1; begin += kCascadeBlock) {
+    const int64_t end = std::min(begin + kCascadeBlock, size1);
+    if (vec_end > 0) {
+      Vec acc = Vec::loadu(data[1] + begin * row_stride);
+      for (int64_t row = begin; row < end; row++) {
+        const char* row_ptr = data[1] + row * row_stride;
+        for (int64_t i = row == begin ? Vec::size() : 0; i < vec_end; i += Vec::size()) {
+          acc = vop(acc, Vec::loadu(row_ptr + i * sizeof(scalar_t)));
+        }
+      }
+      cascade.add(acc);
+    }
+    if (vec_end < size0) {
+      scalar_t acc = *(const scalar_t*)(data[1] + begin * row_stride + vec_end * sizeof(scalar_t));
+      for (int64_t row = begin; row < end; row++) {
+        const char* row_ptr = data[1] + row * row_stride;
+        for (int64_t i = row == begin ? vec_end + 1 : vec_end; i < size0; i++) {
+          acc = op(acc, *(const scalar_t*)(row_ptr + i * sizeof(scalar_t)));
+        }
+      }
+      tail_cascade.add(acc);
+    }
+  }
+  auto dst = (scalar_t*)out_ptr;
+  Vec vec_acc;
+  if (cascade.result(vec_acc)) {
+    *dst = op(*dst, reduce_all(vec_acc, op));
+  }
+  scalar_t tail_acc;
+  if (tail_cascade.result(tail_acc)) {
+    *dst = op(*dst, tail_acc);
+  }
 }
 
 // computes the reduction out = op(out, in)
+// The input is contiguous in dim 1. If the output is not (out_stride), each
+// block of 4 * Vec::size() columns is reduced into a contiguous buffer, which
+// is then combined with the output.
 template <typename func_t, typename vec_func_t>
-static inline void vectorized_outer_reduction(char** data, int64_t inner_stride, int64_t size0, int64_t size1, func_t op, vec_func_t vop) {
+static inline void vectorized_outer_reduction(char** data, int64_t inner_stride, int64_t out_stride, int64_t size0, int64_t size1, func_t op, vec_func_t vop) {
   VEC_LOOP_HEADER(func_t, data)
+  constexpr int64_t kColumns = 4 * Vec::size();
 
   // reduce down each column of 4 * Vec::size() elements (128 bytes)
-  int64_t outer_stride[2] = { 128, 128 };
-  UNARY_OUTER_LOOP(data, outer_stride, size1 / (4 * Vec::size()), [&] {
-    reduction128(data, size0, inner_stride, op, vop, /*reduce=*/false);
-  });
+  int64_t outer_stride[2] = { kColumns * out_stride, 128 };
+  if (out_stride == sizeof(scalar_t)) {
+    UNARY_OUTER_LOOP(data, outer_stride, size1 / kColumns, [&] {
+      reduction128(data, size0, inner_stride, op, vop, /*reduce=*/false);
+    });
+  } else {
+    UNARY_OUTER_LOOP(data, outer_stride, size1 / kColumns, [&] {
+      scalar_t buffer[kColumns];
+      for (int64_t j = 0; j < kColumns; j++) {
+        buffer[j] = *(scalar_t*)(data[0] + j * out_stride);
+      }
+      char* ptrs[2] = { (char*)buffer, data[1] };
+      reduction128(ptrs, size0, inner_stride, op, vop, /*reduce=*/false);
+      for (int64_t j = 0; j < kColumns; j++) {
+        *(scalar_t*)(data[0] + j * out_stride) = buffer[j];
+      }
+    });
+  }
 
   // reduce down the remaining columns
-  int64_t step[] = { sizeof(scalar_t), sizeof(scalar_t) };
-  int64_t remaining = size1 % (4 * Vec::size());
+  int64_t step[] = { out_stride, sizeof(scalar_t) };
+  int64_t remaining = size1 % kColumns;
   UNARY_OUTER_LOOP(data, step, remaining, [&] {
     char* ptrs[3] = { data[0], data[0], data[1] };
     int64_t strides[] = { 0, 0, inner_stride };
@@ -170,11 +299,13 @@ struct all_same : guts::conjunction<
 // the idea is to one sequence of `reduce` calls per thread of execution,
 // and then to combine them at the end with `combine`.
 //
-// If there is more than one output element,
+// If there are at least as many output elements as threads,
 // our parallelization strategy is to use one thread for each of them,
 // which means that `combine` will never be called.
 //
-// If, on the other hand, there is only one, then we split the input into
+// If, on the other hand, there are fewer (e.g. one per channel of an
+// [N, C, H, W] tensor reduced over dims (0, 2, 3)), then the output elements
+// are reduced one after the other, and for each of them we split the input
 // into several pieces, reduce each separately, and then combine them.
 
 template <typename ops_t, typename init_t>
@@ -202,6 +333,7 @@ void binary_kernel_reduce(TensorIterator& iter, ops_t ops, init_t init) {
     "the accumulate type must be default-constructible"
   );
   const int num_outputs = iter.noutputs();
+  const bool parallelize_outputs = iter.output(0).numel() >= at::get_num_threads();
   iter.foreach_reduced_elt([&ops, &init, num_outputs](TensorIterator &sub_iter) {
     auto reduction_body = [&ops, &sub_iter, num_outputs](acc_t acc, int64_t begin, int64_t end) -> acc_t {
       int ntensors = sub_iter.ntensors();
@@ -240,7 +372,7 @@ void binary_kernel_reduce(TensorIterator& iter, ops_t ops, init_t init) {
       }
     }
     set_results<r_traits>(ops.project(total_acc), sub_iter, num_outputs);
-  });
+  }, parallelize_outputs);
 }
 
 template <typename func_t, typename vec_func_t>
@@ -256,7 +388,13 @@ void binary_kernel_reduce_vec(TensorIterator& iter, func_t op, vec_func_t vop, d
   iter.output().fill_(ident);
   iter.parallel_reduce([&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
     int64_t outer_strides[] = { strides[2], strides[3] };
-    if (is_contiguous_reduction<traits>(strides)) {
+    using Vec = Vec256<typename traits::result_type>;
+    if (is_contiguous_reduction<traits>(strides) && strides[2] == 0 &&
+        size0 < 4 * Vec::size()) {
+      // input is contiguous in dim 0, output is reduced in dims 0 and 1, and
+      // the rows are too short for vectorized_inner_reduction
+      vectorized_inner_reduction_2d(data, strides[3], size0, size1, op, vop);
+    } else if (is_contiguous_reduction<traits>(strides)) {
       // input is contiguous in dim 0, output is reduced in dim 0
       UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
         vectorized_inner_reduction(data, size0, op, vop);
@@ -264,7 +402,12 @@ void binary_kernel_reduce_vec(TensorIterator& iter, func_t op, vec_func_t vop, d
     } else if (is_outer_reduction<traits>(strides)) {
       // input and output are contiguous in dim 1
       int64_t inner_stride = strides[1]; // stride of input in dim 0
-      vectorized_outer_reduction(data, inner_stride, size0, size1, op, vop);
+      vectorized_outer_reduction(data, inner_stride, strides[2], size0, size1, op, vop);
+    } else if (strides[0] == 0 && strides[2] != 0 &&
+               strides[3] == sizeof(typename traits::arg2_t)) {
+      // input is contiguous in dim 1, output is reduced in dim 0 but strided
+      // in dim 1
+      vectorized_outer_reduction(data, strides[1], strides[2], size0, size1, op, vop);
     } else {
       UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
         char* ptrs[3] = { data[0], data[0], data[1] };
@@ -2,13 +2,169 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/NumericUtils.h>
+#include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/Sorting.h>
 #include <ATen/native/SortingUtils.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace at { namespace native {
 
 namespace {
 
+// Slices at least this long are searched by all threads together when there
+// are too few slices to keep the threads busy, and k is small enough for
+// per-thread heaps of k elements to pay off.
+constexpr int64_t kParallelTopKMinSize = 1 << 16;
+
+// Finds the top k of elements [begin, end) of a slice with a heap of the
+// best k so far, whose front is the worst of them. Once the heap is full, a
+// block of 4 vectors is only looked at element by element if its maximum
+// (or minimum) beats the front of the heap, so most blocks of a long slice
+// are skipped after a few comparisons.
+template <typename scalar_t, typename Comp>
+std::vector<std::pair<scalar_t, int64_t>> topk_heap(
+    const scalar_t* data,
+    int64_t stride,
+    int64_t begin,
+    int64_t end,
+    int64_t k,
+    bool largest,
+    const Comp& comp) {
+  using elem_t = std::pair<scalar_t, int64_t>;
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr int64_t kBlock = 4 * Vec::size();
+
+  std::vector<elem_t> heap;
+  heap.reserve(k);
+  int64_t j = begin;
+  for (; j < end && static_cast<int64_t>(heap.size()) < k; j++) {
+    heap.emplace_back(data[j * stride], j);
+  }
+  std::make_heap(heap.begin(), heap.end(), comp);
+  auto consider = [&](int64_t index) {
+    elem_t elem(data[index * stride], index);
+    if (comp(elem, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), comp);
+      heap.back() = elem;
+      std::push_heap(heap.begin(), heap.end(), comp);
+    }
+  };
+
+  if (stride == 1) {
+    for (; j + kBlock <= end; j += kBlock) {
+      const scalar_t threshold = heap.front().first;
+      if (!_isnan<scalar_t>(threshold)) {
+        const scalar_t* block = data + j;
+        Vec bound = Vec::loadu(block);
+        for (int64_t v = 1; v < 4; v++) {
+          const Vec next = Vec::loadu(block + v * Vec::size());
+          bound = largest ? vec256::maximum(bound, next) : vec256::minimum(bound, next);
+        }
+        scalar_t lanes[Vec::size()];
+        bound.store(lanes);
+        bool candidate = false;
+        for (int64_t l = 0; l < Vec::size(); l++) {
+          candidate |= _isnan<scalar_t>(lanes[l]) ||
+              (largest ? lanes[l] > threshold : lanes[l] < threshold);
+        }
+        if (!candidate) {
+          continue;
+        }
+      }
+      for (int64_t l = 0; l < kBlock; l++) {
+        consider(j + l);
+      }
+    }
+  }
+  for (; j < end; j++) {
+    consider(j);
+  }
+  return heap;
+}
+
+// Every thread finds the top k of a range of each slice, then the
+// candidates of all threads are selected from.
+static void parallel_topk(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t k,
+    int64_t dim,
+    bool largest,
+    bool sorted) {
+  const int64_t n = self.size(dim);
+  std::vector<int64_t> sizes, self_strides, values_strides, indices_strides;
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (d != dim) {
+      sizes.push_back(self.size(d));
+      self_strides.push_back(self.stride(d));
+      values_strides.push_back(values.stride(d));
+      indices_strides.push_back(indices.stride(d));
+    }
+  }
+  const int64_t num_slices = self.numel() / n;
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / at::internal::GRAIN_SIZE));
+
+  AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
+    using elem_t = std::pair<scalar_t, int64_t>;
+    // we want NaN to be sorted as top for numpy compatibility
+    auto larger = [](const elem_t& x, const elem_t& y) -> bool {
+      return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
+    };
+    auto smaller = [](const elem_t& x, const elem_t& y) -> bool {
+      return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
+    };
+
+    for (int64_t slice = 0; slice < num_slices; slice++) {
+      int64_t self_offset = 0, values_offset = 0, indices_offset = 0;
+      for (int64_t d = static_cast<int64_t>(sizes.size()) - 1, i = slice; d >= 0; d--) {
+        const int64_t index = i % sizes[d];
+        i /= sizes[d];
+        self_offset += index * self_strides[d];
+        values_offset += index * values_strides[d];
+        indices_offset += index * indices_strides[d];
+      }
+      const scalar_t* self_slice = self.data_ptr<scalar_t>() + self_offset;
+
+      std::vector<std::vector<elem_t>> heaps(num_chunks);
+      at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t chunk = begin; chunk < end; chunk++) {
+          const int64_t chunk_begin = chunk * n / num_chunks;
+          const int64_t chunk_end = (chunk + 1) * n / num_chunks;
+          heaps[chunk] = largest
+              ? topk_heap(self_slice, self.stride(dim), chunk_begin, chunk_end, k, largest, larger)
+              : topk_heap(self_slice, self.stride(dim), chunk_begin, chunk_end, k, largest, smaller);
+        }
+      });
+
+      std::vector<elem_t> queue;
+      for (const auto& heap : heaps) {
+        queue.insert(queue.end(), heap.begin(), heap.end());
+      }
+      if (largest && sorted) {
+        std::partial_sort(queue.begin(), queue.begin() + k, queue.end(), larger);
+      } else if (largest) {
+        std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(), larger);
+      } else if (sorted) {
+        std::partial_sort(queue.begin(), queue.begin() + k, queue.end(), smaller);
+      } else {
+        std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(), smaller);
+      }
+
+      scalar_t* values_slice = values.data_ptr<scalar_t>() + values_offset;
+      int64_t* indices_slice = indices.data_ptr<int64_t>() + indices_offset;
+      for (int64_t j = 0; j < k; j++) {
+        values_slice[j * values.stride(dim)] = queue[j].first;
+        indices_slice[j * indices.stride(dim)] = queue[j].second;
+      }
+    }
+  });
+}
+
 static void topk_kernel(
     Tensor& values,
     Tensor& indices,
@@ -17,6 +173,12 @@ static void topk_kernel(
     int64_t dim,
     bool largest,
     bool sorted) {
+  const int64_t n = self.size(dim);
+  if (k > 0 && n >= kParallelTopKMinSize && k * 64 <= n &&
+      self.numel() / n < at::get_num_threads()) {
+    parallel_topk(values, indices, self, k, dim, largest, sorted);
+    return;
+  }
   AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
     dim_apply(
         {self, values, indices},
@@ -83,8 +245,184 @@ static void topk_kernel(
   });
 }
 
+// Slices at least this long are sorted by all threads together when there
+// are too few slices to keep the threads busy.
+constexpr int64_t kParallelSortMinSize = 1 << 16;
+
+// Finds how many of the first k elements of the stable merge of a and b come
+// from a. Elements of a go first on ties.
+template <typename elem_t, typename Comp>
+int64_t merge_split(
+    const elem_t* a,
+    int64_t na,
+    const elem_t* b,
+    int64_t nb,
+    int64_t k,
+    const Comp& comp) {
+  int64_t lo = std::max<int64_t>(0, k - nb);
+  int64_t hi = std::min(k, na);
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    // a[mid] goes before b[k - mid - 1], so more than mid come from a.
+    if (!comp(b[k - mid - 1], a[mid])) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Stable parallel merge sort. Every thread sorts one run, then runs are merged
+// pairwise; each merge is split by output position so that all threads take
+// part in every round. Returns the buffer that holds the result, either data
+// or scratch.
+template <typename elem_t, typename Comp>
+elem_t* parallel_stable_sort(
+    elem_t* data,
+    elem_t* scratch,
+    int64_t n,
+    const Comp& comp) {
+  const int64_t num_runs = std::max<int64_t>(
+      1,
+      std::min<int64_t>(
+          at::get_num_threads(), n / at::internal::GRAIN_SIZE));
+  auto run_begin = [&](int64_t run) {
+    return std::min(run, num_runs) * n / num_runs;
+  };
+  at::parallel_for(0, num_runs, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t run = begin; run < end; run++) {
+      std::stable_sort(data + run_begin(run), data + run_begin(run + 1), comp);
+    }
+  });
+
+  elem_t* src = data;
+  elem_t* dst = scratch;
+  for (int64_t width = 1; width < num_runs; width *= 2) {
+    at::parallel_for(
+        0, n, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+          for (int64_t run = 0; run < num_runs; run += 2 * width) {
+            const int64_t lo = run_begin(run);
+            const int64_t mid = run_begin(run + width);
+            const int64_t hi = run_begin(run + 2 * width);
+            const int64_t out_begin = std::max(begin, lo) - lo;
+            const int64_t out_end = std::min(end, hi) - lo;
+            if (out_begin >= out_end) {
+              continue;
+            }
+            const elem_t* a = src + lo;
+            const elem_t* b = src + mid;
+            const int64_t a_begin =
+                merge_split(a, mid - lo, b, hi - mid, out_begin, comp);
+            const int64_t a_end =
+                merge_split(a, mid - lo, b, hi - mid, out_end, comp);
+            std::merge(
+                a + a_begin,
+                a + a_end,
+                b + (out_begin - a_begin),
+                b + (out_end - a_end),
+                dst + lo + out_begin,
+                comp);
+          }
+        });
+    std::swap(src, dst);
+  }
+  return src;
+}
+
+static void sort_kernel(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool descending) {
+  const int64_t n = self.size(dim);
+  const int64_t self_dim_stride = self.stride(dim);
+  const int64_t values_dim_stride = values.stride(dim);
+  const int64_t indices_dim_stride = indices.stride(dim);
+
+  // Element offsets of the first element of each slice.
+  std::vector<int64_t> sizes, self_strides, values_strides, indices_strides;
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (d != dim) {
+      sizes.push_back(self.size(d));
+      self_strides.push_back(self.stride(d));
+      values_strides.push_back(values.stride(d));
+      indices_strides.push_back(indices.stride(d));
+    }
+  }
+  const int64_t num_slices = self.numel() / n;
+
+  AT_DISPATCH_ALL_TYPES(self.scalar_type(), "sort_cpu", [&] {
+    using elem_t = std::pair<scalar_t, int64_t>;
+    // NaN is sorted as the largest value, for numpy compatibility.
+    auto ascending = [](const elem_t& x, const elem_t& y) -> bool {
+      return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
+    };
+    auto descending_comp = [](const elem_t& x, const elem_t& y) -> bool {
+      return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
+    };
+
+    const scalar_t* self_data = self.data_ptr<scalar_t>();
+    scalar_t* values_data = values.data_ptr<scalar_t>();
+    int64_t* indices_data = indices.data_ptr<int64_t>();
+
+    // Sorts one slice and writes its values and indices in one pass.
+    auto sort_slice = [&](int64_t slice, std::vector<elem_t>& buffer, bool parallel) {
+      int64_t self_offset = 0, values_offset = 0, indices_offset = 0;
+      for (int64_t d = static_cast<int64_t>(sizes.size()) - 1, i = slice; d >= 0; d--) {
+        const int64_t index = i % sizes[d];
+        i /= sizes[d];
+        self_offset += index * self_strides[d];
+        values_offset += index * values_strides[d];
+        indices_offset += index * indices_strides[d];
+      }
+      const scalar_t* self_slice = self_data + self_offset;
+      buffer.resize(parallel ? 2 * n : n);
+      elem_t* data = buffer.data();
+      for (int64_t j = 0; j < n; j++) {
+        data[j].first = self_slice[j * self_dim_stride];
+        data[j].second = j;
+      }
+      const elem_t* sorted = data;
+      if (parallel) {
+        sorted = descending
+            ? parallel_stable_sort(data, data + n, n, descending_comp)
+            : parallel_stable_sort(data, data + n, n, ascending);
+      } else if (descending) {
+        std::stable_sort(data, data + n, descending_comp);
+      } else {
+        std::stable_sort(data, data + n, ascending);
+      }
+      scalar_t* values_slice = values_data + values_offset;
+      int64_t* indices_slice = indices_data + indices_offset;
+      for (int64_t j = 0; j < n; j++) {
+        values_slice[j * values_dim_stride] = sorted[j].first;
+        indices_slice[j * indices_dim_stride] = sorted[j].second;
+      }
+    };
+
+    if (n >= kParallelSortMinSize && num_slices < at::get_num_threads()) {
+      std::vector<elem_t> buffer;
+      for (int64_t slice = 0; slice < num_slices; slice++) {
+        sort_slice(slice, buffer, /*parallel=*/true);
+      }
+    } else {
+      const int64_t grain_size =
+          std::max<int64_t>(1, at::internal::GRAIN_SIZE / n);
+      at::parallel_for(0, num_slices, grain_size, [&](int64_t begin, int64_t end) {
+        std::vector<elem_t> buffer;
+        for (int64_t slice = begin; slice < end; slice++) {
+          sort_slice(slice, buffer, /*parallel=*/false);
+        }
+      });
+    }
+  });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(topk_stub, &topk_kernel);
+REGISTER_DISPATCH(sort_stub, &sort_kernel);
 
 }} //at::native
@@ -0,0 +1,526 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <c10/util/Half.h>
+#include <caffe2/perfkernels/fused_8bit_rowwise_conversion.h>
+#include <caffe2/perfkernels/fused_8bit_rowwise_embedding_lookup_idx.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace at {
+namespace native {
+namespace {
+
+// Row-wise quantized embedding tables.
+//
+// A prepacked table is a 2D uint8 tensor. Each row holds the quantized values
+// of one row of the float table followed by that row's scale and bias (the
+// minimum of the row), so that value = quantized * scale + bias:
+//
+//   8-bit: | num_columns x uint8              | float scale | float bias |
+//   4-bit: | num_columns / 2 x uint8,         | half scale  | half bias  |
+//          | two values per byte, low first   |             |            |
+//
+// This is the layout of the Caffe2 fused row-wise operators
+// (FloatToFused8BitRowwiseQuantized, FloatToFused4BitRowwiseQuantized), so
+// tables can be shared between the two.
+
+// The Caffe2 conversion kernels take int row counts.
+constexpr int64_t kMaxRowsPerCall = 1 << 20;
+
+void check_float_table(const Tensor& weight, const char* op) {
+  TORCH_CHECK(
+      weight.dim() == 2 && weight.scalar_type() == kFloat,
+      op,
+      " expects a 2D float weight, got ",
+      weight.dim(),
+      "D ",
+      weight.scalar_type());
+}
+
+void check_packed_table(const Tensor& packed, int64_t extra, const char* op) {
+  TORCH_CHECK(
+      packed.dim() == 2 && packed.scalar_type() == kByte,
+      op,
+      " expects a 2D uint8 prepacked weight, got ",
+      packed.dim(),
+      "D ",
+      packed.scalar_type());
+  TORCH_CHECK(
+      packed.size(1) > extra,
+      op,
+      " expects rows of more than ",
+      extra,
+      " bytes");
+}
+
+Tensor embedding_bag_byte_prepack(const Tensor& weight) {
+  check_float_table(weight, "embedding_bag_byte_prepack");
+  const auto weight_contig = weight.contiguous();
+  const int64_t rows = weight.size(0);
+  const int64_t cols = weight.size(1);
+  const int64_t packed_cols = cols + 2 * sizeof(float);
+  auto packed = at::empty({rows, packed_cols}, weight.options().dtype(kByte));
+  const float* weight_data = weight_contig.data_ptr<float>();
+  uint8_t* packed_data = packed.data_ptr<uint8_t>();
+  at::parallel_for(
+      0,
+      rows,
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(cols, 1)),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; row += kMaxRowsPerCall) {
+          caffe2::FloatToFused8BitRowwiseQuantized(
+              weight_data + row * cols,
+              std::min(end - row, kMaxRowsPerCall),
+              cols,
+              packed_data + row * packed_cols);
+        }
+      });
+  return packed;
+}
+
+Tensor embedding_bag_byte_unpack(const Tensor& packed) {
+  check_packed_table(packed, 2 * sizeof(float), "embedding_bag_byte_unpack");
+  const auto packed_contig = packed.contiguous();
+  const int64_t rows = packed.size(0);
+  const int64_t packed_cols = packed.size(1);
+  const int64_t cols = packed_cols - 2 * sizeof(float);
+  auto weight = at::empty({rows, cols}, packed.options().dtype(kFloat));
+  const uint8_t* packed_data = packed_contig.data_ptr<uint8_t>();
+  float* weight_data = weight.data_ptr<float>();
+  at::parallel_for(
+      0,
+      rows,
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / cols),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; row += kMaxRowsPerCall) {
+          caffe2::Fused8BitRowwiseQuantizedToFloat(
+              packed_data + row * packed_cols,
+              std::min(end - row, kMaxRowsPerCall),
+              packed_cols,
+              weight_data + row * cols);
+        }
+      });
+  return weight;
+}
+
+Tensor embedding_bag_4bit_prepack(const Tensor& weight) {
+  check_float_table(weight, "embedding_bag_4bit_prepack");
+  const int64_t rows = weight.size(0);
+  const int64_t cols = weight.size(1);
+  TORCH_CHECK(
+      cols % 2 == 0,
+      "embedding_bag_4bit_prepack expects an even number of columns, got ",
+      cols);
+  const auto weight_contig = weight.contiguous();
+  const int64_t packed_cols = cols / 2 + 2 * sizeof(at::Half);
+  auto packed = at::empty({rows, packed_cols}, weight.options().dtype(kByte));
+  const float* weight_data = weight_contig.data_ptr<float>();
+  uint8_t* packed_data = packed.data_ptr<uint8_t>();
+  at::parallel_for(
+      0,
+      rows,
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(cols, 1)),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; row++) {
+          const float* input_row = weight_data + row * cols;
+          uint8_t* output_row = packed_data + row * packed_cols;
+          auto* scale_bias =
+              reinterpret_cast<at::Half*>(output_row + cols / 2);
+          float minimum = cols > 0 ? *std::min_element(input_row, input_row + cols) : 0;
+          const float maximum = cols > 0 ? *std::max_element(input_row, input_row + cols) : 0;
+          // Rounded to half, the precision the bias is stored in, so that
+          // quantization and dequantization agree.
+          minimum = static_cast<at::Half>(minimum);
+          const float range = maximum - minimum;
+          at::Half scale = range == 0 ? 1.0f : range / 15.0f;
+          if (static_cast<float>(scale) == 0) {
+            scale = 1.0f;
+          }
+          scale_bias[0] = scale;
+          scale_bias[1] = minimum;
+          const float inverse_scale = 1.0f / static_cast<float>(scale);
+          for (int64_t col = 0; col < cols; col += 2) {
+            auto quantize = [&](float value) -> uint8_t {
+              return std::max<long>(
+                  0,
+                  std::min<long>(
+                      std::lrintf((value - minimum) * inverse_scale), 15));
+            };
+            output_row[col / 2] =
+                quantize(input_row[col]) | (quantize(input_row[col + 1]) << 4);
+          }
+        }
+      });
+  return packed;
+}
+
+Tensor embedding_bag_4bit_unpack(const Tensor& packed) {
+  check_packed_table(packed, 2 * sizeof(at::Half), "embedding_bag_4bit_unpack");
+  const auto packed_contig = packed.contiguous();
+  const int64_t rows = packed.size(0);
+  const int64_t packed_cols = packed.size(1);
+  const int64_t cols = (packed_cols - 2 * sizeof(at::Half)) * 2;
+  auto weight = at::empty({rows, cols}, packed.options().dtype(kFloat));
+  const uint8_t* packed_data = packed_contig.data_ptr<uint8_t>();
+  float* weight_data = weight.data_ptr<float>();
+  at::parallel_for(
+      0,
+      rows,
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / cols),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; row++) {
+          const uint8_t* input_row = packed_data + row * packed_cols;
+          const auto* scale_bias =
+              reinterpret_cast<const at::Half*>(input_row + cols / 2);
+          const float scale = scale_bias[0];
+          const float bias = scale_bias[1];
+          float* output_row = weight_data + row * cols;
+          for (int64_t col = 0; col < cols; col += 2) {
+            output_row[col] = (input_row[col / 2] & 0xf) * scale + bias;
+            output_row[col + 1] = (input_row[col / 2] >> 4) * scale + bias;
+          }
+        }
+      });
+  return weight;
+}
+
+// Validates the arguments shared by the lookups, and returns the offsets of
+// the bags, including the end of the last bag, as int64.
+std::vector<int64_t> bag_offsets(
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    int64_t mode,
+    const c10::optional<Tensor>& per_sample_weights,
+    bool include_last_offset,
+    const char* op) {
+  TORCH_CHECK(
+      indices.scalar_type() == kLong || indices.scalar_type() == kInt,
+      op,
+      " expects int64 or int32 indices, got ",
+      indices.scalar_type());
+  TORCH_CHECK(
+      mode == 0 || mode == 1,
+      op,
+      " only supports the sum (0) and mean (1) modes, got ",
+      mode);
+  if (per_sample_weights.has_value() && per_sample_weights->defined()) {
+    TORCH_CHECK(
+        mode == 0,
+        op,
+        ": per_sample_weights are only supported with the sum mode");
+    TORCH_CHECK(
+        per_sample_weights->scalar_type() == kFloat &&
+            per_sample_weights->numel() == indices.numel(),
+        op,
+        " expects float per_sample_weights of the size of indices");
+  }
+
+  std::vector<int64_t> offsets;
+  if (offsets_in.has_value() && offsets_in->defined()) {
+    TORCH_CHECK(
+        indices.dim() == 1,
+        op,
+        " expects 1D indices when offsets are given, got ",
+        indices.dim(),
+        "D");
+    TORCH_CHECK(
+        offsets_in->dim() == 1, op, " expects 1D offsets");
+    const auto offsets_long = offsets_in->to(kLong).contiguous();
+    const int64_t* data = offsets_long.data_ptr<int64_t>();
+    offsets.assign(data, data + offsets_long.numel());
+    if (include_last_offset) {
+      TORCH_CHECK(
+          offsets.size() >= 1 && offsets.back() == indices.numel(),
+          op,
+          ": with include_last_offset, the last offset must be the number "
+          "of indices");
+    } else {
+      offsets.push_back(indices.numel());
+    }
+    TORCH_CHECK(
+        offsets.front() == 0, op, ": the first offset must be 0");
+    for (size_t i = 1; i < offsets.size(); i++) {
+      TORCH_CHECK(
+          offsets[i - 1] <= offsets[i], op, ": offsets must be increasing");
+    }
+  } else {
+    // Every row of 2D indices is a bag.
+    TORCH_CHECK(
+        indices.dim() == 2,
+        op,
+        " expects 2D indices when offsets are not given, got ",
+        indices.dim(),
+        "D");
+    for (int64_t bag = 0; bag <= indices.size(0); bag++) {
+      offsets.push_back(bag * indices.size(1));
+    }
+  }
+  return offsets;
+}
+
+const float* weights_data(
+    const c10::optional<Tensor>& per_sample_weights,
+    Tensor& contig) {
+  if (!per_sample_weights.has_value() || !per_sample_weights->defined()) {
+    return nullptr;
+  }
+  contig = per_sample_weights->contiguous();
+  return contig.data_ptr<float>();
+}
+
+// The bags are split between threads. The 8-bit lookup goes through the
+// Caffe2 perfkernel, which is vectorized with AVX2 where available.
+template <typename IndexType>
+void embedding_bag_byte_kernel(
+    const Tensor& weight,
+    const IndexType* indices,
+    const std::vector<int64_t>& offsets,
+    const float* weights,
+    int64_t mode,
+    Tensor& output) {
+  const int64_t output_size = output.size(0);
+  const int64_t block_size = output.size(1);
+  const int64_t num_rows = weight.size(0);
+  const uint8_t* weight_data = weight.data_ptr<uint8_t>();
+  float* output_data = output.data_ptr<float>();
+  at::parallel_for(0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+    caffe2::Fused8BitRowwiseEmbeddingLookupIdx<IndexType, uint8_t, float>(
+        /*block_size=*/block_size,
+        /*output_size=*/end_idx - start_idx,
+        /*index_size=*/offsets[end_idx] - offsets[start_idx],
+        /*data_size=*/num_rows,
+        /*input=*/weight_data,
+        /*indices=*/indices + offsets[start_idx],
+        /*offsets=*/offsets.data() + start_idx,
+        /*weights=*/weights ? weights + offsets[start_idx] : nullptr,
+        /*normalize_by_lengths=*/mode == 1,
+        /*out=*/output_data + start_idx * block_size);
+  });
+}
+
+// There is no 4-bit perfkernel, so the rows are dequantized and accumulated
+// here. The output is expected to be zero-initialized.
+template <typename IndexType>
+void embedding_bag_4bit_kernel(
+    const Tensor& weight,
+    const IndexType* indices,
+    const std::vector<int64_t>& offsets,
+    const float* weights,
+    int64_t mode,
+    Tensor& output) {
+  const int64_t output_size = output.size(0);
+  const int64_t block_size = output.size(1);
+  const int64_t num_rows = weight.size(0);
+  const int64_t packed_cols = weight.size(1);
+  const uint8_t* weight_data = weight.data_ptr<uint8_t>();
+  float* output_data = output.data_ptr<float>();
+  at::parallel_for(0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+    for (int64_t bag = start_idx; bag < end_idx; bag++) {
+      float* out = output_data + bag * block_size;
+      for (int64_t i = offsets[bag]; i < offsets[bag + 1]; i++) {
+        const int64_t idx = indices[i];
+        TORCH_CHECK(
+            idx >= 0 && idx < num_rows,
+            "embedding_bag_4bit_rowwise_offsets: index ",
+            idx,
+            " is out of bounds for a table of ",
+            num_rows,
+            " rows");
+        const uint8_t* row = weight_data + idx * packed_cols;
+        const auto* scale_bias =
+            reinterpret_cast<const at::Half*>(row + block_size / 2);
+        const float sample_weight = weights ? weights[i] : 1.0f;
+        const float scale = sample_weight * static_cast<float>(scale_bias[0]);
+        const float bias = sample_weight * static_cast<float>(scale_bias[1]);
+        for (int64_t j = 0; j < block_size / 2; j++) {
+          out[2 * j] += (row[j] & 0xf) * scale + bias;
+          out[2 * j + 1] += (row[j] >> 4) * scale + bias;
+        }
+      }
+      const int64_t length = offsets[bag + 1] - offsets[bag];
+      if (mode == 1 && length > 0) {
+        const float inverse_length = 1.0f / length;
+        for (int64_t j = 0; j < block_size; j++) {
+          out[j] *= inverse_length;
+        }
+      }
+    }
+  });
+}
+
+Tensor embedding_bag_byte_rowwise_offsets(
+    const Tensor& weight,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    bool scale_grad_by_freq,
+    int64_t mode,
+    bool sparse,
+    const c10::optional<Tensor>& per_sample_weights,
+    bool include_last_offset) {
+  const char* op = "embedding_bag_byte_rowwise_offsets";
+  check_packed_table(weight, 2 * sizeof(float), op);
+  const auto offsets = bag_offsets(
+      indices, offsets_in, mode, per_sample_weights, include_last_offset, op);
+  const int64_t block_size = weight.size(1) - 2 * sizeof(float);
+  const auto weight_contig = weight.contiguous();
+  const auto indices_contig = indices.contiguous();
+  Tensor weights_contig;
+  const float* weights = weights_data(per_sample_weights, weights_contig);
+  auto output = at::empty(
+      {static_cast<int64_t>(offsets.size()) - 1, block_size},
+      weight.options().dtype(kFloat));
+
+  if (indices.scalar_type() == kInt) {
+    embedding_bag_byte_kernel(
+        weight_contig,
+        indices_contig.data_ptr<int32_t>(),
+        offsets,
+        weights,
+        mode,
+        output);
+  } else {
+    embedding_bag_byte_kernel(
+        weight_contig,
+        indices_contig.data_ptr<int64_t>(),
+        offsets,
+        weights,
+        mode,
+        output);
+  }
+  return output;
+}
+
+Tensor embedding_bag_4bit_rowwise_offsets(
+    const Tensor& weight,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    bool scale_grad_by_freq,
+    int64_t mode,
+    bool sparse,
+    const c10::optional<Tensor>& per_sample_weights,
+    bool include_last_offset) {
+  const char* op = "embedding_bag_4bit_rowwise_offsets";
+  check_packed_table(weight, 2 * sizeof(at::Half), op);
+  const auto offsets = bag_offsets(
+      indices, offsets_in, mode, per_sample_weights, include_last_offset, op);
+  const int64_t block_size = (weight.size(1) - 2 * sizeof(at::Half)) * 2;
+  const auto weight_contig = weight.contiguous();
+  const auto indices_contig = indices.contiguous();
+  Tensor weights_contig;
+  const float* weights = weights_data(per_sample_weights, weights_contig);
+  auto output = at::zeros(
+      {static_cast<int64_t>(offsets.size()) - 1, block_size},
+      weight.options().dtype(kFloat));
+
+  if (indices.scalar_type() == kInt) {
+    embedding_bag_4bit_kernel(
+        weight_contig,
+        indices_contig.data_ptr<int32_t>(),
+        offsets,
+        weights,
+        mode,
+        output);
+  } else {
+    embedding_bag_4bit_kernel(
+        weight_contig,
+        indices_contig.data_ptr<int64_t>(),
+        offsets,
+        weights,
+        mode,
+        output);
+  }
+  return output;
+}
+
+class QEmbeddingBagBytePrepack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    return embedding_bag_byte_prepack(weight);
+  }
+};
+
+class QEmbeddingBagByteUnpack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    return embedding_bag_byte_unpack(packed_weight);
+  }
+};
+
+class QEmbeddingBag4BitPrepack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    return embedding_bag_4bit_prepack(weight);
+  }
+};
+
+class QEmbeddingBag4BitUnpack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    return embedding_bag_4bit_unpack(packed_weight);
+  }
+};
+
+template <bool BIT_RATE_4>
+class QEmbeddingBagRowwiseOffsets final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor weight,
+      Tensor indices,
+      c10::optional<Tensor> offsets,
+      bool scale_grad_by_freq,
+      int64_t mode,
+      bool sparse,
+      c10::optional<Tensor> per_sample_weights,
+      bool include_last_offset) {
+    if (BIT_RATE_4) {
+      return embedding_bag_4bit_rowwise_offsets(
+          weight,
+          indices,
+          offsets,
+          scale_grad_by_freq,
+          mode,
+          sparse,
+          per_sample_weights,
+          include_last_offset);
+    }
+    return embedding_bag_byte_rowwise_offsets(
+        weight,
+        indices,
+        offsets,
+        scale_grad_by_freq,
+        mode,
+        sparse,
+        per_sample_weights,
+        include_last_offset);
+  }
+};
+
+static auto registry =
+    c10::RegisterOperators()
+        .op("quantized::embedding_bag_byte_prepack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBagBytePrepack>(DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_byte_unpack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBagByteUnpack>(DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_prepack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBag4BitPrepack>(DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_unpack(Tensor weight) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBag4BitUnpack>(DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_byte_rowwise_offsets(Tensor weight, Tensor indices, Tensor? offsets=None, bool scale_grad_by_freq=False, int mode=0, bool sparse=False, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBagRowwiseOffsets<false>>(
+                    DispatchKey::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_rowwise_offsets(Tensor weight, Tensor indices, Tensor? offsets=None, bool scale_grad_by_freq=False, int mode=0, bool sparse=False, Tensor? per_sample_weights=None, bool include_last_offset=False) -> Tensor",
+            c10::RegisterOperators::options()
+                .kernel<QEmbeddingBagRowwiseOffsets<true>>(
+                    DispatchKey::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
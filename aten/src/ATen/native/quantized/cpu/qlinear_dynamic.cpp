@@ -8,33 +8,184 @@
 #include <caffe2/utils/threadpool/ThreadPoolMobile.h>
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
+#include <tuple>
+#include <utility>
 
 namespace at {
 namespace native {
 namespace {
 
-template <bool ReluFused>
+// The activation fused into the dynamic linear ops.
+enum class LinearActivation { kNone, kRelu, kGelu };
+
+#ifdef USE_FBGEMM
+// The range of data, scanned by chunks on the intra-op thread pool.
+std::pair<float, float> parallel_min_max(const float* data, int64_t len) {
+  if (len == 0) {
+    return {0.0f, 0.0f};
+  }
+  return at::parallel_reduce(
+      0,
+      len,
+      at::internal::GRAIN_SIZE,
+      std::make_pair(
+          std::numeric_limits<float>::max(),
+          std::numeric_limits<float>::lowest()),
+      [&](int64_t begin, int64_t end, std::pair<float, float> range) {
+        float x_min, x_max;
+        fbgemm::FindMinMax(data + begin, &x_min, &x_max, end - begin);
+        return std::make_pair(
+            std::min(range.first, x_min), std::max(range.second, x_max));
+      },
+      [](std::pair<float, float> a, std::pair<float, float> b) {
+        return std::make_pair(
+            std::min(a.first, b.first), std::max(a.second, b.second));
+      });
+}
+
+// Applies GELU to data in place and returns the range of the result, in one
+// pass by chunks on the intra-op thread pool.
+std::pair<float, float> parallel_gelu_min_max(float* data, int64_t len) {
+  if (len == 0) {
+    return {0.0f, 0.0f};
+  }
+  constexpr float kAlpha = 0.70710678118654752440f; // 1 / sqrt(2)
+  return at::parallel_reduce(
+      0,
+      len,
+      at::internal::GRAIN_SIZE,
+      std::make_pair(
+          std::numeric_limits<float>::max(),
+          std::numeric_limits<float>::lowest()),
+      [&](int64_t begin, int64_t end, std::pair<float, float> range) {
+        for (int64_t i = begin; i < end; ++i) {
+          const float x = data[i];
+          const float y = 0.5f * x * (1.0f + std::erf(x * kAlpha));
+          data[i] = y;
+          range.first = std::min(range.first, y);
+          range.second = std::max(range.second, y);
+        }
+        return range;
+      },
+      [](std::pair<float, float> a, std::pair<float, float> b) {
+        return std::make_pair(
+            std::min(a.first, b.first), std::max(a.second, b.second));
+      });
+}
+
+// Multiplies the packed input by the packed weight into output, dequantizing
+// the result (per tensor or per output channel, as the weight is quantized)
+// and adding the bias. Called by each of the num_tasks tasks of a parallel
+// loop.
+template <bool ReluFused, typename PackA>
+void fbgemm_linear_task(
+    PackA& packA,
+    PackedLinearWeight& pack,
+    float input_scale,
+    int32_t input_zero_point,
+    const float* bias_ptr,
+    int64_t N,
+    float* output_ptr,
+    int32_t* buffer_ptr,
+    int task_id,
+    int num_tasks) {
+  // This is the end of the pipeline, pass the resulting matrix through.
+  fbgemm::DoNothing<float, float> doNothingObj{};
+  if (pack.q_scheme == kPerTensorAffine) {
+    // ReQuantizeForFloat requires pointers to the zero point values,
+    // since in the case of rowwise quantization these will be arrays rather
+    // than scalars. But in this case, we're doing whole-tensor quantization so
+    // we just pass a pointer to the scale values (and internally
+    // ReQuantizeForFloat won't index past 0.
+    //
+    // After the uint8 * int8 matrix multiplication is performed, this
+    // operation does:
+    //  1) Add in row and column offsets to the rows and columns,
+    //  respectively.
+    //  2) Dequantize the results into floating point.
+    //  3) Add in the bias term.
+    fbgemm::ReQuantizeForFloat<ReluFused> outputProcObj(
+        /*nextop=*/doNothingObj,
+        /*Aq_scale=*/input_scale,
+        /*Bq_scale=*/pack.w_scale.data(),
+        /*Aq_zero_point=*/input_zero_point,
+        /*Bq_zero_point=*/pack.w_zp.data(),
+        /*row_offsets=*/packA.getRowOffsetBuffer(),
+        /*col_offsets=*/pack.col_offsets.data(),
+        /*bias=*/bias_ptr,
+        /*nCol=*/N);
+    fbgemm::fbgemmPacked(
+        /*packA=*/packA,
+        /*packB=*/*pack.w,
+        /*C=*/output_ptr,
+        /*C_buffer=*/buffer_ptr,
+        /*ldc=*/N,
+        /*outProcess=*/outputProcObj,
+        /*thread_id=*/task_id,
+        /*num_threads=*/num_tasks);
+  } else if (pack.q_scheme == kPerChannelAffine) {
+    // The same, with a scale and zero point per output channel.
+    fbgemm::ReQuantizeForFloat<
+        ReluFused,
+        fbgemm::QuantizationGranularity::OUT_CHANNEL>
+        outputProcObj(
+            /*nextop=*/doNothingObj,
+            /*Aq_scale=*/input_scale,
+            /*Bq_scale=*/pack.w_scale.data(),
+            /*Aq_zero_point=*/input_zero_point,
+            /*Bq_zero_point=*/pack.w_zp.data(),
+            /*row_offsets=*/packA.getRowOffsetBuffer(),
+            /*col_offsets=*/pack.col_offsets.data(),
+            /*bias=*/bias_ptr,
+            /*nCol=*/N);
+    fbgemm::fbgemmPacked(
+        /*packA=*/packA,
+        /*packB=*/*pack.w,
+        /*C=*/output_ptr,
+        /*C_buffer=*/buffer_ptr,
+        /*ldc=*/N,
+        /*outProcess=*/outputProcObj,
+        /*thread_id=*/task_id,
+        /*num_threads=*/num_tasks);
+  }
+}
+#endif // USE_FBGEMM
+
+// fp32 or quint8 input * int8 weight -> fp32 output, or quint8 output with
+// QuantizedOutput. A float input is quantized on the fly with the parameters
+// of its range; a quint8 input, e.g. the output of another of these ops with
+// QuantizedOutput, is used as is, so chains of them skip the quantization of
+// their inputs. The quint8 output is quantized with the parameters of the
+// range of the result, after the activation.
+template <LinearActivation Activation, bool QuantizedOutput = false>
 class QLinearDynamicInt8 final : public torch::OperatorKernel {
  public:
+  static constexpr bool ReluFused = Activation == LinearActivation::kRelu;
+
 #ifdef USE_FBGEMM
   at::Tensor fbgemm_linear(at::Tensor input, at::Tensor packed_weight) {
-    // fp32 * int8 -> fp32 (with quantization on activation, and dequantization
-    // on the result).
-
     // We make a strong guarantee that models using these operators will have
     // the same numerics across different machines. Therefore, we do not provide
     // a fallback path and rather fail loudly if we cannot run FBGEMM.
     TORCH_CHECK(
         fbgemm::fbgemmSupportedCPU(), "Your CPU does not support FBGEMM.");
 
-    // TODO: contiguous is called for further jit optimizations.
-    auto input_contig = input.contiguous();
-    const auto* input_ptr = input_contig.data_ptr<float>();
-
     TORCH_CHECK(
         input.dim() >= 2,
         "The dimension of input tensor should be larger than or equal to 2");
+    const bool quantized_input = input.is_quantized();
+    if (quantized_input) {
+      TORCH_CHECK(
+          input.scalar_type() == c10::kQUInt8 &&
+              input.qscheme() == kPerTensorAffine,
+          "A quantized input of quantized::linear_dynamic must be a quint8 "
+          "tensor quantized per tensor");
+    }
+    // TODO: contiguous is called for further jit optimizations.
+    auto input_contig = input.contiguous();
     // C(output) = A(input) x B(weight), where C, A, B are M x N, M x K, K x N
     // matrices, respectively.
     int64_t M = size_to_dim_(input.dim() - 1, input.sizes());
@@ -43,9 +194,6 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
     auto& pack_ptr =
         cpp_custom_type_hack::cast<PackedLinearWeight>(packed_weight);
     auto packB = pack_ptr.w.get();
-    // packB->printPackedMatrix("packedB inside fbgemm_linear_dynamic
-    // (QLinearDynamicInt8): ");
-    auto& col_offsets = pack_ptr.col_offsets;
 
     int64_t N = static_cast<int64_t>(packB->numCols());
     int64_t K = input.size(input.dim() - 1);
@@ -54,45 +202,43 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
         "The number of rows in the packB should be equal to K: " +
             std::to_string(K));
 
-    // Calculate statistics for quantization of the input Tensor
-    float x_min, x_max;
-    fbgemm::FindMinMax(
-        /*m=*/input_ptr,
-        /*min=*/&x_min,
-        /*max=*/&x_max,
-        /*len=*/input.numel());
-
-    // Input tensor is quantized as 8-bit unsigned values
-    static constexpr int precision = 8;
-    static constexpr bool is_signed = false;
-
-    // Calculate scale and zero point for quantization of input tensor
-    auto q_params = quant_utils::ChooseQuantizationParams(
-        /*min=*/x_min,
-        /*max=*/x_max,
-        /*qmin=*/is_signed ? -(1 << (precision - 1)) : 0,
-        /*qmax=*/
-        is_signed ? ((1 << (precision - 1)) - 1) : (1 << precision) - 1,
-        /*preserve_sparsity=*/false);
-
-    q_params.precision = precision;
-
-    // ReQuantizeForFloat requires pointers to the zero point values,
-    // since in the case of rowwise quantization these will be arrays rather
-    // than scalars. But in this case, we're doing whole-tensor quantization so
-    // we just pass a pointer to the scale values (and internally
-    // ReQuantizeForFloat won't index past 0.
+    float input_scale;
+    int32_t input_zero_point;
+    if (quantized_input) {
+      input_scale = input.q_scale();
+      input_zero_point = input.q_zero_point();
+    } else {
+      // Calculate statistics for quantization of the input Tensor
+      float x_min, x_max;
+      std::tie(x_min, x_max) =
+          parallel_min_max(input_contig.data_ptr<float>(), input.numel());
+
+      // Input tensor is quantized as 8-bit unsigned values
+      static constexpr int precision = 8;
+      static constexpr bool is_signed = false;
+
+      // Calculate scale and zero point for quantization of input tensor
+      auto q_params = quant_utils::ChooseQuantizationParams(
+          /*min=*/x_min,
+          /*max=*/x_max,
+          /*qmin=*/is_signed ? -(1 << (precision - 1)) : 0,
+          /*qmax=*/
+          is_signed ? ((1 << (precision - 1)) - 1) : (1 << precision) - 1,
+          /*preserve_sparsity=*/false);
+      input_scale = q_params.scale;
+      input_zero_point = q_params.zero_point;
+    }
 
     const float* bias_ptr = nullptr;
-    at::Tensor bias_vec;
+    at::Tensor bias_contig;
     if (pack_ptr.bias.has_value()) {
-      bias_vec = pack_ptr.bias.value();
+      at::Tensor bias_vec = pack_ptr.bias.value();
       TORCH_CHECK(bias_vec.dim() == 1, "bias should be a vector (1D Tensor)");
       TORCH_CHECK(
           bias_vec.size(0) == N,
           "bias should have N elements: " + std::to_string(N));
       // TODO: contiguous is called for further jit optimizations.
-      auto bias_contig = bias_vec.contiguous();
+      bias_contig = bias_vec.contiguous();
       bias_ptr = bias_contig.data_ptr<float>();
     }
     // The resulting matrix here is 2-D, let's view it with the original
@@ -107,108 +253,68 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
         output,
         output.options().dtype(at::kInt),
         LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    float* output_ptr = output.data_ptr<float>();
+    int32_t* buffer_ptr = buffer.data_ptr<int32_t>();
 
     int num_tasks = at::get_num_threads();
     at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
-      // This operation does the following:
-      // 1) Quantizes the input matrix given the statistics we've calculated
-      // above
-      // 2) Creates a "row buffer" vector with offset values that must be
-      // added
-      //    to the integer matrix multiplication operation to ensure
-      //    correctness. This "row buffer" is also called the row offset, and it
-      //    is needed when we use affine quantization for weights.
-      // 3) Packs the resulting quantized matrix into vector-register and cache
-      //    friendly tiles.
-      //
-      //  Note this is not executed eagerly, but rather within the fbgemmPacked
-      //  call below.
-
-      fbgemm::PackAWithQuantRowOffset<uint8_t> packA(
-          /*trans=*/fbgemm::matrix_op_t::NoTranspose,
-          /*nRow=*/M,
-          /*nCol=*/K,
-          /*smat=*/input_ptr,
-          /*ld=*/K,
-          /*pmat=*/nullptr, // Currently, packA manages ownership of `pmat`.
-          /*scale=*/q_params.scale,
-          /*zero_pt=*/q_params.zero_point);
-      // TODO: Consider a way to pre-allocate and reuse
-      // pmat buffer.
-
-      // This is the end of the pipeline, pass the resulting matrix through.
-      fbgemm::DoNothing<float, float> doNothingObj{};
-
       for (int task_id = begin; task_id < end; ++task_id) {
-        if (pack_ptr.q_scheme == kPerTensorAffine) {
-          // Process the per tensor quantization.
-          //
-          // After the uint8 * int8 matrix multiplication is performed, this
-          // operation does:
-          //  1) Add in row and column offsets to the rows and columns,
-          //  respectively.
-          //  2) Dequantize the results into floating point.
-          //  3) Add in the bias term.
-          fbgemm::ReQuantizeForFloat<ReluFused> outputProcObj(
-              /*nextop=*/doNothingObj,
-              /*Aq_scale=*/q_params.scale,
-              /*Bq_scale=*/pack_ptr.w_scale.data(),
-              /*Aq_zero_point=*/q_params.zero_point,
-              /*Bq_zero_point=*/pack_ptr.w_zp.data(),
-              /*row_offsets=*/packA.getRowOffsetBuffer(),
-              /*col_offsets=*/col_offsets.data(),
-              /*bias=*/bias_ptr,
-              /*nCol=*/N);
-
-          // Do the GEMM
-          fbgemm::fbgemmPacked(
-              /*packA=*/packA,
-              /*packB=*/*packB,
-              /*C=*/output.data_ptr<float>(),
-              /*C_buffer=*/buffer.data_ptr<int32_t>(),
-              /*ldc=*/N,
-              /*outProcess=*/outputProcObj,
-              /*thread_id=*/task_id,
-              /*num_threads=*/num_tasks);
-
-        } else if (pack_ptr.q_scheme == kPerChannelAffine) {
-          // Process the per channel quantization.
-          //
-          // After the uint8 * int8 matrix multiplication is performed, this
-          // operation does:
-          //  1) Add in row and column offsets to the rows and columns,
-          //  respectively.
-          //  2) Dequantize the results into floating point.
-          //  3) Add in the bias term.
-          fbgemm::ReQuantizeForFloat<
-              ReluFused,
-              fbgemm::QuantizationGranularity::OUT_CHANNEL>
-              outputProcObj(
-                  /*nextop=*/doNothingObj,
-                  /*Aq_scale=*/q_params.scale,
-                  /*Bq_scale=*/pack_ptr.w_scale.data(),
-                  /*Aq_zero_point=*/q_params.zero_point,
-                  /*Bq_zero_point=*/pack_ptr.w_zp.data(),
-                  /*row_offsets=*/packA.getRowOffsetBuffer(),
-                  /*col_offsets=*/col_offsets.data(),
-                  /*bias=*/bias_ptr,
-                  /*nCol=*/N);
-
-          // Do the GEMM
-          fbgemm::fbgemmPacked(
-              /*packA=*/packA,
-              /*packB=*/*packB,
-              /*C=*/output.data_ptr<float>(),
-              /*C_buffer=*/buffer.data_ptr<int32_t>(),
-              /*ldc=*/N,
-              /*outProcess=*/outputProcObj,
-              /*thread_id=*/task_id,
-              /*num_threads=*/num_tasks);
+        if (quantized_input) {
+          // Packs the quantized input and computes its row offsets, which
+          // must be added to the integer matrix multiplication to account
+          // for the affine quantization of the weight.
+          fbgemm::PackAWithRowOffset<uint8_t> packA(
+              /*trans=*/fbgemm::matrix_op_t::NoTranspose,
+              /*nRow=*/M,
+              /*nCol=*/K,
+              /*smat=*/
+              reinterpret_cast<const uint8_t*>(
+                  input_contig.data_ptr<c10::quint8>()),
+              /*ld=*/K);
+          fbgemm_linear_task<ReluFused>(
+              packA, pack_ptr, input_scale, input_zero_point, bias_ptr, N,
+              output_ptr, buffer_ptr, task_id, num_tasks);
+        } else {
+          // Quantizes the input with the statistics calculated above, and
+          // packs it and computes its row offsets as above. Note this is not
+          // executed eagerly, but rather within the fbgemmPacked call.
+          fbgemm::PackAWithQuantRowOffset<uint8_t> packA(
+              /*trans=*/fbgemm::matrix_op_t::NoTranspose,
+              /*nRow=*/M,
+              /*nCol=*/K,
+              /*smat=*/input_contig.data_ptr<float>(),
+              /*ld=*/K,
+              /*pmat=*/nullptr, // Currently, packA manages ownership of `pmat`.
+              /*scale=*/input_scale,
+              /*zero_pt=*/input_zero_point);
+          // TODO: Consider a way to pre-allocate and reuse
+          // pmat buffer.
+          fbgemm_linear_task<ReluFused>(
+              packA, pack_ptr, input_scale, input_zero_point, bias_ptr, N,
+              output_ptr, buffer_ptr, task_id, num_tasks);
         }
       }
     });
 
-    return output;
+    // The epilogue: GELU, and the range of the output to quantize it, in a
+    // single pass over the output.
+    float y_min = 0.0f, y_max = 0.0f;
+    if (Activation == LinearActivation::kGelu) {
+      std::tie(y_min, y_max) = parallel_gelu_min_max(output_ptr, output.numel());
+    } else if (QuantizedOutput) {
+      std::tie(y_min, y_max) = parallel_min_max(output_ptr, output.numel());
+    }
+    if (!QuantizedOutput) {
+      return output;
+    }
+    auto y_params = quant_utils::ChooseQuantizationParams(
+        /*min=*/y_min,
+        /*max=*/y_max,
+        /*qmin=*/0,
+        /*qmax=*/255,
+        /*preserve_sparsity=*/false);
+    return at::quantize_per_tensor(
+        output, y_params.scale, y_params.zero_point, c10::kQUInt8);
   }
 #endif // USE_FBGEMM
 #ifdef USE_PYTORCH_QNNPACK
@@ -326,6 +432,11 @@ class QLinearDynamicInt8 final : public torch::OperatorKernel {
 #endif
 #ifdef USE_PYTORCH_QNNPACK
     if (ctx.qEngine() == at::QEngine::QNNPACK) {
+      TORCH_CHECK(
+          Activation != LinearActivation::kGelu && !QuantizedOutput &&
+              !input.is_quantized(),
+          "QNNPACK only supports float inputs and outputs, and no GELU, in "
+          "the dynamic quantized linear ops");
       return qnnpack_linear(input, packed_weight);
     }
 #endif
@@ -395,17 +506,37 @@ class QLinearDynamicFp16 final : public torch::OperatorKernel {
 #endif // USE_FBGEMM
 };
 
+// The int8 ops also take a quint8 X, which dispatches to QuantizedCPUTensorId.
 static auto registry =
     torch::RegisterOperators()
         .op("quantized::linear_dynamic(Tensor X, Tensor W_prepack) -> Tensor Y",
             torch::RegisterOperators::options()
-                .kernel<QLinearDynamicInt8<false>>(DispatchKey::CPUTensorId))
+                .kernel<QLinearDynamicInt8<LinearActivation::kNone>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kNone>>(DispatchKey::QuantizedCPUTensorId))
         .op("_quantized::linear_dynamic(Tensor X, Tensor W_prepack) -> Tensor Y",
             torch::RegisterOperators::options()
-                .kernel<QLinearDynamicInt8<false>>(DispatchKey::CPUTensorId))
+                .kernel<QLinearDynamicInt8<LinearActivation::kNone>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kNone>>(DispatchKey::QuantizedCPUTensorId))
         .op("quantized::linear_relu_dynamic(Tensor X, Tensor W_prepack) -> Tensor Y",
             torch::RegisterOperators::options()
-                .kernel<QLinearDynamicInt8<true>>(DispatchKey::CPUTensorId))
+                .kernel<QLinearDynamicInt8<LinearActivation::kRelu>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kRelu>>(DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_gelu_dynamic(Tensor X, Tensor W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+                .kernel<QLinearDynamicInt8<LinearActivation::kGelu>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kGelu>>(DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_dynamic_qout(Tensor X, Tensor W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+                .kernel<QLinearDynamicInt8<LinearActivation::kNone, true>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kNone, true>>(DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_relu_dynamic_qout(Tensor X, Tensor W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+                .kernel<QLinearDynamicInt8<LinearActivation::kRelu, true>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kRelu, true>>(DispatchKey::QuantizedCPUTensorId))
+        .op("quantized::linear_gelu_dynamic_qout(Tensor X, Tensor W_prepack) -> Tensor Y",
+            torch::RegisterOperators::options()
+                .kernel<QLinearDynamicInt8<LinearActivation::kGelu, true>>(DispatchKey::CPUTensorId)
+                .kernel<QLinearDynamicInt8<LinearActivation::kGelu, true>>(DispatchKey::QuantizedCPUTensorId))
         .op("quantized::linear_dynamic_fp16(Tensor X, Tensor W_prepack) -> Tensor Y",
             torch::RegisterOperators::options()
                 .kernel<QLinearDynamicFp16<false>>(DispatchKey::CPUTensorId));
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <ATen/ATen.h>
+#include <ATen/native/PointwiseChain.h>
+
+using namespace at;
+using at::native::PointwiseChain;
+
+TEST(PointwiseChainTest, MatchesEagerOps) {
+  for (auto dtype : {kFloat, kDouble}) {
+    // Sizes that leave a remainder after the vectorized loop.
+    auto x = at::randn({37, 19}, dtype);
+    auto y = at::randn({37, 19}, dtype);
+    auto z = at::randn({37, 19}, dtype);
+    PointwiseChain chain;
+    auto a = chain.input(x), b = chain.input(y), c = chain.input(z);
+    auto out = chain.run(chain.relu(chain.add(chain.mul(a, b), c)));
+    ASSERT_TRUE(out.allclose(at::relu(x * y + z)));
+
+    PointwiseChain unary;
+    auto v = unary.input(x);
+    auto w = unary.sigmoid(unary.tanh(unary.abs(unary.neg(v))));
+    w = unary.add(w, unary.log(unary.sqrt(unary.exp(unary.constant(2)))));
+    ASSERT_TRUE(unary.run(w).allclose(at::sigmoid(at::tanh(x.neg().abs())) + 1));
+
+    PointwiseChain binary;
+    auto p = binary.input(x), q = binary.input(y);
+    auto r = binary.div(binary.sub(binary.maximum(p, q), binary.minimum(p, q)), q);
+    ASSERT_TRUE(binary.run(r).allclose((at::max(x, y) - at::min(x, y)) / y));
+  }
+}
+
+TEST(PointwiseChainTest, Broadcast) {
+  auto x = at::randn({8, 33});
+  auto row = at::randn({33});
+  auto scale = at::randn({8, 1});
+  PointwiseChain chain;
+  auto result = chain.mul(
+      chain.add(chain.input(x), chain.input(row)), chain.input(scale));
+  ASSERT_TRUE(chain.run(result).allclose((x + row) * scale));
+}
+
+TEST(PointwiseChainTest, NonContiguous) {
+  auto x = at::randn({20, 30}).t();
+  auto y = at::randn({30, 20});
+  Tensor out = at::empty({20, 30}).t();
+  PointwiseChain chain;
+  chain.run_out(out, chain.mul(chain.input(x), chain.input(y)));
+  ASSERT_TRUE(out.allclose(x * y));
+}
+
+TEST(PointwiseChainTest, Errors) {
+  PointwiseChain chain;
+  chain.input(at::randn({3}));
+  ASSERT_ANY_THROW(chain.input(at::randn({3}, kDouble)));
+  ASSERT_ANY_THROW(chain.input(at::ones({3}, kLong)));
+  PointwiseChain other;
+  auto v = other.input(at::randn({3}));
+  ASSERT_ANY_THROW(chain.run(chain.add(v, other.relu(v))));
+  auto a = chain.input(at::randn({3}));
+  ASSERT_ANY_THROW(chain.mul(a, PointwiseChain::Value{-1}));
+  ASSERT_ANY_THROW(chain.sub(PointwiseChain::Value{-1}, a));
+  // v has an index that is in range for chain, but another chain made it.
+  ASSERT_ANY_THROW(chain.add(a, v));
+  ASSERT_ANY_THROW(chain.run(v));
+}
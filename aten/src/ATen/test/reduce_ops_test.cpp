@@ -3,6 +3,10 @@
 #include <torch/types.h>
 #include <torch/utils.h>
 
+#include <ATen/Parallel.h>
+
+#include <functional>
+
 using namespace at;
 
 TEST(ReduceOpsTest, MaxValuesAndMinValues) {
@@ -22,3 +26,27 @@ TEST(ReduceOpsTest, MaxValuesAndMinValues) {
     }
   }
 }
+
+TEST(ReduceOpsTest, ParallelReductionsAreExact) {
+  // Sums of ones are exact in float, so a partial result that is lost or
+  // counted twice by the per-thread buffers shows up as a wrong count.
+  at::set_num_threads(8);
+  auto a = at::ones({1 << 22});
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(a.sum().item<float>(), 1 << 22);
+    ASSERT_TRUE(a.view({1 << 10, 1 << 12}).sum(0).eq(1 << 10).all().item<bool>());
+    ASSERT_TRUE(a.view({4, 1 << 16, 16}).sum(1).eq(1 << 16).all().item<bool>());
+  }
+
+  const int64_t n = 1 << 20;
+  for (int i = 0; i < 10; ++i) {
+    int64_t total = at::parallel_reduce(
+        0, n, 1024, int64_t(0),
+        [&](int64_t begin, int64_t end, int64_t ident) {
+          EXPECT_LT(at::get_thread_num(), at::get_num_threads());
+          return ident + (end - begin);
+        },
+        std::plus<int64_t>());
+    ASSERT_EQ(total, n);
+  }
+}
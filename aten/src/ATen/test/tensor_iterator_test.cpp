@@ -226,3 +226,42 @@ TEST(TensorIteratorTest, FailNonPromotingBinaryOp) {
   iter.add_input(at::ones({1,1}, at::dtype(at::kInt)));
   ASSERT_ANY_THROW(iter.build());
 }
+
+TEST(TensorIteratorTest, PlanCache) {
+  at::set_tensor_iterator_cache_enabled(true);
+  at::reset_tensor_iterator_cache();
+  auto a = at::randn({3, 1, 5});
+  auto b = at::randn({4, 5});
+  auto c = at::randn({2, 3, 4}).transpose(0, 2);
+  for (int i = 0; i < 3; i++) {
+    Tensor out;
+    auto iter = TensorIterator::binary_op(out, a, b);
+    ASSERT_TRUE(iter.output().sizes().equals({3, 4, 5}));
+    ASSERT_TRUE(at::add(a, b).equal(a + b));
+    ASSERT_TRUE((c * 2).equal(c.contiguous() * 2));
+    ASSERT_TRUE((c * 2).strides().equals(c.strides()));
+  }
+  auto stats = at::tensor_iterator_cache_stats();
+  EXPECT_GT(stats.hits, 0);
+  EXPECT_GT(stats.misses, 0);
+
+  // an out= argument of the wrong shape is resized on every build
+  auto out = at::empty({1});
+  at::add_out(out, a, b);
+  ASSERT_TRUE(out.sizes().equals({3, 4, 5}));
+  out.resize_({1});
+  at::add_out(out, a, b);
+  ASSERT_TRUE(out.sizes().equals({3, 4, 5}));
+  ASSERT_TRUE(out.equal(a + b));
+
+  // promoted inputs are converted again by every build
+  auto i = at::ones({3, 4, 5}, kInt);
+  ASSERT_TRUE((a + i).equal(a + 1));
+  ASSERT_TRUE((a + i).equal(a + 1));
+
+  at::reset_tensor_iterator_cache();
+  stats = at::tensor_iterator_cache_stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  at::set_tensor_iterator_cache_enabled(false);
+}
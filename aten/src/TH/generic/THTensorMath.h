@@ -54,8 +54,6 @@ TH_API accreal THTensor_(trace)(THTensor *t);
 
 TH_API void THTensor_(diag)(THTensor *r_, THTensor *t, int k);
 
-TH_API void THTensor_(sort)(THTensor *rt_, THLongTensor *ri_, THTensor *t, int dimension, int descendingOrder);
-
 #if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
 
 TH_API void THTensor_(renorm)(THTensor *r_, THTensor *t, scalar_t value, int dimension, scalar_t maxnorm);
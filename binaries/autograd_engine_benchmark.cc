@@ -0,0 +1,87 @@
+#include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/torch.h"
+
+#include "c10/util/Flags.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+C10_DEFINE_int(depth, 10000, "Number of nodes in the deep (chain) graph");
+C10_DEFINE_int(width, 1000, "Number of branches in the wide graph");
+C10_DEFINE_int(numel, 16, "Number of elements of every tensor in the graphs");
+C10_DEFINE_int(cpu_threads, 1, "Number of autograd CPU threads");
+C10_DEFINE_int(warmup_iter, 3, "Number of warmup iterations");
+C10_DEFINE_int(benchmark_iter, 10, "Number of times to run benchmark");
+
+using torch::autograd::Variable;
+
+namespace {
+
+// y = x * 1 * 1 * ..., every node only becomes ready once the previous one
+// has run.
+Variable deep_graph(const Variable& x) {
+  auto y = x;
+  for (int i = 0; i < FLAGS_depth; ++i) {
+    y = y * 1;
+  }
+  return y.sum();
+}
+
+// FLAGS_width independent branches joined at the end, so that most of the
+// queue traffic is between nodes that are ready at the same time.
+Variable wide_graph(const Variable& x) {
+  std::vector<Variable> branches;
+  branches.reserve(FLAGS_width);
+  for (int i = 0; i < FLAGS_width; ++i) {
+    branches.push_back((x * 2).sin().sum());
+  }
+  return torch::stack(branches).sum();
+}
+
+template <typename GraphFn>
+void run_benchmark(const std::string& name, GraphFn build_graph) {
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::microseconds us;
+
+  auto x = torch::randn({FLAGS_numel}, torch::requires_grad());
+  for (int i = 0; i < FLAGS_warmup_iter; ++i) {
+    build_graph(x).backward();
+  }
+
+  for (int i = 0; i < FLAGS_benchmark_iter; ++i) {
+    auto y = build_graph(x);
+    auto start_time = clock::now();
+    y.backward();
+    auto duration = static_cast<float>(
+        std::chrono::duration_cast<us>(clock::now() - start_time).count());
+    std::cout << name << " backward: " << (duration / 1000.0) << " ms."
+              << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+  at::init_num_threads();
+
+  if (FLAGS_cpu_threads > 1) {
+    torch::autograd::Engine::get_default_engine().set_num_cpu_threads(
+        FLAGS_cpu_threads);
+  }
+  std::cout << "Running backward with " << FLAGS_cpu_threads
+            << " autograd CPU thread(s)" << std::endl;
+
+  run_benchmark("Deep graph (" + std::to_string(FLAGS_depth) + " nodes)",
+                deep_graph);
+  run_benchmark("Wide graph (" + std::to_string(FLAGS_width) + " branches)",
+                wide_graph);
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "torch/torch.h"
+
+#include "c10/util/Flags.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+C10_DEFINE_int(num_params, 1000, "Number of parameters");
+C10_DEFINE_int(numel, 256, "Number of elements of every parameter");
+C10_DEFINE_int(warmup_iter, 10, "Number of warmup iterations");
+C10_DEFINE_int(benchmark_iter, 100, "Number of steps to time");
+
+namespace {
+
+// Times optimizer.step() on FLAGS_num_params parameters of FLAGS_numel
+// elements with fixed gradients, once with the per-parameter loop and once
+// with the multi-tensor kernel (foreach).
+template <typename OptimizerClass, typename Options>
+void run_benchmark(const std::string& name, Options options) {
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::microseconds us;
+
+  for (bool foreach : {false, true}) {
+    std::vector<torch::Tensor> params;
+    for (int i = 0; i < FLAGS_num_params; ++i) {
+      params.push_back(torch::randn({FLAGS_numel}));
+      params.back().grad() = torch::randn({FLAGS_numel});
+    }
+    OptimizerClass optimizer(params, options.foreach(foreach));
+    for (int i = 0; i < FLAGS_warmup_iter; ++i) {
+      optimizer.step();
+    }
+    auto start_time = clock::now();
+    for (int i = 0; i < FLAGS_benchmark_iter; ++i) {
+      optimizer.step();
+    }
+    auto duration = static_cast<float>(
+        std::chrono::duration_cast<us>(clock::now() - start_time).count());
+    std::cout << name << (foreach ? " foreach" : " loop") << ": "
+              << (duration / FLAGS_benchmark_iter / 1000.0) << " ms/step."
+              << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+  at::init_num_threads();
+  torch::NoGradGuard no_grad;
+
+  std::cout << FLAGS_num_params << " parameters of " << FLAGS_numel
+            << " elements, " << at::get_num_threads() << " thread(s)"
+            << std::endl;
+  run_benchmark<torch::optim::SGD>(
+      "SGD", torch::optim::SGDOptions(0.1).momentum(0.9));
+  run_benchmark<torch::optim::Adam>("Adam", torch::optim::AdamOptions(0.1));
+  run_benchmark<torch::optim::Adagrad>(
+      "Adagrad", torch::optim::AdagradOptions(0.1));
+  run_benchmark<torch::optim::RMSprop>(
+      "RMSprop", torch::optim::RMSpropOptions(0.1).momentum(0.9));
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include "ATen/Parallel.h"
+
+#include "c10/util/Flags.h"
+#include "caffe2/core/init.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+C10_DEFINE_int(iter, 1000, "Number of parallel_for calls");
+C10_DEFINE_int(range, 1 << 16, "Number of elements of each parallel_for");
+C10_DEFINE_int(work, 100, "Number of math operations per element");
+C10_DEFINE_int(warmup_iter, 10, "Number of warmup iterations");
+C10_DEFINE_int(intra_op_threads, 0, "Number of intra-op threads");
+C10_DEFINE_int(benchmark_iter, 3, "Number of times to run benchmark");
+
+// Runs compute-bound parallel_for loops and reports how many of the intra-op
+// threads took part, e.g. to check that all NUMA nodes' workers are used when
+// the pools are sharded (--caffe2_cpu_numa_enabled).
+
+namespace {
+std::unique_ptr<std::atomic<int64_t>[]> elements_per_thread;
+std::atomic<double> sink{0};
+
+void run_loops(int iter) {
+  for (int i = 0; i < iter; ++i) {
+    at::parallel_for(0, FLAGS_range, 1, [](int64_t begin, int64_t end) {
+      double acc = 0;
+      for (int64_t j = begin; j < end; ++j) {
+        double x = j;
+        for (int k = 0; k < FLAGS_work; ++k) {
+          x = std::sin(x) + 1.0;
+        }
+        acc += x;
+      }
+      elements_per_thread[at::get_thread_num()] += end - begin;
+      sink = acc;
+    });
+  }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+  caffe2::unsafeRunCaffe2InitFunction("registerThreadPools");
+  at::init_num_threads();
+
+  if (FLAGS_intra_op_threads > 0) {
+    at::set_num_threads(FLAGS_intra_op_threads);
+  }
+  // Starts the pools, so that the thread count below is final.
+  at::parallel_for(0, 2, 1, [](int64_t, int64_t) {});
+  const int num_threads = at::get_num_threads();
+  elements_per_thread.reset(new std::atomic<int64_t>[num_threads]);
+
+  std::cout << at::get_parallel_info();
+
+  typedef std::chrono::high_resolution_clock clock;
+  typedef std::chrono::milliseconds ms;
+
+  run_loops(FLAGS_warmup_iter);
+
+  for (auto bench_iter = 0; bench_iter < FLAGS_benchmark_iter; ++bench_iter) {
+    for (int t = 0; t < num_threads; ++t) {
+      elements_per_thread[t] = 0;
+    }
+    auto start_time = clock::now();
+    run_loops(FLAGS_iter);
+    auto duration = static_cast<float>(
+        std::chrono::duration_cast<ms>(clock::now() - start_time).count());
+
+    int threads_used = 0;
+    int64_t max_elements = 0;
+    for (int t = 0; t < num_threads; ++t) {
+      threads_used += elements_per_thread[t] > 0;
+      max_elements = std::max(max_elements, elements_per_thread[t].load());
+    }
+    int64_t total_elements = (int64_t)FLAGS_iter * FLAGS_range;
+    std::cout << "Time to run " << FLAGS_iter << " iterations "
+              << (duration / 1000.0) << " s, " << threads_used << " of "
+              << num_threads << " threads used, busiest thread ran "
+              << (100.0 * max_elements / total_elements) << "% of the elements"
+              << std::endl;
+  }
+
+  return 0;
+}
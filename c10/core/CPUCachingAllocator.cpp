@@ -0,0 +1,420 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/llvmMathExtras.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+C10_DEFINE_int64(
+    caffe2_cpu_caching_allocator_max_cached_bytes,
+    1LL << 30,
+    "Upper bound on the bytes kept in the shared pool of the CPU caching "
+    "allocator; blocks freed beyond it are returned to the system");
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+namespace {
+
+// Every block is preceded by a header of gAlignment bytes, so that the
+// pointer handed out keeps the alignment of alloc_cpu and the deleter can
+// recover the size class from the data pointer alone.
+constexpr size_t kHeaderSize = gAlignment;
+constexpr size_t kMinBlockSize = gAlignment;
+constexpr unsigned kMinBlockLog2 = 6;
+constexpr unsigned kMaxCachedLog2 = 26;
+constexpr unsigned kClassesPerDoubling = 4;
+constexpr size_t kNumSizeClasses =
+    1 + (kMaxCachedLog2 - kMinBlockLog2) * kClassesPerDoubling;
+constexpr int64_t kUncached = -1;
+
+static_assert(
+    kMinBlockSize == (size_t(1) << kMinBlockLog2),
+    "kMinBlockLog2 must match gAlignment");
+static_assert(
+    kMaxCachedSize == (size_t(1) << kMaxCachedLog2),
+    "kMaxCachedLog2 must match kMaxCachedSize");
+
+struct BlockHeader {
+  int64_t size_class; // index into the free lists, or kUncached
+  size_t size;        // rounded size of the usable part of the block
+  int64_t numa_node;  // shared pool the block returns to
+};
+
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "BlockHeader too large");
+
+inline BlockHeader* header_of(void* data) {
+  return reinterpret_cast<BlockHeader*>(
+      static_cast<char*>(data) - kHeaderSize);
+}
+
+inline void* data_of(void* base) {
+  return static_cast<char*>(base) + kHeaderSize;
+}
+
+// Counters that are written by a single owning thread and read by
+// getCacheStats(); a plain load/store avoids a locked read-modify-write on
+// the hot path.
+inline void bump(std::atomic<int64_t>& counter, int64_t amount) {
+  counter.store(
+      counter.load(std::memory_order_relaxed) + amount,
+      std::memory_order_relaxed);
+}
+
+struct ThreadCache;
+
+struct SharedFreeList {
+  std::mutex mutex;
+  std::vector<void*> blocks;
+};
+
+struct SharedPool {
+  std::array<SharedFreeList, kNumSizeClasses> lists;
+};
+
+struct CachingState {
+  // One pool per NUMA node when NUMA is enabled. alloc_cpu places fresh
+  // blocks on the allocating thread's node, so a block is only handed out
+  // again to threads running on that node (or through a thread cache).
+  std::unique_ptr<SharedPool[]> shared;
+  int64_t num_nodes;
+  std::atomic<size_t> max_cached_bytes;
+
+  // Shared pool and retired-thread totals; only touched on slow paths.
+  std::atomic<int64_t> shared_cached_bytes{0};
+  std::atomic<int64_t> allocated_bytes{0};
+  std::atomic<int64_t> hits{0};
+  std::atomic<int64_t> misses{0};
+  std::atomic<int64_t> evictions{0};
+
+  // Live thread caches, for statistics.
+  std::mutex registry_mutex;
+  std::unordered_set<ThreadCache*> caches;
+  // Values subtracted from the accumulated counters by getCacheStats(),
+  // updated by resetAccumulatedStats(). Guarded by registry_mutex.
+  CacheStats stats_offset;
+
+  CachingState()
+      : num_nodes(std::max(GetNumNUMANodes(), 1)),
+        max_cached_bytes(static_cast<size_t>(
+            FLAGS_caffe2_cpu_caching_allocator_max_cached_bytes)) {
+    shared.reset(new SharedPool[num_nodes]);
+  }
+
+  int64_t current_node() const {
+    if (num_nodes == 1) {
+      return 0;
+    }
+    int64_t node = GetCurrentNUMANode();
+    return node >= 0 && node < num_nodes ? node : 0;
+  }
+
+  // Puts a block into the shared pool, or releases it to the system if the
+  // pools are at their high-water mark.
+  void push_shared(int64_t size_class, void* base, size_t size) {
+    auto total = shared_cached_bytes.fetch_add(size) + size;
+    if (static_cast<size_t>(total) > max_cached_bytes.load()) {
+      shared_cached_bytes.fetch_sub(size);
+      evictions.fetch_add(1);
+      free_cpu(base);
+      return;
+    }
+    auto node = static_cast<BlockHeader*>(base)->numa_node;
+    auto& list = shared[node].lists[size_class];
+    std::lock_guard<std::mutex> guard(list.mutex);
+    list.blocks.push_back(base);
+  }
+
+  void* pop_shared(int64_t size_class, size_t size) {
+    auto& list = shared[current_node()].lists[size_class];
+    void* base = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(list.mutex);
+      if (list.blocks.empty()) {
+        return nullptr;
+      }
+      base = list.blocks.back();
+      list.blocks.pop_back();
+    }
+    shared_cached_bytes.fetch_sub(size);
+    hits.fetch_add(1);
+    return base;
+  }
+
+  void release_shared() {
+    for (int64_t node = 0; node < num_nodes; ++node) {
+      for (auto& list : shared[node].lists) {
+        std::vector<void*> blocks;
+        {
+          std::lock_guard<std::mutex> guard(list.mutex);
+          blocks.swap(list.blocks);
+        }
+        for (void* base : blocks) {
+          shared_cached_bytes.fetch_sub(
+              static_cast<BlockHeader*>(base)->size);
+          free_cpu(base);
+        }
+      }
+    }
+  }
+};
+
+// Never destroyed: thread caches may be drained after static destructors
+// have run.
+CachingState& state() {
+  static CachingState* state = new CachingState();
+  return *state;
+}
+
+struct ThreadCache {
+  std::array<std::vector<void*>, kNumSizeClasses> free_lists;
+  size_t total_bytes = 0;
+
+  std::atomic<int64_t> cached_bytes{0};
+  std::atomic<int64_t> allocated_bytes{0};
+  std::atomic<int64_t> hits{0};
+
+  ThreadCache();
+  ~ThreadCache();
+
+  // Moves every cached block to the shared pool (release == false) or back
+  // to the system (release == true).
+  void flush(bool release);
+};
+
+// Set once the calling thread's cache has been destroyed, so that frees
+// during thread teardown go to the shared pool instead.
+thread_local bool tls_cache_destroyed = false;
+
+ThreadCache* getThreadCache() {
+  if (tls_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+ThreadCache::ThreadCache() {
+  auto& s = state();
+  std::lock_guard<std::mutex> guard(s.registry_mutex);
+  s.caches.insert(this);
+}
+
+ThreadCache::~ThreadCache() {
+  flush(/*release=*/false);
+  tls_cache_destroyed = true;
+  auto& s = state();
+  std::lock_guard<std::mutex> guard(s.registry_mutex);
+  s.allocated_bytes.fetch_add(allocated_bytes.load());
+  s.hits.fetch_add(hits.load());
+  s.caches.erase(this);
+}
+
+void ThreadCache::flush(bool release) {
+  auto& s = state();
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    for (void* base : free_lists[i]) {
+      auto size = static_cast<BlockHeader*>(base)->size;
+      if (release) {
+        free_cpu(base);
+      } else {
+        s.push_shared(i, base, size);
+      }
+    }
+    free_lists[i].clear();
+  }
+  total_bytes = 0;
+  cached_bytes.store(0, std::memory_order_relaxed);
+}
+
+inline size_t classSize(size_t size_class) {
+  if (size_class == 0) {
+    return kMinBlockSize;
+  }
+  auto k = size_class - 1;
+  auto lg = kMinBlockLog2 + k / kClassesPerDoubling;
+  return (5 + k % kClassesPerDoubling) << (lg - 2);
+}
+
+void fill(void* data, size_t nbytes) {
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
+void Delete(void* data) {
+  if (!data) {
+    return;
+  }
+  auto* header = header_of(data);
+  void* base = header;
+  const auto size = header->size;
+  const auto size_class = header->size_class;
+  auto& s = state();
+  auto* cache = getThreadCache();
+  if (cache) {
+    bump(cache->allocated_bytes, -static_cast<int64_t>(size));
+  } else {
+    s.allocated_bytes.fetch_sub(size);
+  }
+
+  if (size_class == kUncached) {
+    free_cpu(base);
+    return;
+  }
+  if (cache && size <= kThreadCacheMaxBlockSize &&
+      cache->total_bytes + size <= kThreadCacheMaxBytes) {
+    cache->free_lists[size_class].push_back(base);
+    cache->total_bytes += size;
+    bump(cache->cached_bytes, size);
+    return;
+  }
+  s.push_shared(size_class, base, size);
+}
+
+struct CPUCachingAllocatorImpl final : public at::Allocator {
+  at::DataPtr allocate(size_t nbytes) const override {
+    if (nbytes == 0) {
+      return {nullptr, nullptr, &Delete, at::Device(at::DeviceType::CPU)};
+    }
+    auto& s = state();
+    auto* cache = getThreadCache();
+    const size_t size = roundSize(nbytes);
+
+    if (size > kMaxCachedSize) {
+      void* base = alloc_cpu(size + kHeaderSize);
+      *static_cast<BlockHeader*>(base) = {kUncached, size, 0};
+      s.misses.fetch_add(1);
+      account_allocated(cache, size);
+      void* data = data_of(base);
+      return {data, data, &Delete, at::Device(at::DeviceType::CPU)};
+    }
+
+    const auto size_class = sizeClassIndex(size);
+    void* base = nullptr;
+    if (cache && !cache->free_lists[size_class].empty()) {
+      base = cache->free_lists[size_class].back();
+      cache->free_lists[size_class].pop_back();
+      cache->total_bytes -= size;
+      bump(cache->cached_bytes, -static_cast<int64_t>(size));
+      bump(cache->hits, 1);
+    } else {
+      base = s.pop_shared(size_class, size);
+    }
+
+    if (base) {
+      fill(data_of(base), nbytes);
+    } else {
+      base = alloc_cpu(size + kHeaderSize);
+      *static_cast<BlockHeader*>(base) = {
+          static_cast<int64_t>(size_class), size, s.current_node()};
+      s.misses.fetch_add(1);
+    }
+    account_allocated(cache, size);
+    void* data = data_of(base);
+    return {data, data, &Delete, at::Device(at::DeviceType::CPU)};
+  }
+
+  at::DeleterFnPtr raw_deleter() const override {
+    return &Delete;
+  }
+
+ private:
+  static void account_allocated(ThreadCache* cache, size_t size) {
+    if (cache) {
+      bump(cache->allocated_bytes, size);
+    } else {
+      state().allocated_bytes.fetch_add(size);
+    }
+  }
+};
+
+CPUCachingAllocatorImpl g_caching_alloc;
+
+} // namespace
+
+Allocator* get() {
+  return &g_caching_alloc;
+}
+
+void emptyCache() {
+  if (auto* cache = getThreadCache()) {
+    cache->flush(/*release=*/true);
+  }
+  state().release_shared();
+}
+
+CacheStats getCacheStats() {
+  auto& s = state();
+  std::lock_guard<std::mutex> guard(s.registry_mutex);
+  CacheStats stats;
+  stats.cached_bytes = s.shared_cached_bytes.load();
+  stats.allocated_bytes = s.allocated_bytes.load();
+  stats.hits = s.hits.load();
+  stats.misses = s.misses.load();
+  stats.evictions = s.evictions.load();
+  for (auto* cache : s.caches) {
+    stats.cached_bytes += cache->cached_bytes.load(std::memory_order_relaxed);
+    stats.allocated_bytes +=
+        cache->allocated_bytes.load(std::memory_order_relaxed);
+    stats.hits += cache->hits.load(std::memory_order_relaxed);
+  }
+  stats.hits -= s.stats_offset.hits;
+  stats.misses -= s.stats_offset.misses;
+  stats.evictions -= s.stats_offset.evictions;
+  return stats;
+}
+
+void resetAccumulatedStats() {
+  auto stats = getCacheStats();
+  auto& s = state();
+  std::lock_guard<std::mutex> guard(s.registry_mutex);
+  s.stats_offset.hits += stats.hits;
+  s.stats_offset.misses += stats.misses;
+  s.stats_offset.evictions += stats.evictions;
+}
+
+void setMaxCachedBytes(size_t max_cached_bytes) {
+  state().max_cached_bytes.store(max_cached_bytes);
+}
+
+size_t getMaxCachedBytes() {
+  return state().max_cached_bytes.load();
+}
+
+size_t roundSize(size_t nbytes) {
+  if (nbytes <= kMinBlockSize) {
+    return kMinBlockSize;
+  }
+  if (nbytes > kMaxCachedSize) {
+    return nbytes;
+  }
+  // nbytes is in (2^lg, 2^(lg+1)]; split that range into
+  // kClassesPerDoubling equal steps.
+  auto lg = llvm::Log2_64(nbytes - 1);
+  size_t step = size_t(1) << (lg - 2);
+  return (nbytes + step - 1) & ~(step - 1);
+}
+
+size_t sizeClassIndex(size_t rounded_nbytes) {
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(rounded_nbytes <= kMaxCachedSize);
+  if (rounded_nbytes <= kMinBlockSize) {
+    return 0;
+  }
+  auto lg = llvm::Log2_64(rounded_nbytes - 1);
+  auto index = 1 + (lg - kMinBlockLog2) * kClassesPerDoubling +
+      (rounded_nbytes >> (lg - 2)) - 5;
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(classSize(index) == rounded_nbytes);
+  return index;
+}
+
+} // namespace CPUCachingAllocator
+} // namespace c10
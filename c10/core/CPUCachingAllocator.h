@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <c10/core/Allocator.h>
+#include <c10/util/Flags.h>
+
+C10_DECLARE_int64(caffe2_cpu_caching_allocator_max_cached_bytes);
+
+namespace c10 {
+
+// An opt-in caching allocator for CPU memory.
+//
+// - Requests are rounded up to a size class (four classes per power of two,
+//   so at most 25% of a block is wasted). Requests larger than
+//   kMaxCachedSize bypass the cache and go straight to alloc_cpu/free_cpu.
+// - Freed blocks are first kept in a per-thread free list for their size
+//   class, which is touched without any locking. Blocks that do not fit in
+//   the thread cache (it is bounded by kThreadCacheMaxBytes) go to a shared
+//   pool with one lock per size class; threads that miss in their own cache
+//   look there before falling back to alloc_cpu. With NUMA enabled there is
+//   one shared pool per node, and blocks only return to the pool of the
+//   node they were allocated on.
+// - The shared pool never holds more than the high-water mark set by
+//   setMaxCachedBytes() (initialized from
+//   --caffe2_cpu_caching_allocator_max_cached_bytes); blocks freed beyond it
+//   are returned to the system.
+// - A thread's cache is drained into the shared pool when the thread exits.
+//
+// The allocator is not installed by default. To route c10::GetCPUAllocator()
+// (and with it every ATen CPU tensor) through it, call
+//
+//   c10::SetCPUAllocator(c10::CPUCachingAllocator::get());
+//
+// before creating any tensors. Memory handed out by this allocator must be
+// released through its deleter; DataPtrs created before switching keep the
+// deleter of the allocator that created them, so switching is safe at any
+// point.
+namespace CPUCachingAllocator {
+
+// Largest request (in bytes) served from the cache.
+constexpr size_t kMaxCachedSize = 64 * 1024 * 1024;
+// Largest block size kept in a per-thread free list.
+constexpr size_t kThreadCacheMaxBlockSize = 1024 * 1024;
+// Upper bound on the bytes held by a single thread's free lists.
+constexpr size_t kThreadCacheMaxBytes = 4 * 1024 * 1024;
+
+// Struct containing summary statistics of the caching allocator. All values
+// are aggregated over every thread that has used the allocator.
+struct CacheStats {
+  // SUM: bytes currently sitting in free lists (thread caches + shared pool)
+  int64_t cached_bytes = 0;
+  // SUM: bytes currently handed out to callers (rounded to the size class)
+  int64_t allocated_bytes = 0;
+  // COUNT: allocations served from a free list
+  int64_t hits = 0;
+  // COUNT: allocations that had to call alloc_cpu (including uncached sizes)
+  int64_t misses = 0;
+  // COUNT: cached blocks released to the system because the shared pool
+  // was at its high-water mark
+  int64_t evictions = 0;
+};
+
+C10_API Allocator* get();
+
+// Returns every block in the shared pool and in the calling thread's cache
+// to the system. Blocks cached by other live threads are left untouched.
+C10_API void emptyCache();
+
+C10_API CacheStats getCacheStats();
+// Resets the hits/misses/evictions counters. Byte counts are not affected.
+C10_API void resetAccumulatedStats();
+
+C10_API void setMaxCachedBytes(size_t max_cached_bytes);
+C10_API size_t getMaxCachedBytes();
+
+// Size class helpers, exposed for testing.
+C10_API size_t roundSize(size_t nbytes);
+C10_API size_t sizeClassIndex(size_t rounded_nbytes);
+
+} // namespace CPUCachingAllocator
+} // namespace c10
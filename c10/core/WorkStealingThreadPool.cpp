@@ -0,0 +1,366 @@
+#include <c10/core/WorkStealingThreadPool.h>
+
+#include <c10/util/Logging.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace c10 {
+
+namespace {
+
+// Number of failed attempts to find work before an idle thread parks.
+constexpr size_t kSpinIterations = 1024;
+
+// Pool the current thread is a worker of, if any.
+thread_local const WorkStealingThreadPool* tls_pool = nullptr;
+
+} // namespace
+
+struct WorkStealingThreadPool::Job {
+  explicit Job(c10::function_ref<void(size_t, size_t)> fn, size_t num_tasks)
+      : fn(fn), remaining(num_tasks) {}
+
+  // Marks n tasks as completed and wakes up the submitting thread if they
+  // were the last ones. The notification happens under the lock, so the
+  // submitter cannot destroy the job before this returns.
+  void finish(size_t n) {
+    if (remaining.fetch_sub(n, std::memory_order_acq_rel) == n) {
+      std::lock_guard<std::mutex> guard(mutex);
+      done = true;
+      done_cv.notify_all();
+    }
+  }
+
+  c10::function_ref<void(size_t, size_t)> fn;
+  std::atomic<size_t> remaining;
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  bool done = false;
+};
+
+struct WorkStealingThreadPool::Range {
+  Job* job;
+  size_t begin;
+  size_t end;
+};
+
+// A bounded deque of ranges. The owning worker pushes and pops at the
+// bottom, thieves take from the top. Critical sections are a handful of
+// instructions, so a spin lock is used instead of a mutex.
+class WorkStealingThreadPool::RangeDeque {
+ public:
+  bool push(const Range& range) {
+    LockGuard guard(lock_);
+    if (bottom_ - top_ == kCapacity) {
+      return false;
+    }
+    ring_[bottom_ % kCapacity] = range;
+    ++bottom_;
+    size_.store(bottom_ - top_, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(Range& range) {
+    if (empty()) {
+      return false;
+    }
+    LockGuard guard(lock_);
+    if (bottom_ == top_) {
+      return false;
+    }
+    --bottom_;
+    range = ring_[bottom_ % kCapacity];
+    size_.store(bottom_ - top_, std::memory_order_release);
+    return true;
+  }
+
+  bool steal(const Job* job, Range& range) {
+    if (empty()) {
+      return false;
+    }
+    LockGuard guard(lock_);
+    if (bottom_ == top_) {
+      return false;
+    }
+    if (job && ring_[top_ % kCapacity].job != job) {
+      return false;
+    }
+    range = ring_[top_ % kCapacity];
+    ++top_;
+    size_.store(bottom_ - top_, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return size_.load(std::memory_order_acquire) == 0;
+  }
+
+ private:
+  // Ranges are halved on every split, so a single job never needs more
+  // than ~log2(num_tasks) entries; when full, ranges simply stop splitting.
+  static constexpr size_t kCapacity = 256;
+
+  struct LockGuard {
+    explicit LockGuard(std::atomic_flag& flag) : flag_(flag) {
+      while (flag_.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+    }
+    ~LockGuard() {
+      flag_.clear(std::memory_order_release);
+    }
+    std::atomic_flag& flag_;
+  };
+
+  std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+  std::atomic<size_t> size_{0};
+  size_t top_ = 0;
+  size_t bottom_ = 0;
+  std::array<Range, kCapacity> ring_;
+};
+
+constexpr size_t WorkStealingThreadPool::RangeDeque::kCapacity;
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int pool_size,
+    int numa_node_id,
+    std::function<void()> init_thread)
+    : numa_node_id_(numa_node_id) {
+  size_t num_threads = pool_size < 0 ? defaultNumThreads() : pool_size;
+  for (size_t i = 0; i < num_threads; ++i) {
+    deques_.emplace_back(new RangeDeque());
+  }
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i, init_thread]() {
+      NUMABind(numa_node_id_);
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = false;
+    ++epoch_;
+  }
+  condition_.notify_all();
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return num_sleeping_.load();
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return tls_pool == this;
+}
+
+void WorkStealingThreadPool::run(const std::function<void()>& func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push(func);
+    ++num_tasks_;
+    ++epoch_;
+  }
+  condition_.notify_one();
+}
+
+void WorkStealingThreadPool::parallelRun(
+    size_t num_tasks,
+    c10::function_ref<void(size_t, size_t)> fn) {
+  if (num_tasks == 0) {
+    return;
+  }
+  if (num_tasks == 1 || threads_.empty() || inThreadPool()) {
+    for (size_t task_id = 0; task_id < num_tasks; ++task_id) {
+      fn(task_id, 0);
+    }
+    return;
+  }
+
+  Job job(fn, num_tasks);
+  // One piece per worker and one for the calling thread.
+  const size_t num_pieces = std::min(num_tasks, threads_.size() + 1);
+  auto piece = [&](size_t p) {
+    return Range{
+        &job, p * num_tasks / num_pieces, (p + 1) * num_tasks / num_pieces};
+  };
+  for (size_t p = 1; p < num_pieces; ++p) {
+    if (!deques_[p - 1]->push(piece(p))) {
+      executeSequential(piece(p), 0);
+    }
+  }
+  notify(/*all=*/true);
+
+  executeSequential(piece(0), 0);
+
+  // Help with whatever is left of this job before blocking.
+  size_t spins = 0;
+  while (job.remaining.load(std::memory_order_acquire) > 0 &&
+         spins < kSpinIterations) {
+    Range range;
+    if (steal(0, deques_.size(), &job, range)) {
+      executeSequential(range, 0);
+      spins = 0;
+    } else {
+      ++spins;
+      std::this_thread::yield();
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(job.mutex);
+  job.done_cv.wait(lock, [&job]() { return job.done; });
+}
+
+void WorkStealingThreadPool::main_loop(size_t index) {
+  tls_pool = this;
+  auto& own = *deques_[index];
+  size_t spins = 0;
+  while (true) {
+    Range range;
+    if (own.pop(range) ||
+        steal(index + 1, deques_.size() - 1, nullptr, range)) {
+      executeRange(range, own, index + 1);
+      spins = 0;
+      continue;
+    }
+    if (runExternalTask()) {
+      spins = 0;
+      continue;
+    }
+    if (++spins < kSpinIterations) {
+      std::this_thread::yield();
+      continue;
+    }
+    spins = 0;
+
+    // Park. Anything pushed after the epoch is read bumps the epoch, and
+    // anything pushed before is seen by hasWork().
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_) {
+      break;
+    }
+    auto epoch = epoch_;
+    lock.unlock();
+    if (hasWork()) {
+      continue;
+    }
+    lock.lock();
+    ++num_sleeping_;
+    condition_.wait(
+        lock, [this, epoch]() { return epoch_ != epoch || !running_; });
+    --num_sleeping_;
+    if (!running_) {
+      break;
+    }
+  }
+}
+
+void WorkStealingThreadPool::executeRange(
+    Range range,
+    RangeDeque& deque,
+    size_t thread_id) {
+  while (range.end - range.begin > 1) {
+    size_t mid = range.begin + (range.end - range.begin) / 2;
+    if (!deque.push(Range{range.job, mid, range.end})) {
+      break;
+    }
+    range.end = mid;
+    if (num_sleeping_.load(std::memory_order_relaxed) > 0) {
+      notify(/*all=*/false);
+    }
+  }
+  executeSequential(range, thread_id);
+}
+
+void WorkStealingThreadPool::executeSequential(
+    const Range& range,
+    size_t thread_id) {
+  for (size_t task_id = range.begin; task_id < range.end; ++task_id) {
+    range.job->fn(task_id, thread_id);
+  }
+  range.job->finish(range.end - range.begin);
+}
+
+bool WorkStealingThreadPool::steal(
+    size_t first_victim,
+    size_t num_victims,
+    const Job* job,
+    Range& range) {
+  for (size_t i = 0; i < num_victims; ++i) {
+    if (deques_[(first_victim + i) % deques_.size()]->steal(job, range)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool WorkStealingThreadPool::runExternalTask() {
+  if (num_tasks_.load() == 0) {
+    return false;
+  }
+  std::function<void()> task;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (tasks_.empty()) {
+      return false;
+    }
+    task = std::move(tasks_.front());
+    tasks_.pop();
+    --num_tasks_;
+  }
+  try {
+    task();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in thread pool task: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Exception in thread pool task: unknown";
+  }
+  return true;
+}
+
+bool WorkStealingThreadPool::hasWork() const {
+  if (num_tasks_.load() > 0) {
+    return true;
+  }
+  for (const auto& deque : deques_) {
+    if (!deque->empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::notify(bool all) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++epoch_;
+  }
+  if (all) {
+    condition_.notify_all();
+  } else {
+    condition_.notify_one();
+  }
+}
+
+} // namespace c10
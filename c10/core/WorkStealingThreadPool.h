@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <c10/core/thread_pool.h>
+#include <c10/util/FunctionRef.h>
+
+namespace c10 {
+
+// A thread pool for data-parallel loops.
+//
+// parallelRun(num_tasks, fn) calls fn(task_id, thread_id) for every task_id in
+// [0, num_tasks) on the pool's workers and on the calling thread:
+//
+// - The task range is split into one contiguous piece per worker, plus one
+//   for the caller. Pieces are pushed onto per-worker deques, which are
+//   fixed-size rings, so no memory is allocated per task or per call.
+// - A worker pops ranges from the bottom of its own deque and keeps
+//   splitting them in half, pushing the upper half back, until a single
+//   task is left to run. Idle workers (and the caller, once its own piece
+//   is done) steal from the top of other workers' deques, which holds the
+//   largest remaining ranges. Uneven loops are thereby rebalanced without
+//   any shared queue. The caller only steals ranges of its own call, so
+//   thread ids stay unique within a call.
+// - Idle workers spin for a short while before parking on a condition
+//   variable, so back-to-back loops do not pay for a wake-up.
+//
+// Tasks submitted with run() go through a regular locked queue and are
+// picked up by workers that have no loop work.
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  // The number of workers currently parked waiting for work.
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(const std::function<void()>& func) override;
+
+  // Runs fn(task_id, thread_id) for all task_id in [0, num_tasks) and returns
+  // once every call has completed. thread_id is in [0, size()] and is unique
+  // among the threads working on this call at any time: 0 is the calling
+  // thread and i + 1 is worker i. fn must not throw. When called from one of
+  // this pool's workers, the tasks run sequentially on that worker with
+  // thread_id 0.
+  void parallelRun(
+      size_t num_tasks,
+      c10::function_ref<void(size_t, size_t)> fn);
+
+ private:
+  struct Job;
+  struct Range;
+  class RangeDeque;
+
+  void main_loop(size_t index);
+
+  // Runs a range taken by a worker, splitting it onto the worker's deque.
+  void executeRange(Range range, RangeDeque& deque, size_t thread_id);
+  // Runs every task of a range on the current thread.
+  static void executeSequential(const Range& range, size_t thread_id);
+  // Steals from the deques of workers [first_victim, first_victim +
+  // num_victims), modulo the number of workers. If job is not null, only
+  // ranges of that job are taken.
+  bool steal(
+      size_t first_victim,
+      size_t num_victims,
+      const Job* job,
+      Range& range);
+  bool runExternalTask();
+  bool hasWork() const;
+  void notify(bool all);
+
+  std::vector<std::unique_ptr<RangeDeque>> deques_;
+  std::vector<std::thread> threads_;
+
+  // Guards external tasks, parking and shutdown.
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::queue<std::function<void()>> tasks_;
+  std::atomic<size_t> num_tasks_{0};
+  uint64_t epoch_ = 0;
+  std::atomic<size_t> num_sleeping_{0};
+  bool running_ = true;
+  int numa_node_id_;
+};
+
+} // namespace c10
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <thread>
+#include <vector>
+
+using namespace c10;
+
+TEST(CPUCachingAllocatorTest, SizeClasses) {
+  EXPECT_EQ(CPUCachingAllocator::roundSize(1), gAlignment);
+  EXPECT_EQ(CPUCachingAllocator::roundSize(64), 64);
+  EXPECT_EQ(CPUCachingAllocator::roundSize(65), 80);
+  EXPECT_EQ(CPUCachingAllocator::roundSize(128), 128);
+  EXPECT_EQ(CPUCachingAllocator::roundSize(129), 160);
+  EXPECT_EQ(CPUCachingAllocator::roundSize(1000), 1024);
+  size_t last_index = 0;
+  for (size_t n = 1; n <= (1 << 20); n = n * 3 / 2 + 1) {
+    auto rounded = CPUCachingAllocator::roundSize(n);
+    EXPECT_GE(rounded, n);
+    // At most a quarter of a block is padding.
+    EXPECT_LE(rounded - n, rounded / 4 + gAlignment);
+    auto index = CPUCachingAllocator::sizeClassIndex(rounded);
+    EXPECT_GE(index, last_index);
+    last_index = index;
+  }
+  EXPECT_EQ(
+      CPUCachingAllocator::sizeClassIndex(CPUCachingAllocator::kMaxCachedSize),
+      80);
+}
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocks) {
+  auto* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  CPUCachingAllocator::resetAccumulatedStats();
+
+  void* first = nullptr;
+  {
+    auto ptr = allocator->allocate(1000);
+    first = ptr.get();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % gAlignment, 0);
+    auto stats = CPUCachingAllocator::getCacheStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 0);
+  }
+  EXPECT_EQ(CPUCachingAllocator::getCacheStats().cached_bytes, 1024);
+  {
+    // Any request in the same size class is served from the cache.
+    auto ptr = allocator->allocate(1020);
+    EXPECT_EQ(ptr.get(), first);
+    auto stats = CPUCachingAllocator::getCacheStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.cached_bytes, 0);
+  }
+
+  CPUCachingAllocator::emptyCache();
+  EXPECT_EQ(CPUCachingAllocator::getCacheStats().cached_bytes, 0);
+}
+
+TEST(CPUCachingAllocatorTest, RawAllocate) {
+  auto* allocator = CPUCachingAllocator::get();
+  void* ptr = allocator->raw_allocate(4096);
+  ASSERT_NE(ptr, nullptr);
+  memset(ptr, 0, 4096);
+  allocator->raw_deallocate(ptr);
+  EXPECT_EQ(allocator->allocate(0).get(), nullptr);
+}
+
+TEST(CPUCachingAllocatorTest, UncachedSizes) {
+  auto* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  auto before = CPUCachingAllocator::getCacheStats();
+  {
+    auto ptr = allocator->allocate(CPUCachingAllocator::kMaxCachedSize + 1);
+    ASSERT_NE(ptr.get(), nullptr);
+  }
+  auto after = CPUCachingAllocator::getCacheStats();
+  EXPECT_EQ(after.misses, before.misses + 1);
+  EXPECT_EQ(after.cached_bytes, 0);
+  EXPECT_EQ(after.allocated_bytes, before.allocated_bytes);
+}
+
+TEST(CPUCachingAllocatorTest, HighWaterMark) {
+  auto* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  auto old_max = CPUCachingAllocator::getMaxCachedBytes();
+  // Larger than kThreadCacheMaxBlockSize, so these go to the shared pool.
+  constexpr size_t kBlock = 2 * 1024 * 1024;
+  CPUCachingAllocator::setMaxCachedBytes(3 * kBlock);
+  auto before = CPUCachingAllocator::getCacheStats();
+  {
+    std::vector<DataPtr> ptrs;
+    for (int i = 0; i < 5; ++i) {
+      ptrs.push_back(allocator->allocate(kBlock));
+    }
+  }
+  auto after = CPUCachingAllocator::getCacheStats();
+  EXPECT_EQ(after.cached_bytes, 3 * kBlock);
+  EXPECT_EQ(after.evictions, before.evictions + 2);
+  CPUCachingAllocator::setMaxCachedBytes(old_max);
+  CPUCachingAllocator::emptyCache();
+}
+
+TEST(CPUCachingAllocatorTest, ThreadExitDrainsCache) {
+  auto* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  auto before = CPUCachingAllocator::getCacheStats();
+  std::thread producer([&]() {
+    std::vector<DataPtr> ptrs;
+    for (int i = 0; i < 100; ++i) {
+      ptrs.push_back(allocator->allocate(256));
+    }
+  });
+  producer.join();
+  auto drained = CPUCachingAllocator::getCacheStats();
+  EXPECT_EQ(drained.misses, before.misses + 100);
+  EXPECT_EQ(drained.cached_bytes, 100 * 256);
+
+  // The exited thread's blocks are now in the shared pool.
+  std::thread consumer([&]() {
+    std::vector<DataPtr> ptrs;
+    for (int i = 0; i < 100; ++i) {
+      ptrs.push_back(allocator->allocate(256));
+    }
+  });
+  consumer.join();
+  auto after = CPUCachingAllocator::getCacheStats();
+  EXPECT_EQ(after.misses, drained.misses);
+  EXPECT_EQ(after.hits, drained.hits + 100);
+  EXPECT_EQ(after.allocated_bytes, before.allocated_bytes);
+  CPUCachingAllocator::emptyCache();
+}
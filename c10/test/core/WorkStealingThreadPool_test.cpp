@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/WorkStealingThreadPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+using namespace c10;
+
+TEST(WorkStealingThreadPoolTest, RunsEveryTaskOnce) {
+  WorkStealingThreadPool pool(3);
+  for (size_t num_tasks : {0, 1, 2, 3, 4, 7, 64, 1000}) {
+    std::vector<std::atomic<int>> counts(num_tasks);
+    for (auto& count : counts) {
+      count = 0;
+    }
+    pool.parallelRun(num_tasks, [&](size_t task_id, size_t) { ++counts[task_id]; });
+    for (size_t i = 0; i < num_tasks; ++i) {
+      ASSERT_EQ(counts[i].load(), 1) << "task " << i << " of " << num_tasks;
+    }
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, UnevenWork) {
+  WorkStealingThreadPool pool(3);
+  std::atomic<size_t> sum{0};
+  // Only the first few tasks are expensive; the rest must be picked up by
+  // other threads while they run.
+  pool.parallelRun(256, [&](size_t task_id, size_t) {
+    if (task_id < 4) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    sum += task_id;
+  });
+  ASSERT_EQ(sum.load(), 255 * 256 / 2);
+}
+
+TEST(WorkStealingThreadPoolTest, ThreadIdsAreExclusive) {
+  WorkStealingThreadPool pool(3);
+  std::vector<std::atomic<int>> in_use(pool.size() + 1);
+  for (auto& flag : in_use) {
+    flag = 0;
+  }
+  std::atomic<bool> overlap{false};
+  pool.parallelRun(512, [&](size_t, size_t thread_id) {
+    ASSERT_LE(thread_id, pool.size());
+    if (in_use[thread_id].fetch_add(1) != 0) {
+      overlap = true;
+    }
+    std::this_thread::yield();
+    in_use[thread_id].fetch_sub(1);
+  });
+  ASSERT_FALSE(overlap.load());
+}
+
+TEST(WorkStealingThreadPoolTest, ConcurrentCallers) {
+  WorkStealingThreadPool pool(2);
+  std::vector<std::thread> callers;
+  std::atomic<size_t> total{0};
+  for (int i = 0; i < 4; ++i) {
+    callers.emplace_back([&]() {
+      for (int iter = 0; iter < 100; ++iter) {
+        pool.parallelRun(17, [&](size_t, size_t) { ++total; });
+      }
+    });
+  }
+  for (auto& t : callers) {
+    t.join();
+  }
+  ASSERT_EQ(total.load(), 4 * 100 * 17);
+}
+
+TEST(WorkStealingThreadPoolTest, NestedRunIsSequential) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> inner{0};
+  pool.parallelRun(8, [&](size_t, size_t) {
+    pool.parallelRun(4, [&](size_t, size_t) { ++inner; });
+  });
+  ASSERT_EQ(inner.load(), 32);
+}
+
+TEST(WorkStealingThreadPoolTest, ExternalTasks) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> done{0};
+  for (int i = 0; i < 10; ++i) {
+    pool.run([&]() {
+      ASSERT_TRUE(pool.inThreadPool());
+      ++done;
+    });
+  }
+  while (done.load() < 10) {
+    std::this_thread::yield();
+  }
+  ASSERT_FALSE(pool.inThreadPool());
+}
+
+TEST(WorkStealingThreadPoolTest, NoWorkers) {
+  WorkStealingThreadPool pool(0);
+  int sum = 0;
+  pool.parallelRun(10, [&](size_t task_id, size_t) { sum += task_id; });
+  ASSERT_EQ(sum, 45);
+}
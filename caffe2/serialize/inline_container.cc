@@ -217,6 +217,18 @@ std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data for ", name.c_str());
+  // Records stored uncompressed at an aligned offset can be handed out
+  // without a copy if the reader adapter owns the memory (see
+  // MmapFileAdapter). The crc check done by miniz is skipped in that case.
+  if (stat.m_method == 0 && stat.m_comp_size == stat.m_uncomp_size) {
+    size_t offset = getRecordOffset(name);
+    if (offset % kFieldAlignment == 0) {
+      at::DataPtr aliased = in_->aliasingDataPtr(offset, stat.m_uncomp_size);
+      if (aliased) {
+        return std::make_tuple(std::move(aliased), stat.m_uncomp_size);
+      }
+    }
+  }
   void * ptr = malloc(stat.m_uncomp_size);
   mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, 0);
   valid("reading file ", name.c_str());
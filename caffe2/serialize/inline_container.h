@@ -52,6 +52,8 @@ typedef struct mz_zip_archive mz_zip_archive;
 // 2. It provides a getRecordOffset function which returns the offset into the
 //    raw file where file data lives. If the file was written with
 //    PyTorchStreamWriter it is guaranteed to be 64 byte aligned.
+// 3. If the ReadAdapterInterface can hand out its memory (MmapFileAdapter),
+//    getRecord returns uncompressed, aligned records without copying them.
 
 // PyTorchReader/Writer handle checking the version number on the archive format
 // and ensure that all files are written to a archive_name directory so they
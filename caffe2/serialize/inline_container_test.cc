@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -63,6 +64,59 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+#ifndef _WIN32
+TEST(PyTorchStreamWriterAndReader, MmapAliasesRecords) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  writer.writeRecord("key1", data1.data(), data1.size());
+  std::array<char, 100> data2;
+  for (int i = 0; i < data2.size(); ++i) {
+    data2[i] = i;
+  }
+  writer.writeRecord("key2", data2.data(), data2.size(), /*compress=*/true);
+  writer.writeEndOfFile();
+
+  std::string the_file = oss.str();
+  const char* file_name = "output_mmap.zip";
+  std::ofstream foo(file_name);
+  foo.write(the_file.c_str(), the_file.size());
+  foo.close();
+
+  at::DataPtr data_ptr;
+  {
+    auto adapter = std::make_unique<MmapFileAdapter>(file_name);
+    auto base = static_cast<const char*>(adapter->data());
+    ASSERT_EQ(adapter->size(), the_file.size());
+    PyTorchStreamReader reader(std::move(adapter));
+
+    // Stored records alias the mapping.
+    int64_t size;
+    std::tie(data_ptr, size) = reader.getRecord("key1");
+    ASSERT_EQ(size, data1.size());
+    ASSERT_EQ(
+        static_cast<const char*>(data_ptr.get()),
+        base + reader.getRecordOffset("key1"));
+    ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+
+    // Compressed records are still extracted into their own buffer.
+    at::DataPtr compressed_ptr;
+    std::tie(compressed_ptr, size) = reader.getRecord("key2");
+    ASSERT_EQ(size, data2.size());
+    ASSERT_EQ(memcmp(compressed_ptr.get(), data2.data(), data2.size()), 0);
+  }
+  // The record keeps the mapping alive after the reader is gone.
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  std::remove(file_name);
+}
+#endif
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
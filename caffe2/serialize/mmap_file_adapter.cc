@@ -0,0 +1,98 @@
+#include "caffe2/serialize/mmap_file_adapter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <c10/util/Exception.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace caffe2 {
+namespace serialize {
+
+// Owns the mapped region. It is shared by the adapter and by every DataPtr
+// handed out, and unmapped when the last of them goes away.
+struct MmapFileAdapter::Mapping {
+  Mapping(void* data, size_t size) : data(data), size(size) {}
+  ~Mapping() {
+#ifndef _WIN32
+    if (data != nullptr) {
+      munmap(data, size);
+    }
+#endif
+  }
+  void* data;
+  size_t size;
+};
+
+MmapFileAdapter::MmapFileAdapter(const std::string& file_name) {
+#ifdef _WIN32
+  AT_ERROR(
+      "memory-mapped loading is not supported on this platform, file path: ",
+      file_name);
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    AT_ERROR("stat file failed, file path: ", file_name);
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* data = nullptr;
+  if (size > 0) {
+    // A writable private mapping would be charged against the commit limit
+    // for its full size under strict overcommit, so map it read-only.
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    AT_ERROR("mmap failed, file path: ", file_name);
+  }
+  mapping_ = std::make_shared<Mapping>(data, size);
+#endif
+}
+
+size_t MmapFileAdapter::size() const {
+  return mapping_->size;
+}
+
+size_t MmapFileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  if (pos >= mapping_->size) {
+    return 0;
+  }
+  n = std::min<size_t>(n, mapping_->size - pos);
+  std::memcpy(buf, static_cast<const char*>(mapping_->data) + pos, n);
+  return n;
+}
+
+at::DataPtr MmapFileAdapter::aliasingDataPtr(uint64_t pos, size_t n) const {
+  if (pos > mapping_->size || n > mapping_->size - pos) {
+    return at::DataPtr();
+  }
+  void* ptr = static_cast<char*>(mapping_->data) + pos;
+  auto owner = new std::shared_ptr<Mapping>(mapping_);
+  return at::DataPtr(
+      ptr,
+      owner,
+      [](void* ctx) { delete static_cast<std::shared_ptr<Mapping>*>(ctx); },
+      at::kCPU);
+}
+
+const void* MmapFileAdapter::data() const {
+  return mapping_->data;
+}
+
+MmapFileAdapter::~MmapFileAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// this is a reader that maps the whole file into memory. Records that are
+// stored uncompressed and aligned (everything PyTorchStreamWriter writes) are
+// returned as DataPtrs aliasing the mapping instead of being copied, so
+// loading does not touch the tensor data until it is used, and processes
+// loading the same file share its pages. The mapping is read-only: tensors
+// that alias it must be cloned before they are modified in place.
+// The file must not be truncated while any tensor loaded from it is alive.
+// Only available on POSIX systems.
+class CAFFE2_API MmapFileAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MmapFileAdapter);
+  explicit MmapFileAdapter(const std::string& file_name);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  at::DataPtr aliasingDataPtr(uint64_t pos, size_t n) const override;
+  ~MmapFileAdapter();
+
+  const void* data() const;
+
+ private:
+  struct Mapping;
+  std::shared_ptr<Mapping> mapping_;
+};
+
+} // namespace serialize
+} // namespace caffe2
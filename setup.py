@@ -156,6 +156,7 @@
 #       OMP - use OpenMP for intra-op and native backend for inter-op tasks
 #       NATIVE - use native thread pool for both intra- and inter-op tasks
 #       TBB - using TBB for intra- and native thread pool for inter-op parallelism
+#       NATIVE_WS - native backend with a work-stealing pool for intra-op loops
 #
 #   USE_TBB
 #      enable TBB support
@@ -842,6 +843,7 @@ if __name__ == '__main__':
                 'include/torch/csrc/jit/passes/*.h',
                 'include/torch/csrc/jit/passes/utils/*.h',
                 'include/torch/csrc/jit/runtime/*.h',
+                'include/torch/csrc/jit/runtime/static/*.h',
                 'include/torch/csrc/jit/ir/*.h',
                 'include/torch/csrc/jit/frontend/*.h',
                 'include/torch/csrc/jit/api/*.h',
@@ -2,8 +2,12 @@
 
 #include <torch/torch.h>
 
+#include <torch/csrc/autograd/engine.h>
+
 #include <test/cpp/api/support.h>
 
+#include <thread>
+
 using namespace torch::autograd;
 
 #define ASSERT_VARIABLE_EQ(a,b) ASSERT_TRUE(torch::allclose((a),(b)))
@@ -152,6 +156,110 @@ TEST(AutogradAPITests, RetainGrad) {
   ASSERT_VARIABLE_EQ(input * 18, input.grad());
 }
 
+TEST(AutogradAPITests, DeepGraph) {
+  auto x = torch::ones({2, 2}, torch::requires_grad());
+  auto y = x;
+  for (int i = 0; i < 10000; ++i) {
+    y = y * 1;
+  }
+  y.sum().backward();
+  ASSERT_VARIABLE_EQ(x.grad(), torch::ones({2, 2}));
+}
+
+TEST(AutogradAPITests, WideGraph) {
+  auto x = torch::ones({2, 2}, torch::requires_grad());
+  std::vector<Variable> branches;
+  for (int i = 0; i < 1000; ++i) {
+    branches.push_back((x * 2).sum());
+  }
+  torch::stack(branches).sum().backward();
+  ASSERT_VARIABLE_EQ(x.grad(), torch::full({2, 2}, 2000));
+}
+
+// A separate engine with CPU helper threads, so that the helpers (which cannot
+// be stopped) do not change how the other tests run. Leaked like the default
+// engine.
+Engine* multi_threaded_engine() {
+  struct MultiThreadedEngine : public Engine {};
+  static auto* engine = [] {
+    auto* engine = new MultiThreadedEngine();
+    engine->set_num_cpu_threads(4);
+    return engine;
+  }();
+  return engine;
+}
+
+TEST(AutogradAPITests, MultipleCPUThreads) {
+  auto* engine = multi_threaded_engine();
+  ASSERT_THROWS_WITH(engine->set_num_cpu_threads(2), "Cannot decrease");
+
+  // Concurrent backwards accumulating into the same leaf exercise the
+  // serialization of AccumulateGrad across CPU threads.
+  auto x = torch::randn({4, 4}, torch::requires_grad());
+  auto run_backward = [&] {
+    std::vector<Variable> branches;
+    for (int i = 1; i <= 16; ++i) {
+      branches.push_back((x * i).sin().sum());
+    }
+    auto y = torch::stack(branches).sum();
+    engine->execute(
+        {impl::gradient_edge(y)},
+        {torch::ones_like(y)},
+        /*keep_graph=*/false,
+        /*create_graph=*/false);
+  };
+  const int num_threads = 4;
+  const int num_iters = 10;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_iters; ++i) {
+        run_backward();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  torch::NoGradGuard no_grad;
+  auto expected = torch::zeros_like(x);
+  for (int i = 1; i <= 16; ++i) {
+    expected += (x * i).cos() * i;
+  }
+  ASSERT_VARIABLE_EQ(x.grad(), expected * (num_threads * num_iters));
+}
+
+TEST(AutogradAPITests, MultipleCPUThreadsReentrantHook) {
+  auto* engine = multi_threaded_engine();
+
+  // The hook runs a reentrant backward that accumulates into the same leaf,
+  // so AccumulateGrad must not hold its lock while calling hooks.
+  auto x = torch::ones({4, 4}, torch::requires_grad());
+  bool reentered = false;
+  x.register_hook([&](Variable grad) {
+    if (!reentered) {
+      reentered = true;
+      torch::AutoGradMode enable_grad(true);
+      auto y = (x * 3).sum();
+      engine->execute(
+          {impl::gradient_edge(y)},
+          {torch::ones_like(y)},
+          /*keep_graph=*/false,
+          /*create_graph=*/false);
+    }
+    return grad;
+  });
+  auto y = (x * 2).sum();
+  engine->execute(
+      {impl::gradient_edge(y)},
+      {torch::ones_like(y)},
+      /*keep_graph=*/false,
+      /*create_graph=*/false);
+  ASSERT_TRUE(reentered);
+  ASSERT_VARIABLE_EQ(x.grad(), torch::full({4, 4}, 5));
+}
+
 TEST(CustomAutogradTest, CustomFunction) {
   struct MyFunction : public Function<MyFunction> {
     static Variable forward(AutogradContext *ctx, Variable var1, int mul, Variable var2) {
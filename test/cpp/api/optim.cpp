@@ -270,6 +270,11 @@ TEST(OptimTest, XORConvergence_AdamWithAmsgrad) {
       AdamOptions(0.1).weight_decay(1e-6).amsgrad(true)));
 }
 
+TEST(OptimTest, XORConvergence_RowWiseAdagrad) {
+  ASSERT_TRUE(test_optimizer_xor<RowWiseAdagrad>(
+      RowWiseAdagradOptions(1.0).weight_decay(1e-6).lr_decay(1e-3)));
+}
+
 TEST(OptimTest, ProducesPyTorchValues_Adam) {
   check_exact_values<Adam>(AdamOptions(1.0), expected_parameters::Adam());
 }
@@ -363,6 +368,121 @@ TEST(OptimTest, ProducesPyTorchValues_LBFGS_with_line_search) {
       expected_parameters::LBFGS_with_line_search());
 }
 
+// A sparse gradient only has values for some rows. Applying it must update
+// those rows as the equivalent dense gradient would, and leave the other rows
+// and their state untouched.
+template <typename OptimizerClass, typename Options>
+void check_sparse_matches_dense(Options options) {
+  torch::manual_seed(0);
+  auto dense_weight = torch::randn({10, 4});
+  auto sparse_weight = dense_weight.clone();
+  OptimizerClass dense_optimizer(std::vector<torch::Tensor>{dense_weight}, options);
+  OptimizerClass sparse_optimizer(std::vector<torch::Tensor>{sparse_weight}, options);
+  for (int64_t i = 0; i < 3; i++) {
+    // Row 3 appears twice, so that the gradient needs coalescing.
+    auto indices = torch::tensor({{1, 3, 7, 3}}, torch::kLong);
+    auto values = torch::randn({4, 4});
+    auto grad = torch::sparse_coo_tensor(indices, values, {10, 4});
+    sparse_weight.grad() = grad;
+    dense_weight.grad() = grad.to_dense();
+    dense_optimizer.step();
+    sparse_optimizer.step();
+    ASSERT_TRUE(sparse_weight.allclose(dense_weight));
+  }
+}
+
+TEST(OptimTest, SparseMatchesDense_Adagrad) {
+  check_sparse_matches_dense<Adagrad>(AdagradOptions(0.1).lr_decay(1e-2));
+}
+
+TEST(OptimTest, SparseMatchesDense_RowWiseAdagrad) {
+  check_sparse_matches_dense<RowWiseAdagrad>(
+      RowWiseAdagradOptions(0.1).lr_decay(1e-2).initial_accumulator_value(0.1));
+}
+
+TEST(OptimTest, RowWiseAdagradUpdate) {
+  auto weight = torch::zeros({2, 3});
+  weight.grad() = torch::tensor({{1., 2., 2.}, {0., 0., 0.}});
+  RowWiseAdagrad optimizer(std::vector<torch::Tensor>{weight}, RowWiseAdagradOptions(1.0));
+  optimizer.step();
+  // The accumulator of the first row is (1 + 4 + 4) / 3 = 3.
+  ASSERT_TRUE(weight[0].allclose(torch::tensor({1., 2., 2.}) / -std::sqrt(3.)));
+  ASSERT_TRUE(weight[1].equal(torch::zeros({3})));
+}
+
+// The multi-tensor kernels must produce the values of the per-parameter
+// loop, for tensors that are smaller than a vector, not a multiple of it, and
+// split between several chunks.
+template <typename OptimizerClass, typename Options>
+void check_foreach_matches_loop(Options options) {
+  torch::manual_seed(0);
+  std::vector<torch::Tensor> loop_params = {
+      torch::randn({3}), torch::randn({17, 5}), torch::randn({10000}),
+      torch::randn({4, 4}, torch::kFloat64)};
+  std::vector<torch::Tensor> foreach_params;
+  for (const auto& p : loop_params) {
+    foreach_params.push_back(p.clone());
+  }
+  OptimizerClass loop_optimizer(loop_params, options);
+  OptimizerClass foreach_optimizer(foreach_params, options.foreach(true));
+  for (int64_t i = 0; i < 5; i++) {
+    for (size_t p = 0; p < loop_params.size(); p++) {
+      auto grad = torch::randn_like(loop_params[p]);
+      loop_params[p].grad() = grad;
+      foreach_params[p].grad() = grad.clone();
+    }
+    loop_optimizer.step();
+    foreach_optimizer.step();
+    for (size_t p = 0; p < loop_params.size(); p++) {
+      ASSERT_TRUE(foreach_params[p].allclose(loop_params[p], 1e-4, 1e-6));
+    }
+  }
+}
+
+TEST(OptimTest, ForeachMatchesLoop_SGD) {
+  check_foreach_matches_loop<SGD>(SGDOptions(0.1));
+  check_foreach_matches_loop<SGD>(
+      SGDOptions(0.1).momentum(0.9).dampening(0.1).weight_decay(1e-2));
+  check_foreach_matches_loop<SGD>(
+      SGDOptions(0.1).momentum(0.9).nesterov(true));
+}
+
+TEST(OptimTest, ForeachMatchesLoop_Adam) {
+  check_foreach_matches_loop<Adam>(AdamOptions(0.1));
+  check_foreach_matches_loop<Adam>(
+      AdamOptions(0.1).weight_decay(1e-2).amsgrad(true));
+}
+
+TEST(OptimTest, ForeachMatchesLoop_Adagrad) {
+  check_foreach_matches_loop<Adagrad>(
+      AdagradOptions(0.1).lr_decay(1e-2).weight_decay(1e-2));
+}
+
+TEST(OptimTest, ForeachMatchesLoop_RMSprop) {
+  check_foreach_matches_loop<RMSprop>(RMSpropOptions(0.01));
+  check_foreach_matches_loop<RMSprop>(
+      RMSpropOptions(0.01).momentum(0.9).centered(true).weight_decay(1e-2));
+}
+
+TEST(OptimTest, ForeachBumpsStateVersions) {
+  auto p = torch::randn({10});
+  RMSprop optimizer(
+      {p}, RMSpropOptions(0.01).momentum(0.9).centered(true).foreach(true));
+  p.grad() = torch::randn_like(p);
+  optimizer.step();
+  auto& state = static_cast<RMSpropParamState&>(
+      *optimizer.state().at(c10::guts::to_string(p.unsafeGetTensorImpl())));
+  const auto param_version = p._version();
+  const auto square_avg_version = state.square_avg()._version();
+  const auto momentum_buffer_version = state.momentum_buffer()._version();
+  const auto grad_avg_version = state.grad_avg()._version();
+  optimizer.step();
+  ASSERT_GT(p._version(), param_version);
+  ASSERT_GT(state.square_avg()._version(), square_avg_version);
+  ASSERT_GT(state.momentum_buffer()._version(), momentum_buffer_version);
+  ASSERT_GT(state.grad_avg()._version(), grad_avg_version);
+}
+
 TEST(OptimTest, ZeroGrad) {
   torch::manual_seed(0);
 
@@ -9,6 +9,7 @@
 #include "torch/csrc/jit/runtime/autodiff.h"
 #include "torch/csrc/jit/frontend/code_template.h"
 #include "torch/csrc/jit/runtime/custom_operator.h"
+#include "torch/csrc/jit/codegen/fuser/disk_cache.h"
 #include "torch/csrc/jit/codegen/fuser/interface.h"
 #include "torch/csrc/jit/serialization/import.h"
 #include "torch/csrc/jit/ir/irparser.h"
@@ -44,8 +45,15 @@
 
 #include <c10/util/Exception.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#include <utime.h>
+#endif
+
 #include <algorithm>
 #include <cstddef>
+#include <cstdlib>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -226,5 +234,68 @@ void testRegisterFusionCachesKernel() {
   // and therefore share a KernelSpec to share kernels for specializations
   ASSERT_EQ(second_key, expected_key);
 }
+
+void testKernelDiskCache() {
+#ifndef _WIN32
+  using fuser::KernelDiskCache;
+
+  char dir_template[] = "/tmp/pytorch_kernel_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  const std::string dir = dir_template;
+  KernelDiskCache cache(dir, 100);
+
+  // Keys only depend on the content.
+  const auto key_a = KernelDiskCache::key("kernel a");
+  const auto key_b = KernelDiskCache::key("kernel b");
+  ASSERT_EQ(key_a, KernelDiskCache::key("kernel a"));
+  ASSERT_NE(key_a, key_b);
+  ASSERT_EQ(key_a.size(), 32);
+
+  ASSERT_FALSE(cache.lookup(key_a, ".so").has_value());
+  const std::string contents_a(60, 'a');
+  auto path_a = cache.write(key_a, ".so", contents_a);
+  ASSERT_TRUE(path_a.has_value());
+  ASSERT_EQ(*cache.lookup(key_a, ".so"), *path_a);
+  ASSERT_EQ(*cache.read(key_a, ".so"), contents_a);
+  ASSERT_FALSE(cache.read(key_a, ".o").has_value());
+
+  // Makes a the least recently used entry; writing b overflows the cache and
+  // evicts it.
+  struct utimbuf old_times = {1000, 1000};
+  ASSERT_EQ(utime(path_a->c_str(), &old_times), 0);
+  auto path_b = cache.write(key_b, ".so", std::string(60, 'b'));
+  ASSERT_TRUE(path_b.has_value());
+  ASSERT_FALSE(cache.lookup(key_a, ".so").has_value());
+  ASSERT_TRUE(cache.lookup(key_b, ".so").has_value());
+
+  // Files the cache didn't write are never evicted, even when they are the
+  // least recently used.
+  const std::string foreign = dir + "/notes.txt";
+  {
+    std::ofstream out(foreign);
+    out << std::string(60, 'n');
+  }
+  ASSERT_EQ(utime(foreign.c_str(), &old_times), 0);
+  ASSERT_TRUE(cache.write(key_a, ".so", contents_a).has_value());
+  ASSERT_EQ(access(foreign.c_str(), F_OK), 0);
+  ASSERT_FALSE(cache.lookup(key_b, ".so").has_value());
+
+  cache.remove(key_a, ".so");
+  ASSERT_FALSE(cache.lookup(key_a, ".so").has_value());
+  ASSERT_EQ(cache.num_hits(), 3);
+  ASSERT_EQ(cache.num_misses(), 5);
+
+  // The lookup of an entry that turns out to be corrupt counts as a miss.
+  ASSERT_TRUE(cache.write(key_a, ".so", contents_a).has_value());
+  ASSERT_TRUE(cache.lookup(key_a, ".so").has_value());
+  cache.removeCorrupt(key_a, ".so");
+  ASSERT_FALSE(cache.lookup(key_a, ".so").has_value());
+  ASSERT_EQ(cache.num_hits(), 3);
+  ASSERT_EQ(cache.num_misses(), 7);
+
+  unlink(foreign.c_str());
+  rmdir(dir.c_str());
+#endif
+}
 } // namespace jit
 } // namespace torch
@@ -0,0 +1,85 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+#include <torch/torch.h>
+
+#include <sstream>
+
+namespace torch {
+namespace jit {
+
+void testMemoryPlanning() {
+  constexpr size_t kBytes = 4 * 8 * sizeof(float);
+  {
+    const auto graph_string = R"IR(
+      graph(%a : Float(4, 8), %b : Float(4, 8), %c : Float(4, 8)):
+        %one : int = prim::Constant[value=1]()
+        %x : Float(4, 8) = aten::mul(%a, %b)
+        %y : Float(4, 8) = aten::add(%x, %c, %one)
+        %z : Float(4, 8) = aten::relu(%y)
+        %w : Float(4, 8) = aten::tanh(%z)
+        %v : Float(4, 8) = aten::sigmoid(%w)
+        return (%v))IR";
+    auto graph = std::make_shared<Graph>();
+    parseIR(graph_string, graph.get());
+    auto plan = PlanMemory(graph);
+
+    // x, y, z and w are planned; the output v is not.
+    ASSERT_EQ(plan.allocations.size(), 4);
+    ASSERT_EQ(plan.unplanned.size(), 1);
+    ASSERT_EQ(plan.naive_bytes, 4 * kBytes);
+    ASSERT_EQ(plan.peak_live_bytes, 2 * kBytes);
+    ASSERT_EQ(plan.arena_bytes, 2 * kBytes);
+    for (const auto& a : plan.allocations) {
+      for (const auto& b : plan.allocations) {
+        const bool live_together =
+            a.range.begin <= b.range.end && b.range.begin <= a.range.end;
+        if (&a != &b && live_together) {
+          ASSERT_TRUE(
+              a.offset + a.size <= b.offset || b.offset + b.size <= a.offset);
+        }
+      }
+    }
+    std::stringstream report;
+    report << plan;
+    ASSERT_TRUE(report.str().find("arena: 256 bytes, naive: 512 bytes") == 0);
+
+    // The static runtime places the typed intermediates before the first run.
+    StaticRuntime runtime(graph);
+    ASSERT_EQ(runtime.planned_bytes(), 2 * kBytes);
+    auto a = at::randn({4, 8});
+    auto b = at::randn({4, 8});
+    auto c = at::randn({4, 8});
+    auto outputs = runtime.run({a, b, c});
+    auto expected = at::sigmoid(at::tanh(at::relu(a * b + c)));
+    ASSERT_TRUE(outputs[0].allclose(expected));
+    ASSERT_EQ(runtime.planned_bytes(), 2 * kBytes);
+  }
+  {
+    // A view keeps the tensor it aliases alive.
+    const auto graph_string = R"IR(
+      graph(%a : Float(4, 8), %b : Float(4, 8)):
+        %one : int = prim::Constant[value=1]()
+        %x : Float(4, 8) = aten::mul(%a, %b)
+        %xt : Float(8, 4) = aten::t(%x)
+        %y : Float(4, 8) = aten::relu(%a)
+        %z : Float(8, 4) = aten::relu(%xt)
+        %w : Float(4, 8) = aten::add(%y, %a, %one)
+        return (%z, %w))IR";
+    auto graph = std::make_shared<Graph>();
+    parseIR(graph_string, graph.get());
+    auto plan = PlanMemory(graph);
+    ASSERT_EQ(plan.allocations.size(), 2);
+    ASSERT_EQ(plan.allocations[0].value->debugName(), "x");
+    ASSERT_EQ(plan.allocations[0].range.begin, 1);
+    ASSERT_EQ(plan.allocations[0].range.end, 4);
+    ASSERT_EQ(plan.arena_bytes, 2 * kBytes);
+  }
+}
+
+} // namespace jit
+} // namespace torch
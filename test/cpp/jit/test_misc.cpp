@@ -10,6 +10,7 @@
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/ir/type_hashing.h>
 #include "torch/csrc/autograd/generated/variable_factories.h"
+#include "torch/csrc/autograd/profiler_stream.h"
 #include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/jit/runtime/argument_spec.h"
 #include "torch/csrc/jit/ir/attributes.h"
@@ -57,11 +58,15 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <utility>
@@ -933,6 +938,73 @@ void testAutogradProfiler() {
   TORCH_CHECK(count == 200);
 }
 
+void testStreamingProfiler() {
+  const std::string path = "streaming_profile.trace";
+  auto countOf = [](const std::string& str, const std::string& what) {
+    size_t count = 0;
+    for (size_t pos = 0; (pos = str.find(what, pos)) != std::string::npos;
+         count++, pos++) {
+    }
+    return count;
+  };
+  auto readFile = [&] {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+  };
+
+  auto a = torch::randn({4, 4}, at::kCPU);
+  {
+    autograd::profiler::RecordStreamingProfile guard(path);
+    for (size_t i = 0; i < 100; ++i) {
+      a = torch::tanh(a);
+    }
+  }
+  std::string trace = readFile();
+  ASSERT_EQ(trace.find("[\n"), 0);
+  ASSERT_EQ(countOf(trace, "\"name\": \"tanh\""), 100);
+  ASSERT_EQ(countOf(trace, "\"ph\": \"B\""), countOf(trace, "\"ph\": \"E\""));
+
+  // With a ring too small to hold the run, ranges are dropped as a whole.
+  autograd::profiler::StreamingProfilerConfig config(path);
+  config.ring_size = 16;
+  config.flush_interval_ms = 1000 * 1000;
+  autograd::profiler::enableStreamingProfiler(config);
+  for (size_t i = 0; i < 100; ++i) {
+    a = torch::tanh(a);
+  }
+  auto stats = autograd::profiler::disableStreamingProfiler();
+  ASSERT_TRUE(stats.events_written <= 16);
+  ASSERT_TRUE(stats.events_dropped > 0);
+  trace = readFile();
+  ASSERT_EQ(
+      countOf(trace, "\"ph\": \"B\"") + countOf(trace, "\"ph\": \"E\""),
+      stats.events_written);
+  ASSERT_EQ(countOf(trace, "\"ph\": \"B\""), countOf(trace, "\"ph\": \"E\""));
+
+  // A range that ends on another thread releases its slot in the ring it
+  // began in, so later ranges on that thread are still recorded.
+  config.ring_size = 16;
+  autograd::profiler::enableStreamingProfiler(config);
+  for (size_t i = 0; i < 8; ++i) {
+    autograd::profiler::RecordFunction async_range;
+    async_range.before("async");
+    std::thread([&] { async_range.end(); }).join();
+  }
+  {
+    autograd::profiler::RecordFunction range;
+    range.before("sync");
+  }
+  stats = autograd::profiler::disableStreamingProfiler();
+  ASSERT_EQ(stats.events_dropped, 0);
+  trace = readFile();
+  ASSERT_EQ(countOf(trace, "\"name\": \"async\""), 8);
+  ASSERT_EQ(countOf(trace, "\"name\": \"sync\""), 1);
+  ASSERT_EQ(countOf(trace, "\"ph\": \"B\""), countOf(trace, "\"ph\": \"E\""));
+  std::remove(path.c_str());
+}
+
 void testNoneSchemaMatch() {
   RegisterOperators reg({
       Operator(
@@ -0,0 +1,104 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+#include <torch/torch.h>
+
+namespace torch {
+namespace jit {
+
+void testStaticRuntime() {
+  const auto graph_string = R"IR(
+    graph(%a : Tensor, %b : Tensor, %c : Tensor):
+      %one : int = prim::Constant[value=1]()
+      %x : Tensor = aten::mul(%a, %b)
+      %y : Tensor = aten::add(%x, %c, %one)
+      %z : Tensor = aten::relu(%y)
+      %w : Tensor = aten::tanh(%z)
+      %v : Tensor = aten::sigmoid(%w)
+      return (%v))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, graph.get());
+  StaticRuntime runtime(graph);
+  ASSERT_EQ(runtime.num_out_variant_nodes(), 5);
+
+  auto reference = [](const at::Tensor& a,
+                      const at::Tensor& b,
+                      const at::Tensor& c) {
+    return at::sigmoid(at::tanh(at::relu(a * b + c)));
+  };
+
+  // The first run sizes the plan; later runs with the same sizes reuse it.
+  std::vector<at::Tensor> previous;
+  size_t planned_bytes = 0;
+  for (int i = 0; i < 3; ++i) {
+    auto a = at::randn({4, 8});
+    auto b = at::randn({4, 8});
+    auto c = at::randn({4, 8});
+    auto outputs = runtime.run({a, b, c});
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_TRUE(outputs[0].allclose(reference(a, b, c)));
+    if (i > 0) {
+      ASSERT_EQ(runtime.planned_bytes(), planned_bytes);
+      // Outputs are not overwritten by later runs.
+      ASSERT_FALSE(outputs[0].data_ptr() == previous[0].data_ptr());
+    }
+    planned_bytes = runtime.planned_bytes();
+    previous = outputs;
+  }
+  ASSERT_TRUE(planned_bytes > 0);
+  // x, y, z and w are intermediates, but no more than two of them are alive
+  // at the same time.
+  ASSERT_TRUE(planned_bytes <= 2 * 4 * 8 * sizeof(float));
+
+  // Larger inputs grow the plan.
+  auto a = at::randn({16, 8});
+  auto b = at::randn({16, 8});
+  auto c = at::randn({16, 8});
+  auto outputs = runtime.run({a, b, c});
+  ASSERT_TRUE(outputs[0].allclose(reference(a, b, c)));
+  ASSERT_TRUE(runtime.planned_bytes() > planned_bytes);
+  outputs = runtime.run({a, b, c});
+  ASSERT_TRUE(outputs[0].allclose(reference(a, b, c)));
+
+  const auto loop_string = R"IR(
+    graph(%a : Tensor):
+      %cond : bool = prim::Constant[value=1]()
+      %n : int = prim::Constant[value=2]()
+      %x : Tensor = prim::Loop(%n, %cond, %a)
+        block0(%i : int, %y : Tensor):
+          %z : Tensor = aten::relu(%y)
+          -> (%cond, %z)
+      return (%x))IR";
+  auto loop_graph = std::make_shared<Graph>();
+  parseIR(loop_string, loop_graph.get());
+  ASSERT_THROWS_WITH(StaticRuntime{loop_graph}, "control flow");
+}
+
+void testStaticRuntimeModule() {
+  Module m("m");
+  m.register_parameter("weight", torch::randn({8, 4}), false);
+  m.register_parameter("bias", torch::randn({8}), false);
+  m.define(R"(
+    def forward(self, input):
+      x = torch.addmm(self.bias, input, self.weight.t())
+      y = torch.cat([x, x.relu()], 1)
+      return torch.sigmoid(y), x
+  )");
+  m.eval();
+
+  StaticRuntime runtime(m);
+  for (int i = 0; i < 2; ++i) {
+    auto input = torch::randn({3, 4});
+    auto expected = m.forward({input}).toTuple()->elements();
+    auto outputs = runtime.run({input});
+    ASSERT_EQ(outputs.size(), 2);
+    ASSERT_TRUE(outputs[0].allclose(expected[0].toTensor()));
+    ASSERT_TRUE(outputs[1].allclose(expected[1].toTensor()));
+  }
+}
+
+} // namespace jit
+} // namespace torch
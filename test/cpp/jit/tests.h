@@ -31,6 +31,7 @@ namespace jit {
   _(PassManagement)                    \
   _(Proto)                             \
   _(RegisterFusionCachesKernel)        \
+  _(KernelDiskCache)                   \
   _(SchemaParser)                      \
   _(TopologicalIndex)                  \
   _(TopologicalMove)                   \
@@ -53,6 +54,7 @@ namespace jit {
   _(InsertBailOuts)                    \
   _(PeepholeOptimize)                  \
   _(RecordFunction)                    \
+  _(StreamingProfiler)                 \
   _(ThreadLocalDebugInfo)              \
   _(SubgraphMatching)                  \
   _(SubgraphRewriter)                  \
@@ -88,6 +90,9 @@ namespace jit {
   _(LiteInterpreterWrongMethodName)    \
   _(LiteInterpreterParams)             \
   _(LiteInterpreterSetState)           \
+  _(StaticRuntime)                     \
+  _(StaticRuntimeModule)               \
+  _(MemoryPlanning)                    \
   _(TorchbindIValueAPI)
 
 #define TH_FORALL_TESTS_CUDA(_) \
@@ -76,3 +76,45 @@ TEST(WireSerialize, DISABLED_Sparse) {
   auto deser = torch::distributed::rpc::wireDeserialize(ser.data(), ser.size());
   EXPECT_TRUE(torch::equal(main, deser.second[0]));
 }
+
+TEST(WireSerialize, Segments) {
+  std::vector<char> payload = {'h', 'i'};
+  std::vector<at::Tensor> tensors = {torch::randn({5, 5}), torch::rand({10})};
+  torch::distributed::rpc::WireSegments segments(payload, tensors);
+
+  // Payload and tensor data are referenced, not copied.
+  size_t zeroCopy = 0;
+  for (const auto& segment : segments.segments()) {
+    if (segment.data == payload.data() ||
+        segment.data == tensors[0].data_ptr() ||
+        segment.data == tensors[1].data_ptr()) {
+      ++zeroCopy;
+    }
+  }
+  EXPECT_EQ(zeroCopy, 3u);
+
+  // The segments concatenate to the wireSerialize() format.
+  auto flat = torch::distributed::rpc::wireSerialize(payload, tensors);
+  EXPECT_EQ(flat.size(), segments.size());
+  at::Tensor buffer = torch::empty(
+      {static_cast<int64_t>(segments.size())}, torch::kChar);
+  segments.copyTo(static_cast<char*>(buffer.data_ptr()));
+  EXPECT_TRUE(memcmp(flat.data(), buffer.data_ptr(), flat.size()) == 0);
+
+  // Deserializing from a tensor aliases its storage, which stays alive with
+  // the received tensors.
+  auto deser = torch::distributed::rpc::wireDeserialize(buffer);
+  const char* begin = static_cast<const char*>(buffer.data_ptr());
+  buffer.reset();
+  EXPECT_EQ(payload, deser.first);
+  ASSERT_EQ(tensors.size(), deser.second.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const char* data = static_cast<const char*>(deser.second[i].data_ptr());
+    EXPECT_TRUE(data >= begin && data < begin + flat.size());
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(data) %
+            torch::distributed::rpc::kWireAlignment,
+        0);
+    EXPECT_TRUE(torch::equal(tensors[i], deser.second[i]));
+  }
+}
@@ -3,15 +3,25 @@
 
 #include "test/cpp/tensorexpr/padded_buffer.h"
 #include "test/cpp/tensorexpr/test_utils.h"
+#include "torch/csrc/jit/codegen/fuser/disk_cache.h"
 #include "torch/csrc/jit/tensorexpr/buffer.h"
 #include "torch/csrc/jit/tensorexpr/eval.h"
 #include "torch/csrc/jit/tensorexpr/function.h"
 #include "torch/csrc/jit/tensorexpr/ir.h"
 #include "torch/csrc/jit/tensorexpr/ir_printer.h"
+#include "torch/csrc/jit/tensorexpr/ir_simplifier.h"
 #include "torch/csrc/jit/tensorexpr/llvm_codegen.h"
 #include "torch/csrc/jit/tensorexpr/schedule.h"
 #include "torch/csrc/jit/tensorexpr/tensor.h"
+#include "torch/csrc/utils/memory.h"
 
+#ifndef _WIN32
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <iterator>
 #include <numeric>
 
 namespace torch {
@@ -406,6 +416,223 @@ void testLLVMVectorizerLoadStoreTest() {
   assertAllEqual(c_vec, 21);
 }
 
+void testLLVMReduceRfactorVectorize() {
+  KernelScope kernel_scope;
+  const int M = 4;
+  const int N = 67;
+  Buffer b(VarHandle("b", kHandle), kFloat, {M, N});
+  Tensor* c = Reduce(
+      "sum",
+      {{M, "m"}},
+      Sum(),
+      [&](const std::vector<VarHandle>& v) { return b(v[0], v[1]); },
+      {{N, "n"}});
+  LoopNest l({c});
+  std::vector<For*> loops = l.getLoopStmtsFor(c);
+  For* outer;
+  For* inner;
+  For* tail;
+  l.SplitWithTail(loops[1], 8, &outer, &inner, &tail);
+  l.RFactor(c, inner);
+  l.Vectorize(inner);
+  l.ApplyInlines();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+
+  Buffer c_buf(VarHandle(c->func_var()), kFloat, {M});
+  LLVMCodeGen cg(s, {b, c_buf});
+
+  std::vector<float> b_vec(M * N);
+  std::vector<float> c_ref(M, 0.0f);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      b_vec[i * N + j] = i + j * 0.5f;
+      c_ref[i] += i + j * 0.5f;
+    }
+  }
+  std::vector<float> c_vec(M, -1.0f);
+  std::vector<void*> args({b_vec.data(), c_vec.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+  ExpectAllNear(c_vec, c_ref, 1e-3);
+}
+
+void testLLVMAllocateIntermediate() {
+  KernelScope kernel_scope;
+  // The intermediate is too large for the stack and is malloc'ed.
+  const int N = 1024;
+  Buffer a(VarHandle("a", kHandle), kFloat, {N});
+  Tensor* x = Compute(
+      "x", {{N, "i"}}, [&](const VarHandle& i) { return a(i) * 2.0f; });
+  Tensor* y = Reduce("sum", {}, Sum(), x, {{N, "i"}});
+  LoopNest l({y});
+  l.ApplyInlines();
+  Stmt* s = l.root_stmt();
+
+  Buffer y_buf(VarHandle(y->func_var()), kFloat, {1});
+  LLVMCodeGen cg(s, {a, y_buf});
+
+  std::vector<float> a_vec(N, 0.5f);
+  std::vector<float> y_vec(1, -1.0f);
+  std::vector<void*> args({a_vec.data(), y_vec.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+  ASSERT_EQ(y_vec[0], 1024.0f);
+}
+
+void testLLVMParallelFor() {
+  KernelScope kernel_scope;
+  auto testWithSize = [](int32_t M, int32_t N) {
+    VarHandle m("m", kInt);
+    VarHandle n("n", kInt);
+    Buffer a(VarHandle("a", kHandle), kFloat, {m, n});
+    Buffer b(VarHandle("b", kHandle), kFloat, {m, n});
+    VarHandle i("i", kInt);
+    VarHandle j("j", kInt);
+    LoopOptions parallel;
+    parallel.set_parallel();
+    Stmt* s = For::make(
+        i,
+        0,
+        m,
+        For::make(
+            j, 0, n, Store::make(b, i * n + j, a(i, j) * 2.0f + i, 1)),
+        parallel);
+    LLVMCodeGen cg(s, {a, b, m, n});
+
+    std::vector<float> a_vec(M * N);
+    std::vector<float> b_ref(M * N);
+    for (int x = 0; x < M; x++) {
+      for (int y = 0; y < N; y++) {
+        a_vec[x * N + y] = y;
+        b_ref[x * N + y] = y * 2.0f + x;
+      }
+    }
+    std::vector<float> b_vec(M * N, 0.0f);
+    std::vector<void*> args({a_vec.data(), b_vec.data(), &M, &N});
+    ASSERT_EQ(cg.value<int>(args), 0);
+    ExpectAllNear(b_vec, b_ref, 1e-5);
+  };
+  testWithSize(1, 1);
+  testWithSize(3, 7);
+  testWithSize(64, 1000);
+}
+
+void testLLVMParallelReduction() {
+  KernelScope kernel_scope;
+  const int M = 64;
+  const int N = 2051;
+  Buffer b(VarHandle("b", kHandle), kFloat, {M, N});
+  Tensor* c = Reduce(
+      "sum",
+      {{M, "m"}},
+      Sum(),
+      [&](const std::vector<VarHandle>& v) { return b(v[0], v[1]); },
+      {{N, "n"}});
+  LoopNest l({c});
+  std::vector<For*> loops = l.getLoopStmtsFor(c);
+  l.SetParallel(loops[0]);
+  For* outer;
+  For* inner;
+  For* tail;
+  l.SplitWithTail(loops[1], 8, &outer, &inner, &tail);
+  l.RFactor(c, inner);
+  l.Vectorize(inner);
+  l.ApplyInlines();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+
+  Buffer c_buf(VarHandle(c->func_var()), kFloat, {M});
+  LLVMCodeGen cg(s, {b, c_buf});
+
+  std::vector<float> b_vec(M * N);
+  std::vector<float> c_ref(M, 0.0f);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      b_vec[i * N + j] = (i + j) % 5;
+      c_ref[i] += (i + j) % 5;
+    }
+  }
+  std::vector<float> c_vec(M, -1.0f);
+  std::vector<void*> args({b_vec.data(), c_vec.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+  ExpectAllNear(c_vec, c_ref, 1e-3);
+}
+
+// Runs a kernel that adds one to 32 ints.
+static void runLLVMIncrementKernel() {
+  KernelScope kernel_scope;
+  constexpr int N = 32;
+  Buffer a(VarHandle("A", kHandle), kInt, {N});
+  Buffer b(VarHandle("B", kHandle), kInt, {N});
+  std::vector<int32_t> a_buffer(N, 41);
+  std::vector<int32_t> b_buffer(N, 0);
+
+  auto mask = IntImm::make(1);
+  VarHandle i("i", kInt);
+  auto expr = For::make(
+      i,
+      0,
+      N,
+      Store::make(
+          b, i, Add::make(Load::make(a, i, mask), IntImm::make(1)), mask));
+
+  LLVMCodeGen cg(expr, {a, b});
+
+  std::vector<void*> args({a_buffer.data(), b_buffer.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+  assertAllEqual(b_buffer, 42);
+}
+
+void testLLVMKernelDiskCache() {
+#ifndef _WIN32
+  using fuser::KernelDiskCache;
+
+  char dir_template[] = "/tmp/pytorch_llvm_kernel_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  const std::string dir = dir_template;
+  auto previous = KernelDiskCache::replace(
+      torch::make_unique<KernelDiskCache>(dir, 1 << 20));
+  KernelDiskCache* cache = KernelDiskCache::get();
+
+  // The first compilation misses and stores the object code, the second one
+  // loads it.
+  runLLVMIncrementKernel();
+  ASSERT_EQ(cache->num_hits(), 0);
+  ASSERT_EQ(cache->num_misses(), 1);
+  runLLVMIncrementKernel();
+  ASSERT_EQ(cache->num_hits(), 1);
+  ASSERT_EQ(cache->num_misses(), 1);
+
+  std::vector<std::string> entries;
+  DIR* d = opendir(dir.c_str());
+  ASSERT_NE(d, nullptr);
+  while (dirent* file = readdir(d)) {
+    if (file->d_name[0] != '.') {
+      entries.push_back(dir + "/" + file->d_name);
+    }
+  }
+  closedir(d);
+  ASSERT_EQ(entries.size(), 1);
+
+  // A corrupt entry is replaced by the object code of a new compilation.
+  {
+    std::ofstream out(entries[0], std::ios::binary | std::ios::trunc);
+    out << "not an object file";
+  }
+  runLLVMIncrementKernel();
+  ASSERT_EQ(cache->num_hits(), 1);
+  ASSERT_EQ(cache->num_misses(), 2);
+  runLLVMIncrementKernel();
+  ASSERT_EQ(cache->num_hits(), 2);
+  ASSERT_EQ(cache->num_misses(), 2);
+  std::ifstream in(entries[0], std::ios::binary);
+  std::string contents(
+      (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  ASSERT_NE(contents, "not an object file");
+
+  KernelDiskCache::replace(std::move(previous));
+  unlink(entries[0].c_str());
+  rmdir(dir.c_str());
+#endif
+}
+
 void testLLVMMemcpyTest() {
   KernelScope kernel_scope;
   constexpr int N = 32;
@@ -0,0 +1,235 @@
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "test/cpp/tensorexpr/test_base.h"
+
+#include "torch/csrc/jit/tensorexpr/buffer.h"
+#include "torch/csrc/jit/tensorexpr/eval.h"
+#include "torch/csrc/jit/tensorexpr/function.h"
+#include "torch/csrc/jit/tensorexpr/ir.h"
+#include "torch/csrc/jit/tensorexpr/ir_printer.h"
+#include "torch/csrc/jit/tensorexpr/reduction.h"
+#include "torch/csrc/jit/tensorexpr/schedule.h"
+#include "torch/csrc/jit/tensorexpr/tensor.h"
+
+namespace torch {
+namespace jit {
+
+using namespace torch::jit::tensorexpr;
+using namespace torch::jit::tensorexpr::schedule;
+
+void testReduceSumAll() {
+  KernelScope kernel_scope;
+  const int N = 10;
+  Buffer b(VarHandle("b", kHandle), kFloat, {N});
+  Tensor* c = Reduce(
+      "sum",
+      {},
+      Sum(),
+      [&](const std::vector<VarHandle>& v) { return b(v[0]); },
+      {{N, "n"}});
+  LoopNest l({c});
+  l.ApplyInlines();
+  Stmt* s = l.root_stmt();
+
+  std::vector<float> b_data(N);
+  for (int i = 0; i < N; i++) {
+    b_data[i] = i;
+  }
+  std::vector<float> c_data(1, -1.0f);
+  SimpleIREvaluator(s, b, c)(b_data, c_data);
+  ASSERT_EQ(c_data[0], 45.0f);
+}
+
+void testReduceSumRows() {
+  KernelScope kernel_scope;
+  const int M = 4;
+  const int N = 10;
+  Buffer b(VarHandle("b", kHandle), kFloat, {M, N});
+  Tensor* c = Reduce(
+      "sum",
+      {{M, "m"}},
+      Sum(),
+      [&](const std::vector<VarHandle>& v) { return b(v[0], v[1]); },
+      {{N, "n"}});
+  LoopNest l({c});
+  l.ApplyInlines();
+  Stmt* s = l.root_stmt();
+
+  std::vector<float> b_data(M * N);
+  std::vector<float> c_ref(M, 0.0f);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      b_data[i * N + j] = i * j;
+      c_ref[i] += i * j;
+    }
+  }
+  std::vector<float> c_data(M, -1.0f);
+  SimpleIREvaluator(s, b, c)(b_data, c_data);
+  ExpectAllNear(c_data, c_ref, 1e-5);
+}
+
+void testReduceMax() {
+  KernelScope kernel_scope;
+  const int N = 10;
+  Buffer b(VarHandle("b", kHandle), kFloat, {N});
+  Tensor* c = Reduce(
+      "max",
+      {},
+      Maximum(kFloat),
+      [&](const std::vector<VarHandle>& v) { return b(v[0]); },
+      {{N, "n"}});
+  LoopNest l({c});
+  l.ApplyInlines();
+  Stmt* s = l.root_stmt();
+
+  std::vector<float> b_data(N);
+  for (int i = 0; i < N; i++) {
+    b_data[i] = -100.0f + (i * 7) % N;
+  }
+  std::vector<float> c_data(1, 0.0f);
+  SimpleIREvaluator(s, b, c)(b_data, c_data);
+  ASSERT_EQ(c_data[0], -91.0f);
+}
+
+void testReduceInlineProducer() {
+  KernelScope kernel_scope;
+  const int M = 4;
+  const int N = 10;
+  Buffer a(VarHandle("a", kHandle), kFloat, {M, N});
+  Tensor* x = Compute(
+      "x", {{M, "m"}, {N, "n"}}, [&](const VarHandle& m, const VarHandle& n) {
+        return a(m, n) * 2.0f;
+      });
+  Tensor* y = Reduce("sum", {{M, "m"}}, Sum(), x, {{N, "n"}});
+  LoopNest l({y});
+  l.ComputeInline(l.getLoopBodyFor(x));
+  l.ApplyInlines();
+  Stmt* s = l.root_stmt();
+
+  std::vector<float> a_data(M * N);
+  std::vector<float> y_ref(M, 0.0f);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      a_data[i * N + j] = i + j;
+      y_ref[i] += 2.0f * (i + j);
+    }
+  }
+  std::vector<float> y_data(M, -1.0f);
+  SimpleIREvaluator(s, a, y)(a_data, y_data);
+  ExpectAllNear(y_data, y_ref, 1e-5);
+
+  // A reduction can't be inlined into its consumers.
+  Tensor* z = Compute("z", {{M, "m"}}, [&](const VarHandle& m) {
+    return y->call(m) + 1.0f;
+  });
+  LoopNest l2({z});
+  ASSERT_THROW(l2.ComputeInline(l2.getLoopBodyFor(y)), std::runtime_error);
+}
+
+void testReduceRfactor() {
+  KernelScope kernel_scope;
+  const int M = 4;
+  const int N = 10;
+  Buffer b(VarHandle("b", kHandle), kFloat, {M, N});
+  Tensor* c = Reduce(
+      "sum",
+      {{M, "m"}},
+      Sum(),
+      [&](const std::vector<VarHandle>& v) { return b(v[0], v[1]); },
+      {{N, "n"}});
+  LoopNest l({c});
+  std::vector<For*> loops = l.getLoopStmtsFor(c);
+  ASSERT_EQ(loops.size(), 2);
+  For* outer;
+  For* inner;
+  For* tail;
+  l.SplitWithTail(loops[1], 4, &outer, &inner, &tail);
+  l.RFactor(c, inner);
+  l.ApplyInlines();
+  Stmt* s = l.root_stmt();
+
+  std::ostringstream oss;
+  oss << *s;
+  ASSERT_NE(oss.str().find("sum_rfac"), std::string::npos);
+
+  std::vector<float> b_data(M * N);
+  std::vector<float> c_ref(M, 0.0f);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      b_data[i * N + j] = i * N + j;
+      c_ref[i] += i * N + j;
+    }
+  }
+  std::vector<float> c_data(M, -1.0f);
+  SimpleIREvaluator(s, b, c)(b_data, c_data);
+  ExpectAllNear(c_data, c_ref, 1e-5);
+}
+
+void testReduceRfactorNotReduction() {
+  KernelScope kernel_scope;
+  const int N = 10;
+  Buffer b(VarHandle("b", kHandle), kFloat, {N});
+  Tensor* c = Compute(
+      "c", {{N, "n"}}, [&](const VarHandle& n) { return b(n) + 1.0f; });
+  LoopNest l({c});
+  std::vector<For*> loops = l.getLoopStmtsFor(c);
+  ASSERT_THROW(l.RFactor(c, loops[0]), std::runtime_error);
+}
+
+void testScheduleReorder() {
+  KernelScope kernel_scope;
+  const int M = 3;
+  const int N = 5;
+  Buffer a(VarHandle("a", kHandle), kFloat, {M, N});
+  Tensor* b = Compute(
+      "b", {{M, "m"}, {N, "n"}}, [&](const VarHandle& m, const VarHandle& n) {
+        return a(m, n) + 1.0f;
+      });
+  LoopNest l({b});
+  std::vector<For*> loops = l.getLoopStmtsFor(b);
+  const Var* m = loops[0]->var();
+  const Var* n = loops[1]->var();
+  For* new_outer;
+  For* new_inner;
+  l.Reorder(loops[0], loops[1], &new_outer, &new_inner);
+  ASSERT_EQ(new_outer->var(), n);
+  ASSERT_EQ(new_inner->var(), m);
+  Stmt* s = l.root_stmt();
+
+  std::vector<float> a_data(M * N);
+  std::vector<float> b_ref(M * N);
+  for (int i = 0; i < M * N; i++) {
+    a_data[i] = i;
+    b_ref[i] = i + 1.0f;
+  }
+  std::vector<float> b_data(M * N, 0.0f);
+  SimpleIREvaluator(s, a, b)(a_data, b_data);
+  ExpectAllNear(b_data, b_ref, 1e-5);
+}
+
+void testScheduleReorderDependentBounds() {
+  KernelScope kernel_scope;
+  Buffer a(VarHandle("a", kHandle), kFloat, {4 * 4 * 3});
+  Tensor* b = Compute(
+      "b", {{4, "x"}}, [&](const VarHandle& x) { return a(x) + 1.0f; });
+  LoopNest l({b});
+
+  // for i in [0, 4): for j in [0, i): for k in [0, 3): a[i, j, k] = 0
+  // The bounds of j depend on i, so i can't be moved inside of it.
+  VarHandle i("i", kInt);
+  VarHandle j("j", kInt);
+  VarHandle k("k", kInt);
+  For* k_loop = For::make(
+      k, 0, 3, Store::make(a, i * 12 + j * 3 + k, ExprHandle(0.0f), 1));
+  For* j_loop = For::make(j, 0, i, k_loop);
+  For* i_loop = For::make(i, 0, 4, j_loop);
+  Block::make({i_loop});
+  For* new_outer;
+  For* new_inner;
+  ASSERT_THROW(
+      l.Reorder(i_loop, k_loop, &new_outer, &new_inner), std::runtime_error);
+}
+
+} // namespace jit
+} // namespace torch
@@ -545,5 +545,29 @@ void testScheduleDynamicShape2D() {
   testWithSize(37, 11);
 }
 
+void testScheduleSplitParallel() {
+  KernelScope kernel_scope;
+  const int N = 100;
+  Buffer a(VarHandle("a", kHandle), kFloat, {N});
+  Tensor* b = Compute(
+      "b", {{N, "n"}}, [&](const VarHandle& n) { return a(n) + 1.0f; });
+  LoopNest l({b});
+  std::vector<For*> loops = l.getLoopStmtsFor(b);
+  l.SetParallel(loops[0]);
+  ASSERT_THROW(l.SetGPUBlockIndex(loops[0], 0), std::runtime_error);
+
+  For* outer;
+  For* inner;
+  For* tail;
+  l.SplitWithTail(loops[0], 8, &outer, &inner, &tail);
+  ASSERT_TRUE(outer->loop_options().is_parallel());
+  ASSERT_FALSE(inner->loop_options().is_parallel());
+  ASSERT_FALSE(tail->loop_options().is_parallel());
+
+  std::ostringstream oss;
+  oss << *l.root_stmt();
+  ASSERT_NE(oss.str().find("// parallel"), std::string::npos);
+}
+
 } // namespace jit
 } // namespace torch
@@ -47,6 +47,15 @@ namespace jit {
   _(ScheduleFuserStyle)          \
   _(ScheduleFuserThreeArg)       \
   _(ScheduleDynamicShape2D)      \
+  _(ScheduleReorder)             \
+  _(ScheduleReorderDependentBounds) \
+  _(ScheduleSplitParallel)       \
+  _(ReduceSumAll)                \
+  _(ReduceSumRows)               \
+  _(ReduceMax)                   \
+  _(ReduceInlineProducer)        \
+  _(ReduceRfactor)               \
+  _(ReduceRfactorNotReduction)   \
   _(TypeTest01)                  \
   _(TypePropagation)             \
   _(Cond01)                      \
@@ -227,7 +236,12 @@ namespace jit {
   _(LLVMTensorDynamicShapeAdd)     \
   _(LLVMDynamicShape2D)            \
   _(LLVMIfThenElseTest)            \
-  _(LLVMVectorizerLoadStoreTest)
+  _(LLVMVectorizerLoadStoreTest)   \
+  _(LLVMReduceRfactorVectorize)    \
+  _(LLVMAllocateIntermediate)      \
+  _(LLVMParallelFor)               \
+  _(LLVMParallelReduction)         \
+  _(LLVMKernelDiskCache)
 
 #define TH_FORALL_TESTS_CUDA(_) \
   _(CudaTestVectorAdd01)        \
@@ -1996,6 +1996,44 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def test_gloo_backend_cpu_module(self):
         self._test_gloo_backend([torch.device('cpu')], [])
 
+    @requires_gloo()
+    def test_gloo_builtin_comm_hooks(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_device(interface=LOOPBACK)]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+
+        hooks = [
+            (dist.BuiltinCommHookType.FP16_COMPRESS, {}),
+            (dist.BuiltinCommHookType.BF16_COMPRESS, {}),
+            (dist.BuiltinCommHookType.POWER_SGD, {"matrix_approximation_rank": 2}),
+            (dist.BuiltinCommHookType.TOPK_COMPRESS, {"topk_ratio": 0.1}),
+        ]
+        for comm_hook_type, kwargs in hooks:
+            torch.manual_seed(1337)
+            model = Net()
+            ddp_model = DistributedDataParallel(
+                copy.deepcopy(model), process_group=process_group, bucket_cap_mb=0.001)
+            ddp_model._register_builtin_comm_hook(comm_hook_type, **kwargs)
+
+            input = torch.randn(2 * self.world_size, 2)
+            target = torch.randn(2 * self.world_size, 4)
+            local = slice(2 * self.rank, 2 * (self.rank + 1))
+            F.mse_loss(model(input), target).backward()
+            F.mse_loss(ddp_model(input[local]), target[local]).backward()
+
+            for p, ddp_p in zip(model.parameters(), ddp_model.parameters()):
+                # Every process ends up with the same gradients...
+                grads = [torch.empty_like(ddp_p.grad) for _ in range(self.world_size)]
+                process_group.allgather([grads], [ddp_p.grad]).wait()
+                for grad in grads:
+                    self.assertEqual(grad, ddp_p.grad)
+                # ...which, for the 16-bit hooks, match the full-batch gradients.
+                if comm_hook_type == dist.BuiltinCommHookType.FP16_COMPRESS:
+                    self.assertEqual(ddp_p.grad, p.grad, prec=1e-3)
+                elif comm_hook_type == dist.BuiltinCommHookType.BF16_COMPRESS:
+                    self.assertEqual(ddp_p.grad, p.grad, prec=1e-2)
+
     @requires_gloo()
     @skip_if_not_multigpu
     def test_gloo_backend_1gpu_module_device_ids_integer_list(self):
@@ -3086,6 +3124,77 @@ class ReducerTest(TestCase):
             output.backward()
             optimizer.step()
 
+    def _run_with_comm_hook(self, comm_hook_type, iterations=1, **kwargs):
+        """
+        Runs `iterations` backward passes over the same batch through a reducer
+        with the given hook, and returns the mean of the reduced gradients and
+        the gradients computed without a reducer.
+        """
+        batch_size = 10
+        model = ReducerModule()
+        reference = copy.deepcopy(model)
+        parameters = list(model.parameters())
+        reducer = dist.Reducer(
+            [parameters], [list(range(len(parameters)))], self.process_group)
+        reducer._register_builtin_comm_hook(
+            comm_hook_type, self.process_group, **kwargs)
+        loss = nn.CrossEntropyLoss()
+        input = torch.rand([batch_size, 2])
+        target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+        grads = [torch.zeros_like(p) for p in parameters]
+        for _ in range(iterations):
+            model.zero_grad()
+            output = loss(model(input), target)
+            reducer.prepare_for_backward(output)
+            output.backward()
+            for grad, p in zip(grads, parameters):
+                grad += p.grad / iterations
+        loss(reference(input), target).backward()
+        return grads, [p.grad for p in reference.parameters()]
+
+    def _grad_error(self, grads, expected):
+        return sum((g - e).norm() for g, e in zip(grads, expected))
+
+    def test_fp16_compress_hook(self):
+        grads, expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.FP16_COMPRESS)
+        for grad, e in zip(grads, expected):
+            self.assertEqual(grad, e, prec=1e-3)
+
+    def test_bf16_compress_hook(self):
+        grads, expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.BF16_COMPRESS)
+        for grad, e in zip(grads, expected):
+            self.assertEqual(grad, e, prec=1e-2)
+
+    def test_topk_compress_hook(self):
+        # Sending every entry is lossless.
+        grads, expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.TOPK_COMPRESS, topk_ratio=1.0)
+        for grad, e in zip(grads, expected):
+            self.assertEqual(grad, e)
+
+        # With error feedback, the entries that are not sent in one iteration
+        # are sent later, so the mean gradient converges to the exact one.
+        torch.manual_seed(0)
+        one, expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.TOPK_COMPRESS, topk_ratio=0.25)
+        torch.manual_seed(0)
+        many, many_expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.TOPK_COMPRESS, iterations=40, topk_ratio=0.25)
+        self.assertLess(
+            self._grad_error(many, many_expected), self._grad_error(one, expected))
+
+    def test_powersgd_hook(self):
+        torch.manual_seed(0)
+        one, expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.POWER_SGD)
+        torch.manual_seed(0)
+        many, many_expected = self._run_with_comm_hook(
+            dist.BuiltinCommHookType.POWER_SGD, iterations=40)
+        self.assertLess(
+            self._grad_error(many, many_expected), self._grad_error(one, expected))
+
 
 class ComputeBucketAssignmentTest(TestCase):
     def test_single_limit_single_dtype(self):
@@ -5554,6 +5554,41 @@ class TestNN(NNTestCase):
             self.assertEqual(output1, output2)
             self.assertEqual(hidden1, hidden2)
 
+    def test_rnn_cpu_no_grad(self):
+        # Without autograd, CPU RNNs run fused cells into preallocated outputs;
+        # they must match the differentiable path and leave the inputs alone.
+        lengths = [7, 7, 5, 2, 1]
+        for mode, bidirectional, batch_first, dtype in product(
+                ['RNN', 'GRU', 'LSTM'], [False, True], [False, True], [torch.float, torch.double]):
+            rnn = getattr(nn, mode)(6, 9, 2, bidirectional=bidirectional,
+                                    batch_first=batch_first).to(dtype)
+            num_directions = 2 if bidirectional else 1
+            input = torch.randn(7, 5, 6, dtype=dtype)
+            if batch_first:
+                input = input.transpose(0, 1)
+            hx = torch.randn(2 * num_directions, 5, 9, dtype=dtype)
+            hidden = (hx, torch.randn_like(hx)) if mode == 'LSTM' else hx
+            packed = rnn_utils.pack_padded_sequence(input, lengths, batch_first=batch_first)
+            for x in (input, packed):
+                expected_output, expected_hidden = rnn(x, hidden)
+                hidden_copy = tuple(h.clone() for h in hidden) if mode == 'LSTM' else hidden.clone()
+                with torch.no_grad():
+                    output, hidden_out = rnn(x, hidden)
+                self.assertEqual(hidden, hidden_copy)
+                if isinstance(x, rnn_utils.PackedSequence):
+                    expected_output, output = expected_output.data, output.data
+                self.assertEqual(output, expected_output)
+                self.assertEqual(hidden_out, expected_hidden)
+
+        for cell_type in (nn.LSTMCell, nn.GRUCell):
+            cell = cell_type(6, 9)
+            input = torch.randn(3, 6)
+            hx = torch.randn(3, 9)
+            hidden = (hx, torch.randn(3, 9)) if cell_type is nn.LSTMCell else hx
+            expected = cell(input, hidden)
+            with torch.no_grad():
+                self.assertEqual(cell(input, hidden), expected)
+
     def _test_RNN_cpu_vs_cudnn(self, dropout, dtype=torch.double):
 
         def forward_backward(cuda, rnn, input_val, hx_val, grad_output, grad_hy, weights_val):
@@ -1423,6 +1423,55 @@ class TestQuantizedOps(TestCase):
             quantize_ref = torch.quantize_per_tensor(float_ref, Y_scale, Y_zero_point, dtype_x)
             self.assertEqual(qy.int_repr().numpy(), quantize_ref.int_repr().numpy())
 
+class TestQuantizedEmbeddingBag(TestCase):
+    """Tests the row-wise quantized embedding_bag ops against the float
+    embedding_bag on the dequantized table."""
+    def _test_embedding_bag_rowwise(self, bit_rate):
+        prepack = getattr(torch.ops.quantized, 'embedding_bag_{}_prepack'.format(bit_rate))
+        unpack = getattr(torch.ops.quantized, 'embedding_bag_{}_unpack'.format(bit_rate))
+        lookup = getattr(torch.ops.quantized, 'embedding_bag_{}_rowwise_offsets'.format(bit_rate))
+        # Each quantization step is range / 255 (8-bit) or range / 15 (4-bit)
+        # of a row, a rounding error is at most half of that.
+        prec = 1.0 / 255 if bit_rate == 'byte' else 1.0 / 15
+        num_embeddings, embedding_dim = 100, 16
+        weight = torch.rand(num_embeddings, embedding_dim)
+        packed = prepack(weight)
+        weight_ref = unpack(packed)
+        self.assertEqual(weight_ref, weight, prec)
+
+        for index_dtype in (torch.int32, torch.int64):
+            indices = torch.randint(0, num_embeddings, (50,), dtype=index_dtype)
+            offsets = torch.tensor([0, 0, 3, 10, 27, 49], dtype=index_dtype)
+            per_sample_weights = torch.rand(50)
+            for mode, weights in (('sum', None), ('mean', None), ('sum', per_sample_weights)):
+                mode_enum = 0 if mode == 'sum' else 1
+                ref = F.embedding_bag(indices.long(), weight_ref, offsets.long(), mode=mode,
+                                      per_sample_weights=weights)
+                out = lookup(packed, indices, offsets, False, mode_enum, False, weights)
+                self.assertEqual(out, ref, 1e-5)
+
+                offsets_last = torch.cat([offsets, offsets.new_tensor([50])])
+                out = lookup(packed, indices, offsets_last, False, mode_enum, False, weights, True)
+                self.assertEqual(out, ref, 1e-5)
+
+        # 2D indices are one bag per row.
+        indices = torch.randint(0, num_embeddings, (5, 4))
+        ref = F.embedding_bag(indices, weight_ref, mode='mean')
+        self.assertEqual(lookup(packed, indices, None, False, 1), ref, 1e-5)
+
+        with self.assertRaisesRegex(RuntimeError, "out of bounds"):
+            lookup(packed, torch.tensor([0, num_embeddings]), torch.tensor([0]))
+        with self.assertRaisesRegex(RuntimeError, "sum \\(0\\) and mean \\(1\\)"):
+            lookup(packed, indices.view(-1), torch.tensor([0]), False, 2)
+
+    def test_embedding_bag_byte_rowwise(self):
+        self._test_embedding_bag_rowwise('byte')
+
+    def test_embedding_bag_4bit_rowwise(self):
+        self._test_embedding_bag_rowwise('4bit')
+        with self.assertRaisesRegex(RuntimeError, "even number of columns"):
+            torch.ops.quantized.embedding_bag_4bit_prepack(torch.rand(4, 3))
+
 @unittest.skipUnless('fbgemm' in torch.backends.quantized.supported_engines,
                      " Quantized operations require FBGEMM. FBGEMM is only optimized for CPUs"
                      " with instruction set support avx2 or newer.")
@@ -1551,6 +1600,70 @@ class TestDynamicQuantizedLinear(TestCase):
             self.assertEqual(Y_fp32, Y_fp32_ref,
                              message="torch.ops.quantized.linear_dynamic (fbgemm) results are off")
 
+    """Tests the fused GELU, the quint8 output and the quint8 input of the dynamic linear ops."""
+    @given(
+        batch_size=st.integers(1, 4),
+        input_channels=st.integers(16, 32),
+        output_channels=st.integers(4, 8),
+        activation=st.sampled_from(("none", "relu", "gelu")),
+        quantized_output=st.booleans(),
+        use_channelwise=st.booleans())
+    def test_qlinear_fused_epilogue(self, batch_size, input_channels, output_channels,
+                                    activation, quantized_output, use_channelwise):
+        with override_quantized_engine('fbgemm'):
+            name = "linear_dynamic" if activation == "none" else "linear_{}_dynamic".format(activation)
+            qlinear_dynamic = getattr(torch.ops.quantized, name)
+            if quantized_output:
+                qlinear_dynamic = getattr(torch.ops.quantized, name + "_qout")
+
+            X = torch.rand(batch_size, input_channels) * 4 - 2
+            # The weights stay within [-63, 63] so that the uint8 * int8 pairs
+            # of vpmaddubsw cannot saturate.
+            W = torch.rand(output_channels, input_channels) * 2 - 1
+            b = torch.rand(output_channels) - 0.5
+            if use_channelwise:
+                W_scales = W.abs().max(dim=1)[0] / 63
+                W_q = torch.quantize_per_channel(W, W_scales.double(),
+                                                 torch.zeros(output_channels, dtype=torch.long),
+                                                 axis=0, dtype=torch.qint8)
+            else:
+                W_q = torch.quantize_per_tensor(W, W.abs().max().item() / 63, 0, torch.qint8)
+            W_prepack = torch.ops.quantized.linear_prepack(W_q, b)
+
+            X_scale, X_zp = _calculate_dynamic_qparams(X, torch.quint8)
+            X_q = torch.quantize_per_tensor(X, X_scale, X_zp, torch.quint8)
+            Y_ref = F.linear(X_q.dequantize(), W_q.dequantize(), b)
+            if activation == "relu":
+                Y_ref = F.relu(Y_ref)
+            elif activation == "gelu":
+                Y_ref = F.gelu(Y_ref)
+
+            # A quint8 input is used as is, and gives the same result as the
+            # float input it was quantized from.
+            for input in (X, X_q):
+                Y = qlinear_dynamic(input, W_prepack)
+                if quantized_output:
+                    self.assertEqual(Y.dtype, torch.quint8)
+                    Y_scale, Y_zp = _calculate_dynamic_qparams(Y_ref, torch.quint8)
+                    self.assertEqual(Y.q_scale(), Y_scale, prec=1e-4)
+                    self.assertEqual(Y.q_zero_point(), Y_zp, prec=1)
+                    self.assertEqual(Y.dequantize(), Y_ref, prec=2 * Y_scale)
+                else:
+                    self.assertEqual(Y, Y_ref, prec=1e-3)
+
+            if quantized_output:
+                # The quint8 output feeds the next op without a range scan.
+                W2 = torch.rand(3, output_channels) * 2 - 1
+                W2_q = torch.quantize_per_tensor(W2, W2.abs().max().item() / 63, 0, torch.qint8)
+                W2_prepack = torch.ops.quantized.linear_prepack(W2_q, None)
+                Y2 = torch.ops.quantized.linear_relu_dynamic_qout(Y, W2_prepack)
+                Y2_ref = F.relu(F.linear(Y.dequantize(), W2_q.dequantize()))
+                self.assertEqual(Y2.dtype, torch.quint8)
+                self.assertEqual(Y2.dequantize(), Y2_ref, prec=2 * Y2.q_scale())
+                W3_q = torch.quantize_per_tensor(torch.rand(2, 3) - 0.5, 1 / 126, 0, torch.qint8)
+                Y3 = torch.ops.quantized.linear_dynamic(Y2, torch.ops.quantized.linear_prepack(W3_q, None))
+                self.assertEqual(Y3, F.linear(Y2.dequantize(), W3_q.dequantize()), prec=1e-3)
+
     """Tests the correctness of the legacy dynamic quantized linear op."""
     @given(
         batch_size=st.integers(1, 4),
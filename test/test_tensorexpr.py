@@ -4,6 +4,8 @@ import torch
 import torch.nn.functional as F
 import unittest
 
+from typing import List
+
 from torch.testing._internal.common_utils import suppress_warnings
 
 from te_utils import CudaCodeGenCreated, CudaCodeGenExecuted, \
@@ -1097,6 +1099,48 @@ class TestTensorExprFuser(BaseTestClass):
         assert llvm.elapsed_value() == 1 or interp.elapsed_value() == 1
 
 
+    def test_sum(self):
+        def sum_dim(x):
+            return (x * 2).sum(1)
+
+        def sum_keepdim(x):
+            return (x * 2).sum(1, keepdim=True)
+
+        def sum_neg_dims(x):
+            return (x * 2).sum([-1, -3])
+
+        def sum_all_dims(x):
+            return (x * 2).sum(torch.jit.annotate(List[int], []))
+
+        for fn in [sum_dim, sum_keepdim, sum_neg_dims, sum_all_dims]:
+            for dtype in [torch.float, torch.double, torch.int32, torch.int64]:
+                if dtype.is_floating_point:
+                    x = torch.rand(4, 5, 6, dtype=dtype)
+                else:
+                    x = torch.randint(-10, 10, (4, 5, 6), dtype=dtype)
+                scripted = torch.jit.script(fn)
+                llvm = LLVMCodeGenExecuted()
+                interp = SimpleIREvalExecuted()
+                scripted(x)
+                res = scripted(x)
+                ref = fn(x)
+                # int inputs are summed into long, like in eager mode.
+                self.assertEqual(ref.dtype, res.dtype)
+                np.testing.assert_allclose(ref.numpy(), res.numpy(), rtol=1e-5)
+                assert llvm.elapsed_value() == 1 or interp.elapsed_value() == 1
+
+    def test_sum_not_fused(self):
+        # A dtype argument is not lowered, so the sum stays out of the fusion
+        # group.
+        @torch.jit.script
+        def test(x):
+            return (x * 2).sum(1, dtype=torch.double)
+        x = torch.rand(4, 5, 6)
+        test(x)
+        np.testing.assert_allclose(
+            (x * 2).sum(1, dtype=torch.double).numpy(), test(x).numpy())
+
+
     @unittest.skipIf(not torch.cuda.is_available(), "requires CUDA")
     @unittest.skip("dynamic shapes are not quite there yet")
     def test_dynamic_shape(self):
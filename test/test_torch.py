@@ -1057,6 +1057,27 @@ class _TestTorchMixin(object):
         self.assertEqual(y[:, 0], range(100))
         self.assertEqual(y[:, 40], range(4000, 4100))
 
+    def test_copy_permute(self):
+        # permuted copies are done as tiled transposes
+        for dtype in [torch.uint8, torch.half, torch.float, torch.double, torch.cdouble]:
+            for shape, perm in [((67, 131), (1, 0)),
+                                ((8, 3, 33, 35), (0, 2, 3, 1)),
+                                ((8, 33, 35, 3), (0, 3, 1, 2)),
+                                ((4, 12, 70, 64), (0, 2, 1, 3)),
+                                ((9, 17, 70), (2, 1, 0))]:
+                x = torch.arange(torch.Size(shape).numel()).reshape(shape).to(dtype)
+                y = x.permute(*perm)
+                expected = y.reshape(-1).tolist()
+                self.assertEqual(y.contiguous().reshape(-1).tolist(), expected)
+                z = torch.empty(y.shape, dtype=dtype)
+                z.permute(*[perm.index(d) for d in range(len(perm))]).copy_(x)
+                self.assertEqual(z.reshape(-1).tolist(), expected)
+        x = torch.randn(4, 5, 70, 80)
+        y = x.contiguous(memory_format=torch.channels_last)
+        self.assertTrue(y.is_contiguous(memory_format=torch.channels_last))
+        self.assertEqual(y, x)
+        self.assertEqual(y.contiguous(), x)
+
     def test_device(self):
         cpu = torch.device('cpu')
         self.assertEqual('cpu', str(cpu))
@@ -1900,6 +1921,38 @@ class _TestTorchMixin(object):
         self.assertIsOrdered('descending', x, res2val, res2ind,
                              'random with NaNs')
 
+    def test_sort_stable_large(self):
+        # Long slices are sorted by all threads with a parallel merge sort,
+        # short ones one slice per thread. Both are stable.
+        def check(x, dim, descending):
+            values, indices = torch.sort(x, dim, descending)
+            self.assertEqual(values, x.gather(dim, indices), 0)
+            self.assertEqual(torch.argsort(x, dim, descending), indices, 0)
+            keys = values.transpose(dim, -1).reshape(-1, x.size(dim))
+            order = indices.transpose(dim, -1).reshape(-1, x.size(dim))
+            diff = keys[:, 1:] - keys[:, :-1]
+            self.assertTrue((diff <= 0).all() if descending else (diff >= 0).all())
+            ties = diff == 0
+            self.assertTrue((order[:, 1:][ties] > order[:, :-1][ties]).all())
+
+        for dtype in (torch.long, torch.float, torch.double):
+            x = torch.randint(0, 1000, (300000,)).to(dtype)
+            check(x, 0, False)
+            check(x, 0, True)
+            x = torch.randint(0, 10, (3, 100, 2000)).to(dtype)
+            check(x, 1, False)
+            check(x, 2, True)
+            check(x.transpose(0, 2), 2, False)
+
+        x = torch.rand(200000)
+        x[torch.randperm(200000)[:1000]] = float('nan')
+        values, indices = torch.sort(x)
+        self.assertTrue(torch.isnan(values[-1000:]).all())
+        self.assertFalse(torch.isnan(values[:-1000]).any())
+        values, indices = torch.sort(x, descending=True)
+        self.assertTrue(torch.isnan(values[:1000]).all())
+        self.assertFalse(torch.isnan(values[1000:]).any())
+
     def test_topk(self):
         def topKViaSort(t, k, dim, dir):
             sorted, indices = t.sort(dim, dir)
@@ -1944,6 +1997,29 @@ class _TestTorchMixin(object):
                         k = random.randint(1, testTensor.size(dim))
                         compare(testTensor, k, dim, dir)
 
+    def test_topk_long_slices(self):
+        # few long slices are searched by all threads together
+        for dtype in [torch.float, torch.double, torch.int64, torch.uint8]:
+            t = torch.randint(0, 250, (2, 1 << 17), dtype=dtype)
+            if dtype.is_floating_point:
+                t = torch.randn(2, 1 << 17, dtype=dtype)
+                t[0, 100] = float('nan')
+            for largest in [True, False]:
+                for k in [1, 17, 1000]:
+                    for x, dim in [(t, 1), (t.t(), 0), (t[:, ::2], 1)]:
+                        values, indices = x.topk(k, dim, largest, True)
+                        expected = x.sort(dim, largest)[0].narrow(dim, 0, k)
+                        self.assertEqual(values, expected, 0)
+                        self.assertEqual(x.gather(dim, indices), values, 0)
+
+                        values, indices = x.topk(k, dim, largest, False)
+                        self.assertEqual(values.sort(dim, largest)[0], expected, 0)
+
+            for k in [1, 10, (1 << 17) - 9, 1 << 17]:
+                values, indices = t.kthvalue(k, 1)
+                self.assertEqual(values, t.sort(1)[0][:, k - 1], 0)
+                self.assertEqual(t.gather(1, indices.unsqueeze(1)).squeeze(1), values, 0)
+
     def test_topk_arguments(self):
         q = torch.randn(10, 2, 10)
         # Make sure True isn't mistakenly taken as the 2nd dimension (interpreted as 1)
@@ -12853,6 +12929,23 @@ class TestTorchDeviceType(TestCase):
                                     count += 1
                             self.assertEqual(j, count)
 
+    @dtypes(torch.uint8, torch.int, torch.long, torch.float, torch.double)
+    def test_unique_large(self, device, dtype):
+        # Large enough for the parallel partitioning and scans to be used.
+        x = torch.randint(0, 500, (200000,), device=device).to(dtype)
+        expected_unique = torch.tensor(sorted(set(x.tolist())), dtype=dtype, device=device)
+        expected_counts = torch.stack([(x == u).sum() for u in expected_unique])
+
+        unique, inverse, counts = torch.unique(x, sorted=True, return_inverse=True, return_counts=True)
+        self.assertEqual(unique, expected_unique, 0)
+        self.assertEqual(unique[inverse], x, 0)
+        self.assertEqual(counts, expected_counts, 0)
+
+        unique, inverse, counts = torch.unique(x.view(400, 500), sorted=False, return_inverse=True, return_counts=True)
+        self.assertEqual(unique.sort()[0], expected_unique, 0)
+        self.assertEqual(unique[inverse].view(-1), x, 0)
+        self.assertEqual(counts[unique.sort()[1]], expected_counts, 0)
+
     @dtypes(*set(torch.testing.get_all_dtypes()) - {torch.bfloat16})
     def test_unique_consecutive(self, device, dtype):
         if dtype is torch.half and self.device_type == 'cpu':
@@ -13408,6 +13501,52 @@ class TestTorchDeviceType(TestCase):
         else:
             check_sum_all(torch.tensor([True, False, True], dtype=torch.bool, device=device))
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_reduce_nchw_dims(self, device, dtype):
+        # reductions over dims (0, 2, 3) have fewer outputs than threads, and
+        # short rows (H * W) or a strided output
+        def check(x):
+            xd = x.double()
+            self.assertEqual(x.sum((0, 2, 3)), xd.sum((0, 2, 3)).to(dtype))
+            self.assertEqual(x.mean((0, 2, 3)), xd.mean((0, 2, 3)).to(dtype))
+            self.assertEqual(x.var((0, 2, 3)), xd.var((0, 2, 3)).to(dtype))
+            self.assertEqual(x.std((0, 2, 3), keepdim=True), xd.std((0, 2, 3), keepdim=True).to(dtype))
+            out = torch.empty(x.size(1), 2, dtype=dtype, device=device)[:, 0]
+            torch.sum(x, (0, 2, 3), out=out)
+            self.assertEqual(out, xd.sum((0, 2, 3)).to(dtype))
+
+        for shape in [(64, 3, 7, 7), (32, 16, 14, 14), (8, 5, 3, 3), (2, 70, 33, 1)]:
+            x = torch.randn(shape, dtype=dtype, device=device)
+            check(x)
+            check(x.contiguous(memory_format=torch.channels_last))
+            check(x.transpose(0, 1).contiguous().transpose(0, 1))
+
+        # the vectorized sum is accumulated pairwise
+        x = torch.rand(1 << 22, dtype=dtype, device=device)
+        self.assertEqual(x.sum(), x.double().sum(), prec=1e-6 * x.numel())
+        x = x.view(1 << 12, 1 << 10)
+        self.assertEqual(x.sum(0), x.double().sum(0).to(dtype), prec=1e-6 * x.size(0))
+
+    @onlyCPU
+    @unittest.skipIf(torch.get_num_threads() < 2, "needs more than one intra-op thread")
+    def test_reduce_many_outputs_few_slices(self, device):
+        # the outer dim has fewer slices than there are threads and the
+        # reduced dim is long enough that the reduction is split across it;
+        # there are enough outputs that the combine of the per-thread copies
+        # is itself split across threads
+        num_threads = torch.get_num_threads()
+        slices = max(num_threads - 1, 1)
+        inner = -(-32768 // (num_threads * slices))
+        x = torch.randn(slices, 32 * num_threads, inner, dtype=torch.double, device=device)
+        expected = torch.zeros(slices, inner, dtype=torch.double, device=device)
+        for s in x.unbind(1):
+            expected += s
+        for _ in range(3):
+            self.assertEqual(x.sum(1), expected)
+            self.assertEqual(x.transpose(1, 2).contiguous().sum(2), expected)
+            self.assertEqual(x.sum().item(), math.fsum(expected.flatten().tolist()))
+
     def _test_memory_format_transformations(self, device, input_generator_fn, transformation_fn,
                                             memory_format, compare_data=True, default_is_preserve=False):
 
@@ -46,6 +46,7 @@ libtorch_sources = [
     "torch/csrc/autograd/functions/utils.cpp",
     "torch/csrc/autograd/input_buffer.cpp",
     "torch/csrc/autograd/profiler.cpp",
+    "torch/csrc/autograd/profiler_stream.cpp",
     "torch/csrc/autograd/record_function.cpp",
     "torch/csrc/autograd/record_function_ops.cpp",
     "torch/csrc/autograd/saved_variable.cpp",
@@ -98,6 +99,8 @@ libtorch_sources = [
     "torch/csrc/jit/serialization/import_export_helpers.cpp",
     "torch/csrc/jit/runtime/instruction.cpp",
     "torch/csrc/jit/runtime/interpreter.cpp",
+    "torch/csrc/jit/runtime/static/impl.cpp",
+    "torch/csrc/jit/runtime/static/ops.cpp",
     "torch/csrc/jit/ir/ir.cpp",
     "torch/csrc/jit/ir/irparser.cpp",
     "torch/csrc/jit/jit_log.cpp",
@@ -132,6 +135,7 @@ libtorch_sources = [
     "torch/csrc/jit/passes/inplace_check.cpp",
     "torch/csrc/jit/passes/insert_guards.cpp",
     "torch/csrc/jit/passes/liveness.cpp",
+    "torch/csrc/jit/passes/memory_planning.cpp",
     "torch/csrc/jit/passes/loop_unrolling.cpp",
     "torch/csrc/jit/passes/lower_grad_of.cpp",
     "torch/csrc/jit/passes/lower_graph.cpp",
@@ -181,6 +185,7 @@ libtorch_sources = [
     "torch/csrc/jit/frontend/string_to_type.cpp",
     "torch/csrc/jit/frontend/tracer.cpp",
     "torch/csrc/jit/codegen/fuser/kernel_cache.cpp",
+    "torch/csrc/jit/codegen/fuser/disk_cache.cpp",
     "torch/csrc/jit/codegen/fuser/compiler.cpp",
     "torch/csrc/jit/codegen/fuser/executor.cpp",
     "torch/csrc/jit/codegen/fuser/codegen.cpp",
@@ -275,6 +280,7 @@ torch_cpp_srcs = [
     "torch/csrc/api/src/optim/lbfgs.cpp",
     "torch/csrc/api/src/optim/optimizer.cpp",
     "torch/csrc/api/src/optim/rmsprop.cpp",
+    "torch/csrc/api/src/optim/rowwise_adagrad.cpp",
     "torch/csrc/api/src/optim/serialize.cpp",
     "torch/csrc/api/src/optim/sgd.cpp",
     "torch/csrc/api/src/serialize/input-archive.cpp",
@@ -341,6 +347,7 @@ def add_torch_libs():
         "torch/csrc/autograd/python_variable_indexing.cpp",
         "torch/csrc/distributed/autograd/init.cpp",
         "torch/csrc/distributed/c10d/comm.cpp",
+        "torch/csrc/distributed/c10d/comm_hooks.cpp",
         "torch/csrc/distributed/c10d/init.cpp",
         "torch/csrc/distributed/c10d/reducer.cpp",
         "torch/csrc/distributed/rpc/init.cpp",
@@ -5,4 +5,5 @@
 #include <torch/optim/lbfgs.h>
 #include <torch/optim/optimizer.h>
 #include <torch/optim/rmsprop.h>
+#include <torch/optim/rowwise_adagrad.h>
 #include <torch/optim/sgd.h>
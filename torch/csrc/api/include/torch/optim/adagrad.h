@@ -26,6 +26,9 @@ struct TORCH_API AdagradOptions : public OptimizerCloneableOptions<AdagradOption
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(double, initial_accumulator_value) = 0;
   TORCH_ARG(double, eps) = 1e-10;
+  /// Run the step with a multi-tensor kernel, see AdamOptions::foreach.
+  /// Sparse gradients keep their own path.
+  TORCH_ARG(bool, foreach) = false;
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
   void serialize(torch::serialize::OutputArchive& archive) const override;
@@ -26,6 +26,11 @@ struct TORCH_API AdamOptions : public OptimizerCloneableOptions<AdamOptions> {
   TORCH_ARG(double, eps) = 1e-8;
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(bool, amsgrad) = false;
+  /// Update the parameters of a group with one multi-tensor kernel per dtype
+  /// instead of a sequence of ATen ops per parameter, for the parameters it
+  /// supports (contiguous CPU floating point tensors with dense gradients).
+  /// Not serialized: it changes how step() runs, not what it computes.
+  TORCH_ARG(bool, foreach) = false;
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
   void serialize(torch::serialize::OutputArchive& archive) const override;
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -167,6 +168,16 @@ b) For c10::nullopt value: in param state, c10::nullopt value in C++ impl is equ
    missing key in Python impl. Since we don't serialize missing keys in Python API,
    we skip c10::nullopt values when serializing the param state. */
 
+namespace detail {
+/// Bumps the version counters of the tensors that a fused or sparse step
+/// wrote. These steps update the parameters and their state through raw
+/// pointers rather than with in-place ATen ops, so nothing else marks the
+/// tensors as modified, and autograd would not notice that a tensor it saved
+/// for backward has changed. Undefined tensors (e.g. absent optional state)
+/// are skipped.
+TORCH_API void bump_versions(std::initializer_list<at::ArrayRef<Tensor>> tensors);
+} // namespace detail
+
 /// Serializes an `Optimizer` into an `OutputArchive`.
 TORCH_API serialize::OutputArchive& operator<<(
     serialize::OutputArchive& archive,
@@ -30,6 +30,8 @@ struct TORCH_API RMSpropOptions : public OptimizerCloneableOptions<RMSpropOption
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(double, momentum) = 0;
   TORCH_ARG(bool, centered) = false;
+  /// Run the step with a multi-tensor kernel, see AdamOptions::foreach.
+  TORCH_ARG(bool, foreach) = false;
 
  public:
   void serialize(torch::serialize::InputArchive& archive) override;
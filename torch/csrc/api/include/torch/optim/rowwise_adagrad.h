@@ -0,0 +1,82 @@
+#pragma once
+
+#include <torch/nn/pimpl.h>
+#include <torch/optim/optimizer.h>
+#include <torch/optim/serialize.h>
+#include <torch/serialize/archive.h>
+#include <torch/types.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace serialize {
+class OutputArchive;
+class InputArchive;
+} // namespace serialize
+} // namespace torch
+
+namespace torch {
+namespace optim {
+
+/// Row-wise Adagrad keeps a single accumulator per row (the first dimension)
+/// of a parameter, to which it adds the mean of the squared gradient of the
+/// row, instead of one accumulator per element. This divides the optimizer
+/// state of an embedding table by its embedding dimension. It is the
+/// RowWiseSparseAdagrad of Caffe2.
+///
+/// Sparse gradients (e.g. of `Embedding` or `EmbeddingBag` with
+/// `sparse(true)`) only update the rows they have values for.
+struct TORCH_API RowWiseAdagradOptions : public OptimizerCloneableOptions<RowWiseAdagradOptions> {
+  RowWiseAdagradOptions(double lr = 1e-2);
+  TORCH_ARG(double, lr) = 1e-2;
+  TORCH_ARG(double, lr_decay) = 0;
+  TORCH_ARG(double, weight_decay) = 0;
+  TORCH_ARG(double, initial_accumulator_value) = 0;
+  TORCH_ARG(double, eps) = 1e-10;
+public:
+  void serialize(torch::serialize::InputArchive& archive) override;
+  void serialize(torch::serialize::OutputArchive& archive) const override;
+  TORCH_API friend bool operator==(const RowWiseAdagradOptions& lhs, const RowWiseAdagradOptions& rhs);
+  ~RowWiseAdagradOptions() = default;
+};
+
+struct TORCH_API RowWiseAdagradParamState : public OptimizerCloneableParamState<RowWiseAdagradParamState> {
+  // One value per row of the parameter.
+  TORCH_ARG(torch::Tensor, sum);
+  TORCH_ARG(int64_t, step) = 0;
+
+public:
+  void serialize(torch::serialize::InputArchive& archive) override;
+  void serialize(torch::serialize::OutputArchive& archive) const override;
+  TORCH_API friend bool operator==(const RowWiseAdagradParamState& lhs, const RowWiseAdagradParamState& rhs);
+  ~RowWiseAdagradParamState() = default;
+};
+
+class TORCH_API RowWiseAdagrad : public Optimizer {
+ public:
+  explicit RowWiseAdagrad(std::vector<OptimizerParamGroup> param_groups,
+      RowWiseAdagradOptions defaults = {}) : Optimizer(std::move(param_groups), std::make_unique<RowWiseAdagradOptions>(defaults)) {
+    TORCH_CHECK(defaults.lr() >= 0, "Invalid learning rate: ", defaults.lr());
+    TORCH_CHECK(defaults.lr_decay() >= 0, "Invalid lr_decay value: ", defaults.lr_decay());
+    TORCH_CHECK(defaults.weight_decay() >= 0, "Invalid weight_decay value: ", defaults.weight_decay());
+    TORCH_CHECK(defaults.initial_accumulator_value() >= 0, "Invalid initial_accumulator_value value: ", defaults.initial_accumulator_value());
+    TORCH_CHECK(defaults.eps() >= 0, "Invalid epsilon value: ", defaults.eps());
+  }
+
+  explicit RowWiseAdagrad(
+      std::vector<Tensor> params,
+      RowWiseAdagradOptions defaults = {}) : RowWiseAdagrad({std::move(OptimizerParamGroup(params))}, defaults) {}
+
+  torch::Tensor step(LossClosure closure = nullptr) override;
+  void save(serialize::OutputArchive& archive) const override;
+  void load(serialize::InputArchive& archive) override;
+
+ private:
+  template <typename Self, typename Archive>
+  static void serialize(Self& self, Archive& archive) {
+    _TORCH_OPTIM_SERIALIZE_WITH_TEMPLATE_ARG(RowWiseAdagrad);
+  }
+};
+} // namespace optim
+} // namespace torch
@@ -6,8 +6,13 @@
 #include <torch/optim/serialize.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/FusedOptimizer.h>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -53,6 +58,59 @@ void AdagradParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, sum);
 }
 
+namespace {
+
+// An embedding gradient only has values for the rows of the weight that were
+// looked up. The fused update reads each of those rows of the gradient once
+// and updates the same rows of the parameter and of the sum in place, instead
+// of building sparse intermediates for the squared gradient, the masked sum
+// and the step.
+bool can_use_fused_sparse_update(const Tensor& p, const Tensor& sum, const Tensor& grad) {
+  return grad.sparse_dim() == 1 && p.dim() >= 1 && p.device().is_cpu() &&
+      p.is_contiguous() && sum.is_contiguous() &&
+      sum.scalar_type() == p.scalar_type() &&
+      grad.scalar_type() == p.scalar_type() &&
+      at::isFloatingType(p.scalar_type());
+}
+
+template <typename scalar_t>
+void sparse_adagrad_update(
+    scalar_t* param,
+    scalar_t* sum,
+    const int64_t* indices,
+    const scalar_t* values,
+    int64_t nnz,
+    int64_t row_size,
+    scalar_t clr,
+    scalar_t eps) {
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(row_size, 1));
+  // The gradient is coalesced, so no two threads touch the same row.
+  at::parallel_for(0, nnz, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      scalar_t* param_row = param + indices[i] * row_size;
+      scalar_t* sum_row = sum + indices[i] * row_size;
+      const scalar_t* grad_row = values + i * row_size;
+      for (int64_t j = 0; j < row_size; j++) {
+        const scalar_t g = grad_row[j];
+        sum_row[j] += g * g;
+        param_row[j] -= clr * g / (std::sqrt(sum_row[j]) + eps);
+      }
+    }
+  });
+}
+
+// The parameters of a group that are updated by the multi-tensor kernel, with
+// their state, for one dtype.
+struct FusedAdagradGroup {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> sums;
+  std::vector<double> clrs;
+};
+
+} // namespace
+
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 Tensor Adagrad::step(LossClosure closure) {
@@ -63,6 +121,8 @@ Tensor Adagrad::step(LossClosure closure) {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdagradOptions&>(group.options());
+    std::map<ScalarType, FusedAdagradGroup> fused_groups;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -70,18 +130,48 @@ Tensor Adagrad::step(LossClosure closure) {
       auto grad = p.grad();
       TORCH_INTERNAL_ASSERT(state_[c10::guts::to_string(p.unsafeGetTensorImpl())] != nullptr, "state found NULL for the Tensor ", p);
       auto& state = static_cast<AdagradParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
-      auto& options = static_cast<AdagradOptions&>(group.options());
 
       state.step(state.step() + 1);
 
+      const auto clr = options.lr() /
+          (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
+
+      if (options.foreach() && !grad.is_sparse() &&
+          at::native::can_use_fused_optimizer(p, grad, {state.sum()})) {
+        auto& fused = fused_groups[p.scalar_type()];
+        fused.params.push_back(p);
+        fused.grads.push_back(grad);
+        fused.sums.push_back(state.sum());
+        fused.clrs.push_back(clr);
+        continue;
+      }
+
       if (options.weight_decay() != 0) {
         TORCH_CHECK(!p.grad().is_sparse(), "weight_decay option is not compatible with sparse gradients");
         grad = grad.add(p, options.weight_decay());
       }
-      const auto clr = options.lr() /
-          (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
 
-      if (grad.is_sparse()) {
+      if (grad.is_sparse() && can_use_fused_sparse_update(p, state.sum(), grad)) {
+        grad = grad.coalesce();
+        const auto indices = grad._indices().contiguous();
+        const auto values = grad._values().contiguous();
+        const int64_t nnz = values.size(0);
+        if (nnz > 0) {
+          AT_DISPATCH_FLOATING_TYPES(p.scalar_type(), "sparse_adagrad_update", [&] {
+            sparse_adagrad_update<scalar_t>(
+                p.data_ptr<scalar_t>(),
+                state.sum().data_ptr<scalar_t>(),
+                indices.data_ptr<int64_t>(),
+                values.data_ptr<scalar_t>(),
+                nnz,
+                values.numel() / nnz,
+                static_cast<scalar_t>(clr),
+                static_cast<scalar_t>(options.eps()));
+          });
+          detail::bump_versions({p, state.sum()});
+        }
+      }
+      else if (grad.is_sparse()) {
         grad = grad.coalesce();
         auto grad_indices = grad._indices();
         auto grad_values = grad._values();
@@ -105,6 +195,18 @@ Tensor Adagrad::step(LossClosure closure) {
         p.addcdiv_(grad, std, -clr);
       }
     }
+
+    for (auto& entry : fused_groups) {
+      auto& fused = entry.second;
+      at::native::fused_adagrad_stub(
+          kCPU,
+          fused.params,
+          fused.grads,
+          fused.sums,
+          fused.clrs,
+          at::native::FusedAdagradOptions{options.eps(), options.weight_decay()});
+      detail::bump_versions({fused.params, fused.sums});
+    }
   }
   return loss;
 }
@@ -6,9 +6,11 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizer.h>
 
 #include <cmath>
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -61,6 +63,22 @@ void AdamParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, max_exp_avg_sq);
 }
 
+namespace {
+
+// The parameters of a group that are updated by the multi-tensor kernel, with
+// their state, for one dtype.
+struct FusedAdamGroup {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> exp_avgs;
+  std::vector<Tensor> exp_avg_sqs;
+  std::vector<Tensor> max_exp_avg_sqs;
+  std::vector<double> step_sizes;
+  std::vector<double> bias_correction2_sqrts;
+};
+
+} // namespace
+
 Tensor Adam::step(LossClosure closure)  {
   NoGradGuard no_grad;
   Tensor loss = {};
@@ -69,6 +87,8 @@ Tensor Adam::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdamOptions&>(group.options());
+    std::map<ScalarType, FusedAdamGroup> fused_groups;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -76,7 +96,6 @@ Tensor Adam::step(LossClosure closure)  {
       auto grad = p.grad();
       TORCH_CHECK(!grad.is_sparse(), "Adam does not support sparse gradients"/*, please consider SparseAdam instead*/);
       auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-      auto& options = static_cast<AdamOptions&>(group.options());
 
       // State initialization
       if(param_state == state_.end()) {
@@ -105,6 +124,26 @@ Tensor Adam::step(LossClosure closure)  {
       auto bias_correction1 = 1 - std::pow(beta1, state.step());
       auto bias_correction2 = 1 - std::pow(beta2, state.step());
 
+      if (options.foreach()) {
+        std::vector<Tensor> param_states = {exp_avg, exp_avg_sq};
+        if (options.amsgrad()) {
+          param_states.push_back(max_exp_avg_sq);
+        }
+        if (at::native::can_use_fused_optimizer(p, grad, param_states)) {
+          auto& fused = fused_groups[p.scalar_type()];
+          fused.params.push_back(p);
+          fused.grads.push_back(grad);
+          fused.exp_avgs.push_back(exp_avg);
+          fused.exp_avg_sqs.push_back(exp_avg_sq);
+          if (options.amsgrad()) {
+            fused.max_exp_avg_sqs.push_back(max_exp_avg_sq);
+          }
+          fused.step_sizes.push_back(options.lr() / bias_correction1);
+          fused.bias_correction2_sqrts.push_back(std::sqrt(bias_correction2));
+          continue;
+        }
+      }
+
       if(options.weight_decay() != 0) {
         grad = grad.add(p, options.weight_decay());
       }
@@ -126,6 +165,30 @@ Tensor Adam::step(LossClosure closure)  {
       auto step_size = options.lr() / bias_correction1;
       p.addcdiv_(exp_avg, denom, -step_size);
     }
+
+    for (auto& entry : fused_groups) {
+      auto& fused = entry.second;
+      at::native::fused_adam_stub(
+          kCPU,
+          fused.params,
+          fused.grads,
+          fused.exp_avgs,
+          fused.exp_avg_sqs,
+          fused.max_exp_avg_sqs,
+          fused.step_sizes,
+          fused.bias_correction2_sqrts,
+          at::native::FusedAdamOptions{
+              std::get<0>(options.betas()),
+              std::get<1>(options.betas()),
+              options.eps(),
+              options.weight_decay(),
+              options.amsgrad()});
+      detail::bump_versions(
+          {fused.params,
+           fused.exp_avgs,
+           fused.exp_avg_sqs,
+           fused.max_exp_avg_sqs});
+    }
   }
   return loss;
 }
@@ -1,6 +1,7 @@
 #include <torch/optim/optimizer.h>
 
 #include <torch/csrc/autograd/generated/variable_factories.h>
+#include <torch/csrc/autograd/variable.h>
 #include <torch/ordered_dict.h>
 #include <torch/types.h>
 
@@ -11,6 +12,18 @@
 namespace torch {
 namespace optim {
 
+namespace detail {
+void bump_versions(std::initializer_list<at::ArrayRef<Tensor>> tensors) {
+  for (auto list : tensors) {
+    for (const auto& t : list) {
+      if (t.defined()) {
+        torch::autograd::impl::bump_version(t);
+      }
+    }
+  }
+}
+} // namespace detail
+
 bool OptimizerParamGroup::has_options() const {
   return options_ != nullptr;
 }
@@ -5,8 +5,10 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizer.h>
 
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -61,6 +63,20 @@ void RMSpropParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, grad_avg);
 }
 
+namespace {
+
+// The parameters of a group that are updated by the multi-tensor kernel, with
+// their state, for one dtype.
+struct FusedRMSpropGroup {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> square_avgs;
+  std::vector<Tensor> momentum_buffers;
+  std::vector<Tensor> grad_avgs;
+};
+
+} // namespace
+
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/rmsprop.py
 Tensor RMSprop::step(LossClosure closure)  {
@@ -71,6 +87,8 @@ Tensor RMSprop::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<RMSpropOptions&>(group.options());
+    std::map<ScalarType, FusedRMSpropGroup> fused_groups;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -78,7 +96,6 @@ Tensor RMSprop::step(LossClosure closure)  {
       auto grad = p.grad();
       TORCH_CHECK(!grad.is_sparse(), "RMSprop does not support sparse gradients");
       auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-      auto& options = static_cast<RMSpropOptions&>(group.options());
 
       // State initialization
       if (param_state == state_.end()) {
@@ -100,6 +117,29 @@ Tensor RMSprop::step(LossClosure closure)  {
 
       state.step(state.step() + 1);
 
+      if (options.foreach()) {
+        std::vector<Tensor> param_states = {square_avg};
+        if (options.momentum() > 0) {
+          param_states.push_back(state.momentum_buffer());
+        }
+        if (options.centered()) {
+          param_states.push_back(state.grad_avg());
+        }
+        if (at::native::can_use_fused_optimizer(p, grad, param_states)) {
+          auto& fused = fused_groups[p.scalar_type()];
+          fused.params.push_back(p);
+          fused.grads.push_back(grad);
+          fused.square_avgs.push_back(square_avg);
+          if (options.momentum() > 0) {
+            fused.momentum_buffers.push_back(state.momentum_buffer());
+          }
+          if (options.centered()) {
+            fused.grad_avgs.push_back(state.grad_avg());
+          }
+          continue;
+        }
+      }
+
       if (options.weight_decay() != 0) {
         grad = grad.add(p, options.weight_decay());
       }
@@ -125,6 +165,29 @@ Tensor RMSprop::step(LossClosure closure)  {
         p.addcdiv_(grad, avg, -options.lr());
       }
     }
+
+    for (auto& entry : fused_groups) {
+      auto& fused = entry.second;
+      at::native::fused_rmsprop_stub(
+          kCPU,
+          fused.params,
+          fused.grads,
+          fused.square_avgs,
+          fused.momentum_buffers,
+          fused.grad_avgs,
+          at::native::FusedRMSpropOptions{
+              options.lr(),
+              options.alpha(),
+              options.eps(),
+              options.weight_decay(),
+              options.momentum(),
+              options.centered()});
+      detail::bump_versions(
+          {fused.params,
+           fused.square_avgs,
+           fused.momentum_buffers,
+           fused.grad_avgs});
+    }
   }
   return loss;
 }
@@ -0,0 +1,204 @@
+#include <torch/optim/rowwise_adagrad.h>
+
+#include <torch/serialize/archive.h>
+#include <torch/utils.h>
+#include <torch/optim/serialize.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace torch {
+namespace optim {
+
+RowWiseAdagradOptions::RowWiseAdagradOptions(double lr) : lr_(lr) {}
+
+bool operator==(const RowWiseAdagradOptions& lhs, const RowWiseAdagradOptions& rhs) {
+  return (lhs.lr() == rhs.lr()) &&
+          (lhs.lr_decay() == rhs.lr_decay()) &&
+          (lhs.weight_decay() == rhs.weight_decay()) &&
+          (lhs.initial_accumulator_value() == rhs.initial_accumulator_value()) &&
+          (lhs.eps() == rhs.eps());
+}
+
+void RowWiseAdagradOptions::serialize(torch::serialize::OutputArchive& archive) const {
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(lr);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(lr_decay);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(weight_decay);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(initial_accumulator_value);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(eps);
+}
+
+void RowWiseAdagradOptions::serialize(torch::serialize::InputArchive& archive) {
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, lr);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, lr_decay);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, weight_decay);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, initial_accumulator_value);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, eps);
+}
+
+bool operator==(const RowWiseAdagradParamState& lhs, const RowWiseAdagradParamState& rhs) {
+  return (lhs.step() == rhs.step()) &&
+            torch::equal(lhs.sum(), rhs.sum());
+}
+
+void RowWiseAdagradParamState::serialize(torch::serialize::OutputArchive& archive) const {
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(step);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(sum);
+}
+
+void RowWiseAdagradParamState::serialize(torch::serialize::InputArchive& archive) {
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(int64_t, step);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, sum);
+}
+
+namespace {
+
+bool can_use_fused_update(const Tensor& p, const Tensor& sum, const Tensor& grad) {
+  return p.device().is_cpu() && p.is_contiguous() && sum.is_contiguous() &&
+      sum.scalar_type() == p.scalar_type() &&
+      grad.scalar_type() == p.scalar_type() &&
+      at::isFloatingType(p.scalar_type()) &&
+      (grad.is_sparse() ? grad.sparse_dim() == 1 : grad.is_contiguous());
+}
+
+// Updates the rows indices[0..num_rows) of the parameter, or the rows
+// 0..num_rows if indices is null, with the rows of grad in one pass: the mean
+// of the squared gradient of a row is added to its accumulator, then the row
+// is stepped by clr / (sqrt(accumulator) + eps).
+template <typename scalar_t>
+void rowwise_adagrad_update(
+    scalar_t* param,
+    scalar_t* sum,
+    const int64_t* indices,
+    const scalar_t* grad,
+    int64_t num_rows,
+    int64_t row_size,
+    scalar_t clr,
+    scalar_t eps) {
+  using acc_t = at::acc_type<scalar_t, /*is_cuda=*/false>;
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(row_size, 1));
+  // Rows are distinct (the gradient is coalesced), so no two threads touch
+  // the same row.
+  at::parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t row = indices ? indices[i] : i;
+      scalar_t* param_row = param + row * row_size;
+      const scalar_t* grad_row = grad + i * row_size;
+      acc_t grad_sq = 0;
+      for (int64_t j = 0; j < row_size; j++) {
+        grad_sq += static_cast<acc_t>(grad_row[j]) * grad_row[j];
+      }
+      sum[row] += static_cast<scalar_t>(grad_sq / row_size);
+      const scalar_t step = clr / (std::sqrt(sum[row]) + eps);
+      for (int64_t j = 0; j < row_size; j++) {
+        param_row[j] -= step * grad_row[j];
+      }
+    }
+  });
+}
+
+} // namespace
+
+Tensor RowWiseAdagrad::step(LossClosure closure) {
+  NoGradGuard no_grad;
+  Tensor loss = {};
+  if (closure != nullptr) {
+    at::AutoGradMode enable_grad(true);
+    loss = closure();
+  }
+  for (auto& group : param_groups_) {
+    for (auto& p : group.params()) {
+      if (!p.grad().defined()) {
+        continue;
+      }
+      auto grad = p.grad();
+      auto& options = static_cast<RowWiseAdagradOptions&>(group.options());
+      TORCH_CHECK(p.dim() >= 1, "RowWiseAdagrad does not support 0-dim parameters");
+      const int64_t num_rows = p.size(0);
+
+      // State initialization
+      auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
+      if (param_state == state_.end()) {
+        auto state = std::make_unique<RowWiseAdagradParamState>();
+        state->step(0);
+        state->sum(torch::full({num_rows}, options.initial_accumulator_value(), p.options()));
+        state_[c10::guts::to_string(p.unsafeGetTensorImpl())] = std::move(state);
+      }
+      auto& state = static_cast<RowWiseAdagradParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
+
+      state.step(state.step() + 1);
+
+      if (options.weight_decay() != 0) {
+        TORCH_CHECK(!grad.is_sparse(), "weight_decay option is not compatible with sparse gradients");
+        grad = grad.add(p, options.weight_decay());
+      }
+      const auto clr = options.lr() /
+          (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
+
+      Tensor indices;
+      Tensor values;
+      if (grad.is_sparse()) {
+        TORCH_CHECK(
+            grad.sparse_dim() == 1,
+            "RowWiseAdagrad expects sparse gradients indexed by the first dimension only, got ",
+            grad.sparse_dim(), " sparse dimensions");
+        grad = grad.coalesce();
+        indices = grad._indices()[0];
+        values = grad._values();
+      } else {
+        values = grad;
+      }
+      const int64_t grad_rows = values.size(0);
+      if (grad_rows == 0) {
+        continue;
+      }
+
+      if (can_use_fused_update(p, state.sum(), grad)) {
+        indices = indices.defined() ? indices.contiguous() : indices;
+        values = values.contiguous();
+        AT_DISPATCH_FLOATING_TYPES(p.scalar_type(), "rowwise_adagrad_update", [&] {
+          rowwise_adagrad_update<scalar_t>(
+              p.data_ptr<scalar_t>(),
+              state.sum().data_ptr<scalar_t>(),
+              indices.defined() ? indices.data_ptr<int64_t>() : nullptr,
+              values.data_ptr<scalar_t>(),
+              grad_rows,
+              values.numel() / grad_rows,
+              static_cast<scalar_t>(clr),
+              static_cast<scalar_t>(options.eps()));
+        });
+        detail::bump_versions({p, state.sum()});
+        continue;
+      }
+
+      const auto values_2d = values.reshape({grad_rows, -1});
+      const auto grad_sq = values_2d.pow(2).mean(1);
+      if (indices.defined()) {
+        state.sum().index_add_(0, indices, grad_sq);
+        const auto std = state.sum().index_select(0, indices).sqrt_().add_(options.eps());
+        p.index_add_(0, indices, (values_2d / std.unsqueeze(1)).mul_(-clr).view_as(values));
+      } else {
+        state.sum().add_(grad_sq);
+        const auto std = state.sum().sqrt().add_(options.eps());
+        p.add_((values_2d / std.unsqueeze(1)).view_as(p), -clr);
+      }
+    }
+  }
+  return loss;
+}
+
+void RowWiseAdagrad::save(serialize::OutputArchive& archive) const {
+  serialize(*this, archive);
+}
+
+void RowWiseAdagrad::load(serialize::InputArchive& archive) {
+  serialize(*this, archive);
+}
+} // namespace optim
+} // namespace torch
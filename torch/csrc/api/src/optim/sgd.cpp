@@ -8,8 +8,10 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizer.h>
 
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -52,6 +54,18 @@ void SGDParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, momentum_buffer);
 }
 
+namespace {
+
+// The parameters of a group that are updated by the multi-tensor kernel, with
+// their state, for one dtype.
+struct FusedSGDGroup {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> momentum_buffers;
+};
+
+} // namespace
+
 Tensor SGD::step(LossClosure closure)  {
   NoGradGuard no_grad;
   Tensor loss = {};
@@ -65,11 +79,31 @@ Tensor SGD::step(LossClosure closure)  {
     auto momentum = options.momentum();
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
+    std::map<ScalarType, FusedSGDGroup> fused_groups;
 
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
+      if (options.foreach()) {
+        // The momentum buffer is a copy of the first gradient, so the first
+        // step with momentum takes the per-parameter path.
+        auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
+        std::vector<Tensor> param_states;
+        if (momentum != 0 && param_state != state_.end()) {
+          param_states.push_back(static_cast<SGDParamState&>(*param_state->second).momentum_buffer());
+        }
+        if ((momentum == 0 || !param_states.empty()) &&
+            at::native::can_use_fused_optimizer(p, p.grad(), param_states)) {
+          auto& fused = fused_groups[p.scalar_type()];
+          fused.params.push_back(p);
+          fused.grads.push_back(p.grad());
+          if (momentum != 0) {
+            fused.momentum_buffers.push_back(param_states[0]);
+          }
+          continue;
+        }
+      }
       auto d_p = p.grad().data();
       if (weight_decay != 0) {
         d_p = d_p.add(p.data(), weight_decay);
@@ -94,6 +128,18 @@ Tensor SGD::step(LossClosure closure)  {
       }
       p.data().add_(d_p, -1 * options.lr());
     }
+
+    for (auto& entry : fused_groups) {
+      auto& fused = entry.second;
+      at::native::fused_sgd_stub(
+          kCPU,
+          fused.params,
+          fused.grads,
+          fused.momentum_buffers,
+          at::native::FusedSGDOptions{
+              options.lr(), momentum, dampening, weight_decay, nesterov});
+      detail::bump_versions({fused.params, fused.momentum_buffers});
+    }
   }
   return loss;
 }
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -64,12 +65,18 @@ static thread_local int worker_device = NO_DEVICE;
 // gradient checkpointing feature only.
 static thread_local bool checkpoint_valid = true;
 
+// True for the extra threads processing the CPU ReadyQueue next to the CPU
+// worker; see Note [Multiple CPU workers]
+static thread_local bool is_cpu_helper = false;
+
 // XXX: Changes to the way multithreading works in execute should be done with
 // great care. Right now the implementation guarantees that a single function's
 // apply will never be entered concurrently (even if multiple graphs are
 // executed at the same time). Adding multiple threads per-device or removing
 // engine thread affinity to the device can break this invariant, and we depend
-// on it in a few places (e.g. AccumulateGrad function).
+// on it in a few places (e.g. AccumulateGrad function). The CPU helper threads
+// break it, and AccumulateGrad locks around its grad update instead; see
+// Note [Multiple CPU workers]
 
 // Number of nested reentrant backwards calls currently on this thread
 static thread_local int current_depth = 0;
@@ -77,28 +84,29 @@ static thread_local int current_depth = 0;
 static thread_local int total_depth = 0;
 
 // Returns true when t2 should be (weakly) BEFORE t1 in the queue.
-// Shutdown tasks are first and then empty NodeTask are next.
+// Only tasks that run a Node are in the heap; shutdown and empty NodeTasks
+// are kept apart and always come first (see ReadyQueue).
+// This runs O(log n) times per push and pop while the queue lock is held, so
+// it only looks at the keys cached in the NodeTask.
 struct CompareNodeTaskTime {
   bool operator()(NodeTask const & t1, NodeTask const & t2) {
-    if (t2.isShutdownTask_) {
-      return true;
-    } else if (!t1.fn_ || t1.isShutdownTask_) {
-      return false;
-    } else if (!t2.fn_) {
-      return true;
-    } else if (t1.getReentrantDepth() == t2.getReentrantDepth()) {
-      return t1.fn_->sequence_nr() < t2.fn_->sequence_nr();
+    if (t1.reentrantDepth_ == t2.reentrantDepth_) {
+      return t1.sequenceNr_ < t2.sequenceNr_;
     } else {
-      return t1.getReentrantDepth() < t2.getReentrantDepth();
+      return t1.reentrantDepth_ < t2.reentrantDepth_;
     }
   }
 };
 
 struct ReadyQueue {
   std::priority_queue<NodeTask, std::vector<NodeTask>, CompareNodeTaskTime> heap_;
-  // To notify threads waiting on the ReadyQueue of available tasks on the heap_
+  // Shutdown tasks (at the front) and the empty tasks that wake up the owner
+  // of a reentrant backward (at the back). They are popped before heap_, and
+  // only by the thread owning the queue, so helpers never wait behind them.
+  std::deque<NodeTask> control_;
+  // To notify threads waiting on the ReadyQueue of available tasks
   std::condition_variable not_empty_;
-  // To protect read and writes to heap_
+  // To protect read and writes to heap_ and control_
   mutable std::mutex mutex_;
 
   // incrementOutstandingTasks indicates whether or not we should increment
@@ -107,8 +115,14 @@ struct ReadyQueue {
   // might set this to false.
   void push(NodeTask item, bool incrementOutstandingTasks = true);
   void pushShutdownTask();
-  NodeTask pop();
+  // CPU helper threads pass onlyFunctionTasks = true and never take shutdown
+  // or wakeup tasks, which are meant for the thread owning the queue. See
+  // Note [Multiple CPU workers]
+  NodeTask pop(bool onlyFunctionTasks = false);
   size_t size() const;
+
+  // Set once CPU helper threads wait on this queue.
+  std::atomic<bool> has_helpers_{false};
 };
 
 // Note [Reentrant backwards]
@@ -141,6 +155,33 @@ struct ReadyQueue {
 // When the GraphTask is finished, the parent worker thread that is waiting on
 // the task is notified and the current thread returns to the pool.
 
+// Note [Multiple CPU workers]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default a single thread processes the CPU ReadyQueue, so independent
+// branches of a graph run one after the other even when they are large.
+// Engine::set_num_cpu_threads(n) starts n - 1 helper threads that pop from the
+// same queue as the CPU worker and run the tasks they get exactly like it
+// does. They differ from the CPU worker in a few ways:
+//
+//  - A helper only takes tasks that run a Node. Shutdown tasks and the empty
+//    tasks used to wake up the owner of a reentrant backward are left for the
+//    CPU worker, since a helper is never the owner of a GraphTask: a backward
+//    called from a helper blocks on the GraphTask's future like a call from a
+//    user thread does. Pushing an empty task wakes up every waiting thread so
+//    that the CPU worker is among them.
+//
+//  - Nodes are no longer guaranteed to be applied by a single thread. The
+//    only Node relying on it is AccumulateGrad, which holds a per-Node mutex
+//    around the update of the variable's grad. The mutex is not held while
+//    hooks run, so a reentrant backward inside a hook cannot deadlock on it.
+//
+// Helpers are detached and, like the device threads, live until the process
+// exits. The queue is a mutex-protected heap of Node tasks next to a deque of
+// shutdown and wakeup tasks that helpers do not look at. Pushes do the
+// GraphTask bookkeeping before taking the lock, and comparisons use keys
+// cached in the NodeTask, so the critical sections only cover the heap
+// operation.
+
 // Note [Streaming backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // On CUDA devices the autograd engine's device operations are run on the
@@ -188,37 +229,63 @@ bool graph_task_completed(const std::shared_ptr<GraphTask>& graph_task) {
 }
 
 auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
+  if (incrementOutstandingTasks) {
+    // outstanding_tasks_ is atomic, and the increment is visible to whoever
+    // pops the task since they go through mutex_ below.
+    std::shared_ptr<GraphTask> graph_task = item.base_.lock();
+    TORCH_INTERNAL_ASSERT(graph_task, "GraphTask is no longer valid!");
+    ++graph_task->outstanding_tasks_;
+  }
+  // With helpers waiting, notify_one could wake a helper that ignores the
+  // task; see Note [Multiple CPU workers]
+  const bool is_control = !item.fn_;
+  const bool notify_all = is_control && has_helpers_.load();
   {
     // Lock mutex for writing to heap_
     std::lock_guard<std::mutex> lock(mutex_);
-    if (incrementOutstandingTasks) {
-      std::shared_ptr<GraphTask> graph_task = item.base_.lock();
-      TORCH_INTERNAL_ASSERT(graph_task, "GraphTask is no longer valid!");
-      ++graph_task->outstanding_tasks_;
+    if (is_control) {
+      control_.push_back(std::move(item));
+    } else {
+      heap_.push(std::move(item));
     }
-    heap_.push(std::move(item));
   }
-  not_empty_.notify_one();
+  if (notify_all) {
+    not_empty_.notify_all();
+  } else {
+    not_empty_.notify_one();
+  }
 }
 
 auto ReadyQueue::pushShutdownTask() -> void {
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    heap_.push(NodeTask({}, nullptr, InputBuffer(0), true));
+    control_.push_front(NodeTask({}, nullptr, InputBuffer(0), true));
+  }
+  if (has_helpers_.load()) {
+    not_empty_.notify_all();
+  } else {
+    not_empty_.notify_one();
   }
-  not_empty_.notify_one();
 }
 
 size_t ReadyQueue::size() const {
   // Lock mutex for accesses to heap_
   std::unique_lock<std::mutex> lock(mutex_);
-  return heap_.size();
+  return heap_.size() + control_.size();
 }
 
-auto ReadyQueue::pop() -> NodeTask {
+auto ReadyQueue::pop(bool onlyFunctionTasks) -> NodeTask {
   // Lock mutex for accesses to heap_
   std::unique_lock<std::mutex> lock(mutex_);
-  not_empty_.wait(lock, [this]{ return !heap_.empty(); });
+  const bool take_control = !onlyFunctionTasks;
+  not_empty_.wait(lock, [this, take_control] {
+    return !heap_.empty() || (take_control && !control_.empty());
+  });
+  if (take_control && !control_.empty()) {
+    auto task = std::move(control_.front());
+    control_.pop_front();
+    return task;
+  }
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
   return task;
@@ -234,7 +301,7 @@ Engine::~Engine() {
   bool noBackward = true;
   for (auto& queue: ready_queues_) {
     std::lock_guard<std::mutex> lock(queue->mutex_);
-    noBackward =  noBackward && queue->heap_.empty();
+    noBackward =  noBackward && queue->heap_.empty() && queue->control_.empty();
   }
   if (noBackward) {
     for (auto& queue : ready_queues_) {
@@ -321,7 +388,7 @@ auto Engine::thread_main(
       // Scope this block of execution since NodeTask is not needed after this
       // block and can be deallocated (release any references to grad tensors
       // as part of inputs_).
-      NodeTask task = queue->pop();
+      NodeTask task = queue->pop(/* onlyFunctionTasks */ is_cpu_helper);
       // This will only work if the worker is running a non backward task
       // TODO Needs to be fixed this to work in all cases
       if (task.isShutdownTask_) {
@@ -363,9 +430,10 @@ auto Engine::thread_main(
     // graph_task->outstanding_tasks_ == 0 before it gets to the task, but
     // it's a no-op anyway.
     // This is not necessary if the owning thread is not a device thread or the
-    // current thread is the owning thread.
-    if (base_owner != NO_DEVICE && base_owner != worker_device &&
-        gt_completed) {
+    // current thread is the owning thread. CPU helpers share worker_device
+    // with the CPU worker but never own a GraphTask.
+    if (base_owner != NO_DEVICE &&
+        (base_owner != worker_device || is_cpu_helper) && gt_completed) {
       // Synchronize outstanding_tasks_ with queue mutex
       std::atomic_thread_fence(std::memory_order_release);
       ready_queue_by_index(base_owner)
@@ -374,6 +442,13 @@ auto Engine::thread_main(
   }
 }
 
+void Engine::cpu_helper_thread_init() {
+  is_cpu_helper = true;
+  // Goes through the virtual thread_init so that subclasses (e.g. the
+  // PythonEngine) set helpers up like their CPU worker.
+  thread_init(-1);
+}
+
 void Engine::reentrant_thread_init() {
   at::init_num_threads();
   auto tp_shared= thread_pool_shared_;
@@ -766,8 +841,9 @@ std::shared_ptr<FutureVariableList> Engine::execute_with_graph_task(
   ready_queue(at::kCPU).push(
       NodeTask(graph_task, std::move(graph_root), InputBuffer(0)));
 
-  // Not a worker
-  if (worker_device == NO_DEVICE) {
+  // Not a worker. CPU helpers wait like non-workers, see
+  // Note [Multiple CPU workers]
+  if (worker_device == NO_DEVICE || is_cpu_helper) {
     // graph_task_exec_post_processing is done when the Future is marked as
     // completed in mark_graph_task_completed.
     return graph_task->future_result_;
@@ -895,6 +971,29 @@ size_t Engine::ready_queue_size(at::Device device) {
   return ready_queue(device).size();
 }
 
+void Engine::set_num_cpu_threads(int num_threads) {
+  TORCH_CHECK(
+      num_threads >= 1,
+      "Number of autograd CPU threads must be positive, got ", num_threads);
+  initialize_threads_pool();
+  std::lock_guard<std::mutex> lock(cpu_helpers_mutex_);
+  const int num_helpers = num_threads - 1;
+  const int num_started = num_cpu_helpers_;
+  TORCH_CHECK(
+      num_helpers >= num_started,
+      "Cannot decrease the number of autograd CPU threads from ",
+      num_started + 1, " to ", num_threads);
+  if (num_helpers == num_started) {
+    return;
+  }
+  ready_queue(at::kCPU).has_helpers_ = true;
+  num_cpu_helpers_ = num_helpers;
+  for (int i = num_started; i < num_helpers; ++i) {
+    std::thread t(&Engine::cpu_helper_thread_init, this);
+    t.detach();
+  }
+}
+
 auto Engine::ready_queue(at::Device device) -> ReadyQueue& {
   // See Note [Allocating GPUs to autograd threads]
   if (device.type() == at::kCPU) {
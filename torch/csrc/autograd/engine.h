@@ -11,10 +11,12 @@
 #include <torch/csrc/autograd/input_buffer.h>
 #include <torch/csrc/utils/future.h>
 
+#include <atomic>
 #include <deque>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <utility>
@@ -140,6 +142,11 @@ struct NodeTask {
   // When worker receives a task with isShutdownTask = true, it will immediately
   // exit. The engine sends a shutdown task to every queue upon its destruction.
   bool isShutdownTask_;
+  // Ordering keys of the ReadyQueue, captured when the task is created so
+  // that the comparisons done while holding the queue lock neither lock
+  // base_ nor dereference fn_.
+  int reentrantDepth_;
+  uint64_t sequenceNr_;
 
   int getReentrantDepth() const;
 
@@ -151,7 +158,9 @@ struct NodeTask {
       : base_(base),
         fn_(std::move(fn)),
         inputs_(std::move(inputs)),
-        isShutdownTask_(isShutdownTask) {}
+        isShutdownTask_(isShutdownTask),
+        reentrantDepth_(getReentrantDepth()),
+        sequenceNr_(fn_ ? fn_->sequence_nr() : 0) {}
 };
 
 // A single instance of this struct should be created through the whole process lifetime.
@@ -209,6 +218,12 @@ struct TORCH_API Engine {
 
   size_t ready_queue_size(at::Device device);
 
+  // Sets the number of threads processing CPU nodes (1 by default). The extra
+  // threads take nodes from the same CPU ReadyQueue as the CPU worker, so
+  // independent branches of the graph run in parallel. The number can only
+  // be increased. See Note [Multiple CPU workers].
+  void set_num_cpu_threads(int num_threads);
+
  protected:
   Engine();
   void compute_dependencies(Node* root, GraphTask& task);
@@ -228,6 +243,7 @@ struct TORCH_API Engine {
       const std::shared_ptr<GraphTask>& task,
       bool reentrant_thread);
   void reentrant_thread_init();
+  void cpu_helper_thread_init();
   void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
   void set_device(int device);
   void initialize_threads_pool();
@@ -241,6 +257,10 @@ struct TORCH_API Engine {
   std::mutex post_callbacks_lock_;
   // How many nested reentrant calls are allowed until a new thread is used
   int max_recursion_depth_;
+  // Number of CPU helper threads started so far, guarded by
+  // cpu_helpers_mutex_. See Note [Multiple CPU workers]
+  int num_cpu_helpers_ = 0;
+  std::mutex cpu_helpers_mutex_;
 
   struct ThreadPoolShared {
     // Data structures used by the threads for executing reentrant backwards
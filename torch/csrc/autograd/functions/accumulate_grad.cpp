@@ -23,7 +23,6 @@ AccumulateGrad::AccumulateGrad(Variable variable_)
 }
 
 auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
-  // XXX: this method is not thread-safe!
   check_input_variables("AccumulateGrad", grads, 1, 0);
 
   if (!grads[0].defined())
@@ -34,6 +33,14 @@ auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
   if (!variable.requires_grad())
     return {};
 
+  at::Tensor new_grad = std::move(grads[0]);
+  // Hooks run without the lock, so that they can run a reentrant backward
+  // that accumulates into this variable.
+  for (auto& hook : impl::hooks(variable)) {
+    new_grad = (*hook)({new_grad})[0];
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
   at::Tensor& grad = variable.grad();
   // If the function has post hooks (for example, a DDP allreduce hook),
   // call_function in Engine.cpp will temporarily bump the expected refcount
@@ -41,10 +48,9 @@ auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
   // in addition to the one reference that we're holding.
   // 'num_expected_refs' is used to determine whether or not we should clone
   // the grad or can steal the grad.
-  accumulateGradAndCallHooks(
-      variable,
+  accumulateGrad(
       grad,
-      std::move(grads[0]),
+      std::move(new_grad),
       1 + !post_hooks().empty() /* num_expected_refs */,
       [&grad](at::Tensor&& grad_update) { grad = std::move(grad_update); });
 
@@ -4,6 +4,8 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/WindowsTorchApiMacro.h>
 
+#include <mutex>
+
 namespace torch { namespace autograd {
 
 struct TORCH_API AccumulateGrad : public Node {
@@ -35,7 +37,18 @@ struct TORCH_API AccumulateGrad : public Node {
     for (auto& hook : impl::hooks(variable)) {
       new_grad = (*hook)({new_grad})[0];
     }
+    accumulateGrad(
+        variable_grad, std::move(new_grad), num_expected_refs, update_grad);
+  }
 
+  // Accumulates new_grad into variable_grad like accumulateGradAndCallHooks,
+  // without calling the variable's hooks.
+  template <typename T>
+  static void accumulateGrad(
+      at::Tensor& variable_grad,
+      at::Tensor new_grad,
+      size_t num_expected_refs,
+      const T& update_grad) {
     if (!variable_grad.defined()) {
       // under following condition, we can avoid clone()
       if (!GradMode::is_enabled() && !new_grad.is_sparse() &&
@@ -110,6 +123,11 @@ struct TORCH_API AccumulateGrad : public Node {
   }
 
   Variable variable;
+
+ private:
+  // Serializes the grad updates of concurrent applies, which only happen when
+  // the engine has CPU helper threads; see Note [Multiple CPU workers]
+  std::mutex mutex_;
 };
 
 } // namespace autograd
@@ -4,6 +4,7 @@
 #include <torch/csrc/utils/pybind.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/autograd/profiler_stream.h>
 #include <torch/csrc/autograd/python_function.h>
 #include <torch/csrc/autograd/function.h>
 
@@ -52,6 +53,23 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
   m.def("_disable_profiler", disableProfiler);
   m.def("_profiler_enabled", profilerEnabled);
 
+  m.def(
+      "_enable_streaming_profiler",
+      [](std::string path, size_t ring_size, int64_t flush_interval_ms) {
+        StreamingProfilerConfig config(std::move(path));
+        config.ring_size = ring_size;
+        config.flush_interval_ms = flush_interval_ms;
+        enableStreamingProfiler(std::move(config));
+      },
+      py::arg("path"),
+      py::arg("ring_size") = 1 << 16,
+      py::arg("flush_interval_ms") = 100);
+  m.def("_disable_streaming_profiler", []() {
+    auto stats = disableStreamingProfiler();
+    return std::make_pair(stats.events_written, stats.events_dropped);
+  });
+  m.def("_streaming_profiler_enabled", streamingProfilerEnabled);
+
   m.def("_push_range", [](std::string name) { pushRange(std::move(name)); });
   m.def("_pop_range", []() { popRange(); });
   m.def("_run_before_callbacks", runBeforeCallbacks);
@@ -1,4 +1,5 @@
 #include <torch/csrc/autograd/profiler.h>
+#include <torch/csrc/autograd/profiler_stream.h>
 #include <torch/csrc/jit/frontend/code_template.h>
 
 #include <fstream>
@@ -136,6 +137,9 @@ void enableProfiler(ProfilerConfig config) {
   if (state != ProfilerState::Disabled && new_state != state) {
     throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
   }
+  TORCH_CHECK(
+      !streamingProfilerEnabled(),
+      "the profiler cannot be enabled while the streaming profiler is running");
 
   pushCallback(
       [config](const RecordFunction& fn) {
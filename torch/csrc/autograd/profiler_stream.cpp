@@ -0,0 +1,373 @@
+#include <torch/csrc/autograd/profiler_stream.h>
+
+#include <c10/util/string_view.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace autograd { namespace profiler {
+
+namespace detail {
+
+TraceEventRing::TraceEventRing(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity) {
+    size *= 2;
+  }
+  // Touch every slot now so that recording does not fault pages in.
+  events_.resize(size);
+  mask_ = size - 1;
+}
+
+} // namespace detail
+
+namespace {
+
+using detail::TraceEvent;
+using detail::TraceEventKind;
+using detail::TraceEventRing;
+
+struct NameHash {
+  size_t operator()(c10::string_view name) const {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+// A thread's ring and the state only that thread touches.
+struct ThreadRing {
+  ThreadRing(size_t capacity, uint16_t thread_id)
+      : ring(capacity), thread_id(thread_id) {}
+
+  TraceEventRing ring;
+  uint16_t thread_id;
+  // Recorded begin events whose end has not been recorded yet. A free slot is
+  // kept for each of them. Ranges that end on another thread release their
+  // slot from there. The ring is kept alive while any are open.
+  std::atomic<size_t> open_ranges{0};
+  // The ranges that began on this thread and have not ended, innermost last,
+  // with whether their begin event was recorded. A range ending on this
+  // thread is normally the last one; ranges ending on another thread are
+  // looked up and removed from there, hence the mutex.
+  std::mutex open_mutex;
+  std::vector<std::pair<const RecordFunction*, bool>> open;
+  // Read by the writer for the stats.
+  std::atomic<uint64_t> dropped{0};
+  // Caches of the session name table, to intern without taking its lock.
+  // Names that are not owned by their StringView are string literals, so
+  // their address identifies them.
+  std::unordered_map<const char*, uint32_t> static_names;
+  std::unordered_map<c10::string_view, uint32_t, NameHash> owned_names;
+};
+
+struct Session {
+  explicit Session(StreamingProfilerConfig config)
+      : config(std::move(config)),
+        out(this->config.path, std::ofstream::out | std::ofstream::trunc),
+        start_ns(getTime()) {}
+
+  StreamingProfilerConfig config;
+  std::ofstream out;
+  int64_t start_ns;
+
+  std::mutex rings_mutex;
+  std::vector<std::shared_ptr<ThreadRing>> rings;
+  // Dropped events of the rings of threads that have exited.
+  uint64_t retired_dropped = 0;
+
+  // Interned names. A deque, so that the strings never move and the thread
+  // caches can point into them.
+  std::mutex names_mutex;
+  std::deque<std::string> names;
+  std::unordered_map<c10::string_view, uint32_t, NameHash> name_ids;
+
+  // Owned by the writer thread.
+  std::vector<std::string> writer_names;
+  uint64_t written = 0;
+
+  std::mutex writer_mutex;
+  std::condition_variable writer_cv;
+  bool stop = false;
+  std::thread writer;
+};
+
+// Owned by enableStreamingProfiler and disableStreamingProfiler, and read
+// from any thread by streamingProfilerEnabled.
+std::atomic<Session*> session{nullptr};
+// Bumped for every session, so that threads notice that their ring belongs to
+// a previous one.
+std::atomic<uint64_t> session_generation{0};
+thread_local std::shared_ptr<ThreadRing> thread_ring;
+thread_local uint64_t thread_ring_generation = 0;
+
+ThreadRing& getThreadRing(Session& s) {
+  const auto generation = session_generation.load(std::memory_order_acquire);
+  if (!thread_ring || thread_ring_generation != generation) {
+    thread_ring = std::make_shared<ThreadRing>(
+        s.config.ring_size, RecordFunction::getCurrentThreadId());
+    thread_ring_generation = generation;
+    std::lock_guard<std::mutex> guard(s.rings_mutex);
+    s.rings.push_back(thread_ring);
+  }
+  return *thread_ring;
+}
+
+uint32_t internSlow(Session& s, c10::string_view name) {
+  std::lock_guard<std::mutex> guard(s.names_mutex);
+  auto it = s.name_ids.find(name);
+  if (it != s.name_ids.end()) {
+    return it->second;
+  }
+  s.names.emplace_back(name.data(), name.size());
+  const auto id = static_cast<uint32_t>(s.names.size() - 1);
+  s.name_ids.emplace(s.names.back(), id);
+  return id;
+}
+
+uint32_t intern(Session& s, ThreadRing& r, const StringView& name) {
+  if (!name.owned()) {
+    auto it = r.static_names.find(name.str());
+    if (it != r.static_names.end()) {
+      return it->second;
+    }
+    const auto id = internSlow(s, name.str());
+    r.static_names.emplace(name.str(), id);
+    return id;
+  }
+  c10::string_view view(name.str());
+  auto it = r.owned_names.find(view);
+  if (it != r.owned_names.end()) {
+    return it->second;
+  }
+  const auto id = internSlow(s, view);
+  std::lock_guard<std::mutex> guard(s.names_mutex);
+  r.owned_names.emplace(s.names[id], id);
+  return id;
+}
+
+void recordBegin(Session& s, const RecordFunction& fn) {
+  auto& r = getThreadRing(s);
+  const auto open_ranges = r.open_ranges.load(std::memory_order_relaxed);
+  const bool recorded = r.ring.available() >= open_ranges + 2;
+  {
+    std::lock_guard<std::mutex> guard(r.open_mutex);
+    r.open.emplace_back(&fn, recorded);
+  }
+  if (!recorded) {
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const auto name_id = intern(s, r, fn.name());
+  r.ring.push({getTime(), name_id, r.thread_id, TraceEventKind::Begin});
+  r.open_ranges.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Removes fn from the ranges open in r and tells whether its begin event was
+// recorded. Returns false if the range did not begin in r, e.g. because it
+// began before this session.
+bool takeOpenRange(ThreadRing& r, const RecordFunction& fn, bool& recorded) {
+  std::lock_guard<std::mutex> guard(r.open_mutex);
+  for (auto it = r.open.rbegin(); it != r.open.rend(); ++it) {
+    if (it->first == &fn) {
+      recorded = it->second;
+      r.open.erase(std::next(it).base());
+      return true;
+    }
+  }
+  return false;
+}
+
+void recordEnd(Session& s, const RecordFunction& fn) {
+  auto& r = getThreadRing(s);
+  const auto begin_thread_id = fn.getStartCallbacksThreadId();
+  bool recorded = false;
+  if (begin_thread_id == r.thread_id) {
+    if (!takeOpenRange(r, fn, recorded)) {
+      return;
+    }
+    if (!recorded) {
+      r.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    r.open_ranges.fetch_sub(1, std::memory_order_relaxed);
+    r.ring.push({getTime(), 0, r.thread_id, TraceEventKind::End});
+    return;
+  }
+  // The range began on another thread. Its slot there is released, and it is
+  // closed from this thread's ring, with the other thread's id, if there is a
+  // slot to spare. Holding the other ring keeps the writer from retiring it
+  // in the meantime.
+  std::shared_ptr<ThreadRing> begin_ring;
+  {
+    std::lock_guard<std::mutex> guard(s.rings_mutex);
+    for (const auto& ring : s.rings) {
+      if (ring->thread_id == begin_thread_id) {
+        begin_ring = ring;
+        break;
+      }
+    }
+  }
+  if (!begin_ring || !takeOpenRange(*begin_ring, fn, recorded)) {
+    return;
+  }
+  if (!recorded) {
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  begin_ring->open_ranges.fetch_sub(1, std::memory_order_release);
+  if (r.ring.available() > r.open_ranges.load(std::memory_order_relaxed)) {
+    r.ring.push({getTime(), 0, begin_thread_id, TraceEventKind::End});
+  } else {
+    r.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void writeEscaped(std::ostream& out, const std::string& str) {
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << ' ';
+    } else {
+      out << c;
+    }
+  }
+}
+
+void writeEvent(Session& s, const TraceEvent& e) {
+  auto& out = s.out;
+  if (s.written > 0) {
+    out << ",\n";
+  }
+  out << "{";
+  if (e.kind == TraceEventKind::Begin) {
+    if (e.name_id >= s.writer_names.size()) {
+      std::lock_guard<std::mutex> guard(s.names_mutex);
+      s.writer_names.insert(
+          s.writer_names.end(),
+          s.names.begin() + s.writer_names.size(),
+          s.names.end());
+    }
+    out << "\"name\": \"";
+    writeEscaped(out, s.writer_names[e.name_id]);
+    out << "\", \"ph\": \"B\"";
+  } else {
+    out << "\"ph\": \"E\"";
+  }
+  out << ", \"ts\": " << (e.time_ns - s.start_ns) / 1000.0
+      << ", \"pid\": 0, \"tid\": " << e.thread_id << "}";
+  s.written++;
+}
+
+// Drains every ring into the file. Called from the writer thread only.
+void flush(Session& s) {
+  {
+    std::lock_guard<std::mutex> guard(s.rings_mutex);
+    for (auto it = s.rings.begin(); it != s.rings.end();) {
+      auto& r = **it;
+      r.ring.drain([&](const TraceEvent& e) { writeEvent(s, e); });
+      // The thread that owned the ring has exited, so it cannot record
+      // anything else, and no range that began in it is still open.
+      if (it->use_count() == 1 &&
+          r.open_ranges.load(std::memory_order_acquire) == 0) {
+        s.retired_dropped += r.dropped.load(std::memory_order_relaxed);
+        it = s.rings.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  s.out.flush();
+}
+
+void writerLoop(Session& s) {
+  std::unique_lock<std::mutex> lock(s.writer_mutex);
+  while (!s.stop) {
+    s.writer_cv.wait_for(
+        lock, std::chrono::milliseconds(s.config.flush_interval_ms), [&] {
+          return s.stop;
+        });
+    flush(s);
+  }
+}
+
+} // namespace
+
+void enableStreamingProfiler(StreamingProfilerConfig config) {
+  TORCH_CHECK(!session.load(), "the streaming profiler is already enabled");
+  TORCH_CHECK(
+      !profilerEnabled(),
+      "the streaming profiler cannot be enabled while the profiler is running");
+  TORCH_CHECK(config.ring_size > 0, "ring_size must be positive");
+  TORCH_CHECK(
+      config.flush_interval_ms > 0, "flush_interval_ms must be positive");
+
+  auto s = std::make_unique<Session>(std::move(config));
+  TORCH_CHECK(s->out, "could not open file ", s->config.path);
+  s->out.precision(3);
+  s->out << std::fixed << "[\n";
+  session_generation.fetch_add(1, std::memory_order_release);
+
+  Session* raw = s.get();
+  pushCallback(
+      [raw](const RecordFunction& fn) { recordBegin(*raw, fn); },
+      [raw](const RecordFunction& fn) { recordEnd(*raw, fn); });
+  raw->writer = std::thread([raw] { writerLoop(*raw); });
+  session.store(s.release());
+}
+
+StreamingProfilerStats disableStreamingProfiler() {
+  TORCH_CHECK(
+      session.load(),
+      "can't disable the streaming profiler when it's not running");
+  popCallback();
+
+  std::unique_ptr<Session> s(session.exchange(nullptr));
+  {
+    std::lock_guard<std::mutex> guard(s->writer_mutex);
+    s->stop = true;
+  }
+  s->writer_cv.notify_one();
+  // The writer flushes once more after it is told to stop.
+  s->writer.join();
+  s->out << "\n]\n";
+  s->out.close();
+
+  StreamingProfilerStats stats;
+  stats.events_written = s->written;
+  stats.events_dropped = s->retired_dropped;
+  for (const auto& r : s->rings) {
+    stats.events_dropped += r->dropped.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+bool streamingProfilerEnabled() {
+  return session.load() != nullptr;
+}
+
+RecordStreamingProfile::RecordStreamingProfile(StreamingProfilerConfig config) {
+  enableStreamingProfiler(std::move(config));
+}
+
+RecordStreamingProfile::RecordStreamingProfile(const std::string& filename)
+    : RecordStreamingProfile(StreamingProfilerConfig(filename)) {}
+
+RecordStreamingProfile::~RecordStreamingProfile() {
+  stats_ = disableStreamingProfiler();
+}
+
+}}} // namespace torch::autograd::profiler
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/profiler.h>
+
+namespace torch { namespace autograd { namespace profiler {
+
+// Streaming profiler
+// ==================
+//
+// A CPU profiler mode meant to stay enabled for a long time. Unlike
+// enableProfiler(), which keeps every event in memory until disableProfiler(),
+// it writes the trace to a file in the Chrome trace format
+// (chrome://tracing) while the program runs, using a bounded amount of memory.
+//
+// Each thread records into its own preallocated ring buffer of fixed size
+// TraceEvents. Only the recording thread writes to a ring and only the writer
+// thread reads from it, so pushing an event takes no lock. Names are
+// interned: an event stores a 32-bit id, and the string is looked up when the
+// event is written out. Only the first occurrence of a name on a thread
+// allocates. The writer thread drains all rings every flush_interval_ms and
+// appends them to the file.
+//
+// If a ring is full, new ranges on that thread are dropped (and counted) until
+// the writer catches up. Every recorded begin event has a slot reserved for
+// its end event, so the trace stays balanced. A range that ends on another
+// thread (e.g. an async op) releases the slot in the ring it began in and
+// records its end in the ring of the ending thread, if that one has room. The
+// ranges open on a thread are kept next to its ring, under a mutex that only
+// such ranges contend on.
+struct TORCH_API StreamingProfilerConfig {
+  explicit StreamingProfilerConfig(std::string path) : path(std::move(path)) {}
+  // File the trace is written to. It is truncated.
+  std::string path;
+  // Capacity of each per-thread ring, in events. Rounded up to a power of two.
+  size_t ring_size = 1 << 16;
+  // How often the writer thread drains the rings.
+  int64_t flush_interval_ms = 100;
+};
+
+struct TORCH_API StreamingProfilerStats {
+  uint64_t events_written = 0;
+  uint64_t events_dropped = 0;
+};
+
+// NOTE: like enableProfiler(), these are **NOT THREAD SAFE** with respect to
+// code that runs RecordFunctions. The streaming and the regular profiler
+// cannot be enabled at the same time.
+TORCH_API void enableStreamingProfiler(StreamingProfilerConfig config);
+TORCH_API StreamingProfilerStats disableStreamingProfiler();
+TORCH_API bool streamingProfilerEnabled();
+
+// Usage:
+//   {
+//     RecordStreamingProfile guard("filename.trace");
+//     // code you want to profile
+//   }
+// Then open filename.trace in chrome://tracing. The file can also be opened
+// while the guard is alive; the trace is complete up to the last flush.
+struct TORCH_API RecordStreamingProfile {
+  explicit RecordStreamingProfile(StreamingProfilerConfig config);
+  explicit RecordStreamingProfile(const std::string& filename);
+  ~RecordStreamingProfile();
+
+  const StreamingProfilerStats& stats() const {
+    return stats_;
+  }
+
+ private:
+  StreamingProfilerStats stats_;
+};
+
+namespace detail {
+
+enum class TraceEventKind : uint16_t {
+  Begin,
+  End,
+};
+
+struct TraceEvent {
+  int64_t time_ns;
+  uint32_t name_id;
+  uint16_t thread_id;
+  TraceEventKind kind;
+};
+
+// Single producer, single consumer ring of TraceEvents.
+class TORCH_API TraceEventRing {
+ public:
+  explicit TraceEventRing(size_t capacity);
+
+  size_t capacity() const {
+    return events_.size();
+  }
+
+  // Number of free slots, as seen by the producer.
+  size_t available() const {
+    return capacity() -
+        static_cast<size_t>(head_.load(std::memory_order_relaxed) -
+                            tail_.load(std::memory_order_acquire));
+  }
+
+  // Producer side. The caller checks available() first.
+  void push(const TraceEvent& event) {
+    const auto head = head_.load(std::memory_order_relaxed);
+    events_[head & mask_] = event;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  // Consumer side. Calls fn on every event recorded so far, in order, and
+  // frees their slots.
+  template <typename F>
+  size_t drain(F fn) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    const auto head = head_.load(std::memory_order_acquire);
+    for (auto i = tail; i != head; i++) {
+      fn(events_[i & mask_]);
+    }
+    tail_.store(head, std::memory_order_release);
+    return static_cast<size_t>(head - tail);
+  }
+
+ private:
+  std::vector<TraceEvent> events_;
+  uint64_t mask_;
+  // The indices are on separate cache lines, so that the producer and the
+  // consumer do not invalidate each other's line on every event.
+  char pad0_[64];
+  // Written by the producer only.
+  std::atomic<uint64_t> head_{0};
+  char pad1_[64];
+  // Written by the consumer only.
+  std::atomic<uint64_t> tail_{0};
+};
+
+} // namespace detail
+
+}}} // namespace torch::autograd::profiler
@@ -22,6 +22,12 @@ struct TORCH_API StringView {
     return str_ptr_;
   }
 
+  // Whether the string is owned by this StringView, as opposed to being a
+  // string literal.
+  inline bool owned() const {
+    return owned_str_ptr_ != nullptr;
+  }
+
   friend std::ostream& operator<<(std::ostream& os, const StringView& dt) {
     os << dt.str();
     return os;
@@ -0,0 +1,234 @@
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include <ATen/CPUGenerator.h>
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/utils/memory.h>
+
+namespace c10d {
+namespace {
+
+using FuturePtr = c10::intrusive_ptr<c10::ivalue::Future>;
+
+// Returns a future that completes with the result of `then` once every work
+// in `works` has finished. Waiting happens on the inter-op thread pool, so
+// the autograd thread can keep computing gradients for the next buckets.
+FuturePtr completeAfter(
+    std::vector<std::shared_ptr<ProcessGroup::Work>> works,
+    std::function<std::vector<at::Tensor>()> then) {
+  auto future = c10::make_intrusive<c10::ivalue::Future>(
+      c10::ListType::ofTensors());
+  at::launch([works = std::move(works), then = std::move(then), future] {
+    try {
+      for (auto& work : works) {
+        work->wait();
+      }
+      future->markCompleted(c10::IValue(then()));
+    } catch (const std::exception& e) {
+      future->markCompleted(
+          c10::ivalue::Future::FutureError(std::string(e.what())));
+    }
+  });
+  return future;
+}
+
+const at::Tensor& singleReplica(const GradBucket& bucket, const char* hook) {
+  TORCH_CHECK(
+      bucket.getTensors().size() == 1,
+      hook,
+      " only supports a single model replica per process.");
+  return bucket.getTensors().front();
+}
+
+// Allgathers `input` and returns the tensors of all processes.
+std::pair<std::shared_ptr<ProcessGroup::Work>, std::vector<at::Tensor>>
+allgather(ProcessGroup& process_group, const at::Tensor& input) {
+  std::vector<std::vector<at::Tensor>> outputs(1);
+  for (int i = 0; i < process_group.getSize(); i++) {
+    outputs[0].push_back(at::empty_like(input));
+  }
+  std::vector<at::Tensor> inputs = {input};
+  auto work = process_group.allgather(outputs, inputs);
+  return {std::move(work), std::move(outputs[0])};
+}
+
+// Reinterprets the bits of a 16-bit tensor as another 16-bit dtype.
+at::Tensor reinterpret16(const at::Tensor& tensor, at::ScalarType dtype) {
+  TORCH_INTERNAL_ASSERT(
+      tensor.is_contiguous() && tensor.element_size() == 2 &&
+      at::elementSize(dtype) == 2);
+  return at::from_blob(
+      tensor.data_ptr(),
+      tensor.sizes(),
+      [tensor](void*) {},
+      tensor.options().dtype(dtype));
+}
+
+// Orthonormalizes the columns of `matrix` in place (Gram-Schmidt).
+void orthogonalize(at::Tensor& matrix) {
+  const auto columns = matrix.size(1);
+  for (int64_t i = 0; i < columns; i++) {
+    auto column = matrix.narrow(1, i, 1);
+    for (int64_t j = 0; j < i; j++) {
+      auto previous = matrix.narrow(1, j, 1);
+      column.sub_(previous * (column * previous).sum());
+    }
+    column.div_(column.norm().add_(1e-8));
+  }
+}
+
+} // namespace
+
+FuturePtr FP16CompressHook::runHook(const GradBucket& bucket) {
+  std::vector<at::Tensor> compressed;
+  for (const auto& tensor : bucket.getTensors()) {
+    compressed.push_back(tensor.to(at::kHalf));
+  }
+  auto work = process_group_->allreduce(compressed);
+  auto tensors = bucket.getTensors();
+  return completeAfter({std::move(work)}, [compressed, tensors] {
+    for (size_t i = 0; i < tensors.size(); i++) {
+      tensors[i].copy_(compressed[i]);
+    }
+    return tensors;
+  });
+}
+
+FuturePtr BF16CompressHook::runHook(const GradBucket& bucket) {
+  const auto& tensor = singleReplica(bucket, "BF16CompressHook");
+  auto compressed = tensor.to(at::kBFloat16);
+  auto gathered =
+      allgather(*process_group_, reinterpret16(compressed, at::kHalf));
+  auto outputs = std::move(gathered.second);
+  return completeAfter({std::move(gathered.first)}, [tensor, outputs] {
+    tensor.zero_();
+    for (const auto& output : outputs) {
+      tensor.add_(reinterpret16(output, at::kBFloat16).to(tensor.dtype()));
+    }
+    return std::vector<at::Tensor>{tensor};
+  });
+}
+
+PowerSGDHook::PowerSGDHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    int64_t matrix_approximation_rank)
+    : process_group_(std::move(process_group)),
+      matrix_approximation_rank_(matrix_approximation_rank) {
+  TORCH_CHECK(
+      matrix_approximation_rank_ > 0,
+      "PowerSGD matrix approximation rank must be positive.");
+}
+
+FuturePtr PowerSGDHook::runHook(const GradBucket& bucket) {
+  const auto& tensor = singleReplica(bucket, "PowerSGDHook");
+  const auto numel = tensor.numel();
+  const auto rows =
+      static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(numel))));
+  const auto cols = (numel + rows - 1) / rows;
+  const auto rank = matrix_approximation_rank_;
+
+  // Buckets too small to compress are allreduced as they are.
+  if (rank * (rows + cols) >= numel) {
+    std::vector<at::Tensor> tensors = {tensor};
+    auto work = process_group_->allreduce(tensors);
+    return completeAfter({std::move(work)}, [tensors] { return tensors; });
+  }
+
+  auto& state = state_[bucket.getIndex()];
+  if (!state.error.defined() || state.error.numel() != numel) {
+    state.error = at::zeros_like(tensor);
+    // Q must start out identical on every process.
+    auto generator = at::detail::createCPUGenerator(bucket.getIndex());
+    state.q = at::randn(
+                  {cols, rank},
+                  generator.get(),
+                  tensor.options().device(at::kCPU))
+                  .to(tensor.device());
+  }
+
+  // M = bucket + error, zero padded to rows * cols entries.
+  auto padded = at::zeros({rows * cols}, tensor.options());
+  auto corrected = padded.narrow(0, 0, numel);
+  at::add_out(corrected, tensor, state.error);
+  auto matrix = padded.view({rows, cols});
+
+  std::vector<at::Tensor> p = {matrix.mm(state.q)};
+  process_group_->allreduce(p)->wait();
+  orthogonalize(p[0]);
+  std::vector<at::Tensor> q = {matrix.t().mm(p[0])};
+  auto work = process_group_->allreduce(q);
+
+  state.q = q[0];
+  auto error = state.error;
+  return completeAfter(
+      {std::move(work)}, [tensor, corrected, error, p, q, numel] {
+        auto approximation = p[0].mm(q[0].t()).view({-1}).narrow(0, 0, numel);
+        error.copy_(corrected).sub_(approximation);
+        tensor.copy_(approximation);
+        return std::vector<at::Tensor>{tensor};
+      });
+}
+
+TopKCompressHook::TopKCompressHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    double ratio)
+    : process_group_(std::move(process_group)), ratio_(ratio) {
+  TORCH_CHECK(
+      ratio_ > 0 && ratio_ <= 1, "Top-k ratio must be in (0, 1], got ", ratio_);
+}
+
+FuturePtr TopKCompressHook::runHook(const GradBucket& bucket) {
+  const auto& tensor = singleReplica(bucket, "TopKCompressHook");
+  const auto numel = tensor.numel();
+  auto& error = error_[bucket.getIndex()];
+  if (!error.defined() || error.numel() != numel) {
+    error = at::zeros_like(tensor);
+  }
+
+  // The same k on every process, so that the allgathers line up.
+  const auto k = std::max<int64_t>(1, static_cast<int64_t>(numel * ratio_));
+  error.add_(tensor);
+  auto indices = std::get<1>(error.abs().topk(k, 0, true, false));
+  auto values = error.index_select(0, indices);
+  error.index_fill_(0, indices, 0);
+
+  auto gathered_values = allgather(*process_group_, values);
+  auto gathered_indices = allgather(*process_group_, indices);
+  auto all_values = std::move(gathered_values.second);
+  auto all_indices = std::move(gathered_indices.second);
+  return completeAfter(
+      {std::move(gathered_values.first), std::move(gathered_indices.first)},
+      [tensor, all_values, all_indices] {
+        tensor.zero_();
+        for (size_t i = 0; i < all_values.size(); i++) {
+          tensor.index_add_(0, all_indices[i], all_values[i]);
+        }
+        return std::vector<at::Tensor>{tensor};
+      });
+}
+
+std::unique_ptr<CommHookInterface> makeBuiltinCommHook(
+    BuiltinCommHookType type,
+    std::shared_ptr<ProcessGroup> process_group,
+    int64_t matrix_approximation_rank,
+    double topk_ratio) {
+  switch (type) {
+    case BuiltinCommHookType::FP16_COMPRESS:
+      return torch::make_unique<FP16CompressHook>(std::move(process_group));
+    case BuiltinCommHookType::BF16_COMPRESS:
+      return torch::make_unique<BF16CompressHook>(std::move(process_group));
+    case BuiltinCommHookType::POWER_SGD:
+      return torch::make_unique<PowerSGDHook>(
+          std::move(process_group), matrix_approximation_rank);
+    case BuiltinCommHookType::TOPK_COMPRESS:
+      return torch::make_unique<TopKCompressHook>(
+          std::move(process_group), topk_ratio);
+  }
+  TORCH_CHECK(false, "Unknown builtin communication hook type.");
+}
+
+} // namespace c10d
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <ATen/ATen.h>
+#include <ATen/core/ivalue.h>
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+// The flattened contents of one bucket, as passed to a communication hook.
+// There is one tensor per model replica.
+class GradBucket {
+ public:
+  GradBucket(size_t index, std::vector<at::Tensor> tensors)
+      : index_(index), tensors_(std::move(tensors)) {}
+
+  // Position of the bucket in the reduction order. Stable across iterations
+  // as long as the bucket assignment does not change, so hooks can use it to
+  // keep per-bucket state.
+  size_t getIndex() const {
+    return index_;
+  }
+
+  const std::vector<at::Tensor>& getTensors() const {
+    return tensors_;
+  }
+
+ private:
+  size_t index_;
+  std::vector<at::Tensor> tensors_;
+};
+
+// A communication hook replaces the allreduce the Reducer runs for every
+// dense bucket. The hook is called in bucket order on the autograd thread,
+// with the bucket contents already divided by the world size. It must issue
+// its collectives from that thread, in the same order on every process, and
+// returns a future that completes with the reduced tensors (one per replica,
+// same size and dtype as the input). The Reducer waits for the futures at the
+// end of the backward pass and copies the results into the bucket.
+class CommHookInterface {
+ public:
+  virtual ~CommHookInterface() = default;
+
+  virtual c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) = 0;
+};
+
+// Casts the bucket to half precision for the allreduce.
+class FP16CompressHook : public CommHookInterface {
+ public:
+  explicit FP16CompressHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// Casts the bucket to bfloat16, which keeps the range of float32. Process
+// groups cannot reduce bfloat16 tensors, so the 16-bit payloads are
+// allgathered and summed locally in the bucket dtype.
+class BF16CompressHook : public CommHookInterface {
+ public:
+  explicit BF16CompressHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// PowerSGD (Vogels et al., 2019): the bucket is viewed as a matrix M and
+// approximated by P Q^T of the given rank, so only P and Q are allreduced.
+// One step of power iteration is run per iteration, warm-started from the
+// previous Q. What the approximation misses is added back to the bucket in
+// the next iteration (error feedback). The allreduce of P is waited for on
+// the autograd thread, because Q depends on it.
+class PowerSGDHook : public CommHookInterface {
+ public:
+  PowerSGDHook(
+      std::shared_ptr<ProcessGroup> process_group,
+      int64_t matrix_approximation_rank);
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  struct State {
+    at::Tensor error;
+    at::Tensor q;
+  };
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  int64_t matrix_approximation_rank_;
+  std::unordered_map<size_t, State> state_;
+};
+
+// Sends the largest `ratio` fraction of the bucket entries by magnitude, as
+// allgathered (index, value) pairs. Entries that are not sent accumulate
+// locally and are added to the bucket in the next iteration (error feedback).
+class TopKCompressHook : public CommHookInterface {
+ public:
+  TopKCompressHook(std::shared_ptr<ProcessGroup> process_group, double ratio);
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+  double ratio_;
+  std::unordered_map<size_t, at::Tensor> error_;
+};
+
+enum class BuiltinCommHookType {
+  FP16_COMPRESS,
+  BF16_COMPRESS,
+  POWER_SGD,
+  TOPK_COMPRESS,
+};
+
+std::unique_ptr<CommHookInterface> makeBuiltinCommHook(
+    BuiltinCommHookType type,
+    std::shared_ptr<ProcessGroup> process_group,
+    int64_t matrix_approximation_rank = 1,
+    double topk_ratio = 0.01);
+
+} // namespace c10d
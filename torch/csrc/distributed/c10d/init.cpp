@@ -23,6 +23,7 @@
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/distributed/c10d/comm.h>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
 #include <torch/csrc/distributed/c10d/ddp.h>
 #include <torch/csrc/distributed/c10d/reducer.h>
 #include <torch/csrc/utils/object_ptr.h>
@@ -140,7 +141,33 @@ PyObject* c10d_init(PyObject* _unused) {
           [](::c10d::Reducer& reducer, const torch::autograd::Variable& output)
               -> void { reducer.prepare_for_backward({output}); },
           py::call_guard<py::gil_scoped_release>())
-      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats);
+      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats)
+      .def(
+          "_register_builtin_comm_hook",
+          [](::c10d::Reducer& reducer,
+             ::c10d::BuiltinCommHookType comm_hook_type,
+             std::shared_ptr<::c10d::ProcessGroup> process_group,
+             int64_t matrix_approximation_rank,
+             double topk_ratio) {
+            reducer.register_comm_hook(::c10d::makeBuiltinCommHook(
+                comm_hook_type,
+                std::move(process_group),
+                matrix_approximation_rank,
+                topk_ratio));
+          },
+          py::arg("comm_hook_type"),
+          py::arg("process_group"),
+          py::arg("matrix_approximation_rank") = 1,
+          py::arg("topk_ratio") = 0.01,
+          py::call_guard<py::gil_scoped_release>());
+
+  py::enum_<::c10d::BuiltinCommHookType>(module, "BuiltinCommHookType", R"(
+An enum-like class for the built-in communication hooks of the reducer:
+``FP16_COMPRESS``, ``BF16_COMPRESS``, ``POWER_SGD``, and ``TOPK_COMPRESS``.)")
+      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS)
+      .value("BF16_COMPRESS", ::c10d::BuiltinCommHookType::BF16_COMPRESS)
+      .value("POWER_SGD", ::c10d::BuiltinCommHookType::POWER_SGD)
+      .value("TOPK_COMPRESS", ::c10d::BuiltinCommHookType::TOPK_COMPRESS);
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class for available reduction operations: ``SUM``, ``PRODUCT``,
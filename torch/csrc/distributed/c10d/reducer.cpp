@@ -412,10 +412,28 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
       //
       tensors.push_back(replica.contents);
     }
-    bucket.work = process_group_->allreduce(tensors);
+    if (comm_hook_ && !bucket.expect_sparse_gradient) {
+      bucket.work = nullptr;
+      bucket.future =
+          comm_hook_->runHook(GradBucket(next_bucket_, std::move(tensors)));
+    } else {
+      bucket.future.reset();
+      bucket.work = process_group_->allreduce(tensors);
+    }
   }
 }
 
+void Reducer::register_comm_hook(std::unique_ptr<CommHookInterface> hook) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      !expect_autograd_hooks_,
+      "`register_comm_hook` must NOT be called during autograd execution.");
+  TORCH_CHECK(
+      comm_hook_ == nullptr,
+      "`register_comm_hook` can only be called once.");
+  comm_hook_ = std::move(hook);
+}
+
 void Reducer::initialize_buckets(
     std::vector<std::vector<size_t>> bucket_indices) {
   std::lock_guard<std::mutex> lock(mutex_);
@@ -707,8 +725,21 @@ void Reducer::finalize_backward() {
 
   // Wait for asynchronous reduction to complete and unflatten contents.
   for (auto& bucket : buckets_) {
-    TORCH_INTERNAL_ASSERT(bucket.work);
-    bucket.work->wait();
+    if (bucket.future) {
+      bucket.future->wait();
+      // Throws if the hook failed.
+      const auto result = bucket.future->value().toTensorVector();
+      TORCH_INTERNAL_ASSERT(result.size() == bucket.replicas.size());
+      for (size_t i = 0; i < result.size(); i++) {
+        auto& contents = bucket.replicas[i].contents;
+        if (!result[i].is_same(contents)) {
+          contents.copy_(result[i]);
+        }
+      }
+    } else {
+      TORCH_INTERNAL_ASSERT(bucket.work);
+      bucket.work->wait();
+    }
     if (bucket.expect_sparse_gradient) {
       finalize_bucket_sparse(bucket);
     } else {
@@ -7,9 +7,11 @@
 #include <unordered_map>
 #include <vector>
 
+#include <ATen/core/ivalue.h>
 #include <c10d/ProcessGroup.hpp>
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/autograd/variable.h>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
 
 namespace c10d {
 
@@ -47,6 +49,10 @@ class Reducer {
     return backward_stats_;
   }
 
+  // Replaces the allreduce of every dense bucket with the given hook (see
+  // comm_hooks.h). Can only be called once, and not during a backward pass.
+  void register_comm_hook(std::unique_ptr<CommHookInterface> hook);
+
  protected:
   // Forward declaration.
   struct Bucket;
@@ -92,6 +98,9 @@ class Reducer {
   // Work handle for allreduce on local_used_maps_
   std::shared_ptr<c10d::ProcessGroup::Work> local_used_work_;
 
+  // Runs the reduction of dense buckets instead of a plain allreduce, if set.
+  std::unique_ptr<CommHookInterface> comm_hook_;
+
   void mark_variable_ready_dense(VariableIndex index);
 
   void mark_variable_ready_sparse(VariableIndex index);
@@ -160,6 +169,10 @@ class Reducer {
     // Keep work handle around when this set of buckets is being reduced.
     std::shared_ptr<c10d::ProcessGroup::Work> work;
 
+    // Result of the communication hook, used instead of `work` if a hook is
+    // registered. Completes with one reduced tensor per replica.
+    c10::intrusive_ptr<c10::ivalue::Future> future;
+
     // If this bucket should expect a single sparse gradient.
     // Implies: replicas[i].variables.size() == 1.
     bool expect_sparse_gradient = false;
@@ -7,6 +7,8 @@
 
 #include <Python.h>
 
+#include <cstdlib>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
@@ -356,13 +358,14 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
   if (to.id_ == (worker_id_t)pg_->getRank()) {
     threadPool_.run(std::bind(
         [this, future](const Message& message) {
-          // Unlike the other cases, need to add a tensor deleter, since the
-          // data outlives the scope of this function. It's shared_ptr<> due
-          // to c++11 lambda capture limitations with unique_ptr<>.
-          std::unique_ptr<std::string> payload;
+          // Serialize into a buffer laid out as the receiver would, so that
+          // the received tensors can alias it.
+          torch::Tensor payload;
           try {
-            payload = std::make_unique<std::string>(
-                wireSerialize(message.payload(), message.tensors()));
+            WireSegments segments(message.payload(), message.tensors());
+            payload = torch::empty(
+                {static_cast<int64_t>(segments.size())}, {torch::kChar});
+            segments.copyTo(static_cast<char*>(payload.data_ptr()));
             // only increment sendCounts when the message is indeed added into
             // local recv.
             sendCounts_.increment(pg_->getRank());
@@ -370,18 +373,11 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
             markFutureWithError(message.id(), e.what());
             return;
           }
-          const char* data = payload->data();
-          size_t len = payload->length();
-          std::string* delete_when_done = payload.release();
           enqueueRecv(RecvWork(
               getWorkerInfo(pg_->getRank()),
               message.type(),
               message.id(),
-              torch::from_blob(
-                  (void*)data,
-                  len,
-                  [delete_when_done](void*) { delete delete_when_done; },
-                  {torch::kChar})));
+              std::move(payload)));
         },
         std::move(message)));
     return future;
@@ -401,32 +397,51 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
 }
 
 void ProcessGroupAgent::handleSend(const SendWork& work) {
-  std::string serializedPayload =
-      wireSerialize(work.message_.payload(), work.message_.tensors());
+  // The message is sent segment by segment, straight from the payload and
+  // tensor storage, without flattening it first. Padding is not sent.
+  WireSegments serialized(work.message_.payload(), work.message_.tensors());
+  const auto& segments = serialized.segments();
 
   std::vector<torch::Tensor> preamble = {torch::tensor(
       {(int64_t)pg_->getRank(),
-       (int64_t)serializedPayload.length(),
+       (int64_t)serialized.size(),
        (int64_t)work.message_.type(),
-       (int64_t)work.message_.id()},
+       (int64_t)work.message_.id(),
+       (int64_t)segments.size()},
       {torch::kInt64})};
 
+  // Sizes of the segments, negated for padding.
+  std::vector<torch::Tensor> segmentSizes = {
+      torch::empty({(int64_t)segments.size()}, {torch::kInt64})};
+  std::vector<std::vector<torch::Tensor>> payloads;
+  auto* sizes = segmentSizes.front().data_ptr<int64_t>();
+  for (size_t i = 0; i < segments.size(); i++) {
+    const auto& segment = segments[i];
+    sizes[i] = (int64_t)segment.size;
+    if (segment.padding) {
+      sizes[i] = -sizes[i];
+      continue;
+    }
+    payloads.push_back({torch::from_blob(
+        (void*)segment.data, segment.size, {torch::kChar})});
+  }
+
   // ProcessGroup is not thread-safe when sending with the same tag,
   // hence the lock
   std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> pendingSends;
   const auto dst = work.to_.id_;
-  std::vector<torch::Tensor> payload = {torch::from_blob(
-      (void*)serializedPayload.c_str(),
-      serializedPayload.length(),
-      {torch::kChar})};
-  pendingSends.reserve(2);
+  pendingSends.reserve(2 + payloads.size());
 
   sendCounts_.increment(dst);
 
   {
     std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
     pendingSends.emplace_back(pg_->send(preamble, dst, dst /* channelTag */));
-    pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    pendingSends.emplace_back(
+        pg_->send(segmentSizes, dst, dst /* channelTag */));
+    for (auto& payload : payloads) {
+      pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    }
   }
   // Write pendingSends to a global map so that they can be interrupted by
   // ::shutdown().
@@ -486,7 +501,8 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
 
 int ProcessGroupAgent::handleRecv(RecvWork& work) {
   torch::Tensor& payload = work.payload_;
-  auto data = wireDeserialize(payload.storage().data(), payload.numel());
+  // The received tensors alias the payload buffer.
+  auto data = wireDeserialize(payload);
   Message message(
       std::move(data.first), std::move(data.second), work.type_, work.id_);
   if (message.isRequest()) {
@@ -684,8 +700,8 @@ void ProcessGroupAgent::listenLoop() {
 
 void ProcessGroupAgent::listenLoopInternal() {
   while (rpcRunning_.load()) {
-    // rank, tensor size, message type
-    std::vector<torch::Tensor> preamble = {torch::empty({4}, {torch::kInt64})};
+    // rank, message size, message type, message id, number of segments
+    std::vector<torch::Tensor> preamble = {torch::empty({5}, {torch::kInt64})};
     auto work = pg_->recvAnysource(preamble, pg_->getRank());
     {
       std::lock_guard<std::mutex> guard(recvWorkMutex_);
@@ -702,12 +718,35 @@ void ProcessGroupAgent::listenLoopInternal() {
     auto size = preamble_items[1];
     MessageType type = MessageType(preamble_items[2]);
     int64_t id = preamble_items[3];
-
-    std::vector<torch::Tensor> tensors = {torch::empty({size}, {torch::kChar})};
-    pg_->recv(tensors, srcRank, pg_->getRank())->wait();
+    auto numSegments = preamble_items[4];
+
+    std::vector<torch::Tensor> segmentSizes = {
+        torch::empty({numSegments}, {torch::kInt64})};
+    pg_->recv(segmentSizes, srcRank, pg_->getRank())->wait();
+
+    // Receive every segment at its offset in the message buffer, so that
+    // handleRecv() can have the tensors alias the buffer. Padding is skipped.
+    auto payload = torch::empty({size}, {torch::kChar});
+    const auto* sizes = segmentSizes.front().data_ptr<int64_t>();
+    int64_t offset = 0;
+    for (int64_t i = 0; i < numSegments; i++) {
+      if (sizes[i] > 0) {
+        std::vector<torch::Tensor> segment = {
+            payload.narrow(0, offset, sizes[i])};
+        pg_->recv(segment, srcRank, pg_->getRank())->wait();
+      }
+      offset += std::abs(sizes[i]);
+    }
+    TORCH_CHECK(
+        offset == size,
+        "Received segments of ",
+        offset,
+        " bytes for a message of ",
+        size,
+        " bytes");
 
     enqueueRecv(
-        RecvWork(allWorkerInfo_[srcRank], type, id, std::move(tensors[0])));
+        RecvWork(allWorkerInfo_[srcRank], type, id, std::move(payload)));
   }
 }
 
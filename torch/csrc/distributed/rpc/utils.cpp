@@ -18,6 +18,9 @@
 #include <torch/csrc/jit/serialization/pickler.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
 
+#include <cstring>
+#include <functional>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
@@ -220,6 +223,68 @@ parseWireSections(const void* data, size_t data_size) {
 
 static const char* kMeta = "meta";
 static const char* kPayload = "payload";
+// Sections aligning tensor data to kWireAlignment. Their size is written with
+// a fixed number of digits, so that the header size does not depend on it.
+static const char* kPadding = "_";
+constexpr size_t kPaddingDigits = 2;
+static_assert(kWireAlignment <= 100, "Padding sizes must fit in 2 digits");
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserializeImpl(
+    const void* data,
+    size_t data_size,
+    const std::function<at::DataPtr(const char*, size_t)>& tensorData) {
+  auto sections = parseWireSections(data, data_size);
+
+  std::vector<char> payload;
+  auto payloadIt = sections.find(kPayload);
+  if (payloadIt != sections.end() && payloadIt->second.second != 0) {
+    payload.assign(
+        payloadIt->second.first,
+        payloadIt->second.first + payloadIt->second.second);
+  }
+
+  std::vector<at::Tensor> tensors;
+  auto metaIt = sections.find(kMeta);
+  if (metaIt != sections.end()) {
+    const auto& metaData = metaIt->second;
+    size_t metaDataPos = 0;
+    auto metaDataReadFunc = [&](char* buf, size_t n) -> size_t {
+      if (metaDataPos >= metaData.second || n == 0) {
+        return 0;
+      }
+      size_t toCopy = std::min(metaDataPos + n, metaData.second) - metaDataPos;
+      memcpy(buf, metaData.first + metaDataPos, toCopy);
+      metaDataPos += toCopy;
+      return toCopy;
+    };
+    auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
+      auto it = sections.find(ename);
+      if (it == sections.end()) {
+        throw std::runtime_error("Couldn't find entity " + ename);
+      }
+      return tensorData(it->second.first, it->second.second);
+    };
+
+    // No need to pass typeResolver here, as it always processes string and
+    // tensors only
+    torch::jit::Unpickler unpickler(
+        metaDataReadFunc, nullptr, nullptr, sectionReadFunc, {});
+    auto ival = unpickler.parse_ivalue();
+    for (auto&& t : ival.toTensorList()) {
+      tensors.emplace_back(std::move(t));
+    }
+  }
+  return {std::move(payload), std::move(tensors)};
+}
+
+at::DataPtr copyTensorData(const char* data, size_t size) {
+  auto dptr = at::getCPUAllocator()->allocate(size);
+  if (size != 0) {
+    memcpy(dptr.get(), data, size);
+  }
+  return dptr;
+}
+
 }; // namespace
 
 c10::List<at::Tensor> cloneSparseTensors(
@@ -246,7 +311,7 @@ c10::List<at::Tensor> cloneSparseTensors(
   return pTensors;
 }
 
-std::string wireSerialize(
+WireSegments::WireSegments(
     const std::vector<char>& payload,
     const std::vector<at::Tensor>& tensors) {
   for (const auto& tensor : tensors) {
@@ -262,105 +327,122 @@ std::string wireSerialize(
     std::string name;
     const char* data;
     size_t size;
+    bool isTensor;
   };
   std::vector<Ent> entries;
-  std::string metaEntry;
-  std::vector<jit::WriteableTensorData> tensorData;
 
   if (!payload.empty()) {
-    entries.push_back({kPayload, payload.data(), payload.size()});
+    entries.push_back({kPayload, payload.data(), payload.size(), false});
   }
 
   if (!tensors.empty()) {
     torch::jit::Pickler pickler(
         [&](const void* buf, size_t sz) -> size_t {
-          metaEntry.append(static_cast<const char*>(buf), sz);
+          const char* data = static_cast<const char*>(buf);
+          meta_.insert(meta_.end(), data, data + sz);
           return sz;
         },
         nullptr);
     pickler.protocol();
     pickler.pushIValue(cloneSparseTensors(tensors));
     pickler.stop();
-    // tensorData is in function scope so that the data() pointers stay valid.
-    tensorData = pickler.tensorData();
-    entries.push_back({kMeta, metaEntry.data(), metaEntry.size()});
-    for (size_t i = 0; i < tensorData.size(); i++) {
+    // tensorData_ is a member so that the data() pointers stay valid.
+    tensorData_ = pickler.tensorData();
+    entries.push_back({kMeta, meta_.data(), meta_.size(), false});
+    for (size_t i = 0; i < tensorData_.size(); i++) {
       entries.push_back({c10::to_string(i),
-                         tensorData[i].data(),
-                         tensorData[i].sizeInBytes()});
+                         tensorData_[i].data(),
+                         tensorData_[i].sizeInBytes(),
+                         true});
+    }
+  }
+
+  // Every tensor section is preceded by a padding section, so the header
+  // size is known before the padding sizes are.
+  size_t headerSize = 1;
+  for (const auto& e : entries) {
+    headerSize += e.name.size() + c10::to_string(e.size).size() + 2;
+    if (e.isTensor) {
+      headerSize += strlen(kPadding) + kPaddingDigits + 2;
     }
   }
 
+  static const char kZeros[kWireAlignment] = {};
   std::string header;
-  size_t tot = 0;
+  header.reserve(headerSize);
+  segments_.push_back({nullptr, headerSize, false});
+  size_ = headerSize;
   for (const auto& e : entries) {
-    tot += e.size;
+    if (e.isTensor) {
+      const size_t padding =
+          (kWireAlignment - size_ % kWireAlignment) % kWireAlignment;
+      header.append(kPadding)
+          .append(" ")
+          .append(padding < 10 ? "0" : "")
+          .append(c10::to_string(padding))
+          .append("\n");
+      if (padding != 0) {
+        segments_.push_back({kZeros, padding, true});
+        size_ += padding;
+      }
+    }
     header.append(e.name)
         .append(" ")
         .append(c10::to_string(e.size))
         .append("\n");
+    if (e.size != 0) {
+      segments_.push_back({e.data, e.size, false});
+      size_ += e.size;
+    }
   }
   header.push_back('\n');
+  TORCH_INTERNAL_ASSERT(header.size() == headerSize);
+  header_.assign(header.begin(), header.end());
+  segments_.front().data = header_.data();
+}
 
-  std::string out;
-  out.reserve(header.size() + tot);
-  out.append(header);
-  for (const auto& e : entries) {
-    out.append(e.data, e.size);
+void WireSegments::copyTo(char* out) const {
+  for (const auto& segment : segments_) {
+    memcpy(out, segment.data, segment.size);
+    out += segment.size;
   }
+}
+
+std::string wireSerialize(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  WireSegments segments(payload, tensors);
+  std::string out(segments.size(), '\0');
+  segments.copyTo(&out[0]);
   return out;
 }
 
 std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     const void* data,
     size_t data_size) {
-  auto sections = parseWireSections(data, data_size);
-
-  std::vector<char> payload;
-  auto payloadIt = sections.find(kPayload);
-  if (payloadIt != sections.end() && payloadIt->second.second != 0) {
-    payload.assign(
-        payloadIt->second.first,
-        payloadIt->second.first + payloadIt->second.second);
-  }
-
-  std::vector<at::Tensor> tensors;
-  auto metaIt = sections.find(kMeta);
-  if (metaIt != sections.end()) {
-    const auto& metaData = metaIt->second;
-    size_t metaDataPos = 0;
-    auto metaDataReadFunc = [&](char* buf, size_t n) -> size_t {
-      if (metaDataPos >= metaData.second || n == 0) {
-        return 0;
-      }
-      size_t toCopy = std::min(metaDataPos + n, metaData.second) - metaDataPos;
-      memcpy(buf, metaData.first + metaDataPos, toCopy);
-      metaDataPos += toCopy;
-      return toCopy;
-    };
-    auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
-      auto it = sections.find(ename);
-      if (it == sections.end()) {
-        throw std::runtime_error("Couldn't find entity " + ename);
-      }
-      const auto& idat = it->second;
-      auto dptr = at::getCPUAllocator()->allocate(idat.second);
-      if (idat.second != 0) {
-        memcpy(dptr.get(), idat.first, idat.second);
-      }
-      return dptr;
-    };
+  return wireDeserializeImpl(data, data_size, copyTensorData);
+}
 
-    // No need to pass typeResolver here, as it always processes string and
-    // tensors only
-    torch::jit::Unpickler unpickler(
-        metaDataReadFunc, nullptr, nullptr, sectionReadFunc, {});
-    auto ival = unpickler.parse_ivalue();
-    for (auto&& t : ival.toTensorList()) {
-      tensors.emplace_back(std::move(t));
-    }
-  }
-  return {std::move(payload), std::move(tensors)};
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
+    const at::Tensor& buffer) {
+  TORCH_CHECK(
+      buffer.device().is_cpu() && buffer.is_contiguous() &&
+          buffer.element_size() == 1,
+      "Expected a contiguous CPU byte tensor to deserialize from");
+  const char* base = static_cast<const char*>(buffer.data_ptr());
+  return wireDeserializeImpl(
+      base, buffer.numel(), [&](const char* data, size_t size) {
+        // Tensor sections are aligned relative to the start of the buffer.
+        // Only alias them if that makes them aligned in memory as well.
+        if (reinterpret_cast<uintptr_t>(data) % kWireAlignment != 0) {
+          return copyTensorData(data, size);
+        }
+        return at::DataPtr(
+            const_cast<char*>(data),
+            new at::Storage(buffer.storage()),
+            [](void* ctx) { delete static_cast<at::Storage*>(ctx); },
+            at::kCPU);
+      });
 }
 
 } // namespace rpc
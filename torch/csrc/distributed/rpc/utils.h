@@ -1,6 +1,7 @@
 #pragma once
 
 #include <torch/csrc/distributed/rpc/rpc_command_base.h>
+#include <torch/csrc/jit/serialization/pickler.h>
 
 namespace torch {
 namespace distributed {
@@ -39,6 +40,60 @@ TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     const void* data,
     size_t data_size);
 
+// Same as above, but the returned tensors alias `buffer`, a contiguous CPU
+// char tensor holding the serialized bytes, instead of copying out of it.
+// The storage of `buffer` stays alive as long as any of the tensors.
+TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
+    const at::Tensor& buffer);
+
+constexpr size_t kWireAlignment = 64;
+
+// The wireSerialize() format as a list of byte ranges in wire order, like an
+// iovec, so that it can be sent without first being flattened into a single
+// buffer. The payload and tensor data are not copied: their segments point
+// into the payload vector, which must outlive this object, and into tensor
+// storage, which this object keeps alive.
+//
+// Tensor data starts at offsets aligned to kWireAlignment, preceded by
+// padding segments. Padding does not need to be transmitted: a receiver that
+// places every segment at its offset in a buffer aligned to kWireAlignment
+// can have the tensors alias that buffer (see wireDeserialize() above).
+class TORCH_API WireSegments {
+ public:
+  struct Segment {
+    const char* data;
+    size_t size;
+    bool padding;
+  };
+
+  WireSegments(
+      const std::vector<char>& payload,
+      const std::vector<at::Tensor>& tensors);
+  // Segments point into the members, which must not be copied.
+  WireSegments(const WireSegments&) = delete;
+  WireSegments& operator=(const WireSegments&) = delete;
+  WireSegments(WireSegments&&) = default;
+  WireSegments& operator=(WireSegments&&) = default;
+
+  const std::vector<Segment>& segments() const {
+    return segments_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Copies the segments to `out`, which must hold size() bytes.
+  void copyTo(char* out) const;
+
+ private:
+  std::vector<char> header_;
+  std::vector<char> meta_;
+  std::vector<jit::WriteableTensorData> tensorData_;
+  std::vector<Segment> segments_;
+  size_t size_ = 0;
+};
+
 // Some Tensors are effectively views of larger Tensors, where only a small
 // subset of the Storage data is referenced. This normally is good and avoids
 // copies when kept locally, but if we naively push the whole Storage over the
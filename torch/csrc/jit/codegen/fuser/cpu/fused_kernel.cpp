@@ -4,9 +4,12 @@
 #include <torch/csrc/jit/frontend/code_template.h>
 #include <torch/csrc/jit/codegen/fuser/compiler.h>
 #include <torch/csrc/jit/codegen/fuser/cpu/temp_file.h>
+#include <torch/csrc/jit/codegen/fuser/disk_cache.h>
 #include <torch/csrc/utils/memory.h>
 
+#include <cctype>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -278,6 +281,42 @@ static void disas(const std::string& so_file) {
   AT_ASSERT(r == 0);
 }
 
+// Kernels are named in the order the process compiles them, so the kernels
+// of the disk cache are renamed to a name that doesn't depend on the process.
+static const std::string cached_kernel_name = "cached_kernel";
+
+// Renames the identifiers that start with name, e.g. kernel_3 and
+// kernel_3_kernel but not kernel_31.
+static std::string renameKernel(
+    const std::string& code,
+    const std::string& name,
+    const std::string& new_name) {
+  std::string result;
+  size_t pos = 0;
+  while (true) {
+    size_t found = code.find(name, pos);
+    if (found == std::string::npos) {
+      break;
+    }
+    size_t end = found + name.size();
+    bool starts_identifier = found == 0 ||
+        !(std::isalnum(code[found - 1]) || code[found - 1] == '_');
+    bool ends_name = end == code.size() || !std::isdigit(code[end]);
+    result.append(code, pos, found - pos);
+    result.append(starts_identifier && ends_name ? new_name : name);
+    pos = end;
+  }
+  result.append(code, pos, std::string::npos);
+  return result;
+}
+
+static std::string readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
 FusedKernelCPU::FusedKernelCPU(
     std::string name,
     std::string code,
@@ -294,21 +333,61 @@ FusedKernelCPU::FusedKernelCPU(
           std::move(chunk_desc),
           std::move(concat_desc),
           has_random) {
-  TempFile so_file(so_template, so_suffix_len);
-  TempFile cpp_file(cpp_template, cpp_suffix_len);
-  cpp_file.write(code_);
-  cpp_file.sync();
+  std::string symbol = name_;
+  std::string kernel_code = code_;
+  c10::optional<std::string> so_path;
+
+  // The cache key covers the code, which is generated from the normalized
+  // graph and the input specialization, and the compiler and its flags.
+  KernelDiskCache* disk_cache = KernelDiskCache::get();
+  const std::string so_suffix =
+      so_template.substr(so_template.size() - so_suffix_len);
+  std::string key;
+  if (disk_cache) {
+    symbol = cached_kernel_name;
+    kernel_code = renameKernel(code_, name_, symbol);
+    auto& config = getConfig();
+    key = KernelDiskCache::key(
+        kernel_code + compile_string + config.cxx +
+        (config.openmp ? config.openmp_flags : ""));
+    so_path = disk_cache->lookup(key, so_suffix);
+    if (so_path) {
+      try {
+        so_lib = make_unique<at::DynamicLibrary>(so_path->c_str());
+      } catch (const c10::Error&) {
+        // A corrupt entry, e.g. one truncated by a full disk, can't be
+        // loaded. It is dropped and the kernel compiled again.
+        disk_cache->removeCorrupt(key, so_suffix);
+        so_path = c10::nullopt;
+      }
+    }
+  }
+
+  // The compiled kernel, if it is not in the cache.
+  std::unique_ptr<TempFile> so_file;
+  if (!so_path) {
+    so_file = make_unique<TempFile>(so_template, so_suffix_len);
+    TempFile cpp_file(cpp_template, cpp_suffix_len);
+    cpp_file.write(kernel_code);
+    cpp_file.sync();
 #ifdef _MSC_VER
-  so_file.close();
-  cpp_file.close();
+    so_file->close();
+    cpp_file.close();
 #endif
-  runCompiler(cpp_file.name(), so_file.name());
-  if (debugFuser() >= 2)
-    disas(so_file.name());
-  so_lib = make_unique<at::DynamicLibrary>(so_file.name().c_str());
+    runCompiler(cpp_file.name(), so_file->name());
+    if (debugFuser() >= 2)
+      disas(so_file->name());
+    if (disk_cache) {
+      so_path = disk_cache->write(key, so_suffix, readFile(so_file->name()));
+    }
+    if (!so_path) {
+      so_path = so_file->name();
+    }
+    so_lib = make_unique<at::DynamicLibrary>(so_path->c_str());
+  }
 #pragma GCC diagnostic ignored "-Wpedantic"
   kernel =
-      reinterpret_cast<void (*)(uint32_t, void**)>(so_lib->sym(name_.c_str()));
+      reinterpret_cast<void (*)(uint32_t, void**)>(so_lib->sym(symbol.c_str()));
 #pragma GCC diagnostic pop
 }
 
@@ -0,0 +1,276 @@
+#include <torch/csrc/jit/codegen/fuser/disk_cache.h>
+
+#include <c10/util/Exception.h>
+#include <torch/csrc/utils/memory.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+
+namespace {
+
+constexpr int64_t kDefaultMaxMegabytes = 256;
+constexpr size_t kKeyLength = 32;
+
+// The entries live in a subdirectory the cache creates, so that pointing
+// PYTORCH_JIT_KERNEL_CACHE_DIR at a directory with other files in it never
+// gets those evicted.
+constexpr const char* kSubdirectory = "pytorch_kernels";
+
+bool makeDirectory(const std::string& directory) {
+#ifdef _WIN32
+  return false;
+#else
+  return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// Whether name is "<key><suffix>", the name of an entry the cache wrote.
+bool isEntryName(const std::string& name) {
+  if (name.size() < kKeyLength + 2 || name[kKeyLength] != '.') {
+    return false;
+  }
+  for (size_t i = 0; i < name.size(); ++i) {
+    const char c = name[i];
+    const bool valid = i < kKeyLength
+        ? std::isxdigit(static_cast<unsigned char>(c))
+        : i == kKeyLength || std::isalnum(static_cast<unsigned char>(c));
+    if (!valid) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// 64-bit FNV-1a.
+uint64_t fnv1a(const std::string& data, uint64_t hash) {
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::unique_ptr<KernelDiskCache> cacheFromEnvironment() {
+#ifdef _WIN32
+  return nullptr;
+#else
+  const char* directory = std::getenv("PYTORCH_JIT_KERNEL_CACHE_DIR");
+  if (!directory || !*directory) {
+    return nullptr;
+  }
+  int64_t max_megabytes = kDefaultMaxMegabytes;
+  if (const char* max_env = std::getenv("PYTORCH_JIT_KERNEL_CACHE_MAX_MB")) {
+    char* end = nullptr;
+    errno = 0;
+    const long long value = std::strtoll(max_env, &end, 10);
+    if (end == max_env || *end != '\0' || errno != 0 || value <= 0 ||
+        value > (int64_t(1) << 40)) {
+      TORCH_WARN(
+          "Ignoring PYTORCH_JIT_KERNEL_CACHE_MAX_MB=",
+          max_env,
+          ", which is not a positive number of megabytes; the kernel cache "
+          "holds at most ",
+          kDefaultMaxMegabytes,
+          " MB");
+    } else {
+      max_megabytes = value;
+    }
+  }
+  const std::string subdirectory =
+      std::string(directory) + "/" + kSubdirectory;
+  if (!makeDirectory(directory) || !makeDirectory(subdirectory)) {
+    TORCH_WARN(
+        "Can't create the kernel cache directory ",
+        subdirectory,
+        ", the kernel cache is disabled");
+    return nullptr;
+  }
+  return torch::make_unique<KernelDiskCache>(
+      subdirectory, max_megabytes << 20);
+#endif
+}
+
+std::unique_ptr<KernelDiskCache>& globalCache() {
+  static std::unique_ptr<KernelDiskCache> cache = cacheFromEnvironment();
+  return cache;
+}
+
+} // namespace
+
+KernelDiskCache* KernelDiskCache::get() {
+  return globalCache().get();
+}
+
+std::unique_ptr<KernelDiskCache> KernelDiskCache::replace(
+    std::unique_ptr<KernelDiskCache> cache) {
+  std::swap(globalCache(), cache);
+  return cache;
+}
+
+KernelDiskCache::KernelDiskCache(std::string directory, int64_t max_bytes)
+    : directory_(std::move(directory)), max_bytes_(max_bytes) {}
+
+std::string KernelDiskCache::key(const std::string& content) {
+  // 128 bits: the FNV-1a hash of the content, and the hash of the content
+  // again starting from the first one.
+  const uint64_t first = fnv1a(content, 14695981039346656037ULL);
+  const uint64_t second = fnv1a(content, first ^ content.size());
+  std::ostringstream ss;
+  ss << std::hex << std::setfill('0') << std::setw(16) << first
+     << std::setw(16) << second;
+  return ss.str();
+}
+
+std::string KernelDiskCache::path(
+    const std::string& key,
+    const std::string& suffix) const {
+  return directory_ + "/" + key + suffix;
+}
+
+c10::optional<std::string> KernelDiskCache::lookup(
+    const std::string& key,
+    const std::string& suffix) {
+#ifdef _WIN32
+  return c10::nullopt;
+#else
+  std::string entry = path(key, suffix);
+  struct stat st;
+  if (stat(entry.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    ++num_misses_;
+    return c10::nullopt;
+  }
+  ++num_hits_;
+  // The modification time orders the entries for eviction.
+  utime(entry.c_str(), nullptr);
+  return entry;
+#endif
+}
+
+c10::optional<std::string> KernelDiskCache::read(
+    const std::string& key,
+    const std::string& suffix) {
+  auto entry = lookup(key, suffix);
+  if (!entry) {
+    return c10::nullopt;
+  }
+  std::ifstream in(*entry, std::ios::binary);
+  if (!in.is_open()) {
+    return c10::nullopt;
+  }
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+void KernelDiskCache::remove(
+    const std::string& key,
+    const std::string& suffix) {
+  std::remove(path(key, suffix).c_str());
+}
+
+void KernelDiskCache::removeCorrupt(
+    const std::string& key,
+    const std::string& suffix) {
+  remove(key, suffix);
+  --num_hits_;
+  ++num_misses_;
+}
+
+c10::optional<std::string> KernelDiskCache::write(
+    const std::string& key,
+    const std::string& suffix,
+    const std::string& contents) {
+#ifdef _WIN32
+  return c10::nullopt;
+#else
+  std::lock_guard<std::mutex> guard(mutex_);
+  // The entry is written to a temporary file that is then renamed, so that
+  // other processes never see a partial entry.
+  const std::string entry = path(key, suffix);
+  const std::string temp =
+      directory_ + "/.tmp." + std::to_string(getpid()) + "." + key + suffix;
+  {
+    std::ofstream out(temp, std::ios::binary);
+    out.write(contents.data(), contents.size());
+    if (!out) {
+      std::remove(temp.c_str());
+      return c10::nullopt;
+    }
+  }
+  if (std::rename(temp.c_str(), entry.c_str()) != 0) {
+    std::remove(temp.c_str());
+    return c10::nullopt;
+  }
+  evict(entry);
+  return entry;
+#endif
+}
+
+void KernelDiskCache::evict(const std::string& keep) {
+#ifndef _WIN32
+  struct Entry {
+    std::string path;
+    time_t mtime;
+    int64_t size;
+  };
+  std::vector<Entry> entries;
+  int64_t total_bytes = 0;
+  DIR* dir = opendir(directory_.c_str());
+  if (!dir) {
+    return;
+  }
+  while (dirent* file = readdir(dir)) {
+    // Only entries count: this skips ".", "..", the temporary files of writes
+    // in progress and anything the cache didn't write.
+    if (!isEntryName(file->d_name)) {
+      continue;
+    }
+    std::string file_path = directory_ + "/" + file->d_name;
+    struct stat st;
+    if (stat(file_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+      continue;
+    }
+    entries.push_back({file_path, st.st_mtime, st.st_size});
+    total_bytes += st.st_size;
+  }
+  closedir(dir);
+  if (total_bytes <= max_bytes_) {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.mtime < b.mtime;
+  });
+  for (const Entry& entry : entries) {
+    if (total_bytes <= max_bytes_) {
+      break;
+    }
+    if (entry.path != keep && unlink(entry.path.c_str()) == 0) {
+      total_bytes -= entry.size;
+    }
+  }
+#endif
+}
+
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+
+// A persistent cache of compiled kernels (shared objects of the CPU fuser,
+// object code of the tensorexpr LLVM backend) in a directory that can be
+// shared by processes. Entries are content addressed: the key of a kernel is
+// a hash of everything its compilation depends on (the generated code, the
+// compiler and its flags, the target), so that a process finds the kernels
+// compiled by earlier processes instead of compiling them again.
+//
+// The cache is enabled by PYTORCH_JIT_KERNEL_CACHE_DIR, and keeps its
+// entries in a pytorch_kernels subdirectory of it. It holds at most
+// PYTORCH_JIT_KERNEL_CACHE_MAX_MB megabytes (256 by default), and evicts the
+// least recently used entries first; files it didn't write are never
+// evicted. It is not available on Windows.
+class TORCH_API KernelDiskCache {
+ public:
+  // The cache configured by the environment, or nullptr if it is disabled.
+  static KernelDiskCache* get();
+
+  // Replaces the cache returned by get(), e.g. in tests, and returns the
+  // previous one.
+  static std::unique_ptr<KernelDiskCache> replace(
+      std::unique_ptr<KernelDiskCache> cache);
+
+  KernelDiskCache(std::string directory, int64_t max_bytes);
+
+  // The key of a kernel whose compilation depends on content only.
+  static std::string key(const std::string& content);
+
+  // The path of the entry, if it is in the cache. Marks it as recently used.
+  c10::optional<std::string> lookup(
+      const std::string& key,
+      const std::string& suffix);
+
+  // The contents of the entry, if it is in the cache.
+  c10::optional<std::string> read(
+      const std::string& key,
+      const std::string& suffix);
+
+  // Removes the entry.
+  void remove(const std::string& key, const std::string& suffix);
+
+  // Removes an entry that a lookup found but that turned out to be corrupt
+  // (e.g. truncated by a full disk), and counts that lookup as a miss.
+  void removeCorrupt(const std::string& key, const std::string& suffix);
+
+  // The number of lookups that found their entry, and that didn't.
+  int64_t num_hits() const {
+    return num_hits_;
+  }
+  int64_t num_misses() const {
+    return num_misses_;
+  }
+
+  // Stores the entry and returns its path, evicting older entries if the
+  // cache is full. Returns nullopt if the entry couldn't be written.
+  c10::optional<std::string> write(
+      const std::string& key,
+      const std::string& suffix,
+      const std::string& contents);
+
+ private:
+  std::string path(const std::string& key, const std::string& suffix) const;
+  void evict(const std::string& keep);
+
+  const std::string directory_;
+  const int64_t max_bytes_;
+  std::mutex mutex_;
+  std::atomic<int64_t> num_hits_{0};
+  std::atomic<int64_t> num_misses_{0};
+};
+
+} // namespace fuser
+} // namespace jit
+} // namespace torch
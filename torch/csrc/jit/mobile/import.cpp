@@ -237,8 +237,14 @@ mobile::Module _load_for_mobile(
 
 mobile::Module _load_for_mobile(
     const std::string& filename,
-    c10::optional<at::Device> device) {
-  std::unique_ptr<FileAdapter> rai = std::make_unique<FileAdapter>(filename);
+    c10::optional<at::Device> device,
+    bool use_mmap) {
+  std::unique_ptr<ReadAdapterInterface> rai;
+  if (use_mmap) {
+    rai = std::make_unique<MmapFileAdapter>(filename);
+  } else {
+    rai = std::make_unique<FileAdapter>(filename);
+  }
   auto module = _load_for_mobile(std::move(rai), device);
   return module;
 }
@@ -5,20 +5,25 @@
 #include <memory>
 
 #include "caffe2/serialize/file_adapter.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 namespace torch {
 namespace jit {
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapFileAdapter;
 using caffe2::serialize::ReadAdapterInterface;
 
 TORCH_API mobile::Module _load_for_mobile(
     std::istream& in,
     c10::optional<at::Device> device = c10::nullopt);
 
+// With use_mmap, the file is memory-mapped and parameters alias the mapping
+// instead of being read into memory; they are read-only.
 TORCH_API mobile::Module _load_for_mobile(
     const std::string& filename,
-    c10::optional<at::Device> device = c10::nullopt);
+    c10::optional<at::Device> device = c10::nullopt,
+    bool use_mmap = false);
 
 TORCH_API mobile::Module _load_for_mobile(
     std::unique_ptr<ReadAdapterInterface> rai,
@@ -0,0 +1,219 @@
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/ScalarType.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/liveness.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Bytes of the storage of a tensor with a complete type, or nullopt.
+c10::optional<size_t> storageBytes(const Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  if (!type || !type->isComplete()) {
+    return c10::nullopt;
+  }
+  auto sizes = *type->sizes().concrete_sizes();
+  auto strides = *type->strides().concrete_sizes();
+  size_t numel = 1;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    if (sizes[i] == 0) {
+      return 0;
+    }
+    numel += (sizes[i] - 1) * strides[i];
+  }
+  return numel * c10::elementSize(*type->scalarType());
+}
+
+} // namespace
+
+std::unordered_map<const Value*, LiveRange> ComputeLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    const AliasDb& alias_db,
+    at::ArrayRef<Value*> values) {
+  std::unordered_map<const Node*, size_t> node_index;
+  std::vector<Node*> nodes;
+  for (Node* n : graph->nodes()) {
+    node_index.emplace(n, nodes.size());
+    nodes.push_back(n);
+  }
+  // Uses inside nested blocks count as uses by the enclosing top-level node.
+  auto topLevelIndex = [&](Node* n) {
+    while (n->owningBlock() != graph->block()) {
+      n = n->owningBlock()->owningNode();
+    }
+    return node_index.at(n);
+  };
+
+  std::unordered_map<const Value*, size_t> last_use;
+  for (const auto& entry : BuildLivenessSets(graph)) {
+    const size_t index = topLevelIndex(entry.first);
+    for (Value* v : entry.second) {
+      auto& last = last_use[v];
+      last = std::max(last, index);
+    }
+  }
+  auto lastUse = [&](const Value* v) {
+    auto it = last_use.find(v);
+    return it != last_use.end() ? it->second : node_index.at(v->node());
+  };
+
+  std::unordered_map<const Value*, LiveRange> ranges;
+  for (Value* v : values) {
+    LiveRange range{node_index.at(v->node()), lastUse(v)};
+    for (Node* n : nodes) {
+      for (Value* u : n->outputs()) {
+        if (u != v && alias_db.mayContainAlias(u, v)) {
+          range.end = std::max(range.end, lastUse(u));
+        }
+      }
+    }
+    ranges.emplace(v, range);
+  }
+  return ranges;
+}
+
+size_t AssignArenaOffsets(
+    const std::vector<LiveRange>& ranges,
+    const std::vector<size_t>& sizes,
+    std::vector<size_t>& offsets) {
+  TORCH_INTERNAL_ASSERT(ranges.size() == sizes.size());
+  // Linear scan over the buffers in order of definition: a buffer takes the
+  // smallest slot that is free for its whole live range and large enough,
+  // otherwise it grows the largest free slot, otherwise it opens a new one.
+  std::vector<size_t> order(ranges.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return ranges[a].begin < ranges[b].begin;
+  });
+
+  struct Slot {
+    size_t bytes;
+    size_t end;
+  };
+  std::vector<Slot> slots;
+  std::vector<size_t> slot_of(ranges.size(), 0);
+  for (size_t i : order) {
+    if (sizes[i] == 0) {
+      continue;
+    }
+    Slot* best = nullptr;
+    Slot* largest = nullptr;
+    for (auto& slot : slots) {
+      if (slot.end >= ranges[i].begin) {
+        continue;
+      }
+      if (slot.bytes >= sizes[i] && (!best || slot.bytes < best->bytes)) {
+        best = &slot;
+      }
+      if (!largest || slot.bytes > largest->bytes) {
+        largest = &slot;
+      }
+    }
+    Slot* slot = best ? best : largest;
+    if (!slot) {
+      slots.push_back(Slot{0, 0});
+      slot = &slots.back();
+    }
+    slot->bytes = std::max(slot->bytes, sizes[i]);
+    slot->end = ranges[i].end;
+    slot_of[i] = slot - slots.data();
+  }
+
+  std::vector<size_t> slot_offsets(slots.size());
+  size_t total = 0;
+  for (size_t s = 0; s < slots.size(); ++s) {
+    slot_offsets[s] = total;
+    total += (slots[s].bytes + c10::gAlignment - 1) / c10::gAlignment *
+        c10::gAlignment;
+  }
+  offsets.resize(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    offsets[i] = sizes[i] == 0 ? 0 : slot_offsets[slot_of[i]];
+  }
+  return total;
+}
+
+MemoryPlan PlanMemory(
+    const std::shared_ptr<Graph>& graph,
+    const std::function<bool(const Value*)>& should_plan) {
+  AliasDb alias_db(graph);
+  MemoryPlan plan;
+  std::vector<Value*> planned;
+  std::vector<size_t> sizes;
+  for (Node* n : graph->nodes()) {
+    if (n->kind() == prim::Constant) {
+      continue;
+    }
+    for (Value* v : n->outputs()) {
+      if (!v->type()->isSubtypeOf(TensorType::get())) {
+        continue;
+      }
+      if (should_plan && !should_plan(v)) {
+        continue;
+      }
+      // Only tensors owning fresh memory that is not handed to the caller
+      // can be placed in the arena.
+      auto size = storageBytes(v);
+      if (!size || alias_db.mayContainAlias(n->inputs(), v) ||
+          alias_db.mayContainAlias(graph->inputs(), v) ||
+          alias_db.mayContainAlias(v, graph->outputs())) {
+        plan.unplanned.push_back(v);
+        continue;
+      }
+      planned.push_back(v);
+      sizes.push_back(*size);
+    }
+  }
+
+  auto live_ranges = ComputeLiveRanges(graph, alias_db, planned);
+  std::vector<LiveRange> ranges;
+  for (Value* v : planned) {
+    ranges.push_back(live_ranges.at(v));
+  }
+  std::vector<size_t> offsets;
+  plan.arena_bytes = AssignArenaOffsets(ranges, sizes, offsets);
+
+  size_t num_nodes = 0;
+  for (size_t i = 0; i < planned.size(); ++i) {
+    plan.allocations.push_back({planned[i], ranges[i], sizes[i], offsets[i]});
+    plan.naive_bytes += sizes[i];
+    num_nodes = std::max(num_nodes, ranges[i].end + 1);
+  }
+  std::vector<size_t> live_bytes(num_nodes, 0);
+  for (const auto& allocation : plan.allocations) {
+    for (size_t t = allocation.range.begin; t <= allocation.range.end; ++t) {
+      live_bytes[t] += allocation.size;
+    }
+  }
+  for (size_t bytes : live_bytes) {
+    plan.peak_live_bytes = std::max(plan.peak_live_bytes, bytes);
+  }
+  GRAPH_DEBUG("Memory plan:\n", plan);
+  return plan;
+}
+
+std::ostream& operator<<(std::ostream& out, const MemoryPlan& plan) {
+  out << "arena: " << plan.arena_bytes << " bytes, naive: " << plan.naive_bytes
+      << " bytes, peak live: " << plan.peak_live_bytes << " bytes, "
+      << plan.allocations.size() << " planned and " << plan.unplanned.size()
+      << " unplanned tensors\n";
+  for (const auto& allocation : plan.allocations) {
+    out << "  %" << allocation.value->debugName() << ": offset "
+        << allocation.offset << ", " << allocation.size << " bytes, nodes ["
+        << allocation.range.begin << ", " << allocation.range.end << "]\n";
+  }
+  for (const Value* v : plan.unplanned) {
+    out << "  %" << v->debugName() << ": unplanned\n";
+  }
+  return out;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <functional>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// Range of top-level nodes of a graph during which a value is alive: from the
+// index of the node defining it to the index of the last node using it or any
+// value that may alias it (both inclusive).
+struct LiveRange {
+  size_t begin;
+  size_t end;
+};
+
+// Computes the live ranges of `values`, which must be outputs of top-level
+// nodes of `graph`. Uses come from BuildLivenessSets; aliases (views,
+// containers, results of in-place ops) come from `alias_db`.
+TORCH_API std::unordered_map<const Value*, LiveRange> ComputeLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    const AliasDb& alias_db,
+    at::ArrayRef<Value*> values);
+
+// Places buffers of the given sizes and live ranges in a single arena, so
+// that buffers whose live ranges overlap do not overlap in memory. Offsets
+// are aligned to c10::gAlignment. Returns the size of the arena.
+TORCH_API size_t AssignArenaOffsets(
+    const std::vector<LiveRange>& ranges,
+    const std::vector<size_t>& sizes,
+    std::vector<size_t>& offsets);
+
+// Result of PlanMemory.
+struct TORCH_API MemoryPlan {
+  struct Allocation {
+    Value* value;
+    LiveRange range;
+    size_t size;
+    size_t offset;
+  };
+  std::vector<Allocation> allocations;
+  // Tensors produced by top-level nodes that could not be planned, because
+  // their type is not complete or they may alias a graph input or output.
+  std::vector<Value*> unplanned;
+  // Size of the arena holding every planned tensor.
+  size_t arena_bytes = 0;
+  // Memory needed if every planned tensor had its own allocation for the
+  // whole run.
+  size_t naive_bytes = 0;
+  // Largest number of bytes of planned tensors alive at the same time; no
+  // plan can use less than this.
+  size_t peak_live_bytes = 0;
+};
+
+// Plans the memory of the tensors produced by the top-level nodes of a graph
+// whose tensor types are complete (e.g. after shape propagation with example
+// inputs). Values for which `should_plan` returns false are skipped.
+TORCH_API MemoryPlan PlanMemory(
+    const std::shared_ptr<Graph>& graph,
+    const std::function<bool(const Value*)>& should_plan = nullptr);
+
+// Prints the arena size against the naive and peak-live sizes, followed by
+// the offset, size and live range of every allocation.
+TORCH_API std::ostream& operator<<(std::ostream& out, const MemoryPlan& plan);
+
+} // namespace jit
+} // namespace torch
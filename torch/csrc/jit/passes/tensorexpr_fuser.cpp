@@ -42,6 +42,27 @@ value_list sortReverseTopological(
   return result;
 }
 
+// Reductions are only lowered for the LLVM backend, on static dims and with
+// the accumulation done in the dtype of the result.
+static bool isSupportedReduction(Node* node) {
+  if (!node->matches(
+          "aten::sum(Tensor self, int[1] dim, bool keepdim=False, *, ScalarType? dtype=None) -> Tensor",
+          /*const_inputs=*/{attr::dim, attr::keepdim})) {
+    return false;
+  }
+  if (!node->namedInput(attr::dtype)->mustBeNone()) {
+    return false;
+  }
+  auto type = node->input(0)->type()->cast<TensorType>();
+  if (!type || !type->device() || !type->device()->is_cpu()) {
+    return false;
+  }
+  auto scalarType = type->scalarType();
+  return scalarType &&
+      (*scalarType == at::kFloat || *scalarType == at::kDouble ||
+       *scalarType == at::kInt || *scalarType == at::kLong);
+}
+
 bool isSupported(Node* node) {
   // TODO:
   switch (node->kind()) {
@@ -111,6 +132,8 @@ bool isSupported(Node* node) {
     case aten::__rshift__:
     case aten::where:
       return true;
+    case aten::sum:
+      return isSupportedReduction(node);
     default:
       return false;
   }
@@ -0,0 +1,297 @@
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+#include <ATen/ATen.h>
+#include <ATen/core/grad_mode.h>
+#include <c10/core/CPUAllocator.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
+#include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+std::shared_ptr<Graph> frozenForwardGraph(const torch::jit::Module& m) {
+  auto frozen = freeze_module(m);
+  auto graph = frozen.get_method("forward").graph()->copy();
+  TORCH_CHECK(
+      !graph->inputs().at(0)->hasUses(),
+      "Static runtime requires a module whose forward method does not use "
+      "self after freezing");
+  graph->eraseInput(0);
+  return graph;
+}
+
+} // namespace
+
+ProcessedNode::ProcessedNode(
+    Node* node,
+    std::vector<const c10::IValue*> inputs,
+    std::vector<c10::IValue*> outputs)
+    : node_(node),
+      inputs_(std::move(inputs)),
+      outputs_(std::move(outputs)),
+      fn_(getOutOfPlaceOperation(node)) {
+  if (!fn_) {
+    op_ = node->getOperation();
+  }
+}
+
+void ProcessedNode::run() {
+  if (fn_) {
+    fn_(this);
+    return;
+  }
+  for (const auto* input : inputs_) {
+    stack_.push_back(*input);
+  }
+  op_(stack_);
+  TORCH_INTERNAL_ASSERT(stack_.size() == outputs_.size());
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    *outputs_[i] = std::move(stack_[i]);
+  }
+  stack_.clear();
+}
+
+MemoryPlanner::MemoryPlanner(
+    std::vector<c10::IValue*> values,
+    std::vector<LiveRange> lifetimes)
+    : values_(std::move(values)),
+      lifetimes_(std::move(lifetimes)),
+      max_bytes_(values_.size(), 0),
+      offsets_(values_.size(), 0) {}
+
+void MemoryPlanner::update() {
+  bool replan = false;
+  for (size_t i = 0; i < values_.size(); ++i) {
+    const auto& value = *values_[i];
+    if (!value.isTensor()) {
+      continue;
+    }
+    const auto* impl = value.unsafeToTensorImpl();
+    if (impl->device_type() != at::kCPU) {
+      continue;
+    }
+    const auto* storage = impl->storage().unsafeGetStorageImpl();
+    const size_t nbytes = storage->capacity();
+    if (nbytes > max_bytes_[i]) {
+      max_bytes_[i] = nbytes;
+      replan = true;
+    } else if (
+        nbytes > 0 &&
+        storage->data() != static_cast<char*>(buffer_.get()) + offsets_[i]) {
+      // The kernel replaced the storage, e.g. because the tensor was resized
+      // while its slot was shared with a larger one.
+      replan = true;
+    }
+  }
+  if (replan) {
+    plan();
+    bind();
+  }
+}
+
+void MemoryPlanner::plan() {
+  total_bytes_ = AssignArenaOffsets(lifetimes_, max_bytes_, offsets_);
+}
+
+void MemoryPlanner::bind() {
+  // The previous buffer is only released once every managed tensor points
+  // into the new one.
+  auto buffer = c10::GetCPUAllocator()->allocate(total_bytes_);
+  char* base = static_cast<char*>(buffer.get());
+  for (size_t i = 0; i < values_.size(); ++i) {
+    if (max_bytes_[i] == 0 || !values_[i]->isTensor()) {
+      continue;
+    }
+    auto* storage =
+        values_[i]->unsafeToTensorImpl()->storage().unsafeGetStorageImpl();
+    void* ptr = base + offsets_[i];
+    storage->set_data_ptr(at::DataPtr(ptr, ptr, nullptr, at::kCPU));
+    storage->set_numel(max_bytes_[i] / storage->itemsize());
+  }
+  buffer_ = std::move(buffer);
+}
+
+StaticRuntime::StaticRuntime(const torch::jit::Module& m)
+    : StaticRuntime(frozenForwardGraph(m)) {}
+
+StaticRuntime::StaticRuntime(std::shared_ptr<Graph> g)
+    : graph_(std::move(g)) {
+  Inline(*graph_);
+  ConstantPropagation(graph_);
+  EliminateDeadCode(graph_);
+  for (Node* n : graph_->nodes()) {
+    TORCH_CHECK(
+        n->blocks().empty(),
+        "Static runtime does not support control flow, found ",
+        n->kind().toQualString());
+  }
+  prepare();
+}
+
+StaticRuntime::~StaticRuntime() = default;
+
+void StaticRuntime::prepare() {
+  // Assign an index to every value first: values_ must not be resized once
+  // the ProcessedNodes point into it.
+  std::unordered_map<const Value*, size_t> value_index;
+  for (Value* v : graph_->inputs()) {
+    input_indices_.push_back(value_index.size());
+    value_index.emplace(v, value_index.size());
+  }
+  for (Node* n : graph_->nodes()) {
+    for (Value* v : n->outputs()) {
+      value_index.emplace(v, value_index.size());
+    }
+  }
+  values_.resize(value_index.size());
+  for (Value* v : graph_->outputs()) {
+    output_indices_.push_back(value_index.at(v));
+  }
+
+  AliasDb alias_db(graph_);
+  std::vector<Value*> managed;
+  // Constants and managed tensors persist across runs.
+  std::vector<bool> persistent(values_.size(), false);
+  for (Node* n : graph_->nodes()) {
+    if (n->kind() == prim::Constant) {
+      const size_t index = value_index.at(n->output());
+      values_[index] = toIValue(n->output()).value();
+      persistent[index] = true;
+      continue;
+    }
+
+    std::vector<const c10::IValue*> inputs;
+    for (Value* v : n->inputs()) {
+      inputs.push_back(&values_[value_index.at(v)]);
+    }
+    std::vector<c10::IValue*> outputs;
+    for (Value* v : n->outputs()) {
+      outputs.push_back(&values_[value_index.at(v)]);
+    }
+    nodes_.emplace_back(n, std::move(inputs), std::move(outputs));
+    if (!nodes_.back().has_out_variant()) {
+      continue;
+    }
+
+    // The tensors written by out variants keep their memory across runs, so
+    // they may only be managed if nothing returned to the caller can refer
+    // to them.
+    Value* out = n->output();
+    if (alias_db.mayContainAlias({out}, graph_->outputs())) {
+      continue;
+    }
+    managed.push_back(out);
+    persistent[value_index.at(out)] = true;
+  }
+
+  for (size_t i = 0; i < values_.size(); ++i) {
+    if (!persistent[i]) {
+      transient_indices_.push_back(i);
+    }
+  }
+  if (managed.empty()) {
+    return;
+  }
+  // Values that may alias a managed tensor (views, containers, results of
+  // in-place ops) extend its lifetime.
+  auto live_ranges = ComputeLiveRanges(graph_, alias_db, managed);
+  std::vector<c10::IValue*> managed_values;
+  std::vector<LiveRange> lifetimes;
+  for (Value* v : managed) {
+    managed_values.push_back(&values_[value_index.at(v)]);
+    lifetimes.push_back(live_ranges.at(v));
+  }
+  planner_ = std::make_unique<MemoryPlanner>(
+      std::move(managed_values), std::move(lifetimes));
+
+  // Tensors whose type is complete are allocated up front so that the first
+  // run already goes through the out variants and the planned arena.
+  bool preallocated = false;
+  for (Value* v : managed) {
+    auto type = v->type()->cast<TensorType>();
+    if (!type || !type->isComplete() || type->device()->type() != at::kCPU) {
+      continue;
+    }
+    values_[value_index.at(v)] = at::empty_strided(
+        *type->sizes().concrete_sizes(),
+        *type->strides().concrete_sizes(),
+        at::TensorOptions(*type->device()).dtype(*type->scalarType()));
+    preallocated = true;
+  }
+  if (preallocated) {
+    planner_->update();
+  }
+}
+
+std::vector<c10::IValue> StaticRuntime::run_with_ivalues(
+    std::vector<c10::IValue> inputs) {
+  TORCH_CHECK(
+      inputs.size() == input_indices_.size(),
+      "Expected ",
+      input_indices_.size(),
+      " inputs, got ",
+      inputs.size());
+  // Out variants do not support autograd, and frozen graphs are inference
+  // only anyway.
+  at::AutoGradMode grad_mode(false);
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    values_[input_indices_[i]] = std::move(inputs[i]);
+  }
+  for (auto& node : nodes_) {
+    node.run();
+  }
+
+  std::vector<c10::IValue> outputs;
+  outputs.reserve(output_indices_.size());
+  for (size_t index : output_indices_) {
+    outputs.push_back(values_[index]);
+  }
+  if (planner_) {
+    planner_->update();
+  }
+  for (size_t index : transient_indices_) {
+    values_[index] = c10::IValue();
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> StaticRuntime::run(
+    const std::vector<at::Tensor>& inputs) {
+  std::vector<c10::IValue> ivalues(inputs.begin(), inputs.end());
+  std::vector<at::Tensor> tensors;
+  for (auto& output : run_with_ivalues(std::move(ivalues))) {
+    if (output.isTuple()) {
+      for (const auto& element : output.toTuple()->elements()) {
+        tensors.push_back(element.toTensor());
+      }
+    } else {
+      tensors.push_back(output.toTensor());
+    }
+  }
+  return tensors;
+}
+
+size_t StaticRuntime::num_out_variant_nodes() const {
+  return std::count_if(
+      nodes_.begin(), nodes_.end(), [](const ProcessedNode& node) {
+        return node.has_out_variant();
+      });
+}
+
+size_t StaticRuntime::planned_bytes() const {
+  return planner_ ? planner_->total_bytes() : 0;
+}
+
+} // namespace jit
+} // namespace torch
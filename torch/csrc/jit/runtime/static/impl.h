@@ -0,0 +1,155 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <ATen/core/stack.h>
+#include <c10/core/Allocator.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+class ProcessedNode;
+
+// Signature of the out variants in static/ops.h. The function writes the
+// results of the node into the tensors already held by its outputs, or
+// creates them if the outputs are still None.
+using SROperator = std::function<void(ProcessedNode*)>;
+
+// A node of the graph prepared for execution by the StaticRuntime. Inputs and
+// outputs point directly into the runtime's value table, so running a node
+// does not copy any IValue in or out of a stack.
+class ProcessedNode {
+ public:
+  ProcessedNode(
+      Node* node,
+      std::vector<const c10::IValue*> inputs,
+      std::vector<c10::IValue*> outputs);
+
+  void run();
+
+  Node* node() const {
+    return node_;
+  }
+
+  const c10::IValue& Input(size_t i) const {
+    return *inputs_[i];
+  }
+
+  c10::IValue& Output(size_t i) const {
+    return *outputs_[i];
+  }
+
+  // True if the node runs through an out variant, i.e. it reuses the tensors
+  // of its outputs from one run to the next.
+  bool has_out_variant() const {
+    return static_cast<bool>(fn_);
+  }
+
+ private:
+  Node* node_;
+  std::vector<const c10::IValue*> inputs_;
+  std::vector<c10::IValue*> outputs_;
+  // Exactly one of fn_ and op_ is set.
+  SROperator fn_;
+  Operation op_;
+  // Reused by op_ across runs.
+  Stack stack_;
+};
+
+// Assigns the tensors produced by out variants to offsets in a single buffer.
+// Tensors whose lifetimes (in node indices) do not overlap share memory. The
+// plan is recomputed whenever a tensor no longer fits its slot, so after the
+// first few runs with a given input size no memory is allocated at all.
+class MemoryPlanner {
+ public:
+  MemoryPlanner(
+      std::vector<c10::IValue*> values,
+      std::vector<LiveRange> lifetimes);
+
+  // Called after every run: records the sizes of the managed tensors and
+  // rebinds them to a new buffer if the plan changed.
+  void update();
+
+  size_t total_bytes() const {
+    return total_bytes_;
+  }
+
+ private:
+  void plan();
+  void bind();
+
+  std::vector<c10::IValue*> values_;
+  std::vector<LiveRange> lifetimes_;
+  // Largest size seen so far of each value's storage.
+  std::vector<size_t> max_bytes_;
+  std::vector<size_t> offsets_;
+  size_t total_bytes_ = 0;
+  at::DataPtr buffer_;
+};
+
+// A runtime for frozen inference graphs without control flow.
+//
+// The graph is prepared once: constants are materialized, every node gets its
+// inputs and outputs resolved to slots of a flat value table, and nodes with
+// an out variant (see static/ops.h) call the ATen out= kernel directly
+// instead of going through the boxed operator. The tensors produced by out
+// variants are managed by a MemoryPlanner based on the liveness of the graph
+// values, so steady-state runs reuse the same memory for intermediates. When
+// the graph carries complete tensor types (e.g. after shape propagation), the
+// managed tensors are planned ahead of time and even the first run writes
+// into the arena.
+//
+// A StaticRuntime is not thread safe; use one instance per thread.
+class TORCH_API StaticRuntime {
+ public:
+  // Freezes the module and runs its forward method. The module must be in
+  // eval mode.
+  explicit StaticRuntime(const torch::jit::Module& m);
+  explicit StaticRuntime(std::shared_ptr<Graph> g);
+
+  ~StaticRuntime();
+
+  // Runs the graph with tensor inputs and returns its outputs; a tuple output
+  // is flattened into the returned vector.
+  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inputs);
+
+  // Runs the graph with arbitrary inputs and returns the graph outputs.
+  std::vector<c10::IValue> run_with_ivalues(std::vector<c10::IValue> inputs);
+
+  const std::shared_ptr<Graph>& graph() const {
+    return graph_;
+  }
+
+  // Number of nodes that run through an out variant.
+  size_t num_out_variant_nodes() const;
+
+  // Size of the buffer currently holding the intermediate tensors.
+  size_t planned_bytes() const;
+
+ private:
+  void prepare();
+
+  std::shared_ptr<Graph> graph_;
+  // Graph inputs, node outputs and constants, indexed as assigned in
+  // prepare(). Never resized after prepare(), so pointers stay valid.
+  std::vector<c10::IValue> values_;
+  std::vector<size_t> input_indices_;
+  std::vector<size_t> output_indices_;
+  // Values released after every run: everything but constants and the
+  // tensors managed by planner_. Results of out variants that may alias a
+  // graph output are included, so that the next run does not write into
+  // memory handed out to the caller.
+  std::vector<size_t> transient_indices_;
+  std::vector<ProcessedNode> nodes_;
+  std::unique_ptr<MemoryPlanner> planner_;
+};
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,155 @@
+#include <torch/csrc/jit/runtime/static/ops.h>
+
+#include <ATen/ATen.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Calls functional() on the first run, when the output is still None, and
+// out_variant(out) with the tensor of the previous run afterwards.
+template <typename Functional, typename OutVariant>
+void runOutVariant(
+    ProcessedNode* p,
+    Functional functional,
+    OutVariant out_variant) {
+  auto& output = p->Output(0);
+  if (output.isNone()) {
+    output = functional();
+    return;
+  }
+  auto out = output.toTensor();
+  out_variant(out);
+}
+
+c10::optional<at::Scalar> toOptionalScalar(const c10::IValue& v) {
+  if (v.isNone()) {
+    return c10::nullopt;
+  }
+  return v.toScalar();
+}
+
+using OutVariantEntry = std::pair<const char*, SROperator>;
+
+const std::vector<OutVariantEntry>& outVariants() {
+  static const std::vector<OutVariantEntry> variants = {
+      {"aten::add.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         auto other = p->Input(1).toTensor();
+         auto alpha = p->Input(2).toScalar();
+         runOutVariant(
+             p,
+             [&] { return at::add(self, other, alpha); },
+             [&](at::Tensor& out) { at::add_out(out, self, other, alpha); });
+       }},
+      {"aten::mul.Tensor(Tensor self, Tensor other) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         auto other = p->Input(1).toTensor();
+         runOutVariant(
+             p,
+             [&] { return at::mul(self, other); },
+             [&](at::Tensor& out) { at::mul_out(out, self, other); });
+       }},
+      {"aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         auto mat1 = p->Input(1).toTensor();
+         auto mat2 = p->Input(2).toTensor();
+         auto beta = p->Input(3).toScalar();
+         auto alpha = p->Input(4).toScalar();
+         runOutVariant(
+             p,
+             [&] { return at::addmm(self, mat1, mat2, beta, alpha); },
+             [&](at::Tensor& out) {
+               at::addmm_out(out, self, mat1, mat2, beta, alpha);
+             });
+       }},
+      {"aten::mm(Tensor self, Tensor mat2) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         auto mat2 = p->Input(1).toTensor();
+         runOutVariant(
+             p,
+             [&] { return at::mm(self, mat2); },
+             [&](at::Tensor& out) { at::mm_out(out, self, mat2); });
+       }},
+      {"aten::bmm(Tensor self, Tensor mat2) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         auto mat2 = p->Input(1).toTensor();
+         runOutVariant(
+             p,
+             [&] { return at::bmm(self, mat2); },
+             [&](at::Tensor& out) { at::bmm_out(out, self, mat2); });
+       }},
+      // relu has no out variant; threshold(x, 0, 0) computes the same values.
+      {"aten::relu(Tensor self) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         runOutVariant(
+             p,
+             [&] { return at::relu(self); },
+             [&](at::Tensor& out) { at::threshold_out(out, self, 0, 0); });
+       }},
+      {"aten::sigmoid(Tensor self) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         runOutVariant(
+             p,
+             [&] { return at::sigmoid(self); },
+             [&](at::Tensor& out) { at::sigmoid_out(out, self); });
+       }},
+      {"aten::tanh(Tensor self) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         runOutVariant(
+             p,
+             [&] { return at::tanh(self); },
+             [&](at::Tensor& out) { at::tanh_out(out, self); });
+       }},
+      {"aten::clamp(Tensor self, Scalar? min=None, Scalar? max=None) -> Tensor",
+       [](ProcessedNode* p) {
+         auto self = p->Input(0).toTensor();
+         auto min = toOptionalScalar(p->Input(1));
+         auto max = toOptionalScalar(p->Input(2));
+         runOutVariant(
+             p,
+             [&] { return at::clamp(self, min, max); },
+             [&](at::Tensor& out) { at::clamp_out(out, self, min, max); });
+       }},
+      {"aten::cat(Tensor[] tensors, int dim=0) -> Tensor",
+       [](ProcessedNode* p) {
+         auto tensors = p->Input(0).toTensorVector();
+         auto dim = p->Input(1).toInt();
+         runOutVariant(
+             p,
+             [&] { return at::cat(tensors, dim); },
+             [&](at::Tensor& out) { at::cat_out(out, tensors, dim); });
+       }},
+  };
+  return variants;
+}
+
+} // namespace
+
+bool canRunOutOfPlace(Node* n) {
+  return static_cast<bool>(getOutOfPlaceOperation(n));
+}
+
+SROperator getOutOfPlaceOperation(Node* n) {
+  for (const auto& entry : outVariants()) {
+    if (n->matches(entry.first)) {
+      return entry.second;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace jit
+} // namespace torch
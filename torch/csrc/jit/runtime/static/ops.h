@@ -0,0 +1,19 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+namespace torch {
+namespace jit {
+
+// Returns true if the static runtime has an out variant for n.
+bool canRunOutOfPlace(Node* n);
+
+// Returns the out variant for n, which writes into the tensors held by the
+// outputs of its ProcessedNode. On the first run the outputs are None and
+// the functional op is called instead, so that the output dtype and device
+// come from the kernel itself.
+SROperator getOutOfPlaceOperation(Node* n);
+
+} // namespace jit
+} // namespace torch
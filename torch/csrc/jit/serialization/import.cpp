@@ -15,6 +15,7 @@
 #include "caffe2/serialize/file_adapter.h"
 #include "caffe2/serialize/inline_container.h"
 #include "caffe2/serialize/istream_adapter.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 #include <ATen/ATen.h>
 
@@ -28,6 +29,7 @@ namespace jit {
 
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapFileAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
@@ -227,8 +229,12 @@ Module import_ir_module(
     std::shared_ptr<CompilationUnit> cu,
     const std::string& filename,
     c10::optional<at::Device> device,
-    ExtraFilesMap& extra_files) {
-  auto reader = torch::make_unique<PyTorchStreamReader>(filename);
+    ExtraFilesMap& extra_files,
+    bool use_mmap) {
+  auto reader = use_mmap
+      ? torch::make_unique<PyTorchStreamReader>(
+            std::make_unique<MmapFileAdapter>(filename))
+      : torch::make_unique<PyTorchStreamReader>(filename);
   ScriptModuleDeserializer deserializer(std::move(cu), std::move(reader));
   return deserializer.deserialize(device, extra_files);
 }
@@ -256,8 +262,14 @@ Module load(
 Module load(
     const std::string& filename,
     c10::optional<at::Device> device,
-    ExtraFilesMap& extra_files) {
-  std::unique_ptr<FileAdapter> rai = std::make_unique<FileAdapter>(filename);
+    ExtraFilesMap& extra_files,
+    bool use_mmap) {
+  std::unique_ptr<ReadAdapterInterface> rai;
+  if (use_mmap) {
+    rai = std::make_unique<MmapFileAdapter>(filename);
+  } else {
+    rai = std::make_unique<FileAdapter>(filename);
+  }
   auto module = load(std::move(rai), device, extra_files);
   return module;
 }
@@ -22,7 +22,8 @@ TORCH_API Module import_ir_module(
     std::shared_ptr<CompilationUnit> cu,
     const std::string& filename,
     c10::optional<c10::Device> device = c10::nullopt,
-    ExtraFilesMap& extra_files = default_extra_files);
+    ExtraFilesMap& extra_files = default_extra_files,
+    bool use_mmap = false);
 
 TORCH_API Module import_ir_module(
     std::shared_ptr<CompilationUnit> cu,
@@ -50,10 +51,16 @@ TORCH_API Module load(
 /// The file stored at the location given in `filename` must contain a
 /// serialized `Module`, exported either via `ScriptModule.save()` in
 /// Python or `torch::jit::ExportModule` in C++.
+///
+/// With `use_mmap`, the file is memory-mapped and CPU tensors alias the
+/// mapping instead of being read into memory. The mapping is read-only, so
+/// clone a tensor before modifying it in place (see
+/// `caffe2::serialize::MmapFileAdapter`).
 TORCH_API Module load(
     const std::string& filename,
     c10::optional<c10::Device> device = c10::nullopt,
-    ExtraFilesMap& extra_files = default_extra_files);
+    ExtraFilesMap& extra_files = default_extra_files,
+    bool use_mmap = false);
 
 /// Loads a serialized `Module` from the given `rai`.
 ///
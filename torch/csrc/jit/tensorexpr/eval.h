@@ -694,6 +694,8 @@ class SimpleIREvaluator : public CodeGen, public IRVisitor {
           "Free a buffer that is not currently bound: " +
           buffer_var->name_hint());
     }
+    // The buffer may be allocated again, e.g. if it is freed in a loop.
+    buffer_mapping_.erase(buffer_var);
   }
 
   void visit(const Cond* v) override {
@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/tensorexpr/function.h>
 
 #include <c10/util/Logging.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
 namespace torch {
@@ -106,6 +107,45 @@ Tensor* Compute(
   return new Tensor(func, 0);
 }
 
+Tensor* Reduce(
+    const std::string& func_name,
+    const std::vector<DimArg>& dim_args,
+    const Reducer& reducer,
+    const std::function<ExprHandle(const std::vector<VarHandle>&)>& body_func,
+    const std::vector<DimArg>& reduce_args) {
+  std::vector<const Expr*> dims;
+  std::vector<const Var*> args;
+  unpack_dim_args(dim_args, &dims, &args);
+  std::vector<const Expr*> reduce_dims;
+  std::vector<const Var*> reduce_vars;
+  unpack_dim_args(reduce_args, &reduce_dims, &reduce_vars);
+
+  std::vector<const Var*> all_args(args);
+  all_args.insert(all_args.end(), reduce_vars.begin(), reduce_vars.end());
+  const Expr* body = body_func(VarVectorToVarHandleVector(all_args)).node();
+  const Expr* reduce_op = new ReduceOp(body, reduce_vars, reduce_dims, reducer);
+  Function* func = new Function(func_name, dims, args, reduce_op);
+  return new Tensor(func, 0);
+}
+
+Tensor* Reduce(
+    const std::string& func_name,
+    const std::vector<DimArg>& dim_args,
+    const Reducer& reducer,
+    Tensor* tensor,
+    const std::vector<DimArg>& reduce_args) {
+  if (static_cast<size_t>(tensor->ndim()) !=
+      dim_args.size() + reduce_args.size()) {
+    throw malformed_input();
+  }
+  return Reduce(
+      func_name,
+      dim_args,
+      reducer,
+      [&](const std::vector<VarHandle>& vars) { return tensor->call(vars); },
+      reduce_args);
+}
+
 Stmt* Function::ElementStmt(size_t index) {
   std::vector<ExprHandle> strides(dims_.size());
   for (size_t i = 0; i < strides.size(); i++) {
@@ -132,9 +172,38 @@ Stmt* Function::ElementStmt(size_t index) {
 
   const Expr* mask = new IntImm(1);
 
-  Stmt* update_stmt =
-      new Store(func_var(index), total_index.node(), body(index), mask);
-  return update_stmt;
+  const ReduceOp* reduce_op = dynamic_cast<const ReduceOp*>(body(index));
+  if (!reduce_op) {
+    Stmt* update_stmt =
+        new Store(func_var(index), total_index.node(), body(index), mask);
+    return update_stmt;
+  }
+
+  // A reduction initializes the element, then combines the body into it in
+  // a loop nest over the reduce axes.
+  const Reducer& reducer = reduce_op->reducer();
+  Dtype dtype = reduce_op->dtype();
+  Stmt* init_stmt = new Store(
+      func_var(index),
+      total_index.node(),
+      reducer.initializer(dtype).node(),
+      mask);
+  ExprHandle accumulator = Load::make(
+      dtype, VarHandle(func_var(index)), total_index, ExprHandle(mask));
+  Stmt* update_stmt = new Store(
+      func_var(index),
+      total_index.node(),
+      reducer.combine(accumulator, ExprHandle(reduce_op->body())).node(),
+      mask);
+  const std::vector<const Var*>& reduce_args = reduce_op->reduce_args();
+  for (size_t i = reduce_args.size(); i > 0; i--) {
+    update_stmt = For::make(
+        VarHandle(reduce_args[i - 1]),
+        0,
+        ExprHandle(reduce_op->reduce_dims()[i - 1]),
+        update_stmt);
+  }
+  return new Block({init_stmt, update_stmt});
 }
 
 } // namespace tensorexpr
@@ -2,6 +2,7 @@
 
 #include <torch/csrc/jit/tensorexpr/eval.h>
 #include <torch/csrc/jit/tensorexpr/ir.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 
 namespace torch {
 namespace jit {
@@ -239,6 +240,22 @@ const Expr* IRMutator::mutate(const LinearForm* v) {
   return new LinearForm(new_x, new_a, new_b);
 }
 
+const Expr* IRMutator::mutate(const ReduceOp* v) {
+  const Expr* body = v->body();
+  const Expr* body_new = body->accept_mutator(this);
+  bool any_change = body_new != body;
+  std::vector<const Expr*> dims_new;
+  for (const Expr* dim : v->reduce_dims()) {
+    const Expr* dim_new = dim->accept_mutator(this);
+    any_change |= dim_new != dim;
+    dims_new.push_back(dim_new);
+  }
+  if (!any_change) {
+    return v;
+  }
+  return new ReduceOp(body_new, v->reduce_args(), dims_new, v->reducer());
+}
+
 const Expr* IRMutator::mutate(const BaseCallNode* v) {
   std::vector<const Expr*> params(v->nparams());
   bool any_change = false;
@@ -46,6 +46,7 @@ class Free;
 class Cond;
 class Stmt;
 class LinearForm;
+class ReduceOp;
 
 class TORCH_API IRMutator {
  public:
@@ -87,6 +88,7 @@ class TORCH_API IRMutator {
   virtual const Expr* mutate(const FunctionCall* v);
 
   virtual const Expr* mutate(const LinearForm* v);
+  virtual const Expr* mutate(const ReduceOp* v);
 
   virtual Stmt* mutate(const For* v);
   virtual Stmt* mutate(const Block* v);
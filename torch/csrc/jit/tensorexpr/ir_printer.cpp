@@ -1,5 +1,7 @@
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 
+#include <torch/csrc/jit/tensorexpr/reduction.h>
+
 namespace torch {
 namespace jit {
 namespace tensorexpr {
@@ -373,6 +375,17 @@ void IRPrinter::visit(const LinearForm* v) {
        << ")" << std::endl;
 }
 
+void IRPrinter::visit(const ReduceOp* v) {
+  os() << "ReduceOp(" << *v->body() << ", reduce_args={";
+  for (size_t i = 0; i < v->reduce_args().size(); i++) {
+    if (i > 0) {
+      os() << ", ";
+    }
+    os() << *v->reduce_args()[i] << " < " << *v->reduce_dims()[i];
+  }
+  os() << "})";
+}
+
 void IRPrinter::emitIndent() {
   os() << std::setw(2 * indent_) << "";
 }
@@ -49,6 +49,7 @@ class TORCH_API IRPrinter : public IRVisitor {
   void visit(const Free* v) override;
   void visit(const Cond* v) override;
   void visit(const LinearForm* v) override;
+  void visit(const ReduceOp* v) override;
 
   std::ostream& os() {
     return printer_os_;
@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/tensorexpr/ir_visitor.h>
 
 #include <torch/csrc/jit/tensorexpr/ir.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
 namespace torch {
@@ -182,6 +183,13 @@ void IRVisitor::visit(const LinearForm* v) {
   v->getB()->accept(this);
 }
 
+void IRVisitor::visit(const ReduceOp* v) {
+  v->body()->accept(this);
+  for (const Expr* dim : v->reduce_dims()) {
+    dim->accept(this);
+  }
+}
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
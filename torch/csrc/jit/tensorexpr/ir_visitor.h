@@ -43,6 +43,7 @@ class Allocate;
 class Free;
 class Cond;
 class LinearForm;
+class ReduceOp;
 
 class TORCH_API IRVisitor {
  public:
@@ -91,6 +92,7 @@ class TORCH_API IRVisitor {
   virtual void visit(const Free* v);
   virtual void visit(const Cond* v);
   virtual void visit(const LinearForm* v);
+  virtual void visit(const ReduceOp* v);
 };
 
 } // namespace tensorexpr
@@ -1,9 +1,11 @@
 #include <torch/csrc/jit/tensorexpr/kernel.h>
 
+#include <ATen/Parallel.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/tensorexpr/analysis.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 #include <torch/csrc/jit/tensorexpr/schedule.h>
 
 using namespace torch::jit;
@@ -37,6 +39,10 @@ static at::ScalarType tensorType(Tensor* t) {
   return static_cast<at::ScalarType>(t->body()->dtype().scalar_type());
 }
 
+static bool isReduction(Tensor* t) {
+  return dynamic_cast<const ReduceOp*>(t->body()) != nullptr;
+}
+
 static std::vector<ExprHandle> texprSizes(const c10::VaryingShape& shape) {
   std::vector<ExprHandle> dims;
   for (size_t i = 0; i < *shape.size(); i++) {
@@ -391,6 +397,68 @@ Tensor* TensorExprKernel::computeFourOperand(
       });
 }
 
+Tensor* TensorExprKernel::computeSum(const torch::jit::Value* v) {
+  auto const& n = v->node();
+  auto const& inputShape = valueShape(n->inputs()[0]);
+  size_t rank = inputShape.size();
+  auto dims = toIValue(n->inputs()[1])->toIntVector();
+  bool keepdim = toIValue(n->inputs()[2])->toBool();
+
+  // An empty dim list reduces all the dims.
+  std::vector<bool> reduced(rank, dims.empty());
+  for (int64_t dim : dims) {
+    if (dim < 0) {
+      dim += rank;
+    }
+    if (dim < 0 || dim >= static_cast<int64_t>(rank)) {
+      throw malformed_input();
+    }
+    reduced[dim] = true;
+  }
+
+  std::vector<DimArg> outputDims;
+  std::vector<DimArg> reduceDims;
+  for (size_t i = 0; i < rank; i++) {
+    if (!reduced[i]) {
+      outputDims.emplace_back(inputShape[i], "i" + std::to_string(i));
+      continue;
+    }
+    reduceDims.emplace_back(inputShape[i], "r" + std::to_string(i));
+    if (keepdim) {
+      outputDims.emplace_back(IntImm::make(1), "i" + std::to_string(i));
+    }
+  }
+  size_t outputRank = outputDims.size();
+
+  return Reduce(
+      "aten_sum",
+      outputDims,
+      Sum(),
+      [this, v, reduced, keepdim, outputRank](
+          const std::vector<VarHandle>& vars) {
+        // vars are the output axes followed by the reduce axes.
+        std::vector<ExprHandle> indices;
+        size_t outputAxis = 0;
+        size_t reduceAxis = outputRank;
+        for (size_t i = 0; i < reduced.size(); i++) {
+          if (!reduced[i]) {
+            indices.push_back(vars[outputAxis++]);
+            continue;
+          }
+          indices.push_back(vars[reduceAxis++]);
+          if (keepdim) {
+            outputAxis++;
+          }
+        }
+        // The body is cast to the output dtype (e.g. long for int inputs),
+        // in which the elements are accumulated.
+        auto const& n = v->node();
+        return demoteOutput(
+            tensorOrConstant(n->inputs()[0], indices), n->output());
+      },
+      reduceDims);
+}
+
 Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
   switch (v->node()->kind()) {
     case aten::add: {
@@ -942,6 +1010,10 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
           });
     }
 
+    case aten::sum: {
+      return computeSum(v);
+    }
+
     default: {
       throw std::runtime_error("Unhandled node kind");
     }
@@ -952,6 +1024,12 @@ void TensorExprKernel::lowerToBackend(BackendType backendType) {
   std::vector<Tensor*> tensorOutputs(tensorOutputs_);
 
   if (backendType == BackendType::kCudaCodeGen) {
+    // The flattening below assumes pointwise tensors.
+    for (auto& p : tensors_) {
+      if (isReduction(p.second)) {
+        throw std::runtime_error("Reductions are not supported on CUDA");
+      }
+    }
     for (size_t tensorIdx = 0; tensorIdx < tensorOutputs_.size(); tensorIdx++) {
       Tensor* tensor = tensorOutputs_[tensorIdx];
       ExprHandle totalCount = ExprHandle(tensor->dim(0));
@@ -992,9 +1070,10 @@ void TensorExprKernel::lowerToBackend(BackendType backendType) {
 
   torch::jit::tensorexpr::schedule::LoopNest l(tensorOutputs);
 
-  // Compute non-output tensors_ inline
+  // Compute non-output tensors_ inline. Reductions are computed into their
+  // own buffers.
   for (auto& p : tensors_) {
-    if (!l.hasLoopBodyFor(p.second)) {
+    if (!l.hasLoopBodyFor(p.second) || isReduction(p.second)) {
       continue;
     }
     Stmt* loop = l.getLoopBodyFor(p.second);
@@ -1048,6 +1127,66 @@ void TensorExprKernel::lowerToBackend(BackendType backendType) {
       }
     }
   } else if (backendType == kLLVMCodeGen) {
+    // Accumulate the innermost reduce axis in a vector of 8 partial sums:
+    // its loop is split by 8 and rfactored into a temporary buffer indexed by
+    // the split inner loop, which the inner loop pass below vectorizes.
+    for (auto& p : tensors_) {
+      Tensor* t = p.second;
+      if (!isReduction(t) || !l.hasLoopBodyFor(t)) {
+        continue;
+      }
+      const ReduceOp* reduceOp = static_cast<const ReduceOp*>(t->body());
+      std::vector<For*> loops = l.getLoopStmtsFor(t);
+      if (loops.empty() ||
+          loops.back()->var() != reduceOp->reduce_args().back()) {
+        continue;
+      }
+      const IntImm* stop = dynamic_cast<const IntImm*>(loops.back()->stop());
+      if (!stop || stop->value() < 8) {
+        continue;
+      }
+      For* outer;
+      For* inner;
+      For* tail;
+      l.SplitWithTail(loops.back(), 8, &outer, &inner, &tail);
+      l.RFactor(t, inner);
+    }
+
+    // Run the outermost loop of the computed tensors (outputs and
+    // reductions) on the intra-op thread pool when they are large enough.
+    for (auto& p : tensors_) {
+      Tensor* t = p.second;
+      if (!l.hasLoopBodyFor(t) || t->ndim() == 0) {
+        continue;
+      }
+      bool isOutput =
+          std::find(tensorOutputs.begin(), tensorOutputs.end(), t) !=
+          tensorOutputs.end();
+      if (!isOutput && !isReduction(t)) {
+        continue;
+      }
+      std::vector<For*> loops = l.getLoopStmtsFor(t);
+      if (loops.empty() || loops[0]->var() != t->arg(0)) {
+        continue;
+      }
+      std::vector<const Expr*> dims = t->dims();
+      if (isReduction(t)) {
+        auto const& reduceDims =
+            static_cast<const ReduceOp*>(t->body())->reduce_dims();
+        dims.insert(dims.end(), reduceDims.begin(), reduceDims.end());
+      }
+      int64_t work = 1;
+      for (const Expr* dim : dims) {
+        const IntImm* dimImm = dynamic_cast<const IntImm*>(dim);
+        work *= dimImm ? dimImm->value() : 1;
+      }
+      const IntImm* tripCount = dynamic_cast<const IntImm*>(loops[0]->stop());
+      if (work >= at::internal::GRAIN_SIZE && tripCount &&
+          tripCount->value() > 1) {
+        l.SetParallel(loops[0]);
+      }
+    }
+
     l.ApplyInlines();
 
     std::vector<For*> innerLoops;
@@ -1112,7 +1251,9 @@ void TensorExprKernel::lowerToBackend(BackendType backendType) {
     }
   }
 
-  l.ApplyInlines();
+  if (backendType != kLLVMCodeGen) {
+    l.ApplyInlines();
+  }
   Stmt* stmt = l.root_stmt();
   stmt = IRSimplifier::simplify(stmt);
 
@@ -152,6 +152,8 @@ class TensorExprKernel {
           const ExprHandle&,
           const ExprHandle&)>& innerExpr);
 
+  Tensor* computeSum(const torch::jit::Value* v);
+
   Tensor* computeValue(const torch::jit::Value* v);
 
   void lowerToBackend(BackendType backendType);
@@ -4,17 +4,23 @@
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
 #include <memory>
+#include <unordered_set>
 
+#include <ATen/Parallel.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
+#include <torch/csrc/jit/codegen/fuser/disk_cache.h>
 #include <torch/csrc/jit/tensorexpr/buffer.h>
 #include <torch/csrc/jit/tensorexpr/execution_counter.h>
 #include <torch/csrc/jit/tensorexpr/ir.h>
@@ -56,6 +62,9 @@ class LLVMCodeGenImpl : public IRVisitor {
   llvm::Type* dtypeToLLVMPtr(Dtype dtype);
   void emitWrapper(const std::vector<llvm::Type*>& params);
   void emitKernel(Stmt* stmt, const std::vector<llvm::Type*>& params);
+  void compileKernel();
+  std::string emitObject();
+  void emitParallelFor(const For* v);
 
  public:
   LLVMCodeGenImpl(
@@ -256,9 +265,8 @@ LLVMCodeGenImpl::LLVMCodeGenImpl(
 
   emitWrapper(params);
   emitKernel(stmt, params);
+  compileKernel();
 
-  cantFail(jit_->addModule(
-      llvm::orc::ThreadSafeModule(std::move(module_), context_)));
   auto sym = jit_->findSymbol("wrapper");
   kernelAddress_ = cantFail(sym.getAddress());
 
@@ -332,8 +340,65 @@ void LLVMCodeGenImpl::emitKernel(
   if (llvm::verifyFunction(*fn_, &llvm::outs())) {
     throw std::runtime_error("Function verification failed");
   }
-  optimize(*module_);
+}
+
+namespace {
 
+// Whether object is object code that defines the symbol wrapper, rather than
+// a truncated or foreign file that ended up in the kernel cache.
+bool isKernelObject(const std::string& object, llvm::StringRef wrapper) {
+  auto file = llvm::object::ObjectFile::createObjectFile(
+      llvm::MemoryBufferRef(object, "cached kernel"));
+  if (!file) {
+    llvm::consumeError(file.takeError());
+    return false;
+  }
+  for (const auto& symbol : (*file)->symbols()) {
+    auto name = symbol.getName();
+    if (!name) {
+      llvm::consumeError(name.takeError());
+      return false;
+    }
+    if (*name == wrapper) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+// With the kernel cache (see fuser/disk_cache.h) enabled, the object code of
+// the module is cached under a key of its unoptimized IR and of the target, so
+// that later processes skip optimizing and compiling the same kernel.
+void LLVMCodeGenImpl::compileKernel() {
+  auto diskCache = fuser::KernelDiskCache::get();
+  std::string key;
+  if (diskCache) {
+    std::string keyContent;
+    llvm::raw_string_ostream keyStream(keyContent);
+    keyStream << *module_ << "\n"
+              << TM_->getTargetCPU() << "\n"
+              << TM_->getTargetFeatureString() << "\n"
+              << LLVM_VERSION_STRING;
+    key = fuser::KernelDiskCache::key(keyStream.str());
+
+    c10::optional<std::string> object = diskCache->read(key, ".o");
+    if (object) {
+      const char prefix = jit_->getDataLayout().getGlobalPrefix();
+      const std::string wrapper =
+          prefix ? std::string(1, prefix) + "wrapper" : "wrapper";
+      if (isKernelObject(*object, wrapper)) {
+        cantFail(
+            jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(*object)));
+        return;
+      }
+      // A corrupt entry is dropped and the kernel compiled again.
+      diskCache->removeCorrupt(key, ".o");
+    }
+  }
+
+  optimize(*module_);
 #if DEBUG_PRINT
   llvm::errs() << *module_;
   llvm::SmallVector<char, 0> asmBuffer;
@@ -347,6 +412,29 @@ void LLVMCodeGenImpl::emitKernel(
   PM.run(*module_);
   llvm::errs() << asmStream.str();
 #endif
+  if (!diskCache) {
+    cantFail(jit_->addModule(
+        llvm::orc::ThreadSafeModule(std::move(module_), context_)));
+    return;
+  }
+  const std::string object = emitObject();
+  diskCache->write(key, ".o", object);
+  cantFail(jit_->addObjectFile(llvm::MemoryBuffer::getMemBufferCopy(object)));
+}
+
+std::string LLVMCodeGenImpl::emitObject() {
+  llvm::SmallVector<char, 0> objBuffer;
+  llvm::raw_svector_ostream objStream(objBuffer);
+  llvm::legacy::PassManager PM;
+  if (TM_->addPassesToEmitFile(
+          PM,
+          objStream,
+          nullptr,
+          llvm::TargetMachine::CodeGenFileType::CGFT_ObjectFile)) {
+    throw std::runtime_error("Target can't emit an object file");
+  }
+  PM.run(*module_);
+  return std::string(objBuffer.begin(), objBuffer.end());
 }
 
 // TODO: The binary ops are copypasta.
@@ -896,6 +984,11 @@ void LLVMCodeGenImpl::visit(const Load* v) {
 }
 
 void LLVMCodeGenImpl::visit(const For* v) {
+  if (v->loop_options().is_parallel()) {
+    emitParallelFor(v);
+    return;
+  }
+
   // Create "start" and "stop" values.
   v->start()->accept(this);
   auto start = this->value_;
@@ -939,6 +1032,166 @@ void LLVMCodeGenImpl::visit(const For* v) {
   value_ = llvm::ConstantInt::get(IntTy_, 0);
 }
 
+namespace {
+
+// Collects the vars a loop body uses that are defined outside of it.
+class CapturedVarFinder : public IRVisitor {
+ public:
+  const std::vector<const Var*>& vars() const {
+    return vars_;
+  }
+
+  void visit(const Var* v) override {
+    if (!defined_.count(v) && seen_.insert(v).second) {
+      vars_.push_back(v);
+    }
+  }
+
+  void visit(const For* v) override {
+    defined_.insert(v->var());
+    IRVisitor::visit(v);
+  }
+
+  void visit(const Let* v) override {
+    defined_.insert(v->var());
+    IRVisitor::visit(v);
+  }
+
+  void visit(const LetStmt* v) override {
+    defined_.insert(v->var());
+    IRVisitor::visit(v);
+  }
+
+  void visit(const Allocate* v) override {
+    defined_.insert(v->buffer_var());
+    IRVisitor::visit(v);
+  }
+
+ private:
+  std::unordered_set<const Var*> defined_;
+  std::unordered_set<const Var*> seen_;
+  std::vector<const Var*> vars_;
+};
+
+// Estimates the number of elements one iteration of a loop stores. Loops
+// with non-constant bounds are counted once.
+class WorkEstimator : public IRVisitor {
+ public:
+  int64_t work() const {
+    return work_;
+  }
+
+  void visit(const For* v) override {
+    int64_t outer_work = work_;
+    work_ = 0;
+    v->body()->accept(this);
+    const IntImm* start = dynamic_cast<const IntImm*>(v->start());
+    const IntImm* stop = dynamic_cast<const IntImm*>(v->stop());
+    int64_t trip_count = 1;
+    if (start && stop) {
+      trip_count = std::max(stop->value() - start->value(), 0);
+    }
+    work_ = outer_work + trip_count * work_;
+  }
+
+  void visit(const Store* v) override {
+    work_ += v->value()->dtype().lanes();
+  }
+
+ private:
+  int64_t work_ = 0;
+};
+
+} // namespace
+
+// A parallel loop is lowered into a call to DispatchParallel (see
+// llvm_jit.cpp), which runs its iterations on the intra-op thread pool. The
+// body is outlined into a function of the loop index and of a struct that
+// packs the values the body uses from the kernel: its buffer arguments, the
+// enclosing loop vars and so on.
+void LLVMCodeGenImpl::emitParallelFor(const For* v) {
+  v->start()->accept(this);
+  auto start = irb_.CreateSExt(value_, LongTy_);
+  v->stop()->accept(this);
+  auto stop = irb_.CreateSExt(value_, LongTy_);
+
+  // Pack the captured values.
+  CapturedVarFinder finder;
+  v->body()->accept(&finder);
+  std::vector<const Var*> captured;
+  std::vector<llvm::Value*> capturedVals;
+  std::vector<llvm::Type*> capturedTys;
+  for (const Var* var : finder.vars()) {
+    if (!varToArg_.count(var) && !varToVal_.count(var)) {
+      continue;
+    }
+    var->accept(this);
+    captured.push_back(var);
+    capturedVals.push_back(value_);
+    capturedTys.push_back(value_->getType());
+  }
+  auto packedTy = llvm::StructType::get(getContext(), capturedTys);
+  llvm::IRBuilder<> entryBuilder(
+      &fn_->getEntryBlock(), fn_->getEntryBlock().begin());
+  auto packed = entryBuilder.CreateAlloca(packedTy);
+  for (size_t i = 0; i < capturedVals.size(); i++) {
+    auto addr = irb_.CreateStructGEP(packedTy, packed, i);
+    irb_.CreateStore(capturedVals[i], addr);
+  }
+
+  // Emit the body into void body(int64_t index, int8_t* packed_data).
+  auto int8PtrTy = llvm::Type::getInt8PtrTy(getContext());
+  auto voidTy = llvm::Type::getVoidTy(getContext());
+  auto bodyFn = llvm::Function::Create(
+      llvm::FunctionType::get(voidTy, {LongTy_, int8PtrTy}, false),
+      llvm::Function::PrivateLinkage,
+      "parallel_body",
+      module_.get());
+
+  llvm::Function* parentFn = fn_;
+  llvm::BasicBlock* parentBlock = irb_.GetInsertBlock();
+  auto parentVarToArg = std::move(varToArg_);
+  auto parentVarToVal = std::move(varToVal_);
+  varToArg_.clear();
+  varToVal_.clear();
+
+  fn_ = bodyFn;
+  irb_.SetInsertPoint(llvm::BasicBlock::Create(getContext(), "entry", fn_));
+  auto bodyPacked =
+      irb_.CreatePointerCast(fn_->arg_begin() + 1, packedTy->getPointerTo());
+  for (size_t i = 0; i < captured.size(); i++) {
+    varToVal_[captured[i]] =
+        irb_.CreateLoad(irb_.CreateStructGEP(packedTy, bodyPacked, i));
+  }
+  varToVal_[v->var()] = irb_.CreateTrunc(fn_->arg_begin(), IntTy_);
+  v->body()->accept(this);
+  irb_.CreateRetVoid();
+
+  fn_ = parentFn;
+  irb_.SetInsertPoint(parentBlock);
+  varToArg_ = std::move(parentVarToArg);
+  varToVal_ = std::move(parentVarToVal);
+
+  // Each task runs at least GRAIN_SIZE elements.
+  WorkEstimator estimator;
+  v->body()->accept(&estimator);
+  int64_t work = std::max(estimator.work(), int64_t{1});
+  int64_t grainSize = std::max(at::internal::GRAIN_SIZE / work, int64_t{1});
+
+  llvm::FunctionCallee dispatchFn = module_->getOrInsertFunction(
+      "DispatchParallel",
+      llvm::FunctionType::get(
+          voidTy, {int8PtrTy, LongTy_, LongTy_, LongTy_, int8PtrTy}, false));
+  irb_.CreateCall(
+      dispatchFn,
+      {irb_.CreatePointerCast(bodyFn, int8PtrTy),
+       start,
+       stop,
+       llvm::ConstantInt::getSigned(LongTy_, grainSize),
+       irb_.CreatePointerCast(packed, int8PtrTy)});
+  value_ = llvm::ConstantInt::get(IntTy_, 0);
+}
+
 void LLVMCodeGenImpl::visit(const Block* v) {
   for (Stmt* s : v->stmts()) {
     s->accept(this);
@@ -1436,12 +1689,65 @@ void LLVMCodeGenImpl::visit(const FunctionCall* v) {
   throw unimplemented_lowering(v);
 }
 
+// Buffers of a constant size up to this many bytes are allocated on the stack.
+// They are usually the partial results of a reduction, which LLVM then keeps
+// in registers.
+static constexpr int64_t kMaxStackAllocBytes = 1024;
+
 void LLVMCodeGenImpl::visit(const Allocate* v) {
-  throw unimplemented_lowering(v);
+  llvm::Type* elementTy = dtypeToLLVM(v->dtype());
+  int64_t numel = 1;
+  bool constantSize = true;
+  for (const Expr* dim : v->dims()) {
+    auto* dimImm = dynamic_cast<const IntImm*>(dim);
+    if (!dimImm) {
+      constantSize = false;
+      break;
+    }
+    numel *= dimImm->value();
+  }
+
+  llvm::Value* buffer = nullptr;
+  if (constantSize && numel * v->dtype().byte_size() <= kMaxStackAllocBytes) {
+    // Allocas belong in the entry block, where they are allocated once even
+    // if the Allocate is in a loop.
+    llvm::IRBuilder<> entryBuilder(
+        &fn_->getEntryBlock(), fn_->getEntryBlock().begin());
+    buffer = entryBuilder.CreateAlloca(
+        elementTy, llvm::ConstantInt::getSigned(LongTy_, numel));
+  } else {
+    llvm::Value* size = llvm::ConstantInt::getSigned(
+        LongTy_, v->dtype().byte_size());
+    for (const Expr* dim : v->dims()) {
+      dim->accept(this);
+      size = irb_.CreateMul(size, irb_.CreateSExt(value_, LongTy_));
+    }
+    auto int8PtrTy = llvm::Type::getInt8PtrTy(getContext());
+    llvm::FunctionCallee mallocFn = module_->getOrInsertFunction(
+        "malloc", llvm::FunctionType::get(int8PtrTy, {LongTy_}, false));
+    buffer = irb_.CreatePointerCast(
+        irb_.CreateCall(mallocFn, {size}), elementTy->getPointerTo());
+  }
+  varToVal_[v->buffer_var()] = buffer;
+  value_ = llvm::ConstantInt::get(IntTy_, 0);
 }
 
 void LLVMCodeGenImpl::visit(const Free* v) {
-  throw unimplemented_lowering(v);
+  auto it = varToVal_.find(v->buffer_var());
+  if (it == varToVal_.end()) {
+    throw malformed_input(v);
+  }
+  // Stack buffers are released when the kernel returns.
+  if (!llvm::isa<llvm::AllocaInst>(it->second)) {
+    auto int8PtrTy = llvm::Type::getInt8PtrTy(getContext());
+    llvm::FunctionCallee freeFn = module_->getOrInsertFunction(
+        "free",
+        llvm::FunctionType::get(
+            llvm::Type::getVoidTy(getContext()), {int8PtrTy}, false));
+    irb_.CreateCall(freeFn, {irb_.CreatePointerCast(it->second, int8PtrTy)});
+  }
+  varToVal_.erase(it);
+  value_ = llvm::ConstantInt::get(IntTy_, 0);
 }
 
 void LLVMCodeGenImpl::visit(const Cond* v) {
@@ -2,6 +2,7 @@
 
 #include <torch/csrc/jit/tensorexpr/llvm_jit.h>
 
+#include <ATen/Parallel.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <sleef.h>
 #include <algorithm>
@@ -9,6 +10,29 @@
 #include <string>
 #include <vector>
 
+namespace {
+
+// Runs callee(index, packed_data) for every index in [start, stop) on the
+// intra-op thread pool. LLVMCodeGen emits calls to it for parallel loops,
+// whose body it outlines into callee, with the values the body uses from the
+// kernel packed into packed_data.
+void DispatchParallel(
+    int8_t* callee,
+    int64_t start,
+    int64_t stop,
+    int64_t grain_size,
+    int8_t* packed_data) {
+  using ParallelCallee = void (*)(int64_t, int8_t*);
+  auto fn = reinterpret_cast<ParallelCallee>(callee);
+  at::parallel_for(start, stop, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t index = begin; index < end; index++) {
+      fn(index, packed_data);
+    }
+  });
+}
+
+} // namespace
+
 namespace llvm {
 namespace orc {
 
@@ -416,6 +440,10 @@ class TORCH_API PytorchLLVMJITImpl {
         *Mangle("Sleef_fmodd4"),
         {llvm::pointerToJITTargetAddress(&Sleef_fmodd4), {}}));
 #endif
+
+    cantFail(LLJ->defineAbsolute(
+        *Mangle("DispatchParallel"),
+        {llvm::pointerToJITTargetAddress(&DispatchParallel), {}}));
   }
 
   Error addModule(ThreadSafeModule M) {
@@ -425,6 +453,10 @@ class TORCH_API PytorchLLVMJITImpl {
     return Error::success();
   }
 
+  Error addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+    return LLJ->addObjectFile(std::move(Obj));
+  }
+
   JITSymbol findSymbol(const std::string Name) {
     return cantFail(LLJ->lookup(Name));
   }
@@ -443,6 +475,10 @@ Error PytorchLLVMJIT::addModule(ThreadSafeModule M) {
   return impl_->addModule(std::move(M));
 }
 
+Error PytorchLLVMJIT::addObjectFile(std::unique_ptr<MemoryBuffer> Obj) {
+  return impl_->addObjectFile(std::move(Obj));
+}
+
 JITSymbol PytorchLLVMJIT::findSymbol(const std::string Name) {
   return impl_->findSymbol(std::move(Name));
 }
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <torch/csrc/jit/tensorexpr/expr.h>
+#include <torch/csrc/jit/tensorexpr/ir.h>
+#include <torch/csrc/jit/tensorexpr/types.h>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+// A Reducer is the initial value of a reduction and the combiner that folds
+// one more element into the accumulator. The combiner must be associative:
+// scheduling (e.g. LoopNest::RFactor) changes the order in which the elements
+// are combined.
+class Reducer {
+ public:
+  using ReduceInteraction =
+      std::function<ExprHandle(const ExprHandle&, const ExprHandle&)>;
+
+  Reducer(const ExprHandle& init, ReduceInteraction interaction)
+      : init_(init.node()), interaction_(std::move(interaction)) {}
+
+  // The initial value of an accumulator of the given dtype.
+  ExprHandle initializer(Dtype dtype) const {
+    if (init_->dtype() == dtype) {
+      return ExprHandle(init_);
+    }
+    return Cast::make(dtype, ExprHandle(init_));
+  }
+
+  ExprHandle combine(const ExprHandle& accumulator, const ExprHandle& value)
+      const {
+    return interaction_(accumulator, value);
+  }
+
+ private:
+  const Expr* init_;
+  ReduceInteraction interaction_;
+};
+
+class Sum : public Reducer {
+ public:
+  Sum()
+      : Reducer(ExprHandle(0), [](const ExprHandle& a, const ExprHandle& b) {
+          return a + b;
+        }) {}
+};
+
+class Product : public Reducer {
+ public:
+  Product()
+      : Reducer(ExprHandle(1), [](const ExprHandle& a, const ExprHandle& b) {
+          return a * b;
+        }) {}
+};
+
+// The identity of Maximum: -inf for floating point types, the lowest value
+// otherwise.
+inline ExprHandle maximumIdentity(ScalarType type) {
+  switch (type) {
+#define MAX_IDENTITY_CASE(Type, Name)                          \
+  case ScalarType::Name:                                       \
+    return ExprHandle(                                         \
+        std::numeric_limits<Type>::has_infinity                \
+            ? static_cast<Type>(                               \
+                  -std::numeric_limits<Type>::infinity())      \
+            : std::numeric_limits<Type>::lowest());
+    AT_FORALL_SCALAR_TYPES_AND(Half, MAX_IDENTITY_CASE);
+#undef MAX_IDENTITY_CASE
+    default:
+      throw unsupported_dtype();
+  }
+  return ExprHandle();
+}
+
+// The identity of Minimum: +inf for floating point types, the largest value
+// otherwise.
+inline ExprHandle minimumIdentity(ScalarType type) {
+  switch (type) {
+#define MIN_IDENTITY_CASE(Type, Name)                          \
+  case ScalarType::Name:                                       \
+    return ExprHandle(                                         \
+        std::numeric_limits<Type>::has_infinity                \
+            ? std::numeric_limits<Type>::infinity()            \
+            : std::numeric_limits<Type>::max());
+    AT_FORALL_SCALAR_TYPES_AND(Half, MIN_IDENTITY_CASE);
+#undef MIN_IDENTITY_CASE
+    default:
+      throw unsupported_dtype();
+  }
+  return ExprHandle();
+}
+
+// Maximum and Minimum propagate NaNs, like torch.max and torch.min.
+class Maximum : public Reducer {
+ public:
+  explicit Maximum(Dtype dtype)
+      : Reducer(
+            maximumIdentity(dtype.scalar_type()),
+            [](const ExprHandle& a, const ExprHandle& b) {
+              return Max::make(a, b, true);
+            }) {}
+};
+
+class Minimum : public Reducer {
+ public:
+  explicit Minimum(Dtype dtype)
+      : Reducer(
+            minimumIdentity(dtype.scalar_type()),
+            [](const ExprHandle& a, const ExprHandle& b) {
+              return Min::make(a, b, true);
+            }) {}
+};
+
+// The combination by a Reducer of body over the reduce axes reduce_args,
+// which range over [0, reduce_dims). A ReduceOp is only valid as the body of
+// a Function (see Reduce() in tensor.h): Function::ElementStmt lowers it into
+// the initialization of the element followed by a loop nest over the reduce
+// axes, so codegens never see it.
+class ReduceOp : public ExprNode<ReduceOp> {
+ public:
+  ReduceOp(
+      const Expr* body,
+      const std::vector<const Var*>& reduce_args,
+      const std::vector<const Expr*>& reduce_dims,
+      const Reducer& reducer)
+      : ExprNodeBase(body->dtype()),
+        body_(body),
+        reduce_args_(reduce_args),
+        reduce_dims_(reduce_dims),
+        reducer_(reducer) {
+    if (reduce_args_.size() != reduce_dims_.size()) {
+      throw malformed_input();
+    }
+  }
+
+  const Expr* body() const {
+    return body_;
+  }
+  const std::vector<const Var*>& reduce_args() const {
+    return reduce_args_;
+  }
+  const std::vector<const Expr*>& reduce_dims() const {
+    return reduce_dims_;
+  }
+  const Reducer& reducer() const {
+    return reducer_;
+  }
+
+ private:
+  const Expr* body_;
+  std::vector<const Var*> reduce_args_;
+  std::vector<const Expr*> reduce_dims_;
+  Reducer reducer_;
+};
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
@@ -9,6 +9,7 @@
 #include <torch/csrc/jit/tensorexpr/eval.h>
 #include <torch/csrc/jit/tensorexpr/ir_mutator.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
 namespace torch {
@@ -25,6 +26,73 @@ static T EvalConstExpr(const ExprHandle& expr) {
   return eval.value<T>();
 }
 
+// Whether an expression depends on a variable.
+class UsesVar : public IRVisitor {
+ public:
+  UsesVar(const Expr* expr, const Var* var) : var_(var) {
+    expr->accept(this);
+  }
+
+  bool uses_var() const {
+    return uses_var_;
+  }
+
+ private:
+  void visit(const Var* v) override {
+    uses_var_ |= v == var_;
+  }
+
+  const Var* var_;
+  bool uses_var_ = false;
+};
+
+static bool usesVar(const Expr* expr, const Var* var) {
+  return UsesVar(expr, var).uses_var();
+}
+
+// Collects the Stores to a buffer.
+class StoreFinder : public IRVisitor {
+ public:
+  StoreFinder(Stmt* stmt, const Var* buffer) : buffer_(buffer) {
+    stmt->accept(this);
+  }
+
+  const std::vector<const Store*>& stores() const {
+    return stores_;
+  }
+
+ private:
+  void visit(const Store* v) override {
+    if (v->base_handle() == buffer_) {
+      stores_.push_back(v);
+    }
+    IRVisitor::visit(v);
+  }
+
+  const Var* buffer_;
+  std::vector<const Store*> stores_;
+};
+
+// Replaces the Loads of a buffer with Loads of another buffer at a fixed
+// index.
+class LoadReplacer : public IRMutator {
+ public:
+  LoadReplacer(const Var* buffer, const Var* new_buffer, const Expr* new_index)
+      : buffer_(buffer), new_buffer_(new_buffer), new_index_(new_index) {}
+
+  const Expr* mutate(const Load* v) override {
+    if (v->base_handle() != buffer_) {
+      return IRMutator::mutate(v);
+    }
+    return new Load(v->dtype(), new_buffer_, new_index_, v->mask());
+  }
+
+ private:
+  const Var* buffer_;
+  const Var* new_buffer_;
+  const Expr* new_index_;
+};
+
 } // namespace
 
 class Vectorizer : public IRMutator {
@@ -205,6 +273,12 @@ class Vectorizer : public IRMutator {
     const Var* base_handle = v->base_handle();
     std::vector<const Expr*> inputs = {v->index(), v->value(), v->mask()};
     return try_vectorize(v, inputs, [&]() {
+      // All the lanes would store to the same element, e.g. the accumulator
+      // of a reduction, whose update must see the previous lane's result.
+      if (dynamic_cast<const Broadcast*>(inputs[0])) {
+        throw std::runtime_error(
+            "Can't vectorize a Store to a loop-invariant index!");
+      }
       return Store::make(
           VarHandle(base_handle),
           ExprHandle(inputs[0]),
@@ -646,8 +720,17 @@ Stmt* LoopNest::LowerToStmt(Tensor* t) {
   // TODO: Support multiple-output functions
   Stmt* body = f->ElementStmt(0);
 
-  stmt_to_tensor_[body] = t;
-  tensor_to_stmt_[t] = body;
+  // The element of a reduction is computed by the update of the accumulator,
+  // in the innermost reduce loop.
+  Stmt* element_stmt = body;
+  if (dynamic_cast<const ReduceOp*>(f->body(0))) {
+    element_stmt = dynamic_cast<Block*>(body)->stmts().back();
+    while (For* loop = dynamic_cast<For*>(element_stmt)) {
+      element_stmt = loop->body()->stmts().front();
+    }
+  }
+  stmt_to_tensor_[element_stmt] = t;
+  tensor_to_stmt_[t] = element_stmt;
 
   if (f->ndim() == 0) {
     return body;
@@ -666,13 +749,24 @@ Stmt* LoopNest::LowerToStmt(Tensor* t) {
   return body;
 }
 
+static void checkNotReduction(Tensor* t) {
+  if (dynamic_cast<const ReduceOp*>(t->body())) {
+    throw std::runtime_error(
+        "Can't inline the reduction " + t->func_var()->name_hint());
+  }
+}
+
 void LoopNest::ComputeInline(Stmt* s) {
   // TODO: check if `s` is a body of a loop
-  inlined_functions_.insert(stmt_to_tensor_.at(s)->function());
+  Tensor* t = stmt_to_tensor_.at(s);
+  checkNotReduction(t);
+  inlined_functions_.insert(t->function());
 }
 
 void LoopNest::ComputeInlineWithRandom(Stmt* s) {
-  inlined_random_functions_.insert(stmt_to_tensor_.at(s)->function());
+  Tensor* t = stmt_to_tensor_.at(s);
+  checkNotReduction(t);
+  inlined_random_functions_.insert(t->function());
 }
 
 void LoopNest::ApplyInlines() {
@@ -721,6 +815,15 @@ void LoopNest::ApplyInlines() {
   root_stmt_ = combined_stmt;
 }
 
+// The options of the outer loop of a split of f, which stays parallel.
+static LoopOptions outerLoopOptions(For* f) {
+  LoopOptions loop_options;
+  if (f->loop_options().is_parallel()) {
+    loop_options.set_parallel();
+  }
+  return loop_options;
+}
+
 void LoopNest::SplitWithTail(
     For* f,
     int factor,
@@ -763,7 +866,7 @@ void LoopNest::SplitWithTail(
       Substitute(Stmt::clone(f->body()), {{f->var(), combined_index1}});
 
   *inner = For::make(i_inner, 0, factor, body_inner);
-  *outer = For::make(i_outer, 0, split_count, *inner);
+  *outer = For::make(i_outer, 0, split_count, *inner, outerLoopOptions(f));
 
   // TODO: cleanup API for adding/removing statements
   p->replace_stmt(f, *outer);
@@ -833,7 +936,7 @@ void LoopNest::SplitWithMask(For* f, int factor, For** outer, For** inner) {
   body_inner = Substitute(body_inner, {{f->var(), combined_index}});
 
   *inner = For::make(i_inner, 0, factor, body_inner);
-  *outer = For::make(i_outer, 0, split_count, *inner);
+  *outer = For::make(i_outer, 0, split_count, *inner, outerLoopOptions(f));
 
   // TODO: cleanup API for adding/removing statements
   p->replace_stmt(f, *outer);
@@ -841,6 +944,156 @@ void LoopNest::SplitWithMask(For* f, int factor, For** outer, For** inner) {
   // TODO: record history of transformations
 }
 
+void LoopNest::Reorder(
+    For* outer,
+    For* inner,
+    For** new_outer,
+    For** new_inner) {
+  Block* p = dynamic_cast<Block*>(outer->get_parent());
+  if (!p) {
+    throw malformed_input(outer);
+  }
+
+  // The loops from outer down to inner.
+  std::vector<For*> loops = {outer};
+  while (loops.back() != inner) {
+    Block* body = loops.back()->body();
+    For* next = body->nstmts() == 1 ? dynamic_cast<For*>(body->stmts().front())
+                                    : nullptr;
+    if (!next) {
+      throw std::runtime_error("Can't reorder loops of an imperfect nest!");
+    }
+    loops.push_back(next);
+  }
+  // The bounds of the interchanged loops must not depend on the loops in
+  // between, and the other way around.
+  for (For* loop : loops) {
+    for (const Expr* bound :
+         {outer->start(), outer->stop(), inner->start(), inner->stop()}) {
+      if (usesVar(bound, loop->var())) {
+        throw std::runtime_error("Can't reorder loops with dependent bounds!");
+      }
+    }
+    for (const Expr* bound : {loop->start(), loop->stop()}) {
+      if (usesVar(bound, outer->var()) || usesVar(bound, inner->var())) {
+        throw std::runtime_error("Can't reorder loops with dependent bounds!");
+      }
+    }
+  }
+
+  std::swap(loops.front(), loops.back());
+  Stmt* body = Stmt::clone(inner->body());
+  for (size_t i = loops.size(); i > 0; i--) {
+    For* loop = loops[i - 1];
+    body = new For(
+        loop->var(), loop->start(), loop->stop(), body, loop->loop_options());
+    if (i == loops.size()) {
+      *new_inner = static_cast<For*>(body);
+    }
+  }
+  *new_outer = static_cast<For*>(body);
+  p->replace_stmt(outer, *new_outer);
+}
+
+void LoopNest::RFactor(Tensor* t, For* f) {
+  const ReduceOp* reduce_op = dynamic_cast<const ReduceOp*>(t->body());
+  if (!reduce_op) {
+    throw std::runtime_error(
+        "Can't rfactor " + t->func_var()->name_hint() +
+        ", which is not a reduction!");
+  }
+  const IntImm* start = dynamic_cast<const IntImm*>(f->start());
+  const IntImm* stop = dynamic_cast<const IntImm*>(f->stop());
+  if (!start || !stop) {
+    throw std::runtime_error("Can't rfactor due to non-constant loop bounds!");
+  }
+
+  // The update of the accumulator, in the body of f.
+  const Var* buffer = t->func_var();
+  StoreFinder finder(f->body(), buffer);
+  if (finder.stores().size() != 1) {
+    throw std::runtime_error(
+        "Can't rfactor a loop that doesn't update the reduction once!");
+  }
+  Store* update = const_cast<Store*>(finder.stores()[0]); // NOLINT
+  const Expr* index = update->index();
+
+  // The loops from the update up to f, and then up to the outermost reduce
+  // loop, must all be reduce loops: the index of the element doesn't depend
+  // on them.
+  For* outermost = nullptr;
+  bool is_reduce_loop = false;
+  for (Stmt* s = update->get_parent(); s; s = s->get_parent()) {
+    if (dynamic_cast<Block*>(s)) {
+      continue;
+    }
+    For* loop = dynamic_cast<For*>(s);
+    if (!loop || usesVar(index, loop->var())) {
+      break;
+    }
+    is_reduce_loop |= loop == f;
+    outermost = loop;
+  }
+  if (!is_reduce_loop) {
+    throw std::runtime_error(
+        "Can't rfactor a loop which is not a reduce axis!");
+  }
+  Block* p = dynamic_cast<Block*>(outermost->get_parent());
+  if (!p) {
+    throw malformed_input(outermost);
+  }
+
+  int size = stop->value() - start->value();
+  Dtype dtype = reduce_op->dtype();
+  const Reducer& reducer = reduce_op->reducer();
+  const Expr* mask = update->mask();
+  VarHandle tmp(buffer->name_hint() + "_rfac", kHandle);
+  ExprHandle tmp_index = ExprHandle(f->var());
+  if (start->value() != 0) {
+    tmp_index = tmp_index - ExprHandle(start->value());
+  }
+
+  // Accumulate into tmp[f].
+  LoadReplacer replacer(buffer, tmp.node(), tmp_index.node());
+  Store* new_update = new Store(
+      tmp.node(),
+      tmp_index.node(),
+      update->value()->accept_mutator(&replacer),
+      mask);
+  dynamic_cast<Block*>(update->get_parent())->replace_stmt(update, new_update);
+  stmt_to_tensor_.erase(update);
+  stmt_to_tensor_[new_update] = t;
+  tensor_to_stmt_[t] = new_update;
+
+  const std::string& loop_var_name = f->var()->name_hint();
+  Dtype loop_var_dtype = f->var()->dtype();
+  VarHandle i_init(loop_var_name + "_init", loop_var_dtype);
+  Stmt* init = For::make(
+      i_init,
+      0,
+      size,
+      Store::make(tmp, i_init, reducer.initializer(dtype), ExprHandle(mask)));
+
+  VarHandle i_combine(loop_var_name + "_combine", loop_var_dtype);
+  ExprHandle accumulator =
+      Load::make(dtype, VarHandle(buffer), ExprHandle(index), ExprHandle(mask));
+  ExprHandle partial = Load::make(dtype, tmp, i_combine, ExprHandle(mask));
+  Stmt* combine = For::make(
+      i_combine,
+      0,
+      size,
+      Store::make(
+          VarHandle(buffer),
+          ExprHandle(index),
+          reducer.combine(accumulator, partial),
+          ExprHandle(mask)));
+
+  p->insert_stmt_before(Allocate::make(tmp, dtype, {size}), outermost);
+  p->insert_stmt_before(init, outermost);
+  p->insert_stmt_after(Free::make(tmp), outermost);
+  p->insert_stmt_after(combine, outermost);
+}
+
 std::vector<For*> LoopNest::getLoopStmtsFor(Tensor* t) const {
   std::vector<For*> result;
   Stmt* cur_stmt = tensor_to_stmt_.at(t);
@@ -861,6 +1114,10 @@ void LoopNest::SetGPUThreadIndex(For* f, int thread_index) {
   f->set_gpu_thread_index(thread_index);
 }
 
+void LoopNest::SetParallel(For* f) {
+  f->set_parallel();
+}
+
 Stmt* LoopNest::getLoopBodyFor(Tensor* t) const {
   return tensor_to_stmt_.at(t);
 }
@@ -20,6 +20,8 @@ class TORCH_API LoopNest {
     return root_stmt_;
   }
 
+  // The loops around the computation of an element of the tensor, outermost
+  // first. For a reduction, they end with the reduce axes.
   std::vector<For*> getLoopStmtsFor(Tensor*) const;
   Stmt* getLoopBodyFor(Tensor*) const;
   bool hasLoopBodyFor(Tensor*) const;
@@ -32,9 +34,29 @@ class TORCH_API LoopNest {
   void SplitWithTail(For* f, int factor, For** outer, For** inner, For** tail);
   void SplitWithMask(For* f, int factor, For** outer, For** inner);
 
+  // Interchanges the loops outer and inner of a perfect loop nest: every
+  // loop from outer down to the parent of inner has a single statement, the
+  // next loop, as its body.
+  void Reorder(For* outer, For* inner, For** new_outer, For** new_inner);
+
+  // Accumulates the reduction t into a temporary buffer indexed by its reduce
+  // axis f instead of into the element itself, and combines the buffer into
+  // the element after the reduce loops. The loop f, which must have constant
+  // bounds, then no longer carries a dependence and can be vectorized, e.g.:
+  //   SplitWithTail(k, 8, &k_outer, &k_inner, &k_tail);
+  //   RFactor(t, k_inner);
+  //   Vectorize(k_inner);
+  // keeps 8 partial results in a vector register.
+  void RFactor(Tensor* t, For* f);
+
   void SetGPUBlockIndex(For* f, int idx);
   void SetGPUThreadIndex(For* f, int idx);
 
+  // Runs the iterations of f in parallel on CPU. The iterations must be
+  // independent: f must not be a reduce axis. Splitting f keeps the outer
+  // loop parallel.
+  void SetParallel(For* f);
+
  private:
   std::vector<Tensor*> FindAllNeededTensors(
       const std::vector<Tensor*>& tensors);
@@ -135,6 +135,13 @@ class Block : public StmtNode<Block> {
     set_parent(new_stmt, this);
     return true;
   }
+  // Inserts s right before (after) the statement pos of this block.
+  void insert_stmt_before(Stmt* s, Stmt* pos) {
+    insert_stmt(s, pos, false);
+  }
+  void insert_stmt_after(Stmt* s, Stmt* pos) {
+    insert_stmt(s, pos, true);
+  }
   std::list<Stmt*> stmts() const {
     return stmts_;
   }
@@ -151,6 +158,22 @@ class Block : public StmtNode<Block> {
   }
 
  private:
+  void insert_stmt(Stmt* s, Stmt* pos, bool after) {
+    if (s->get_parent()) {
+      throw malformed_input(s);
+    }
+
+    auto it = std::find(stmts_.begin(), stmts_.end(), pos);
+    if (it == stmts_.end()) {
+      throw malformed_input(pos);
+    }
+    if (after) {
+      ++it;
+    }
+    stmts_.insert(it, s);
+    set_parent(s, this);
+  }
+
   std::list<Stmt*> stmts_;
 };
 
@@ -367,6 +390,9 @@ class LoopOptions {
     if (is_gpu_thread_index()) {
       throw std::runtime_error("Cannot set both gpu block and thread index");
     }
+    if (is_parallel()) {
+      throw std::runtime_error("Cannot set both gpu index and parallel");
+    }
     if (is_gpu_block_index() && gpu_block_index() != index) {
       throw std::runtime_error(
           "Cannot set a previously set block index: " +
@@ -403,6 +429,9 @@ class LoopOptions {
     if (is_gpu_block_index()) {
       throw std::runtime_error("Cannot set both gpu thread and block index");
     }
+    if (is_parallel()) {
+      throw std::runtime_error("Cannot set both gpu index and parallel");
+    }
     if (is_gpu_thread_index() && gpu_thread_index() != index) {
       throw std::runtime_error(
           "Cannot set a previously set thread index: " +
@@ -411,12 +440,27 @@ class LoopOptions {
     gpu_thread_index_ = index;
   }
 
+  // Parallel loops run their iterations on the intra-op thread pool of the
+  // CPU (at::parallel_for).
+  bool is_parallel() const {
+    return is_parallel_;
+  }
+
+  void set_parallel() {
+    if (is_gpu_block_index() || is_gpu_thread_index()) {
+      throw std::runtime_error("Cannot set both gpu index and parallel");
+    }
+    is_parallel_ = true;
+  }
+
   std::string ToString() const {
     std::ostringstream oss;
     if (is_gpu_block_index()) {
       oss << gpu_block_index_str();
     } else if (is_gpu_thread_index()) {
       oss << gpu_thread_index_str();
+    } else if (is_parallel()) {
+      oss << "parallel";
     }
     return oss.str();
   }
@@ -424,6 +468,7 @@ class LoopOptions {
  private:
   int gpu_block_index_ = -1;
   int gpu_thread_index_ = -1;
+  bool is_parallel_ = false;
 };
 
 class For : public StmtNode<For> {
@@ -517,6 +562,10 @@ class For : public StmtNode<For> {
     loop_options_.set_gpu_thread_index(thread_index);
   }
 
+  void set_parallel() {
+    loop_options_.set_parallel();
+  }
+
  private:
   const Var* var_;
   const Expr* start_;
@@ -5,6 +5,7 @@
 
 #include <torch/csrc/jit/tensorexpr/expr.h>
 #include <torch/csrc/jit/tensorexpr/function.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 
 namespace torch {
 namespace jit {
@@ -108,6 +109,27 @@ TORCH_API Tensor* Compute(
     const std::vector<DimArg>& dim_args,
     const std::function<ExprHandle(const std::vector<VarHandle>&)>& body_func);
 
+// Reduce builds a tensor over dim_args whose every element is the combination
+// by reducer of body_func over reduce_args, e.g. a row sum of A:
+//    Reduce("sum", {{M, "m"}}, Sum(), [&](const std::vector<VarHandle>& v) {
+//      return A->call(v[0], v[1]);
+//    }, {{N, "n"}});
+// body_func receives the vars of dim_args followed by the vars of
+// reduce_args.
+TORCH_API Tensor* Reduce(
+    const std::string& func_name,
+    const std::vector<DimArg>& dim_args,
+    const Reducer& reducer,
+    const std::function<ExprHandle(const std::vector<VarHandle>&)>& body_func,
+    const std::vector<DimArg>& reduce_args);
+// Reduces tensor over its trailing reduce_args.size() dims.
+TORCH_API Tensor* Reduce(
+    const std::string& func_name,
+    const std::vector<DimArg>& dim_args,
+    const Reducer& reducer,
+    Tensor* tensor,
+    const std::vector<DimArg>& reduce_args);
+
 class FunctionCall : public CallNode<FunctionCall> {
  public:
   using BaseClass = CallNode<FunctionCall>;
@@ -437,6 +437,31 @@ class DistributedDataParallel(Module):
         finally:
             self.require_backward_grad_sync = old_require_backward_grad_sync
 
+    def _register_builtin_comm_hook(self, comm_hook_type, **kwargs):
+        r"""
+        Replaces the allreduce of gradient buckets with a built-in
+        communication hook that compresses the gradients on the wire. Must be
+        called before the first backward pass, and at most once.
+
+        Arguments:
+            comm_hook_type (dist.BuiltinCommHookType): ``FP16_COMPRESS`` or
+                ``BF16_COMPRESS`` to send 16-bit gradients, ``POWER_SGD`` for
+                low-rank compression, ``TOPK_COMPRESS`` for top-k
+                sparsification. The last two feed the compression error back
+                into the next iteration.
+            matrix_approximation_rank (int, optional): rank used by
+                ``POWER_SGD`` (default: 1).
+            topk_ratio (float, optional): fraction of the gradient entries
+                sent by ``TOPK_COMPRESS`` (default: 0.01).
+
+        Example::
+
+            >>> ddp = torch.nn.DistributedDataParallel(model, pg)
+            >>> ddp._register_builtin_comm_hook(dist.BuiltinCommHookType.FP16_COMPRESS)
+        """
+        self.reducer._register_builtin_comm_hook(
+            comm_hook_type, self.process_group, **kwargs)
+
     def forward(self, *inputs, **kwargs):
         if self.require_forward_param_sync:
             self._sync_params()